@@ -62,7 +62,7 @@ bool Application::OnInit()
         notifyAppError(msg);
     });
 
-    try { imageResourcesInit(appendPath(fff::getResourceDirPath(), Zstr("Icons.zip"))); }
+    try { imageResourcesInit(appendPath(fff::getResourceDirPath(), Zstr("Icons.zip")), fff::getConfigDirPath()); }
     catch (const FileError& e) { logExtraError(e.toString()); } //not critical in this context
 
     //GTK should already have been initialized by wxWidgets (see \src\gtk\app.cpp:wxApp::Initialize)
@@ -5,10 +5,12 @@
 // *****************************************************************************
 
 #include "abstract.h"
+#include "block_size_tuning.h"
 #include <zen/serialize.h>
 #include <zen/guid.h>
 #include <zen/crc.h>
 #include <zen/ring_buffer.h>
+#include <zen/trace.h>
 #include <typeindex>
 
 using namespace zen;
@@ -95,6 +97,10 @@ void AFS::traverseFolder(const AfsPath& folderPath, //throw FileError
 AFS::FileCopyResult AFS::copyFileAsStream(const AfsPath& sourcePath, const StreamAttributes& attrSource, //throw FileError, ErrorFileLocked, X
                                           const AbstractPath& targetPath, const IoCallback& notifyUnbufferedIO /*throw X*/) const
 {
+    TraceSpan span("AFS::copyFileAsStream");
+    if (span)
+        span.setDevice(utfTo<std::string>(getDisplayPath(AfsPath())));
+
     int64_t totalBytesNotified = 0;
     IOCallbackDivider notifyIoDiv(notifyUnbufferedIO, totalBytesNotified);
 
@@ -118,17 +124,21 @@ AFS::FileCopyResult AFS::copyFileAsStream(const AfsPath& sourcePath, const Strea
     auto streamOut = getOutputStream(targetPath, attrSourceNew.fileSize, attrSourceNew.modTime); //throw FileError
 
 
+    const size_t blockSizeOut = streamOut->getBlockSize(); //throw FileError
+
     unbufferedStreamCopy([&](void* buffer, size_t bytesToRead)
     {
         return streamIn->tryRead(buffer, bytesToRead, notifyUnbufferedRead); //throw FileError, ErrorFileLocked, X
     },
-    streamIn->getBlockSize() /*throw FileError*/,
+    streamIn->getBlockSize() /*throw FileError*/ * getReadBlockMultiplier(*this, sourcePath),
 
     [&](const void* buffer, size_t bytesToWrite)
     {
+        if (bytesToWrite > blockSizeOut) //tuned block size: stream contract still requires multiples of its own block size (except for the last one)
+            bytesToWrite -= bytesToWrite % blockSizeOut;
         return streamOut->tryWrite(buffer, bytesToWrite, notifyUnbufferedWrite); //throw FileError, X
     },
-    streamOut->getBlockSize() /*throw FileError*/); //throw FileError, ErrorFileLocked, X
+    blockSizeOut * getWriteBlockMultiplier(targetPath.afsDevice.ref(), targetPath.afsPath)); //throw FileError, ErrorFileLocked, X
 
 
     //check incomplete input *before* failing with (slightly) misleading error message in OutputStream::finalize()
@@ -147,6 +157,8 @@ AFS::FileCopyResult AFS::copyFileAsStream(const AfsPath& sourcePath, const Strea
         throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(getDisplayPath(targetPath))),
                         _("Unexpected size of data stream:") + L' ' + formatNumber(totalBytesWritten) + L'\n' +
                         _("Expected:") + L' ' + formatNumber(totalBytesRead) + L" [notifyUnbufferedWrite]");
+
+    span.addBytes(totalBytesWritten);
     return
     {
         .fileSize        = attrSourceNew.fileSize,
@@ -172,6 +184,10 @@ AFS::FileCopyResult AFS::copyFileTransactional(const AbstractPath& sourcePath, c
                                                const std::function<void()>& onDeleteTargetFile,
                                                const IoCallback& notifyUnbufferedIO /*throw X*/)
 {
+    IoOpScope ios(targetPath.afsDevice, IoOp::copy);
+    ZEN_ON_SCOPE_SUCCESS(fff::impl::recordIoBytes(sourcePath.afsDevice, makeSigned(attrSource.fileSize), 0);
+                         fff::impl::recordIoBytes(targetPath.afsDevice, 0, makeSigned(attrSource.fileSize)));
+
     auto copyFilePlain = [&](const AbstractPath& targetPathTmp)
     {
         //caveat: typeid returns static type for pointers, dynamic type for references!!!
@@ -13,6 +13,7 @@
 #include <zen/file_path.h>
 #include <zen/serialize.h> //InputStream/OutputStream support buffered stream concept
 #include <wx+/image_holder.h> //NOT a wxWidgets dependency!
+#include "io_metrics.h"
 
 
 namespace fff
@@ -46,7 +47,7 @@ struct AbstractPath //THREAD-SAFETY: like an int!
 };
 //==============================================================================================================
 
-struct AbstractFileSystem //THREAD-SAFETY: "const" member functions must model thread-safe access!
+struct AbstractFileSystem : public std::enable_shared_from_this<AbstractFileSystem> //THREAD-SAFETY: "const" member functions must model thread-safe access!
 {
     //=============== convenience =================
     static Zstring getItemName(const AbstractPath& itemPath) { assert(getParentPath(itemPath)); return getItemName(itemPath.afsPath); }
@@ -90,21 +91,21 @@ struct AbstractFileSystem //THREAD-SAFETY: "const" member functions must model t
     };
     //(hopefully) fast: does not distinguish between error/not existing
     //root path? => do access test
-    static ItemType getItemType(const AbstractPath& itemPath) { return itemPath.afsDevice.ref().getItemType(itemPath.afsPath); } //throw FileError
+    static ItemType getItemType(const AbstractPath& itemPath) { IoOpScope ios(itemPath.afsDevice, IoOp::stat); return itemPath.afsDevice.ref().getItemType(itemPath.afsPath); } //throw FileError
 
     //assumes: - folder traversal access right (=> yes, because we can assume base path exist at this point; e.g. avoids problem when SFTP parent paths might deny access)
     //         - all child item path parts must correspond to folder traversal
     //           => conclude whether an item is *not* existing anymore by doing a *case-sensitive* name search => potentially SLOW!
     //         - root path? => do access test
     static std::optional<ItemType> getItemTypeIfExists(const AbstractPath& itemPath)
-    { return itemPath.afsDevice.ref().getItemTypeIfExists(itemPath.afsPath); } //throw FileError
+    { IoOpScope ios(itemPath.afsDevice, IoOp::stat); return itemPath.afsDevice.ref().getItemTypeIfExists(itemPath.afsPath); } //throw FileError
 
     static bool itemExists(const AbstractPath& itemPath) { return static_cast<bool>(getItemTypeIfExists(itemPath)); } //throw FileError
     //----------------------------------------------------------------------------------------------------------------
 
     //already existing: fail
     //does NOT create parent directories recursively if not existing
-    static void createFolderPlain(const AbstractPath& folderPath) { folderPath.afsDevice.ref().createFolderPlain(folderPath.afsPath); } //throw FileError
+    static void createFolderPlain(const AbstractPath& folderPath) { IoOpScope ios(folderPath.afsDevice, IoOp::create); folderPath.afsDevice.ref().createFolderPlain(folderPath.afsPath); } //throw FileError
 
     //creates directories recursively if not existing
     //returns false if folder already exists
@@ -114,15 +115,15 @@ struct AbstractFileSystem //THREAD-SAFETY: "const" member functions must model t
                                               const std::function<void(const std::wstring& displayPath)>& onBeforeFileDeletion    /*throw X*/, //
                                               const std::function<void(const std::wstring& displayPath)>& onBeforeSymlinkDeletion /*throw X*/, //optional; one call for each object!
                                               const std::function<void(const std::wstring& displayPath)>& onBeforeFolderDeletion  /*throw X*/) //
-    { return folderPath.afsDevice.ref().removeFolderIfExistsRecursion(folderPath.afsPath, onBeforeFileDeletion, onBeforeSymlinkDeletion, onBeforeFolderDeletion); }
+    { IoOpScope ios(folderPath.afsDevice, IoOp::remove); return folderPath.afsDevice.ref().removeFolderIfExistsRecursion(folderPath.afsPath, onBeforeFileDeletion, onBeforeSymlinkDeletion, onBeforeFolderDeletion); }
 
     static void removeFileIfExists       (const AbstractPath& filePath);   //
     static void removeSymlinkIfExists    (const AbstractPath& linkPath);   //throw FileError
     static void removeEmptyFolderIfExists(const AbstractPath& folderPath); //
 
-    static void removeFilePlain   (const AbstractPath& filePath  ) { filePath  .afsDevice.ref().removeFilePlain   (filePath  .afsPath); } //
-    static void removeSymlinkPlain(const AbstractPath& linkPath  ) { linkPath  .afsDevice.ref().removeSymlinkPlain(linkPath  .afsPath); } //throw FileError
-    static void removeFolderPlain (const AbstractPath& folderPath) { folderPath.afsDevice.ref().removeFolderPlain (folderPath.afsPath); } //
+    static void removeFilePlain   (const AbstractPath& filePath  ) { IoOpScope ios(filePath  .afsDevice, IoOp::remove); filePath  .afsDevice.ref().removeFilePlain   (filePath  .afsPath); } //
+    static void removeSymlinkPlain(const AbstractPath& linkPath  ) { IoOpScope ios(linkPath  .afsDevice, IoOp::remove); linkPath  .afsDevice.ref().removeSymlinkPlain(linkPath  .afsPath); } //throw FileError
+    static void removeFolderPlain (const AbstractPath& folderPath) { IoOpScope ios(folderPath.afsDevice, IoOp::remove); folderPath.afsDevice.ref().removeFolderPlain (folderPath.afsPath); } //
     //----------------------------------------------------------------------------------------------------------------
     //static void setModTime(const AbstractPath& itemPath, time_t modTime) { itemPath.afsDevice.ref().setModTime(itemPath.afsPath, modTime); } //throw FileError, follows symlinks
 
@@ -152,7 +153,7 @@ struct AbstractFileSystem //THREAD-SAFETY: "const" member functions must model t
         virtual std::optional<StreamAttributes> tryGetAttributesFast() = 0; //throw FileError
     };
     //return value always bound:
-    static std::unique_ptr<InputStream> getInputStream(const AbstractPath& filePath) { return filePath.afsDevice.ref().getInputStream(filePath.afsPath); } //throw FileError, ErrorFileLocked
+    static std::unique_ptr<InputStream> getInputStream(const AbstractPath& filePath) { IoOpScope ios(filePath.afsDevice, IoOp::open); return filePath.afsDevice.ref().getInputStream(filePath.afsPath); } //throw FileError, ErrorFileLocked
 
     //----------------------------------------------------------------------------------------------------------------
 
@@ -189,7 +190,7 @@ struct AbstractFileSystem //THREAD-SAFETY: "const" member functions must model t
     static std::unique_ptr<OutputStream> getOutputStream(const AbstractPath& filePath, //throw FileError
                                                          std::optional<uint64_t> streamSize,
                                                          std::optional<time_t> modTime)
-    { return std::make_unique<OutputStream>(filePath.afsDevice.ref().getOutputStream(filePath.afsPath, streamSize, modTime), filePath, streamSize); }
+    { IoOpScope ios(filePath.afsDevice, IoOp::create); return std::make_unique<OutputStream>(filePath.afsDevice.ref().getOutputStream(filePath.afsPath, streamSize, modTime), filePath, streamSize); }
     //----------------------------------------------------------------------------------------------------------------
 
     struct SymlinkInfo
@@ -254,7 +255,7 @@ struct AbstractFileSystem //THREAD-SAFETY: "const" member functions must model t
                                const std::function<void(const FileInfo&    fi)>& onFile,    //
                                const std::function<void(const FolderInfo&  fi)>& onFolder,  //optional
                                const std::function<void(const SymlinkInfo& si)>& onSymlink) //
-    { folderPath.afsDevice.ref().traverseFolder(folderPath.afsPath, onFile, onFolder, onSymlink); }
+    { folderPath.afsDevice.ref().traverseFolder(folderPath.afsPath, onFile, onFolder, onSymlink); } //I/O metrics: see traverseFolderRecursive()
     //----------------------------------------------------------------------------------------------------------------
 
     //already existing: undefined behavior! (e.g. fail/overwrite)
@@ -338,6 +339,8 @@ struct AbstractFileSystem //THREAD-SAFETY: "const" member functions must model t
 
 
 protected:
+    AfsDevice getDevice() const { return AfsDevice(shared_from_this()); } //instances are always owned by an AfsDevice
+
     //default implementation: folder traversal
     virtual void removeFolderIfExistsRecursion(const AfsPath& folderPath, //throw FileError
                                                const std::function<void(const std::wstring& displayPath)>& onBeforeFileDeletion,
@@ -408,6 +411,7 @@ private:
                                                               std::optional<uint64_t> streamSize,
                                                               std::optional<time_t> modTime) const = 0;
     //----------------------------------------------------------------------------------------------------------------
+    //implementations: record IoOp::list for each folder read
     virtual void traverseFolderRecursive(const TraverserWorkload& workload /*throw X*/, size_t parallelOps) const = 0;
     //----------------------------------------------------------------------------------------------------------------
     virtual bool supportsPermissions(const AfsPath& folderPath) const = 0; //throw FileError
@@ -551,6 +555,7 @@ void AbstractFileSystem::moveAndRenameItem(const AbstractPath& pathFrom, const A
     if (typeid(pathFrom.afsDevice.ref()) != typeid(pathTo.afsDevice.ref()))
         throw ErrorMoveUnsupported(generateMoveErrorMsg(pathFrom, pathTo), _("Operation not supported between different devices."));
 
+    IoOpScope ios(pathFrom.afsDevice, IoOp::rename);
     //already existing: undefined behavior! (e.g. fail/overwrite)
     pathFrom.afsDevice.ref().moveAndRenameItemForSameAfsType(pathFrom.afsPath, pathTo); //throw FileError, ErrorMoveUnsupported
 }
@@ -0,0 +1,166 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include "block_size_tuning.h"
+#include <random>
+#include <zen/thread.h>
+#include <zen/guid.h>
+#include <zen/crc.h>
+#include <zen/format_unit.h>
+#include <zen/extra_log.h>
+
+using namespace zen;
+using namespace fff;
+using AFS = AbstractFileSystem;
+
+
+namespace
+{
+Protected<std::vector<BlockSizeTuning>> globalBlockSizeTuning;
+
+
+bool isWithinFolder(const AfsPath& itemPath, const AfsPath& folderPath)
+{
+    return folderPath.value.empty() || //device root
+           (startsWith(itemPath.value, folderPath.value) &&
+            (itemPath.value.size() == folderPath.value.size() || itemPath.value[folderPath.value.size()] == FILE_NAME_SEPARATOR));
+}
+
+
+size_t getBlockMultiplier(const AbstractFileSystem& afs, const AfsPath& filePath, size_t BlockSizeTuning::* multiplier)
+{
+    size_t output = 1;
+    globalBlockSizeTuning.access([&](const std::vector<BlockSizeTuning>& tuning)
+    {
+        const BlockSizeTuning* bestMatch = nullptr;
+
+        for (const BlockSizeTuning& bst : tuning) //few items: linear search
+            if (isWithinFolder(filePath, bst.folderPath.afsPath) &&
+                (!bestMatch || bst.folderPath.afsPath.value.size() > bestMatch->folderPath.afsPath.value.size()) &&
+                AFS::compareDevice(bst.folderPath.afsDevice.ref(), afs) == std::weak_ordering::equivalent) //most expensive check last
+                bestMatch = &bst;
+
+        if (bestMatch)
+            output = std::clamp<size_t>(bestMatch->*multiplier, 1, BLOCK_MULTIPLIER_MAX);
+    });
+    return output;
+}
+
+
+constexpr size_t CALIBRATION_MULTIPLIERS[] = {1, 2, 4, 8, 16};
+static_assert(std::end(CALIBRATION_MULTIPLIERS)[-1] == BLOCK_MULTIPLIER_MAX);
+const size_t CALIBRATION_BYTES_MIN = 32 * 1024 * 1024; //per measurement: large enough to amortize file open/close
+const double CALIBRATION_TOLERANCE = 0.95; //prefer smaller block sizes (less memory, smoother progress) if throughput is about the same
+
+
+size_t pickMultiplier(const std::vector<double>& bytesPerSec)
+{
+    const double bestSpeed = *std::max_element(bytesPerSec.begin(), bytesPerSec.end());
+
+    for (size_t i = 0; i < bytesPerSec.size(); ++i)
+        if (bytesPerSec[i] >= bestSpeed * CALIBRATION_TOLERANCE)
+            return i;
+    assert(false);
+    return 0;
+}
+}
+
+
+void fff::setBlockSizeTuning(const std::vector<BlockSizeTuning>& tuning)
+{
+    globalBlockSizeTuning.access([&](std::vector<BlockSizeTuning>& bst) { bst = tuning; });
+}
+
+
+size_t fff::getReadBlockMultiplier (const AbstractFileSystem& afs, const AfsPath& filePath) { return getBlockMultiplier(afs, filePath, &BlockSizeTuning::readMultiplier ); }
+size_t fff::getWriteBlockMultiplier(const AbstractFileSystem& afs, const AfsPath& filePath) { return getBlockMultiplier(afs, filePath, &BlockSizeTuning::writeMultiplier); }
+
+
+BlockSizeCalibration fff::calibrateBlockSize(const AbstractPath& folderPath, const std::function<void(std::wstring&& msg)>& notifyStatus /*throw X*/) //throw FileError, X
+{
+    const Zstring& shortGuid = printNumber<Zstring>(Zstr("%04x"), static_cast<unsigned int>(getCrc16(generateGUID())));
+    const AbstractPath tmpFilePath = AFS::appendRelPath(folderPath, Zstr("BlockSizeCalibration-") + shortGuid + AFS::TEMP_FILE_ENDING);
+
+    //random content: don't let SSH/HTTP compression or deduplicating storage skew the results
+    std::vector<std::byte> buf;
+    std::minstd_rand rng(static_cast<unsigned int>(std::chrono::steady_clock::now().time_since_epoch().count()));
+    auto reserveBuffer = [&](size_t size)
+    {
+        const size_t sizeOld = buf.size();
+        if (size > sizeOld)
+        {
+            buf.resize(size);
+            std::generate(buf.begin() + sizeOld, buf.end(), [&] { return static_cast<std::byte>(rng()); });
+        }
+    };
+
+    std::vector<double> readSpeeds;
+    std::vector<double> writeSpeeds;
+    std::vector<size_t> readBlockSizes;
+    std::vector<size_t> writeBlockSizes;
+
+    for (const size_t multiplier : CALIBRATION_MULTIPLIERS)
+    {
+        //----------------------- write -----------------------
+        auto streamOut = AFS::getOutputStream(tmpFilePath, std::nullopt /*streamSize*/, std::nullopt /*modTime*/); //throw FileError
+
+        const size_t blockSizeOut = streamOut->getBlockSize() * multiplier; //throw FileError
+        const size_t blockCount = std::max<size_t>(CALIBRATION_BYTES_MIN / blockSizeOut, 4);
+        reserveBuffer(blockSizeOut);
+
+        notifyStatus(replaceCpy(replaceCpy(_("Measuring write throughput for %x using block size %y..."),
+                                           L"%x", fmtPath(AFS::getDisplayPath(folderPath))), L"%y", formatFilesizeShort(blockSizeOut))); //throw X
+
+        const auto writeStartTime = std::chrono::steady_clock::now();
+
+        for (size_t i = 0; i < blockCount; ++i)
+            for (size_t bytesWritten = 0; bytesWritten < blockSizeOut;)
+                bytesWritten += streamOut->tryWrite(buf.data() + bytesWritten, blockSizeOut - bytesWritten, nullptr /*notifyUnbufferedIO*/); //throw FileError; may return short!
+
+        streamOut->finalize(nullptr /*notifyUnbufferedIO*/); //throw FileError
+        streamOut.reset();
+
+        const std::chrono::duration<double> writeTime = std::chrono::steady_clock::now() - writeStartTime;
+
+        ZEN_ON_SCOPE_EXIT(try { AFS::removeFilePlain(tmpFilePath); /*throw FileError*/ }
+        catch (const FileError& e) { logExtraError(e.toString()); }); //after finalize(): not guarded by ~AFS::OutputStream() anymore!
+
+        //----------------------- read -----------------------
+        auto streamIn = AFS::getInputStream(tmpFilePath); //throw FileError, ErrorFileLocked
+
+        const size_t blockSizeIn = streamIn->getBlockSize() * multiplier; //throw FileError
+        reserveBuffer(blockSizeIn);
+
+        notifyStatus(replaceCpy(replaceCpy(_("Measuring read throughput for %x using block size %y..."),
+                                           L"%x", fmtPath(AFS::getDisplayPath(folderPath))), L"%y", formatFilesizeShort(blockSizeIn))); //throw X
+
+        const auto readStartTime = std::chrono::steady_clock::now();
+        uint64_t totalBytesRead = 0;
+
+        while (const size_t bytesRead = streamIn->tryRead(buf.data(), blockSizeIn, nullptr /*notifyUnbufferedIO*/)) //throw FileError, ErrorFileLocked
+            totalBytesRead += bytesRead;
+
+        const std::chrono::duration<double> readTime = std::chrono::steady_clock::now() - readStartTime;
+        streamIn.reset();
+
+        writeSpeeds.push_back(static_cast<double>(blockCount * blockSizeOut) / std::max(writeTime.count(), 1e-6));
+        readSpeeds .push_back(static_cast<double>(totalBytesRead)            / std::max(readTime .count(), 1e-6));
+        writeBlockSizes.push_back(blockSizeOut);
+        readBlockSizes .push_back(blockSizeIn);
+    }
+
+    const size_t idxRead  = pickMultiplier(readSpeeds);
+    const size_t idxWrite = pickMultiplier(writeSpeeds);
+    return
+    {
+        .readMultiplier   = CALIBRATION_MULTIPLIERS[idxRead],
+        .writeMultiplier  = CALIBRATION_MULTIPLIERS[idxWrite],
+        .readBlockSize    = readBlockSizes [idxRead],
+        .writeBlockSize   = writeBlockSizes[idxWrite],
+        .readBytesPerSec  = readSpeeds [idxRead],
+        .writeBytesPerSec = writeSpeeds[idxWrite],
+    };
+}
@@ -0,0 +1,53 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef BLOCK_SIZE_TUNING_H_2836401957362049187
+#define BLOCK_SIZE_TUNING_H_2836401957362049187
+
+#include <functional>
+#include "abstract.h"
+
+
+namespace fff
+{
+/*  Tuned block sizes for AFS::copyFileAsStream() and zen::copyNewFile():
+    - expressed as multiples of the streams' getBlockSize() => alignment contracts of the backends stay intact
+    - SFTP: pipeline depth scales with the read block size (number of parallel SSH_FXP_READ requests) => covered by the read multiplier
+    - keyed by folder, not by device: all local folders share the same native AfsDevice, but e.g. a NAS mount point is a different story
+    - THREAD-SAFETY: set on main thread, queried by worker threads                                                                */
+struct BlockSizeTuning
+{
+    AbstractPath folderPath; //applies to all items within
+    size_t readMultiplier  = 1;
+    size_t writeMultiplier = 1;
+};
+
+void setBlockSizeTuning(const std::vector<BlockSizeTuning>& tuning);
+
+const size_t BLOCK_MULTIPLIER_MAX = 16; //= largest multiplier tried by calibrateBlockSize(): don't trust GlobalSettings.xml for memory usage
+
+//longest matching folder path wins; 1 if no match; clamped to [1, BLOCK_MULTIPLIER_MAX]:
+size_t getReadBlockMultiplier (const AbstractFileSystem& afs, const AfsPath& filePath);
+size_t getWriteBlockMultiplier(const AbstractFileSystem& afs, const AfsPath& filePath);
+
+
+struct BlockSizeCalibration
+{
+    size_t readMultiplier  = 1;
+    size_t writeMultiplier = 1;
+    size_t readBlockSize  = 0; //bytes: base block size * multiplier
+    size_t writeBlockSize = 0; //
+    double readBytesPerSec  = 0; //best throughput measured
+    double writeBytesPerSec = 0; //
+};
+//benchmark throughput against block size using a temporary file in "folderPath":
+//- writes 32 MB or more per multiplier into "folderPath" itself: a temp folder elsewhere would measure a different device!
+//- file ends with AFS::TEMP_FILE_ENDING and is deleted after each measurement => leftovers after a crash are cleaned up by the next sync
+//caveat: read throughput may be served from the OS cache (local disk, NAS with SMB/NFS client cache) => write numbers are more telling
+BlockSizeCalibration calibrateBlockSize(const AbstractPath& folderPath, const std::function<void(std::wstring&& msg)>& notifyStatus /*throw X*/); //throw FileError, X
+}
+
+#endif //BLOCK_SIZE_TUNING_H_2836401957362049187
@@ -1769,8 +1769,8 @@ private:
 class SingleFolderTraverser
 {
 public:
-    SingleFolderTraverser(const FtpLogin& login, const std::vector<std::pair<AfsPath, std::shared_ptr<AFS::TraverserCallback>>>& workload /*throw X*/)
-        : workload_(workload), login_(login)
+    SingleFolderTraverser(const FtpLogin& login, const AfsDevice& afsDevice, const std::vector<std::pair<AfsPath, std::shared_ptr<AFS::TraverserCallback>>>& workload /*throw X*/)
+        : workload_(workload), login_(login), afsDevice_(afsDevice)
     {
         while (!workload_.empty())
         {
@@ -1780,6 +1780,7 @@ public:
 
             tryReportingDirError([&] //throw X
             {
+                IoOpScope ios(afsDevice_, IoOp::list);
                 traverseWithException(folderPath, *cb); //throw FileError, X
             }, *cb);
         }
@@ -1848,12 +1849,13 @@ private:
 
     std::vector<std::pair<AfsPath, std::shared_ptr<AFS::TraverserCallback>>> workload_;
     const FtpLogin login_;
+    const AfsDevice afsDevice_;
 };
 
 
-void traverseFolderRecursiveFTP(const FtpLogin& login, const std::vector<std::pair<AfsPath, std::shared_ptr<AFS::TraverserCallback>>>& workload /*throw X*/, size_t) //throw X
+void traverseFolderRecursiveFTP(const FtpLogin& login, const AfsDevice& afsDevice, const std::vector<std::pair<AfsPath, std::shared_ptr<AFS::TraverserCallback>>>& workload /*throw X*/, size_t) //throw X
 {
-    SingleFolderTraverser dummy(login, workload); //throw X
+    SingleFolderTraverser dummy(login, afsDevice, workload); //throw X
 }
 //===========================================================================================================================
 //===========================================================================================================================
@@ -2414,7 +2416,7 @@ private:
     //----------------------------------------------------------------------------------------------------------------
     void traverseFolderRecursive(const TraverserWorkload& workload /*throw X*/, size_t parallelOps) const override
     {
-        traverseFolderRecursiveFTP(login_, workload, parallelOps); //throw X
+        traverseFolderRecursiveFTP(login_, getDevice(), workload, parallelOps); //throw X
     }
     //----------------------------------------------------------------------------------------------------------------
 
@@ -3000,8 +3000,8 @@ private:
 class SingleFolderTraverser
 {
 public:
-    SingleFolderTraverser(const GdriveLogin& gdriveLogin, const std::vector<std::pair<AfsPath, std::shared_ptr<AFS::TraverserCallback>>>& workload /*throw X*/) :
-        gdriveLogin_(gdriveLogin), workload_(workload)
+    SingleFolderTraverser(const GdriveLogin& gdriveLogin, const AfsDevice& afsDevice, const std::vector<std::pair<AfsPath, std::shared_ptr<AFS::TraverserCallback>>>& workload /*throw X*/) :
+        gdriveLogin_(gdriveLogin), afsDevice_(afsDevice), workload_(workload)
     {
         while (!workload_.empty())
         {
@@ -3011,6 +3011,7 @@ public:
 
             tryReportingDirError([&] //throw X
             {
+                IoOpScope ios(afsDevice_, IoOp::list);
                 traverseWithException(folderPath, *cb); //throw FileError, X
             }, *cb);
         }
@@ -3075,13 +3076,14 @@ private:
     }
 
     const GdriveLogin gdriveLogin_;
+    const AfsDevice afsDevice_;
     std::vector<std::pair<AfsPath, std::shared_ptr<AFS::TraverserCallback>>> workload_;
 };
 
 
-void gdriveTraverseFolderRecursive(const GdriveLogin& gdriveLogin, const std::vector<std::pair<AfsPath, std::shared_ptr<AFS::TraverserCallback>>>& workload /*throw X*/, size_t) //throw X
+void gdriveTraverseFolderRecursive(const GdriveLogin& gdriveLogin, const AfsDevice& afsDevice, const std::vector<std::pair<AfsPath, std::shared_ptr<AFS::TraverserCallback>>>& workload /*throw X*/, size_t) //throw X
 {
-    SingleFolderTraverser dummy(gdriveLogin, workload); //throw X
+    SingleFolderTraverser dummy(gdriveLogin, afsDevice, workload); //throw X
 }
 //==========================================================================================
 //==========================================================================================
@@ -3612,7 +3614,7 @@ private:
     //----------------------------------------------------------------------------------------------------------------
     void traverseFolderRecursive(const TraverserWorkload& workload /*throw X*/, size_t parallelOps) const override
     {
-        gdriveTraverseFolderRecursive(gdriveLogin_, workload, parallelOps); //throw X
+        gdriveTraverseFolderRecursive(gdriveLogin_, getDevice(), workload, parallelOps); //throw X
     }
     //----------------------------------------------------------------------------------------------------------------
 
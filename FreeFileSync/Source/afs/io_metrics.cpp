@@ -0,0 +1,209 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include "io_metrics.h"
+#include <bit>
+#include <cmath>
+#include <map>
+#include <zen/thread.h>
+#include <zen/json.h>
+#include "abstract.h"
+
+using namespace zen;
+using namespace fff;
+using AFS = AbstractFileSystem;
+
+
+namespace
+{
+struct ThreadIoMetrics
+{
+    std::mutex lockMetrics; //uncontended, except while merging
+    std::vector<DeviceIoMetrics> devices; //few items: linear search by device instance is fastest
+};
+
+//keep data of finished threads until next reset
+Protected<std::vector<std::shared_ptr<ThreadIoMetrics>>> globalIoMetrics;
+
+
+ThreadIoMetrics& getThreadIoMetrics()
+{
+    thread_local const std::shared_ptr<ThreadIoMetrics> threadMetrics = []
+    {
+        auto tm = std::make_shared<ThreadIoMetrics>();
+        globalIoMetrics.access([&](std::vector<std::shared_ptr<ThreadIoMetrics>>& metrics) { metrics.push_back(tm); });
+        return tm;
+    }();
+    return *threadMetrics;
+}
+
+
+DeviceIoMetrics& getDeviceMetrics(std::vector<DeviceIoMetrics>& devices, const AfsDevice& afsDevice)
+{
+    //compare instances, not devices: AFS::compareDevice() is too expensive for each I/O operation => merged in getIoMetrics()
+    for (DeviceIoMetrics& dm : devices)
+        if (&dm.afsDevice.ref() == &afsDevice.ref())
+            return dm;
+
+    return devices.emplace_back(DeviceIoMetrics{.afsDevice = afsDevice}); //holding AfsDevice: instance address won't be reused until reset
+}
+}
+
+
+const char* fff::getIoOpName(IoOp op)
+{
+    switch (op)
+    {
+        //*INDENT-OFF*
+        case IoOp::stat:   return "stat";
+        case IoOp::list:   return "list";
+        case IoOp::open:   return "open";
+        case IoOp::create: return "create";
+        case IoOp::remove: return "delete";
+        case IoOp::rename: return "rename";
+        case IoOp::copy:   return "copy";
+        //*INDENT-ON*
+    }
+    assert(false);
+    return "";
+}
+
+
+void fff::impl::recordIoOp(const AfsDevice& afsDevice, IoOp op, std::chrono::nanoseconds latency, bool failed)
+{
+    const auto latencyUs = std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+    const size_t bucket = std::min<size_t>(std::bit_width(static_cast<uint64_t>(std::max<int64_t>(latencyUs, 0))), IO_LATENCY_BUCKETS - 1);
+
+    ThreadIoMetrics& tm = getThreadIoMetrics();
+    std::lock_guard dummy(tm.lockMetrics);
+
+    IoOpStats& stats = getDeviceMetrics(tm.devices, afsDevice).ops[static_cast<size_t>(op)];
+    ++stats.count;
+    if (failed)
+        ++stats.errors;
+    stats.totalTime += latency;
+    ++stats.latencyHist[bucket];
+}
+
+
+void fff::impl::recordIoBytes(const AfsDevice& afsDevice, int64_t bytesRead, int64_t bytesWritten)
+{
+    ThreadIoMetrics& tm = getThreadIoMetrics();
+    std::lock_guard dummy(tm.lockMetrics);
+
+    DeviceIoMetrics& dm = getDeviceMetrics(tm.devices, afsDevice);
+    dm.bytesRead    += bytesRead;
+    dm.bytesWritten += bytesWritten;
+}
+
+
+void fff::resetIoMetrics()
+{
+    globalIoMetrics.access([](std::vector<std::shared_ptr<ThreadIoMetrics>>& metrics)
+    {
+        std::erase_if(metrics, [](const std::shared_ptr<ThreadIoMetrics>& tm) { return tm.use_count() == 1; }); //thread has finished
+
+        for (const std::shared_ptr<ThreadIoMetrics>& tm : metrics)
+        {
+            std::lock_guard dummy(tm->lockMetrics);
+            tm->devices.clear();
+        }
+    });
+}
+
+
+std::vector<DeviceIoMetrics> fff::getIoMetrics()
+{
+    std::map<AfsDevice, DeviceIoMetrics> merged; //different AfsDevice instances may refer to the same device
+
+    globalIoMetrics.access([&](const std::vector<std::shared_ptr<ThreadIoMetrics>>& metrics)
+    {
+        for (const std::shared_ptr<ThreadIoMetrics>& tm : metrics)
+        {
+            std::lock_guard dummy(tm->lockMetrics);
+
+            for (const DeviceIoMetrics& dm : tm->devices)
+            {
+                DeviceIoMetrics& out = merged.try_emplace(dm.afsDevice, DeviceIoMetrics{.afsDevice = dm.afsDevice}).first->second;
+                out.bytesRead    += dm.bytesRead;
+                out.bytesWritten += dm.bytesWritten;
+
+                for (size_t i = 0; i < IO_OP_COUNT; ++i)
+                {
+                    out.ops[i].count     += dm.ops[i].count;
+                    out.ops[i].errors    += dm.ops[i].errors;
+                    out.ops[i].totalTime += dm.ops[i].totalTime;
+                    for (size_t b = 0; b < IO_LATENCY_BUCKETS; ++b)
+                        out.ops[i].latencyHist[b] += dm.ops[i].latencyHist[b];
+                }
+            }
+        }
+    });
+
+    std::vector<DeviceIoMetrics> output;
+    for (auto& [afsDevice, dm] : merged)
+        output.push_back(std::move(dm));
+    return output;
+}
+
+
+std::chrono::microseconds fff::getLatencyPercentile(const IoOpStats& stats, double percentile)
+{
+    assert(0 <= percentile && percentile <= 1);
+    const int64_t rank = std::max<int64_t>(std::ceil(percentile * stats.count), 1);
+
+    int64_t countSum = 0;
+    for (size_t b = 0; b < IO_LATENCY_BUCKETS; ++b)
+        if ((countSum += stats.latencyHist[b]) >= rank)
+            return std::chrono::microseconds(int64_t(1) << b);
+
+    return std::chrono::microseconds(0); //no samples
+}
+
+
+std::string fff::getIoMetricsJson(const std::vector<DeviceIoMetrics>& metrics, std::chrono::milliseconds totalTime)
+{
+    JsonValue jdevices(JsonValue::Type::array);
+
+    for (const DeviceIoMetrics& dm : metrics)
+    {
+        JsonValue jdevice(JsonValue::Type::object);
+        jdevice.objectVal.emplace("device", utfTo<std::string>(AFS::getDisplayPath(AbstractPath(dm.afsDevice, AfsPath()))));
+        jdevice.objectVal.emplace("bytesRead",    dm.bytesRead);
+        jdevice.objectVal.emplace("bytesWritten", dm.bytesWritten);
+
+        JsonValue& jops = jdevice.objectVal["ops"] = JsonValue(JsonValue::Type::object);
+        for (size_t i = 0; i < IO_OP_COUNT; ++i)
+            if (const IoOpStats& stats = dm.ops[i];
+                stats.count > 0)
+            {
+                JsonValue jop(JsonValue::Type::object);
+                jop.objectVal.emplace("count",  stats.count);
+                jop.objectVal.emplace("errors", stats.errors);
+                jop.objectVal.emplace("totalTimeUs", static_cast<int64_t>(std::chrono::duration_cast<std::chrono::microseconds>(stats.totalTime).count()));
+                if (totalTime > std::chrono::milliseconds(0))
+                    jop.objectVal.emplace("opsPerSec", stats.count * 1000.0 / totalTime.count());
+
+                JsonValue& jhist = jop.objectVal["latencyHistUs"] = JsonValue(JsonValue::Type::array); //[[bucket upper bound, count], ...]
+                for (size_t b = 0; b < IO_LATENCY_BUCKETS; ++b)
+                    if (stats.latencyHist[b] > 0)
+                        jhist.arrayVal.emplace_back(std::vector<JsonValue>
+                    {
+                        JsonValue(b + 1 < IO_LATENCY_BUCKETS ? int64_t(1) << b : int64_t(-1) /*open-ended*/),
+                        JsonValue(stats.latencyHist[b])
+                    });
+
+                jops.objectVal.emplace(getIoOpName(static_cast<IoOp>(i)), std::move(jop));
+            }
+
+        jdevices.arrayVal.push_back(std::move(jdevice));
+    }
+
+    JsonValue jroot(JsonValue::Type::object);
+    jroot.objectVal.emplace("totalTimeMs", static_cast<int64_t>(totalTime.count()));
+    jroot.objectVal.emplace("devices", std::move(jdevices));
+    return serializeJson(jroot);
+}
@@ -0,0 +1,91 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef IO_METRICS_H_4720956183470126583
+#define IO_METRICS_H_4720956183470126583
+
+#include <array>
+#include <chrono>
+#include <exception>
+#include <vector>
+#include <zen/stl_tools.h>
+
+
+namespace fff
+{
+struct AbstractFileSystem;
+using AfsDevice = zen::SharedRef<const AbstractFileSystem>;
+
+/*  Per-device I/O statistics collected by the AFS convenience functions (AFS::getItemType(), AFS::copyFileTransactional(), ...)
+    - THREAD-SAFETY: each thread records into its own buffer => no contention between worker threads; merged by getIoMetrics()
+    - only operations going through the static AFS interface are counted, not the AFS-internal calls they are implemented with */
+enum class IoOp
+{
+    stat,
+    list,
+    open,
+    create,
+    remove,
+    rename,
+    copy,
+};
+constexpr size_t IO_OP_COUNT = static_cast<size_t>(IoOp::copy) + 1;
+
+const char* getIoOpName(IoOp op); //not translated: technical label also used as JSON key
+
+
+constexpr size_t IO_LATENCY_BUCKETS = 24; //bucket i: latency < 2^i µs (last bucket: open-ended, >= 4s)
+
+struct IoOpStats
+{
+    int64_t count  = 0;
+    int64_t errors = 0;
+    std::chrono::nanoseconds totalTime{};
+    std::array<int64_t, IO_LATENCY_BUCKETS> latencyHist{};
+};
+
+struct DeviceIoMetrics
+{
+    AfsDevice afsDevice;
+    int64_t bytesRead    = 0; //file content copied by AFS::copyFileTransactional()
+    int64_t bytesWritten = 0; //
+    std::array<IoOpStats, IO_OP_COUNT> ops{};
+};
+
+void resetIoMetrics(); //start of comparison/synchronization
+std::vector<DeviceIoMetrics> getIoMetrics(); //sorted by device
+
+std::chrono::microseconds getLatencyPercentile(const IoOpStats& stats, double percentile); //bucket upper bound: percentile in [0, 1]
+
+std::string getIoMetricsJson(const std::vector<DeviceIoMetrics>& metrics, std::chrono::milliseconds totalTime);
+
+
+namespace impl
+{
+void recordIoOp(const AfsDevice& afsDevice, IoOp op, std::chrono::nanoseconds latency, bool failed);
+void recordIoBytes(const AfsDevice& afsDevice, int64_t bytesRead, int64_t bytesWritten);
+}
+
+
+class IoOpScope //measure a single AFS operation: exception => failed
+{
+public:
+    IoOpScope(const AfsDevice& afsDevice, IoOp op) : afsDevice_(afsDevice), op_(op) {}
+
+    ~IoOpScope() { impl::recordIoOp(afsDevice_, op_, std::chrono::steady_clock::now() - startTime_, std::uncaught_exceptions() > exceptionCount_); }
+
+private:
+    IoOpScope           (const IoOpScope&) = delete;
+    IoOpScope& operator=(const IoOpScope&) = delete;
+
+    const AfsDevice& afsDevice_;
+    const IoOp op_;
+    const int exceptionCount_ = std::uncaught_exceptions();
+    const std::chrono::steady_clock::time_point startTime_ = std::chrono::steady_clock::now();
+};
+}
+
+#endif //IO_METRICS_H_4720956183470126583
@@ -15,6 +15,7 @@
 #include <zen/guid.h>
 #include <zen/crc.h>
 #include "abstract_impl.h"
+#include "block_size_tuning.h"
 #include "../base/icon_loader.h"
 
     #include <sys/vfs.h> //statfs
@@ -216,7 +217,8 @@ FsItemDetails getSymlinkTargetDetails(const Zstring& linkPath) //throw FileError
 class SingleFolderTraverser
 {
 public:
-    SingleFolderTraverser(const std::vector<std::pair<Zstring, std::shared_ptr<AFS::TraverserCallback>>>& workload /*throw X*/)
+    SingleFolderTraverser(const AfsDevice& afsDevice, const std::vector<std::pair<Zstring, std::shared_ptr<AFS::TraverserCallback>>>& workload /*throw X*/) :
+        afsDevice_(afsDevice)
     {
         for (const auto& [folderPath, cb] : workload)
             workload_.push_back({folderPath, cb});
@@ -228,6 +230,7 @@ public:
 
             tryReportingDirError([&] //throw X
             {
+                IoOpScope ios(afsDevice_, IoOp::list);
                 traverseWithException(wi.dirPath, *wi.cb); //throw FileError, X
             }, *wi.cb);
         }
@@ -297,12 +300,13 @@ private:
         std::shared_ptr<AFS::TraverserCallback> cb;
     };
     std::vector<WorkItem> workload_;
+    const AfsDevice afsDevice_;
 };
 
 
-void traverseFolderRecursiveNative(const std::vector<std::pair<Zstring, std::shared_ptr<AFS::TraverserCallback>>>& workload /*throw X*/, size_t) //throw X
+void traverseFolderRecursiveNative(const AfsDevice& afsDevice, const std::vector<std::pair<Zstring, std::shared_ptr<AFS::TraverserCallback>>>& workload /*throw X*/, size_t) //throw X
 {
-    SingleFolderTraverser dummy(workload); //throw X
+    SingleFolderTraverser dummy(afsDevice, workload); //throw X
 }
 //====================================================================================================
 //====================================================================================================
@@ -546,7 +550,7 @@ private:
         for (const auto& [folderPath, cb] : workload)
             initialWorkItems.emplace_back(getNativePath(folderPath), cb);
 
-        traverseFolderRecursiveNative(initialWorkItems, parallelOps); //throw X
+        traverseFolderRecursiveNative(getDevice(), initialWorkItems, parallelOps); //throw X
     }
     //----------------------------------------------------------------------------------------------------------------
 
@@ -560,7 +564,9 @@ private:
 
         initComForThread(); //throw FileError
 
-        const zen::FileCopyResult nativeResult = copyNewFile(getNativePath(sourcePath), nativePathTarget, notifyUnbufferedIO); //throw FileError, ErrorTargetExisting, ErrorFileLocked, X
+        const zen::FileCopyResult nativeResult = copyNewFile(getNativePath(sourcePath), nativePathTarget, //throw FileError, ErrorTargetExisting, ErrorFileLocked, X
+                                                             getReadBlockMultiplier(*this, sourcePath),
+                                                             getWriteBlockMultiplier(targetPath.afsDevice.ref(), targetPath.afsPath), notifyUnbufferedIO);
 
         //at this point we know we created a new file, so it's fine to delete it for cleanup!
         ZEN_ON_SCOPE_FAIL(try { zen::removeFilePlain(nativePathTarget); }
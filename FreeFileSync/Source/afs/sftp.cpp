@@ -1223,8 +1223,8 @@ class SingleFolderTraverser
 public:
     using WorkItem = std::pair<AfsPath, std::shared_ptr<AFS::TraverserCallback>>;
 
-    SingleFolderTraverser(const SftpLogin& login, const std::vector<std::pair<AfsPath, std::shared_ptr<AFS::TraverserCallback>>>& workload /*throw X*/) :
-        login_(login)
+    SingleFolderTraverser(const SftpLogin& login, const AfsDevice& afsDevice, const std::vector<std::pair<AfsPath, std::shared_ptr<AFS::TraverserCallback>>>& workload /*throw X*/) :
+        login_(login), afsDevice_(afsDevice)
     {
         for (const auto& [folderPath, cb] : workload)
             workload_.push_back(WorkItem{folderPath, cb});
@@ -1237,6 +1237,7 @@ public:
 
             tryReportingDirError([&] //throw X
             {
+                IoOpScope ios(afsDevice_, IoOp::list);
                 traverseWithException(folderPath, *cb); //throw FileError, X
             }, *cb);
         }
@@ -1294,13 +1295,14 @@ private:
     }
 
     const SftpLogin login_;
+    const AfsDevice afsDevice_;
     RingBuffer<WorkItem> workload_;
 };
 
 
-void traverseFolderRecursiveSftp(const SftpLogin& login, const std::vector<std::pair<AfsPath, std::shared_ptr<AFS::TraverserCallback>>>& workload /*throw X*/, size_t) //throw X
+void traverseFolderRecursiveSftp(const SftpLogin& login, const AfsDevice& afsDevice, const std::vector<std::pair<AfsPath, std::shared_ptr<AFS::TraverserCallback>>>& workload /*throw X*/, size_t) //throw X
 {
-    SingleFolderTraverser dummy(login, workload); //throw X
+    SingleFolderTraverser dummy(login, afsDevice, workload); //throw X
 }
 
 //===========================================================================================================================
@@ -1774,7 +1776,7 @@ private:
     //----------------------------------------------------------------------------------------------------------------
     void traverseFolderRecursive(const TraverserWorkload& workload /*throw X*/, size_t parallelOps) const override
     {
-        traverseFolderRecursiveSftp(login_, workload /*throw X*/, parallelOps); //throw X
+        traverseFolderRecursiveSftp(login_, getDevice(), workload /*throw X*/, parallelOps); //throw X
     }
     //----------------------------------------------------------------------------------------------------------------
 
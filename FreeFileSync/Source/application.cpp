@@ -7,11 +7,13 @@
 #include "application.h"
 #include <memory>
 #include <zen/file_access.h>
+#include <zen/format_unit.h>
 #include <zen/perf.h>
 #include <zen/shutdown.h>
 #include <zen/process_exec.h>
 #include <zen/resolve_path.h>
 #include <zen/sys_info.h>
+#include <zen/trace.h>
 #include <wx/clipbrd.h>
 #include <wx/tooltip.h>
 #include <wx/log.h>
@@ -19,9 +21,11 @@
 #include <wx+/popup_dlg.h>
 #include <wx+/image_resources.h>
 #include <wx/msgdlg.h>
+#include "afs/block_size_tuning.h"
 #include "afs/concrete.h"
 #include "base/algorithm.h"
 #include "base/comparison.h"
+#include "base/status_handler_impl.h"
 #include "base/synchronization.h"
 #include "ui/batch_status_handler.h"
 #include "ui/main_dlg.h"
@@ -98,6 +102,43 @@ void notifyAppError(const std::wstring& msg)
     //alternative1: wxSafeShowMessage => NO console output on Debian x86, WTF!
     //alternative2: wxMessageBox() => works, but we probably shouldn't block during command line usage
 }
+
+
+void runBlockSizeCalibration(std::vector<BlockSizeTuningConfig>& tuningCfg, const MainConfiguration& mainCfg, PhaseCallback& callback) //throw X
+{
+    std::vector<std::pair<Zstring, AbstractPath>> calibrationFolders;
+    {
+        std::set<AbstractPath> folderPaths;
+        auto addFolder = [&](const Zstring& folderPathPhrase)
+        {
+            if (const AbstractPath folderPath = createAbstractPath(folderPathPhrase);
+                !AFS::isNullPath(folderPath) && folderPaths.insert(folderPath).second)
+                calibrationFolders.emplace_back(folderPathPhrase, folderPath);
+        };
+        addFolder(mainCfg.firstPair.folderPathPhraseLeft);
+        addFolder(mainCfg.firstPair.folderPathPhraseRight);
+
+        for (const LocalPairConfig& lpc : mainCfg.additionalPairs)
+        {
+            addFolder(lpc.folderPathPhraseLeft);
+            addFolder(lpc.folderPathPhraseRight);
+        }
+    }
+
+    for (const auto& [folderPathPhrase, folderPath] : calibrationFolders)
+        tryReportingError([&]
+    {
+        const BlockSizeCalibration bsc = calibrateBlockSize(folderPath, [&](std::wstring&& msg) { callback.updateStatus(std::move(msg)); /*throw X*/ }); //throw FileError, X
+
+        callback.logMessage(replaceCpy(_("Block size calibration for %x:"), L"%x", fmtPath(AFS::getDisplayPath(folderPath))) + L'\n' +
+                            TAB_SPACE + _("Read:")    + L' ' + formatFilesizeShort(bsc.readBlockSize)  + L" (" + replaceCpy(_("%x/sec"), L"%x", formatFilesizeShort(std::llround(bsc.readBytesPerSec)))  + L")\n" +
+                            TAB_SPACE + _("Written:") + L' ' + formatFilesizeShort(bsc.writeBlockSize) + L" (" + replaceCpy(_("%x/sec"), L"%x", formatFilesizeShort(std::llround(bsc.writeBytesPerSec))) + L')',
+                            PhaseCallback::MsgType::info); //throw X
+
+        std::erase_if(tuningCfg, [&](const BlockSizeTuningConfig& bst) { return createAbstractPath(bst.folderPathPhrase) == folderPath; });
+        tuningCfg.push_back({folderPathPhrase, bsc.readMultiplier, bsc.writeMultiplier});
+    }, callback); //throw X
+}
 }
 
 //##################################################################################################################
@@ -121,7 +162,7 @@ bool Application::OnInit()
     });
 
     //parallel xBRZ-scaling! => run as early as possible
-    try { imageResourcesInit(appendPath(getResourceDirPath(), Zstr("Icons.zip"))); }
+    try { imageResourcesInit(appendPath(getResourceDirPath(), Zstr("Icons.zip")), getConfigDirPath()); }
     catch (const FileError& e) { logExtraError(e.toString()); } //not critical in this context
 
     //GTK should already have been initialized by wxWidgets (see \src\gtk\app.cpp:wxApp::Initialize)
@@ -277,10 +318,15 @@ void Application::onEnterEventLoop()
         std::vector<Zstring> cfgFilePaths;
         Zstring globalConfigFile;
         bool openForEdit = false;
+        bool traceRun = false;
+        bool calibrateBlockSize = false;
         {
             const char* optionEdit    = "-edit";
             const char* optionDirPair = "-dirpair";
             const char* optionSendTo  = "-sendto"; //remaining arguments are unspecified number of folder paths; wonky syntax; let's keep it undocumented
+            const char* optionTrace   = "-trace";  //batch mode: save trace + I/O metrics for performance tracking; undocumented
+            const char* optionCalibrate = "-calibrate"; //batch mode: benchmark block sizes for the job's folders => save in GlobalSettings.xml; undocumented
+            //=> writes temporary files (>= 32 MB each) into the job's base folders, see calibrateBlockSize()
 
             auto isHelpRequest = [](const Zstring& arg)
             {
@@ -298,6 +344,8 @@ void Application::onEnterEventLoop()
                 return equalAsciiNoCase(arg, optionEdit   ) ||
                        equalAsciiNoCase(arg, optionDirPair) ||
                        equalAsciiNoCase(arg, optionSendTo ) ||
+                       equalAsciiNoCase(arg, optionTrace  ) ||
+                       equalAsciiNoCase(arg, optionCalibrate) ||
                        isHelpRequest(arg);
             };
 
@@ -306,6 +354,10 @@ void Application::onEnterEventLoop()
                     return showSyntaxHelp();
                 else if (equalAsciiNoCase(*it, optionEdit))
                     openForEdit = true;
+                else if (equalAsciiNoCase(*it, optionTrace))
+                    traceRun = true;
+                else if (equalAsciiNoCase(*it, optionCalibrate))
+                    calibrateBlockSize = true;
                 else if (equalAsciiNoCase(*it, optionDirPair))
                 {
                     if (++it == commandArgs.end() || isCommandLineOption(*it))
@@ -436,7 +488,7 @@ void Application::onEnterEventLoop()
 
                 replaceDirectories(batchCfg.guiCfg.mainCfg); //throw FileError
 
-                runBatchMode(globalConfigFilePath, batchCfg, filePath);
+                runBatchMode(globalConfigFilePath, batchCfg, filePath, traceRun, calibrateBlockSize);
             }
             //GUI mode: single config (ffs_gui *or* ffs_batch)
             else
@@ -487,7 +539,7 @@ void Application::runGuiMode(const Zstring& globalConfigFilePath,
 }
 
 
-void Application::runBatchMode(const Zstring& globalConfigFilePath, const XmlBatchConfig& batchCfg, const Zstring& cfgFilePath)
+void Application::runBatchMode(const Zstring& globalConfigFilePath, const XmlBatchConfig& batchCfg, const Zstring& cfgFilePath, bool traceRun, bool calibrateBlockSize)
 {
     const bool allowUserInteraction = !batchCfg.batchExCfg.autoCloseSummary ||
                                       (!batchCfg.guiCfg.mainCfg.ignoreErrors && batchCfg.batchExCfg.batchErrorHandling == BatchErrorHandling::showPopup);
@@ -580,11 +632,20 @@ void Application::runBatchMode(const Zstring& globalConfigFilePath, const XmlBat
         //inform about (important) non-default global settings
         logNonDefaultSettings(globalCfg, statusHandler); //throw CancelProcess
 
+        if (calibrateBlockSize)
+            runBlockSizeCalibration(globalCfg.blockSizeTuning, batchCfg.guiCfg.mainCfg, statusHandler); //throw CancelProcess
+
+        applyBlockSizeTuning(globalCfg.blockSizeTuning);
+
+        enableTracing(globalCfg.enableTracing || traceRun); //saved along with the log file
+        resetIoMetrics();                       //
+
         //batch mode: place directory locks on directories during both comparison AND synchronization
         std::unique_ptr<LockHolder> dirLocks;
 
         FolderComparison cmpResult = compare(globalCfg.warnDlgs,
                                              globalCfg.fileTimeTolerance,
+                                             globalCfg.detectMovedFilesByContent,
                                              requestPassword,
                                              globalCfg.runWithBackgroundPriority,
                                              globalCfg.createLockFile,
@@ -644,15 +705,15 @@ void Application::runBatchMode(const Zstring& globalConfigFilePath, const XmlBat
                         exitCode != 0)
                         throw SysError(formatSystemError("", replaceCpy(_("Exit code %x"), L"%x", numberTo<std::wstring>(exitCode)), utfTo<std::wstring>(output)));
 
-                    logMsg(r.errorLog.ref(), _("Executing command:") + L' ' + utfTo<std::wstring>(cmdLine) + L" [" + replaceCpy(_("Exit code %x"), L"%x", L"0") + L']', MSG_TYPE_INFO);
+                    logMsg(r.log.ref(), _("Executing command:") + L' ' + utfTo<std::wstring>(cmdLine) + L" [" + replaceCpy(_("Exit code %x"), L"%x", L"0") + L']', MSG_TYPE_INFO);
                 }
                 catch (SysErrorTimeOut&) //child process not failed yet => probably fine :>
                 {
-                    logMsg(r.errorLog.ref(), _("Executing command:") + L' ' + utfTo<std::wstring>(cmdLine), MSG_TYPE_INFO);
+                    logMsg(r.log.ref(), _("Executing command:") + L' ' + utfTo<std::wstring>(cmdLine), MSG_TYPE_INFO);
                 }
                 catch (const SysError& e)
                 {
-                    logMsg(r.errorLog.ref(), replaceCpy(_("Command %x failed."), L"%x", fmtPath(cmdLine)) + L"\n\n" + e.toString(), MSG_TYPE_ERROR);
+                    logMsg(r.log.ref(), replaceCpy(_("Command %x failed."), L"%x", fmtPath(cmdLine)) + L"\n\n" + e.toString(), MSG_TYPE_ERROR);
                 }
 
         //--------------------- email notification ----------------------
@@ -666,34 +727,34 @@ void Application::runBatchMode(const Zstring& globalConfigFilePath, const XmlBat
                         r.summary.result == TaskResult::error)))
                 try
                 {
-                    logMsg(r.errorLog.ref(), replaceCpy(_("Sending email notification to %x"), L"%x", utfTo<std::wstring>(notifyEmail)), MSG_TYPE_INFO);
-                    sendLogAsEmail(notifyEmail, r.summary, r.errorLog.ref(), logFilePath, notifyStatusNoThrow); //throw FileError
+                    logMsg(r.log.ref(), replaceCpy(_("Sending email notification to %x"), L"%x", utfTo<std::wstring>(notifyEmail)), MSG_TYPE_INFO);
+                    sendLogAsEmail(notifyEmail, r.summary, r.log.ref().getLog().ref() /*email: first entries only*/, logFilePath, notifyStatusNoThrow); //throw FileError
                 }
-                catch (const FileError& e) { logMsg(r.errorLog.ref(), e.toString(), MSG_TYPE_ERROR); }
+                catch (const FileError& e) { logMsg(r.log.ref(), e.toString(), MSG_TYPE_ERROR); }
     }
 
     //--------------------- save log file ----------------------
     try //create not before destruction: 1. avoid issues with FFS trying to sync open log file 2. include status in log file name without extra rename
     {
         //do NOT use tryReportingError()! saving log files should not be cancellable!
-        saveLogFile(logFilePath, r.summary, r.errorLog.ref(), globalCfg.logfilesMaxAgeDays, globalCfg.logFormat, logFilePathsToKeep, notifyStatusNoThrow); //throw FileError
+        saveLogFile(logFilePath, r.summary, r.log.ref(), globalCfg.logfilesMaxAgeDays, globalCfg.logFormat, logFilePathsToKeep, notifyStatusNoThrow); //throw FileError
     }
     catch (const FileError& e)
     {
-        logMsg(r.errorLog.ref(), e.toString(), MSG_TYPE_ERROR);
+        logMsg(r.log.ref(), e.toString(), MSG_TYPE_ERROR);
 
         const AbstractPath logFileDefaultPath = AFS::appendRelPath(createAbstractPath(getLogFolderDefaultPath()), generateLogFileName(globalCfg.logFormat, r.summary));
         if (logFilePath != logFileDefaultPath) //fallback: log file *must* be saved no matter what!
             try
             {
                 logFilePath = logFileDefaultPath;
-                saveLogFile(logFileDefaultPath, r.summary, r.errorLog.ref(), globalCfg.logfilesMaxAgeDays, globalCfg.logFormat, logFilePathsToKeep, notifyStatusNoThrow); //throw FileError
+                saveLogFile(logFileDefaultPath, r.summary, r.log.ref(), globalCfg.logfilesMaxAgeDays, globalCfg.logFormat, logFilePathsToKeep, notifyStatusNoThrow); //throw FileError
             }
-            catch (const FileError& e2) { logMsg(r.errorLog.ref(), e2.toString(), MSG_TYPE_ERROR); assert(false); } //should never happen!!!
+            catch (const FileError& e2) { logMsg(r.log.ref(), e2.toString(), MSG_TYPE_ERROR); assert(false); } //should never happen!!!
     }
 
     //--------- update last sync stats for the selected cfg files ---------
-    const ErrorLogStats& logStats = getStats(r.errorLog.ref());
+    const ErrorLogStats logStats = r.log.ref().getStats();
 
     for (ConfigFileItem& cfi : globalCfg.mainDlg.config.fileHistory)
         if (equalNativePath(cfi.cfgFilePath, cfgFilePath))
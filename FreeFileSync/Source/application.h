@@ -27,7 +27,7 @@ private:
 
     void runGuiMode  (const Zstring& globalConfigFile);
     void runGuiMode  (const Zstring& globalConfigFile, const XmlGuiConfig& guiCfg, const std::vector<Zstring>& cfgFilePaths, bool startComparison);
-    void runBatchMode(const Zstring& globalConfigFile, const XmlBatchConfig& batchCfg, const Zstring& cfgFilePath);
+    void runBatchMode(const Zstring& globalConfigFile, const XmlBatchConfig& batchCfg, const Zstring& cfgFilePath, bool traceRun, bool calibrateBlockSize);
 
     FfsExitCode exitCode_ = FfsExitCode::success;
 };
@@ -8,9 +8,11 @@
 #include <zen/perf.h>
 #include <zen/crc.h>
 #include <zen/guid.h>
+#include <zen/trace.h>
 #include <zen/file_access.h> //needed for TempFileBuffer only
 #include "norm_filter.h"
 #include "db_file.h"
+#include "binary.h"
 #include "cmp_filetime.h"
 #include "status_handler_impl.h"
 #include "../afs/concrete.h"
@@ -323,28 +325,44 @@ bool stillInSync(const InSyncFolder& dbFolder)
 
 //----------------------------------------------------------------------------------------------
 
+using MovePairsByContent = std::set<std::pair<const FilePair*, const FilePair*>>; //(left only, right only)
+
 class DetectMovedFiles
 {
 public:
-    static void execute(BaseFolderPair& baseFolder, const InSyncFolder& dbFolder)
+    static void execute(BaseFolderPair& baseFolder, const InSyncFolder& dbFolder, const MovePairsByContent& confirmedByContent)
     {
-        DetectMovedFiles(baseFolder, dbFolder);
+        DetectMovedFiles(baseFolder, dbFolder, &confirmedByContent, nullptr);
         baseFolder.removeDoubleEmpty(); //see findAndSetMovePair()
     }
 
+    //move pairs associated via (size, modTime) only: too weak => caller needs to confirm by content before execute()
+    static std::vector<std::pair<FilePair*, FilePair*>> getContentCheckCandidates(BaseFolderPair& baseFolder, const InSyncFolder& dbFolder)
+    {
+        std::vector<std::pair<FilePair*, FilePair*>> candidates;
+        if (baseFolder.getDetectMovesByContent())
+            DetectMovedFiles(baseFolder, dbFolder, nullptr, &candidates);
+        return candidates;
+    }
+
 private:
-    DetectMovedFiles(BaseFolderPair& baseFolder, const InSyncFolder& dbFolder) :
+    DetectMovedFiles(BaseFolderPair& baseFolder, const InSyncFolder& dbFolder,
+                     const MovePairsByContent* confirmedByContent,                      //either apply move pairs...
+                     std::vector<std::pair<FilePair*, FilePair*>>* contentCheckCandidates) : //...or only collect candidates
         cmpVar_           (baseFolder.getCompVariant()),
         fileTimeTolerance_(baseFolder.getFileTimeTolerance()),
-        ignoreTimeShiftMinutes_(baseFolder.getIgnoredTimeShift())
+        ignoreTimeShiftMinutes_(baseFolder.getIgnoredTimeShift()),
+        detectByAttributes_(baseFolder.getDetectMovesByContent()),
+        confirmedByContent_(confirmedByContent),
+        contentCheckCandidates_(contentCheckCandidates)
     {
         recurse(baseFolder, &dbFolder, &dbFolder);
 
         purgeDuplicates<SelectSide::left >(filesL_,  exLeftOnlyById_);
         purgeDuplicates<SelectSide::right>(filesR_, exRightOnlyById_);
 
-        if ((!exLeftOnlyById_ .empty() || !exLeftOnlyByPath_ .empty()) &&
-            (!exRightOnlyById_.empty() || !exRightOnlyByPath_.empty()))
+        if ((!exLeftOnlyById_ .empty() || !exLeftOnlyByPath_ .empty() || !exLeftOnlyByAttr_ .empty()) &&
+            (!exRightOnlyById_.empty() || !exRightOnlyByPath_.empty() || !exRightOnlyByAttr_.empty()))
             detectMovePairs(dbFolder);
     }
 
@@ -374,11 +392,15 @@ private:
             {
                 if (const InSyncFile* dbEntry = getDbEntry(dbFolderL, file.getItemName<SelectSide::left>()))
                     exLeftOnlyByPath_.emplace(dbEntry, &file);
+                else if (filePrintL == 0 && detectByAttributes_)
+                    addByAttributes<SelectSide::left>(file);
             }
             else if (cat == FILE_RIGHT_ONLY)
             {
                 if (const InSyncFile* dbEntry = getDbEntry(dbFolderR, file.getItemName<SelectSide::right>()))
                     exRightOnlyByPath_.emplace(dbEntry, &file);
+                else if (filePrintR == 0 && detectByAttributes_)
+                    addByAttributes<SelectSide::right>(file);
             }
         }
 
@@ -403,6 +425,16 @@ private:
         }
     }
 
+    template <SelectSide side>
+    void addByAttributes(FilePair& file)
+    {
+        std::map<std::pair<uint64_t, time_t>, FilePair*>& exOneSideByAttr = selectParam<side>(exLeftOnlyByAttr_, exRightOnlyByAttr_);
+
+        const auto [it, inserted] = exOneSideByAttr.try_emplace({file.getFileSize<side>(), file.getLastWriteTime<side>()}, &file);
+        if (!inserted)
+            it->second = nullptr; //(size, modTime) not unique => ambiguous, but keep key to block further matches
+    }
+
     template <SelectSide side>
     static void purgeDuplicates(std::vector<FilePair*>& files,
                                 std::unordered_map<AFS::FingerPrint, FilePair*>& exOneSideById)
@@ -466,10 +498,11 @@ private:
     }
 
     template <SelectSide side>
-    FilePair* getAssocFilePair(const InSyncFile& dbFile) const
+    FilePair* getAssocFilePair(const InSyncFile& dbFile, bool& assocByAttributes) const
     {
         const std::unordered_map<const InSyncFile*, FilePair*>& exOneSideByPath = selectParam<side>(exLeftOnlyByPath_, exRightOnlyByPath_);
         const std::unordered_map<AFS::FingerPrint,  FilePair*>& exOneSideById   = selectParam<side>(exLeftOnlyById_,   exRightOnlyById_);
+        const std::map<std::pair<uint64_t, time_t>, FilePair*>& exOneSideByAttr = selectParam<side>(exLeftOnlyByAttr_, exRightOnlyByAttr_);
 
         if (const auto it = exOneSideByPath.find(&dbFile);
             it != exOneSideByPath.end())
@@ -477,27 +510,48 @@ private:
         //even if the association by path doesn't match time and size while the association by ID does!
         //there doesn't seem to be (any?) value in allowing this!
 
-        if (const AFS::FingerPrint filePrint = selectParam<side>(dbFile.left, dbFile.right).filePrint;
-            filePrint != 0)
-            if (const auto it = exOneSideById.find(filePrint);
+        const InSyncDescrFile& descrDb = selectParam<side>(dbFile.left, dbFile.right);
+
+        if (descrDb.filePrint != 0)
+        {
+            if (const auto it = exOneSideById.find(descrDb.filePrint);
                 it != exOneSideById.end())
                 return it->second;
+        }
+        else //device without file IDs (e.g. FTP): fall back to (size, modTime) => requires confirmation by content!
+            if (const auto it = exOneSideByAttr.find({dbFile.fileSize, descrDb.modTime});
+                it != exOneSideByAttr.end() && it->second)
+            {
+                assocByAttributes = true;
+                return it->second;
+            }
 
         return nullptr;
     }
 
     void findAndSetMovePair(const InSyncFile& dbFile) const
     {
+        bool assocByAttributesL = false;
+        bool assocByAttributesR = false;
+
         if (stillInSync(dbFile, cmpVar_, fileTimeTolerance_, ignoreTimeShiftMinutes_))
-            if (FilePair* fileLeftOnly = getAssocFilePair<SelectSide::left>(dbFile))
+            if (FilePair* fileLeftOnly = getAssocFilePair<SelectSide::left>(dbFile, assocByAttributesL))
                 if (sameSizeAndDate<SelectSide::left>(*fileLeftOnly, dbFile))
-                    if (FilePair* fileRightOnly = getAssocFilePair<SelectSide::right>(dbFile))
+                    if (FilePair* fileRightOnly = getAssocFilePair<SelectSide::right>(dbFile, assocByAttributesR))
                         if (sameSizeAndDate<SelectSide::right>(*fileRightOnly, dbFile))
                         {
-                            if (fileLeftOnly ->getMoveRef() == nullptr &&              //needless checks? (file prints are unique in this context)
-                                fileRightOnly->getMoveRef() == nullptr &&              //
-                                fileLeftOnly ->getCategory() == FILE_LEFT_ONLY && //is it possible we could get conflicting matches!?
-                                fileRightOnly->getCategory() == FILE_RIGHT_ONLY)  //=> likely 'yes', but only in obscure cases
+                            if (contentCheckCandidates_) //collect only: don't modify model!
+                            {
+                                if (assocByAttributesL || assocByAttributesR)
+                                    contentCheckCandidates_->emplace_back(fileLeftOnly, fileRightOnly);
+                            }
+                            else if ((assocByAttributesL || assocByAttributesR) &&
+                                     !confirmedByContent_->contains({fileLeftOnly, fileRightOnly}))
+                                ; //(size, modTime) match not confirmed by content
+                            else if (fileLeftOnly ->getMoveRef() == nullptr &&         //needless checks? (file prints are unique in this context)
+                                     fileRightOnly->getMoveRef() == nullptr &&         //
+                                     fileLeftOnly ->getCategory() == FILE_LEFT_ONLY && //is it possible we could get conflicting matches!?
+                                     fileRightOnly->getCategory() == FILE_RIGHT_ONLY)  //=> likely 'yes', but only in obscure cases
                                 //--------------- found a match ---------------
                             {
                                 //move pair is just a 'rename' => combine:
@@ -546,6 +600,13 @@ private:
     std::unordered_map<const InSyncFile*, FilePair*>  exLeftOnlyByPath_;
     std::unordered_map<const InSyncFile*, FilePair*> exRightOnlyByPath_;
 
+    const bool detectByAttributes_;
+    std::map<std::pair<uint64_t, time_t>, FilePair*>  exLeftOnlyByAttr_; //only files without file print; nullptr if ambiguous
+    std::map<std::pair<uint64_t, time_t>, FilePair*> exRightOnlyByAttr_; //
+
+    const MovePairsByContent* const confirmedByContent_;
+    std::vector<std::pair<FilePair*, FilePair*>>* const contentCheckCandidates_;
+
     /*  Detect Renamed Files:
 
          X  ->  |_|      Create right
@@ -560,6 +621,8 @@ private:
               |  (file ID, size, date)                   |  (file ID, size, date)
               |            or                            |            or
               |  (file path, size, date)                 |  (file path, size, date)
+              |            or                            |            or
+              |  (size, date) + content (no file IDs)    |  (size, date) + content (no file IDs)
              \|/                                        \|/
         file left only                             file right only
 
@@ -571,6 +634,43 @@ private:
 
 //----------------------------------------------------------------------------------------------
 
+MovePairsByContent confirmMovePairsByContent(BaseFolderPair& baseFolder, const std::vector<std::pair<FilePair*, FilePair*>>& candidates, PhaseCallback& callback /*throw X*/) //throw X
+{
+    MovePairsByContent confirmed;
+
+    const std::wstring txtComparingContentOfFiles = _("Comparing content of files %x");
+
+    auto notifyUnbufferedIO = [&callback](int64_t bytesDelta) { callback.requestUiUpdate(); }; //throw X
+
+    for (const auto& [fileLeftOnly, fileRightOnly] : candidates)
+    {
+        //checked during an earlier call, e.g. at comparison time => don't read again for applySyncDirections(), swapGrids()
+        std::optional<bool> sameContent = baseFolder.getMoveCandidateContentCheck(fileLeftOnly->getId(), fileRightOnly->getId());
+        if (!sameContent)
+        {
+            try
+            {
+                callback.updateStatus(replaceCpy(txtComparingContentOfFiles, L"%x", fmtPath(fileLeftOnly->getRelativePath<SelectSide::left>()))); //throw X
+
+                sameContent = filesHaveSameContent(fileLeftOnly ->getAbstractPath<SelectSide::left >(),
+                                                   fileRightOnly->getAbstractPath<SelectSide::right>(), notifyUnbufferedIO); //throw FileError, X
+            }
+            catch (const FileError& e) //not critical: fall back to delete + copy
+            {
+                callback.logMessage(e.toString(), PhaseCallback::MsgType::warning); //throw X
+                sameContent = false; //don't retry (and warn again) on each redetermineSyncDirection()
+            }
+            baseFolder.setMoveCandidateContentCheck(fileLeftOnly->getId(), fileRightOnly->getId(), *sameContent);
+        }
+
+        if (*sameContent)
+            confirmed.emplace(fileLeftOnly, fileRightOnly);
+    }
+    return confirmed;
+}
+
+//----------------------------------------------------------------------------------------------
+
 class SetSyncDirViaChanges
 {
 public:
@@ -836,12 +936,24 @@ std::vector<std::pair<BaseFolderPair*, SyncDirectionConfig>> fff::extractDirecti
 
 void fff::redetermineSyncDirection(const std::vector<std::pair<BaseFolderPair*, SyncDirectionConfig>>& directCfgs,
                                    PhaseCallback& callback /*throw X*/) //throw X
+{
+    redetermineSyncDirection(directCfgs, {}, callback); //throw X
+}
+
+
+void fff::redetermineSyncDirection(const std::vector<std::pair<BaseFolderPair*, SyncDirectionConfig>>& directCfgs,
+                                   std::unordered_map<const BaseFolderPair*, SharedRef<const InSyncFolder>>&& lastSyncStatesLoaded,
+                                   PhaseCallback& callback /*throw X*/) //throw X
 {
     if (directCfgs.empty())
         return;
 
+    TraceSpan span("redetermineSyncDirection");
+    span.addItems(directCfgs.size());
+
     std::unordered_set<const BaseFolderPair*> allEqualPairs;
-    std::unordered_map<const BaseFolderPair*, SharedRef<const InSyncFolder>> lastSyncStates;
+    std::unordered_map<const BaseFolderPair*, SharedRef<const InSyncFolder>> lastSyncStates = std::move(lastSyncStatesLoaded);
+    std::unordered_map<const BaseFolderPair*, MovePairsByContent> movePairsByContent;
 
     //best effort: always set sync directions (even on DB load error and when user cancels during file loading)
     ZEN_ON_SCOPE_EXIT
@@ -860,7 +972,10 @@ void fff::redetermineSyncDirection(const std::vector<std::pair<BaseFolderPair*,
                     if (const InSyncFolder* lastSyncState = it != lastSyncStates.end() ? &it->second.ref() : nullptr)
                     {
                         //detect moved files (*before* setting sync directions: might combine moved files into single file pairs, wich changes category!)
-                        DetectMovedFiles::execute(*baseFolder, *lastSyncState);                
+                        {
+                            TraceSpan spanMoved("DetectMovedFiles");
+                            DetectMovedFiles::execute(*baseFolder, *lastSyncState, movePairsByContent[baseFolder]);
+                        }
 
                         SetSyncDirViaChanges::execute(*baseFolder, *lastSyncState, changeDirs);
                     }
@@ -885,13 +1000,23 @@ void fff::redetermineSyncDirection(const std::vector<std::pair<BaseFolderPair*,
         {
             if (allItemsCategoryEqual(*baseFolder)) //nothing to do: don't even try to open DB files
                 allEqualPairs.insert(baseFolder);
-            else
+            else if (!lastSyncStates.contains(baseFolder))
                 baseFoldersForDbLoad.push_back(baseFolder);
         }
 
     //(try to) load sync-database files
-    lastSyncStates = loadLastSynchronousState(baseFoldersForDbLoad,
-                                              callback /*throw X*/); //throw X
+    NamePool names; //InSyncFolder keys hold their own references => no need to outlive database load
+    lastSyncStates.merge(loadLastSynchronousState(baseFoldersForDbLoad,
+                                                  names,
+                                                  callback /*throw X*/)); //throw X
+
+    //devices without file IDs: confirm move candidates by content *outside* of ZEN_ON_SCOPE_EXIT (=> error reporting + cancellation)
+    for (const auto& [baseFolder, dirCfg] : directCfgs)
+        if (auto it = lastSyncStates.find(baseFolder);
+            it != lastSyncStates.end())
+            if (const std::vector<std::pair<FilePair*, FilePair*>> candidates = DetectMovedFiles::getContentCheckCandidates(*baseFolder, it->second.ref());
+                !candidates.empty())
+                movePairsByContent.emplace(baseFolder, confirmMovePairsByContent(*baseFolder, candidates, callback)); //throw X
 
     callback.updateStatus(_("Calculating sync directions...")); //throw X
     callback.requestUiUpdate(true /*force*/); //throw X
@@ -913,12 +1038,7 @@ void fff::setSyncDirectionRec(SyncDirection newDirection, FileSystemObject& fsOb
 
 void fff::setActiveStatus(bool newStatus, FolderComparison& folderCmp)
 {
-    auto onFsItem = [newStatus](FileSystemObject& fsObj) { fsObj.setActive(newStatus); };
-
-    std::for_each(begin(folderCmp), end(folderCmp), [onFsItem](BaseFolderPair& baseFolder)
-    {
-        visitFSObjectRecursively(baseFolder, onFsItem, onFsItem, onFsItem);
-    });
+    std::for_each(begin(folderCmp), end(folderCmp), [newStatus](BaseFolderPair& baseFolder) { baseFolder.setActiveAll(newStatus); });
 }
 
 
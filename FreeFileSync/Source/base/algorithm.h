@@ -13,6 +13,7 @@
 #include "file_hierarchy.h"
 #include "soft_filter.h"
 #include "process_callback.h"
+#include "db_file.h"
 
 
 namespace fff
@@ -25,6 +26,10 @@ std::vector<std::pair<BaseFolderPair*, SyncDirectionConfig>> extractDirectionCfg
 void redetermineSyncDirection(const std::vector<std::pair<BaseFolderPair*, SyncDirectionConfig>>& directCfgs,
                               PhaseCallback& callback /*throw X*/); //throw X
 
+void redetermineSyncDirection(const std::vector<std::pair<BaseFolderPair*, SyncDirectionConfig>>& directCfgs,
+                              std::unordered_map<const BaseFolderPair*, zen::SharedRef<const InSyncFolder>>&& lastSyncStatesLoaded, //databases loaded already: don't read again
+                              PhaseCallback& callback /*throw X*/); //throw X
+
 void setSyncDirectionRec(SyncDirection newDirection, FileSystemObject& fsObj); //set new direction (recursively)
 
 bool allElementsEqual(const FolderComparison& folderCmp);
@@ -5,14 +5,56 @@
 // *****************************************************************************
 
 #include "binary.h"
+#include <zen/open_ssl.h>
 
 using namespace zen;
 using namespace fff;
 using AFS = AbstractFileSystem;
 
 
-bool fff::filesHaveSameContent(const AbstractPath& filePath1, const AbstractPath& filePath2, const IoCallback& notifyUnbufferedIO /*throw X*/) //throw FileError, X
+namespace
 {
+class ContentHasher //optional: hash file content as it is being read
+{
+public:
+    ContentHasher(bool active, const AbstractPath& filePath) : filePath_(filePath) //throw FileError
+    {
+        if (active)
+            try { hasher_.emplace(); /*throw SysError*/ }
+            catch (const SysError& e) { throwFileError(e); }
+    }
+
+    void update(const std::byte* buffer, size_t bytesToHash) //throw FileError
+    {
+        if (hasher_)
+            try { hasher_->update(buffer, bytesToHash); /*throw SysError*/ }
+            catch (const SysError& e) { throwFileError(e); }
+    }
+
+    std::string finalize() //throw FileError
+    {
+        assert(hasher_);
+        try { return hasher_->finalize(); /*throw SysError*/ }
+        catch (const SysError& e) { throwFileError(e); }
+    }
+
+private:
+    [[noreturn]] void throwFileError(const SysError& e) const
+    {
+        throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(AFS::getDisplayPath(filePath_))), e.toString());
+    }
+
+    const AbstractPath filePath_;
+    std::optional<Sha256Stream> hasher_;
+};
+}
+
+
+bool fff::filesHaveSameContent(const AbstractPath& filePath1, const AbstractPath& filePath2, const IoCallback& notifyUnbufferedIO /*throw X*/, //throw FileError, X
+                               std::string* contentHash)
+{
+    ContentHasher hasher(contentHash != nullptr, filePath2); //throw FileError
+
     int64_t totalBytesNotified = 0;
     IoCallback /*[!] as expected by InputStream::tryRead()*/ notifyIoDiv = IOCallbackDivider(notifyUnbufferedIO, totalBytesNotified);
 
@@ -48,9 +90,15 @@ bool fff::filesHaveSameContent(const AbstractPath& filePath1, const AbstractPath
                 if (std::memcmp(buf1 + buf1Pos, buf2, bytesRead2) != 0)
                     return false;
 
+                hasher.update(buf2, bytesRead2); //throw FileError
                 buf1Pos += bytesRead2;
             }
-            return stream2->tryRead(buf2, blockSize2, notifyIoDiv) == 0; //throw FileError, X; expect EOF
+            if (stream2->tryRead(buf2, blockSize2, notifyIoDiv) != 0) //throw FileError, X; expect EOF
+                return false;
+
+            if (contentHash)
+                *contentHash = hasher.finalize(); //throw FileError
+            return true;
         }
         else
         {
@@ -67,6 +115,7 @@ bool fff::filesHaveSameContent(const AbstractPath& filePath1, const AbstractPath
                 if (std::memcmp(buf1 + buf1Pos, buf2, bytesRead2) != 0)
                     return false;
 
+                hasher.update(buf2, bytesRead2); //throw FileError
                 buf1Pos += bytesRead2;
             }
             if (buf1Pos > 0)
@@ -77,3 +126,22 @@ bool fff::filesHaveSameContent(const AbstractPath& filePath1, const AbstractPath
         }
     }
 }
+
+
+std::string fff::getFileContentHash(const AbstractPath& filePath, const IoCallback& notifyUnbufferedIO /*throw X*/) //throw FileError, X
+{
+    ContentHasher hasher(true /*active*/, filePath); //throw FileError
+
+    const std::unique_ptr<AFS::InputStream> stream = AFS::getInputStream(filePath); //throw FileError
+    const size_t blockSize = stream->getBlockSize(); //throw FileError
+
+    const std::unique_ptr<std::byte[]> buf(new std::byte[blockSize]);
+    for (;;)
+    {
+        const size_t bytesRead = stream->tryRead(buf.get(), blockSize, notifyUnbufferedIO); //throw FileError, X; may return short; only 0 means EOF
+        if (bytesRead == 0) //end of file
+            return hasher.finalize(); //throw FileError
+
+        hasher.update(buf.get(), bytesRead); //throw FileError
+    }
+}
@@ -14,7 +14,10 @@ namespace fff
 {
 bool filesHaveSameContent(const AbstractPath& filePath1,
                           const AbstractPath& filePath2,
-                          const zen::IoCallback& notifyUnbufferedIO  /*throw X*/); //throw FileError, X
+                          const zen::IoCallback& notifyUnbufferedIO  /*throw X*/, //throw FileError, X
+                          std::string* contentHash = nullptr); //optional: SHA-256 of file content; set only if content is the same
+
+std::string getFileContentHash(const AbstractPath& filePath, const zen::IoCallback& notifyUnbufferedIO /*throw X*/); //throw FileError, X
 }
 
 #endif //BINARY_H_3941281398513241134
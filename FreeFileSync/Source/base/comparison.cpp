@@ -5,9 +5,11 @@
 // *****************************************************************************
 
 #include "comparison.h"
+#include <malloc.h>
 #include <zen/process_priority.h>
 #include <zen/perf.h>
 #include <zen/time.h>
+#include <zen/trace.h>
 #include "algorithm.h"
 #include "parallel_scan.h"
 #include "dir_exist_async.h"
@@ -188,26 +190,33 @@ class ComparisonBuffer
 public:
     ComparisonBuffer(const FolderStatus& folderStatus,
                      int fileTimeTolerance,
+                     bool detectMovesByContent,
                      ProcessCallback& callback) :
         fileTimeTolerance_(fileTimeTolerance),
+        detectMovesByContent_(detectMovesByContent),
         folderStatus_(folderStatus),
         cb_(callback) {}
 
     FolderComparison execute(const std::vector<std::pair<ResolvedFolderPair, FolderPairCfg>>& workLoad);
 
+    //databases loaded by "compare by content" => redetermineSyncDirection() need not load them again
+    std::unordered_map<const BaseFolderPair*, SharedRef<const InSyncFolder>> takeLastSyncStates() { return std::move(lastSyncStates_); }
+
 private:
     ComparisonBuffer           (const ComparisonBuffer&) = delete;
     ComparisonBuffer& operator=(const ComparisonBuffer&) = delete;
 
     //create comparison result table and fill category except for files existing on both sides: undefinedFiles and undefinedSymlinks are appended!
-    SharedRef<BaseFolderPair> compareByTimeSize(const ResolvedFolderPair& fp, const FolderPairCfg& fpConfig) const;
-    SharedRef<BaseFolderPair> compareBySize    (const ResolvedFolderPair& fp, const FolderPairCfg& fpConfig) const;
-    std::vector<SharedRef<BaseFolderPair>> compareByContent(const std::vector<std::pair<ResolvedFolderPair, FolderPairCfg>>& workLoad) const;
+    SharedRef<BaseFolderPair> compareByTimeSize(const ResolvedFolderPair& fp, const FolderPairCfg& fpConfig);
+    SharedRef<BaseFolderPair> compareBySize    (const ResolvedFolderPair& fp, const FolderPairCfg& fpConfig);
+    std::vector<SharedRef<BaseFolderPair>> compareByContent(const std::vector<std::pair<ResolvedFolderPair, FolderPairCfg>>& workLoad);
 
     SharedRef<BaseFolderPair> performComparison(const ResolvedFolderPair& fp,
                                                 const FolderPairCfg& fpCfg,
                                                 std::vector<FilePair*>& undefinedFiles,
-                                                std::vector<SymlinkPair*>& undefinedSymlinks) const;
+                                                std::vector<SymlinkPair*>& undefinedSymlinks);
+
+    void releaseFolderBuffer(const DirectoryKey& folderKey);
 
     BaseFolderStatus getBaseFolderStatus(const AbstractPath& folderPath) const
     {
@@ -222,8 +231,12 @@ private:
     };
 
     const int fileTimeTolerance_;
+    const bool detectMovesByContent_;
     const FolderStatus& folderStatus_;
-    std::map<DirectoryKey, DirectoryValue> folderBuffer_; //contains entries for *all* scanned folders!
+    std::map<DirectoryKey, DirectoryValue> folderBuffer_; //contains entries for *all* scanned folders (until merged)
+    std::map<DirectoryKey, size_t> folderBufferRefs_; //number of folder pairs yet to be merged: release buffer as soon as unused => reduce peak memory
+    std::unordered_map<const BaseFolderPair*, SharedRef<const InSyncFolder>> lastSyncStates_;
+    NamePool names_; //whole comparison: traversal, database load, left/right matching
     ProcessCallback& cb_;
 };
 
@@ -236,10 +249,13 @@ FolderComparison ComparisonBuffer::execute(const std::vector<std::pair<ResolvedF
             getBaseFolderStatus(folderPair.folderPathRight) != BaseFolderStatus::failure)   //*either* folder existence check fails
         {
             //+ only traverse *existing* folders
-            if (getBaseFolderStatus(folderPair.folderPathLeft) == BaseFolderStatus::existing)
-                foldersToRead.emplace(DirectoryKey{folderPair.folderPathLeft,  fpCfg.filter.nameFilter, fpCfg.handleSymlinks});
-            if (getBaseFolderStatus(folderPair.folderPathRight) == BaseFolderStatus::existing)
-                foldersToRead.emplace(DirectoryKey{folderPair.folderPathRight, fpCfg.filter.nameFilter, fpCfg.handleSymlinks});
+            for (const AbstractPath& folderPath : {folderPair.folderPathLeft, folderPair.folderPathRight})
+                if (getBaseFolderStatus(folderPath) == BaseFolderStatus::existing)
+                {
+                    const DirectoryKey folderKey{folderPath, fpCfg.filter.nameFilter, fpCfg.handleSymlinks};
+                    foldersToRead.insert(folderKey);
+                    ++folderBufferRefs_[folderKey];
+                }
         }
 
     //------------------------------------------------------------------
@@ -254,12 +270,15 @@ FolderComparison ComparisonBuffer::execute(const std::vector<std::pair<ResolvedF
         cb_.updateStatus(textScanning + statusLine); //throw X
     };
 
-    //PERF_START;
-    folderBuffer_ = parallelDeviceTraversal(foldersToRead,
-    [&](const PhaseCallback::ErrorInfo& errorInfo) { return cb_.reportError(errorInfo); }, //throw X
-    onStatusUpdate, //throw X
-    UI_UPDATE_INTERVAL / 2); //every ~50 ms
-    //PERF_STOP;
+    {
+        TraceSpan span("ComparisonBuffer::scan");
+        folderBuffer_ = parallelDeviceTraversal(foldersToRead,
+        [&](const PhaseCallback::ErrorInfo& errorInfo) { return cb_.reportError(errorInfo); }, //throw X
+        onStatusUpdate, //throw X
+        UI_UPDATE_INTERVAL / 2, //every ~50 ms
+        names_);
+        span.addItems(itemsReported);
+    }
 
     const int64_t totalTimeSec = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - compareStartTime).count();
     cb_.logMessage(_("Comparison finished:") + L' ' +
@@ -274,6 +293,8 @@ FolderComparison ComparisonBuffer::execute(const std::vector<std::pair<ResolvedF
         if (fpCfg.compareVar == CompareVariant::content)
             workLoadByContent.push_back({folderPair, fpCfg});
 
+    TraceSpan span("ComparisonBuffer::categorize");
+
     std::vector<SharedRef<BaseFolderPair>> outputByContent = compareByContent(workLoadByContent);
     auto itOByC = outputByContent.begin();
 
@@ -367,7 +388,7 @@ void categorizeSymlinkByTime(SymlinkPair& symlink)
 }
 
 
-SharedRef<BaseFolderPair> ComparisonBuffer::compareByTimeSize(const ResolvedFolderPair& fp, const FolderPairCfg& fpConfig) const
+SharedRef<BaseFolderPair> ComparisonBuffer::compareByTimeSize(const ResolvedFolderPair& fp, const FolderPairCfg& fpConfig)
 {
     //do basis scan and retrieve files existing on both sides as "compareCandidates"
     std::vector<FilePair*> uncategorizedFiles;
@@ -435,7 +456,7 @@ void categorizeSymlinkByContent(SymlinkPair& symlink, PhaseCallback& callback)
 }
 
 
-SharedRef<BaseFolderPair> ComparisonBuffer::compareBySize(const ResolvedFolderPair& fp, const FolderPairCfg& fpConfig) const
+SharedRef<BaseFolderPair> ComparisonBuffer::compareBySize(const ResolvedFolderPair& fp, const FolderPairCfg& fpConfig)
 {
     //do basis scan and retrieve files existing on both sides as "compareCandidates"
     std::vector<FilePair*> uncategorizedFiles;
@@ -471,16 +492,95 @@ namespace parallel
 inline
 bool filesHaveSameContent(const AbstractPath& filePath1, const AbstractPath& filePath2, //throw FileError, X
                           const IoCallback& notifyUnbufferedIO /*throw X*/,
+                          std::string* contentHash, //optional
                           std::mutex& singleThread)
-{ return parallelScope([=] { return filesHaveSameContent(filePath1, filePath2, notifyUnbufferedIO); /*throw FileError, X*/ }, singleThread); }
+{ return parallelScope([=] { return filesHaveSameContent(filePath1, filePath2, notifyUnbufferedIO, contentHash); /*throw FileError, X*/ }, singleThread); }
+
+inline
+std::string getFileContentHash(const AbstractPath& filePath, const IoCallback& notifyUnbufferedIO /*throw X*/, std::mutex& singleThread) //throw FileError, X
+{ return parallelScope([=] { return getFileContentHash(filePath, notifyUnbufferedIO); /*throw FileError, X*/ }, singleThread); }
 }
 
 
 namespace
 {
-void categorizeFileByContent(FilePair& file, const std::wstring& txtComparingContentOfFiles, AsyncCallback& acb, std::mutex& singleThread) //throw ThreadStopRequest
+struct ContentCompareTask
+{
+    FilePair* file = nullptr;
+    bool hashContent = false; //store content hash in sync.ffs_db
+    Zstringc dbContentHash;   //optional: content of "unchangedSide" is known from last sync => hash "changedSide" only
+    SelectSide changedSide = SelectSide::left;
+};
+
+
+const InSyncFolder* findDbFolder(const ContainerObject& conObj, const InSyncFolder& dbBaseFolder)
+{
+    if (const auto folder = dynamic_cast<const FolderPair*>(&conObj))
+    {
+        if (const InSyncFolder* dbParent = findDbFolder(folder->parent(), dbBaseFolder))
+            if (const auto it = dbParent->folders.find(folder->getItemName<SelectSide::left>());
+                it != dbParent->folders.end())
+                return &it->second;
+        return nullptr;
+    }
+    return &dbBaseFolder; //conObj is the BaseFolderPair
+}
+
+
+template <SelectSide side> inline
+bool unchangedSinceLastSync(const FilePair& file, const InSyncFile& dbFile)
+{
+    //be strict: any metadata change means "content needs to be read"
+    const InSyncDescrFile& descrDb = selectParam<side>(dbFile.left, dbFile.right);
+    return file.getFileSize     <side>() == dbFile.fileSize &&
+           file.getLastWriteTime<side>() == descrDb.modTime &&
+           file.getFilePrint    <side>() == descrDb.filePrint;
+}
+
+
+//skip reading files that were found equal "by content" during last sync and are unchanged since
+void applyLastSyncContentState(RingBuffer<ContentCompareTask>& tasks, const InSyncFolder& dbBaseFolder)
+{
+    RingBuffer<ContentCompareTask> tasksRemaining;
+
+    for (ContentCompareTask& task : tasks)
+    {
+        FilePair& file = *task.file;
+
+        if (file.hasEquivalentItemNames()) //InSyncFolder's mapping tables use file name as a key!
+            if (const InSyncFolder* dbFolder = findDbFolder(file.parent(), dbBaseFolder))
+                if (const auto it = dbFolder->files.find(file.getItemName<SelectSide::left>());
+                    it != dbFolder->files.end())
+                    if (const InSyncFile& dbFile = it->second;
+                        dbFile.cmpVar == CompareVariant::content)
+                    {
+                        const bool unchangedL = unchangedSinceLastSync<SelectSide::left >(file, dbFile);
+                        const bool unchangedR = unchangedSinceLastSync<SelectSide::right>(file, dbFile);
+
+                        if (unchangedL && unchangedR)
+                        {
+                            file.setContentCategory(FileContentCategory::equal);
+                            if (!dbFile.contentHash.empty())
+                                file.setContentHash(dbFile.contentHash);
+                            continue;
+                        }
+                        if ((unchangedL || unchangedR) && !dbFile.contentHash.empty())
+                        {
+                            task.dbContentHash = dbFile.contentHash;
+                            task.changedSide = unchangedL ? SelectSide::right : SelectSide::left;
+                        }
+                    }
+        tasksRemaining.push_back(std::move(task));
+    }
+    tasks.swap(tasksRemaining);
+}
+
+
+void categorizeFileByContent(const ContentCompareTask& task, const std::wstring& txtComparingContentOfFiles, AsyncCallback& acb, std::mutex& singleThread) //throw ThreadStopRequest
 {
+    FilePair& file = *task.file;
     bool haveSameContent = false;
+    std::string contentHash;
     const std::wstring errMsg = tryReportingError([&]
     {
         std::wstring statusMsg = replaceCpy(txtComparingContentOfFiles, L"%x", fmtPath(file.getRelativePath<SelectSide::left>()));
@@ -498,20 +598,35 @@ void categorizeFileByContent(FilePair& file, const std::wstring& txtComparingCon
             interruptionPoint(); //throw ThreadStopRequest => not reliably covered by PercentStatReporter::updateDeltaAndStatus()!
         };
 
-        haveSameContent = parallel::filesHaveSameContent(file.getAbstractPath<SelectSide::left >(),
-                                                         file.getAbstractPath<SelectSide::right>(), notifyUnbufferedIO, singleThread); //throw FileError, ThreadStopRequest
+        if (!task.dbContentHash.empty()) //only one side changed since last sync: no need to read the other one
+        {
+            const AbstractPath filePath = task.changedSide == SelectSide::left ?
+                                          file.getAbstractPath<SelectSide::left >() :
+                                          file.getAbstractPath<SelectSide::right>();
+
+            contentHash = parallel::getFileContentHash(filePath, notifyUnbufferedIO, singleThread); //throw FileError, ThreadStopRequest
+            haveSameContent = equalString(contentHash, task.dbContentHash);
+        }
+        else
+            haveSameContent = parallel::filesHaveSameContent(file.getAbstractPath<SelectSide::left >(),
+                                                             file.getAbstractPath<SelectSide::right>(), notifyUnbufferedIO,
+                                                             task.hashContent ? &contentHash : nullptr, singleThread); //throw FileError, ThreadStopRequest
         statReporter.reportDelta(1, 0);
     }, acb); //throw ThreadStopRequest
 
     if (!errMsg.empty())
         file.setCategoryConflict(utfTo<Zstringc>(errMsg));
     else
+    {
         file.setContentCategory(haveSameContent ? FileContentCategory::equal : FileContentCategory::different);
+        if (haveSameContent && task.hashContent)
+            file.setContentHash(task.dbContentHash.empty() ? utfTo<Zstringc>(contentHash) : task.dbContentHash); //share memory with other references
+    }
 }
 }
 
 
-std::vector<SharedRef<BaseFolderPair>> ComparisonBuffer::compareByContent(const std::vector<std::pair<ResolvedFolderPair, FolderPairCfg>>& workLoad) const
+std::vector<SharedRef<BaseFolderPair>> ComparisonBuffer::compareByContent(const std::vector<std::pair<ResolvedFolderPair, FolderPairCfg>>& workLoad)
 {
     struct ParallelOps
     {
@@ -523,11 +638,11 @@ std::vector<SharedRef<BaseFolderPair>> ComparisonBuffer::compareByContent(const
     {
         ParallelOps& parallelOpsL; //
         ParallelOps& parallelOpsR; //consider aliasing!
-        RingBuffer<FilePair*> filesToCompareBytewise;
+        RingBuffer<ContentCompareTask> filesToCompareBytewise;
     };
     std::vector<BinaryWorkload> fpWorkload;
 
-    auto addToBinaryWorkload = [&](const AbstractPath& basePathL, const AbstractPath& basePathR, RingBuffer<FilePair*>&& filesToCompareBytewise)
+    auto addToBinaryWorkload = [&](const AbstractPath& basePathL, const AbstractPath& basePathR, RingBuffer<ContentCompareTask>&& filesToCompareBytewise)
     {
         ParallelOps& posL = parallelOpsStatus[basePathL.afsDevice];
         ParallelOps& posR = parallelOpsStatus[basePathR.afsDevice];
@@ -545,7 +660,10 @@ std::vector<SharedRef<BaseFolderPair>> ComparisonBuffer::compareByContent(const
         //run basis scan and retrieve candidates for binary comparison (files existing on both sides)
         output.push_back(performComparison(folderPair, fpCfg, undefinedFiles, uncategorizedLinks));
 
-        RingBuffer<FilePair*> filesToCompareBytewise;
+        //sync.ffs_db is maintained only for "two way" variant: use it to skip (re-)reading files unchanged since last sync
+        const bool useSyncDb = std::get_if<DirectionByChange>(&fpCfg.directionCfg.dirs);
+
+        RingBuffer<ContentCompareTask> filesToCompareBytewise;
         //content comparison of file content happens AFTER finding corresponding files and AFTER filtering
         //in order to separate into two processes (scanning and comparing)
         for (FilePair* file : undefinedFiles)
@@ -560,8 +678,44 @@ std::vector<SharedRef<BaseFolderPair>> ComparisonBuffer::compareByContent(const
                 if (!file->isActive())
                     file->setCategoryConflict(txtConflictSkippedBinaryComparison);
                 else
-                    filesToCompareBytewise.push_back(file);
+                    filesToCompareBytewise.push_back(ContentCompareTask{.file = file, .hashContent = useSyncDb});
+            }
+
+        if (useSyncDb && !filesToCompareBytewise.empty())
+        {
+            //load one database at a time; successfully loaded ones are handed over to redetermineSyncDirection()
+            //errors: ignore, they will be reported when redetermineSyncDirection() tries to load the database again
+            class PcbSilentErrors : public PhaseCallback
+            {
+            public:
+                explicit PcbSilentErrors(ProcessCallback& cb) : cb_(cb) {}
+
+                void updateDataProcessed(int itemsDelta, int64_t bytesDelta) override {} //not part of comparison statistics
+                void updateDataTotal    (int itemsDelta, int64_t bytesDelta) override {} //
+
+                void requestUiUpdate(bool force) override { cb_.requestUiUpdate(force); } //throw X
+                void updateStatus(std::wstring&& msg) override { cb_.updateStatus(std::move(msg)); } //throw X
+                void logMessage(const std::wstring& msg, MsgType type) override {}
+
+                void reportWarning(const std::wstring& msg, bool& warningActive) override {}
+                Response reportError     (const ErrorInfo& errorInfo)            override { return Response::ignore; }
+                void     reportFatalError(const std::wstring& msg)               override {}
+
+            private:
+                ProcessCallback& cb_;
+            } callbackSilent(cb_);
+
+            const BaseFolderPair& baseFolder = output.back().ref();
+            auto lastSyncStates = loadLastSynchronousState({&baseFolder}, names_, callbackSilent); //throw X
+
+            if (const auto it = lastSyncStates.find(&baseFolder);
+                it != lastSyncStates.end())
+            {
+                applyLastSyncContentState(filesToCompareBytewise, it->second.ref());
+                lastSyncStates_.insert(std::move(*it));
             }
+        }
+
         if (!filesToCompareBytewise.empty())
             addToBinaryWorkload(output.back().ref().getAbstractPath<SelectSide::left >(),
                                 output.back().ref().getAbstractPath<SelectSide::right>(), std::move(filesToCompareBytewise));
@@ -580,12 +734,14 @@ std::vector<SharedRef<BaseFolderPair>> ComparisonBuffer::compareByContent(const
         {
             itemsTotal += static_cast<int>(bwl.filesToCompareBytewise.size());
 
-            for (const FilePair* file : bwl.filesToCompareBytewise)
-                bytesTotal += file->getFileSize<SelectSide::left>(); //left and right file sizes are equal
+            for (const ContentCompareTask& task : bwl.filesToCompareBytewise)
+                bytesTotal += task.file->getFileSize<SelectSide::left>(); //left and right file sizes are equal
         }
         cb_.initNewPhase(itemsTotal, bytesTotal, ProcessPhase::binaryCompare); //throw X
 
-        //PERF_START;
+        TraceSpan span("ComparisonBuffer::compareByContent");
+        span.addItems(itemsTotal);
+        span.addBytes(bytesTotal);
 
         std::mutex singleThread; //only a single worker thread may run at a time, except for parallel file I/O
 
@@ -610,7 +766,7 @@ std::vector<SharedRef<BaseFolderPair>> ComparisonBuffer::compareByContent(const
 
                 for (size_t i = 0; i < newTaskCount; ++i)
                 {
-                    tg.run([&, statusPrio = j, &file = *bwl.filesToCompareBytewise.front()]
+                    tg.run([&, statusPrio = j, task = std::move(bwl.filesToCompareBytewise.front())]
                     {
                         acb.notifyTaskBegin(statusPrio); //prioritize status messages according to natural order of folder pairs
                         ZEN_ON_SCOPE_EXIT(acb.notifyTaskEnd());
@@ -621,7 +777,7 @@ std::vector<SharedRef<BaseFolderPair>> ComparisonBuffer::compareByContent(const
                                              /**/                --posR.current;
                                              scheduleMoreTasks());
 
-                        categorizeFileByContent(file, txtComparingContentOfFiles, acb, singleThread); //throw ThreadStopRequest
+                        categorizeFileByContent(task, txtComparingContentOfFiles, acb, singleThread); //throw ThreadStopRequest
                     });
 
                     bwl.filesToCompareBytewise.pop_front();
@@ -649,14 +805,18 @@ std::vector<SharedRef<BaseFolderPair>> ComparisonBuffer::compareByContent(const
 class MergeSides
 {
 public:
-    static void execute(const FolderContainer& lhs, const FolderContainer& rhs,
+    //release input: free traversal buffer while merging (if not needed by other folder pairs) => peak memory ~ max(input, output) instead of input + output
+    static void execute(FolderContainer& lhs, bool releaseL,
+                        FolderContainer& rhs, bool releaseR,
                         const std::unordered_map<Zstring, Zstringc>& errorsByRelPathL,
                         const std::unordered_map<Zstring, Zstringc>& errorsByRelPathR,
                         ContainerObject& output,
                         std::vector<FilePair*>& undefinedFilesOut,
-                        std::vector<SymlinkPair*>& undefinedSymlinksOut)
+                        std::vector<SymlinkPair*>& undefinedSymlinksOut,
+                        NamePool& names)
     {
-        MergeSides inst(errorsByRelPathL, errorsByRelPathR, undefinedFilesOut, undefinedSymlinksOut);
+        assert(!(releaseL || releaseR) || &lhs != &rhs);
+        MergeSides inst(releaseL, releaseR, errorsByRelPathL, errorsByRelPathR, undefinedFilesOut, undefinedSymlinksOut, names);
 
         const Zstringc* errorMsg = nullptr;
         if (auto it = inst.errorsByRelPathL_.find(Zstring()); //empty path if read-error for whole base directory
@@ -670,29 +830,44 @@ public:
     }
 
 private:
-    MergeSides(const std::unordered_map<Zstring, Zstringc>& errorsByRelPathL,
+    MergeSides(bool releaseL, bool releaseR,
+               const std::unordered_map<Zstring, Zstringc>& errorsByRelPathL,
                const std::unordered_map<Zstring, Zstringc>& errorsByRelPathR,
                std::vector<FilePair*>& undefinedFilesOut,
-               std::vector<SymlinkPair*>& undefinedSymlinksOut) :
+               std::vector<SymlinkPair*>& undefinedSymlinksOut,
+               NamePool& names) :
+        releaseL_(releaseL),
+        releaseR_(releaseR),
         errorsByRelPathL_(errorsByRelPathL),
         errorsByRelPathR_(errorsByRelPathR),
         undefinedFiles_(undefinedFilesOut),
-        undefinedSymlinks_(undefinedSymlinksOut) {}
+        undefinedSymlinks_(undefinedSymlinksOut),
+        names_(names) {}
 
-    void mergeFolders(const FolderContainer& lhs, const FolderContainer& rhs, const Zstringc* errorMsg, ContainerObject& output);
+    void mergeFolders(FolderContainer& lhs, FolderContainer& rhs, const Zstringc* errorMsg, ContainerObject& output);
 
     template <SelectSide side>
-    void fillOneSide(const FolderContainer& folderCont, const Zstringc* errorMsg, ContainerObject& output);
+    void fillOneSide(FolderContainer& folderCont, const Zstringc* errorMsg, ContainerObject& output);
+
+    template <SelectSide side, class MapType>
+    void releaseMerged(MapType& itemMap)
+    {
+        if (selectParam<side>(releaseL_, releaseR_))
+            MapType().swap(itemMap); //clear() would keep the bucket array
+    }
 
     template <SelectSide side>
     const Zstringc* checkFailedRead(FileSystemObject& fsObj, const Zstringc* errorMsg);
 
     const Zstringc* checkFailedRead(FileSystemObject& fsObj, const Zstringc* errorMsg);
 
+    const bool releaseL_;
+    const bool releaseR_;
     const std::unordered_map<Zstring, Zstringc>& errorsByRelPathL_; //base-relative paths or empty if read-error for whole base directory
     const std::unordered_map<Zstring, Zstringc>& errorsByRelPathR_; //
     std::vector<FilePair*>& undefinedFiles_;
     std::vector<SymlinkPair*>& undefinedSymlinks_;
+    NamePool& names_; //precomputed compare keys
 };
 
 
@@ -729,66 +904,72 @@ const Zstringc* MergeSides::checkFailedRead(FileSystemObject& fsObj, const Zstri
 
 
 template <class MapType, class Function>
-void forEachSorted(const MapType& fileMap, Function fun)
+void forEachSorted(MapType& fileMap, NamePool& names, Function fun)
 {
-    using FileRef = const typename MapType::value_type*;
-
+    struct FileRef
+    {
+        typename MapType::value_type* ref;
+        const Zstring* upperCase; //precomputed compareNoCase() key
+    };
     std::vector<FileRef> fileList;
     fileList.reserve(fileMap.size());
 
-    for (const auto& item : fileMap)
-        fileList.push_back(&item);
+    for (auto& item : fileMap)
+        fileList.push_back({&item, &names.getCompareKeys(item.first).upperCase});
 
     //sort for natural default sequence on UI file grid:
-    std::sort(fileList.begin(), fileList.end(), [](const FileRef& lhs, const FileRef& rhs) { return compareNoCase(lhs->first /*item name*/, rhs->first) < 0; });
+    std::sort(fileList.begin(), fileList.end(), [](const FileRef& lhs, const FileRef& rhs) { return *lhs.upperCase < *rhs.upperCase; });
 
-    for (const auto& item : fileList)
-        fun(item->first, item->second);
+    for (const FileRef& fr : fileList)
+        fun(fr.ref->first, fr.ref->second);
 }
 
 
 template <SelectSide side>
-void MergeSides::fillOneSide(const FolderContainer& folderCont, const Zstringc* errorMsg, ContainerObject& output)
+void MergeSides::fillOneSide(FolderContainer& folderCont, const Zstringc* errorMsg, ContainerObject& output)
 {
-    forEachSorted(folderCont.files, [&](const Zstring& fileName, const FileAttributes& attrib)
+    forEachSorted(folderCont.files, names_, [&](const Zstring& fileName, const FileAttributes& attrib)
     {
         FilePair& newItem = output.addFile<side>(fileName, attrib);
         checkFailedRead<side>(newItem, errorMsg);
     });
+    releaseMerged<side>(folderCont.files);
 
-    forEachSorted(folderCont.symlinks, [&](const Zstring& linkName, const LinkAttributes& attrib)
+    forEachSorted(folderCont.symlinks, names_, [&](const Zstring& linkName, const LinkAttributes& attrib)
     {
         SymlinkPair& newItem = output.addLink<side>(linkName, attrib);
         checkFailedRead<side>(newItem, errorMsg);
     });
+    releaseMerged<side>(folderCont.symlinks);
 
-    forEachSorted(folderCont.folders, [&](const Zstring& folderName, const std::pair<FolderAttributes, FolderContainer>& attrib)
+    forEachSorted(folderCont.folders, names_, [&](const Zstring& folderName, std::pair<FolderAttributes, FolderContainer>& attrib)
     {
         FolderPair& newFolder = output.addFolder<side>(folderName, attrib.first);
         const Zstringc* errorMsgNew = checkFailedRead<side>(newFolder, errorMsg);
         fillOneSide<side>(attrib.second, errorMsgNew, newFolder); //recurse
     });
+    releaseMerged<side>(folderCont.folders);
 }
 
 
 template <class MapType, class ProcessLeftOnly, class ProcessRightOnly, class ProcessBoth> inline
-void matchFolders(const MapType& mapLeft, const MapType& mapRight, ProcessLeftOnly lo, ProcessRightOnly ro, ProcessBoth bo)
+void matchFolders(MapType& mapLeft, MapType& mapRight, NamePool& names, ProcessLeftOnly lo, ProcessRightOnly ro, ProcessBoth bo)
 {
     struct FileRef
     {
-        //perf: buffer ZstringNoCase instead of compareNoCase()/equalNoCase()? => makes no (significant) difference!
-        const typename MapType::value_type* ref;
+        typename MapType::value_type* ref;
         SelectSide side;
+        const NamePool::CompareKeys* keys; //interned names: compare keys are computed once per unique name and comparison
     };
     std::vector<FileRef> fileList;
     fileList.reserve(mapLeft.size() + mapRight.size()); //perf: ~5% shorter runtime
 
-    for (const auto& item : mapLeft ) fileList.push_back({&item, SelectSide::left});
-    for (const auto& item : mapRight) fileList.push_back({&item, SelectSide::right});
+    for (auto& item : mapLeft ) fileList.push_back({&item, SelectSide::left,  &names.getCompareKeys(item.first)});
+    for (auto& item : mapRight) fileList.push_back({&item, SelectSide::right, &names.getCompareKeys(item.first)});
 
     //primary sort: ignore Unicode normal form and upper/lower case
     //bonus: natural default sequence on UI file grid
-    std::sort(fileList.begin(), fileList.end(), [](const FileRef& lhs, const FileRef& rhs) { return compareNoCase(lhs.ref->first /*item name*/, rhs.ref->first) < 0; });
+    std::sort(fileList.begin(), fileList.end(), [](const FileRef& lhs, const FileRef& rhs) { return lhs.keys->upperCase < rhs.keys->upperCase; }); //= compareNoCase()
 
     using ItType = typename std::vector<FileRef>::iterator;
     auto tryMatchRange = [&](ItType it, ItType itLast) //auto parameters? compiler error on VS 17.2...
@@ -815,16 +996,16 @@ void matchFolders(const MapType& mapLeft, const MapType& mapRight, ProcessLeftOn
     for (auto it = fileList.begin(); it != fileList.end();)
     {
         //find equal range: ignore case, ignore Unicode normalization
-        auto itEndEq = std::find_if(it + 1, fileList.end(), [&](const FileRef& fr) { return !equalNoCase(fr.ref->first, it->ref->first); });
+        auto itEndEq = std::find_if(it + 1, fileList.end(), [&](const FileRef& fr) { return fr.keys->upperCase != it->keys->upperCase; }); //= !equalNoCase()
         if (!tryMatchRange(it, itEndEq))
         {
             //secondary sort: respect case, ignore unicode normal forms
-            std::sort(it, itEndEq, [](const FileRef& lhs, const FileRef& rhs) { return getUnicodeNormalForm(lhs.ref->first) < getUnicodeNormalForm(rhs.ref->first); });
+            std::sort(it, itEndEq, [](const FileRef& lhs, const FileRef& rhs) { return lhs.keys->normalForm < rhs.keys->normalForm; });
 
             for (auto itCase = it; itCase != itEndEq;)
             {
                 //find equal range: respect case, ignore Unicode normalization
-                auto itEndCase = std::find_if(itCase + 1, itEndEq, [&](const FileRef& fr) { return getUnicodeNormalForm(fr.ref->first) != getUnicodeNormalForm(itCase->ref->first); });
+                auto itEndCase = std::find_if(itCase + 1, itEndEq, [&](const FileRef& fr) { return fr.keys->normalForm != itCase->keys->normalForm; });
                 if (!tryMatchRange(itCase, itEndCase))
                 {
                     const Zstringc& conflictMsg = getConflictAmbiguousItemName(itCase->ref->first);
@@ -844,11 +1025,14 @@ void matchFolders(const MapType& mapLeft, const MapType& mapRight, ProcessLeftOn
 }
 
 
-void MergeSides::mergeFolders(const FolderContainer& lhs, const FolderContainer& rhs, const Zstringc* errorMsg, ContainerObject& output)
+size_t dbgPeak = 0;
+void dbgSample() { dbgPeak = std::max(dbgPeak, ::mallinfo2().uordblks); }
+void MergeSides::mergeFolders(FolderContainer& lhs, FolderContainer& rhs, const Zstringc* errorMsg, ContainerObject& output)
 {
+    dbgSample();
     using FileData = FolderContainer::FileList::value_type;
 
-    matchFolders(lhs.files, rhs.files, [&](const FileData& fileLeft, const Zstringc* conflictMsg)
+    matchFolders(lhs.files, rhs.files, names_, [&](const FileData& fileLeft, const Zstringc* conflictMsg)
     {
         FilePair& newItem = output.addFile<SelectSide::left>(fileLeft.first, fileLeft.second);
         checkFailedRead(newItem, conflictMsg ? conflictMsg : errorMsg);
@@ -866,13 +1050,15 @@ void MergeSides::mergeFolders(const FolderContainer& lhs, const FolderContainer&
                                            fileRight.second);
         if (!checkFailedRead(newItem, errorMsg))
             undefinedFiles_.push_back(&newItem);
-        static_assert(std::is_same_v<ContainerObject::FileList, std::list<FilePair>>); //ContainerObject::addFile() must NOT invalidate references used in "undefinedFiles"!
+        static_assert(std::is_same_v<ContainerObject::FileList, std::pmr::list<FilePair>>); //ContainerObject::addFile() must NOT invalidate references used in "undefinedFiles"!
     });
+    releaseMerged<SelectSide::left >(lhs.files);
+    releaseMerged<SelectSide::right>(rhs.files);
 
     //-----------------------------------------------------------------------------------------------
     using SymlinkData = FolderContainer::SymlinkList::value_type;
 
-    matchFolders(lhs.symlinks, rhs.symlinks, [&](const SymlinkData& symlinkLeft, const Zstringc* conflictMsg)
+    matchFolders(lhs.symlinks, rhs.symlinks, names_, [&](const SymlinkData& symlinkLeft, const Zstringc* conflictMsg)
     {
         SymlinkPair& newItem = output.addLink<SelectSide::left>(symlinkLeft.first, symlinkLeft.second);
         checkFailedRead(newItem, conflictMsg ? conflictMsg : errorMsg);
@@ -891,28 +1077,32 @@ void MergeSides::mergeFolders(const FolderContainer& lhs, const FolderContainer&
         if (!checkFailedRead(newItem, errorMsg))
             undefinedSymlinks_.push_back(&newItem);
     });
+    releaseMerged<SelectSide::left >(lhs.symlinks);
+    releaseMerged<SelectSide::right>(rhs.symlinks);
 
     //-----------------------------------------------------------------------------------------------
     using FolderData = FolderContainer::FolderList::value_type;
 
-    matchFolders(lhs.folders, rhs.folders, [&](const FolderData& dirLeft, const Zstringc* conflictMsg)
+    matchFolders(lhs.folders, rhs.folders, names_, [&](FolderData& dirLeft, const Zstringc* conflictMsg)
     {
         FolderPair& newFolder = output.addFolder<SelectSide::left>(dirLeft.first, dirLeft.second.first);
         const Zstringc* errorMsgNew = checkFailedRead(newFolder, conflictMsg ? conflictMsg : errorMsg);
         this->fillOneSide<SelectSide::left>(dirLeft.second.second, errorMsgNew, newFolder); //recurse
     },
-    [&](const FolderData& dirRight, const Zstringc* conflictMsg)
+    [&](FolderData& dirRight, const Zstringc* conflictMsg)
     {
         FolderPair& newFolder = output.addFolder<SelectSide::right>(dirRight.first, dirRight.second.first);
         const Zstringc* errorMsgNew = checkFailedRead(newFolder, conflictMsg ? conflictMsg : errorMsg);
         this->fillOneSide<SelectSide::right>(dirRight.second.second, errorMsgNew, newFolder); //recurse
     },
-    [&](const FolderData& dirLeft, const FolderData& dirRight)
+    [&](FolderData& dirLeft, FolderData& dirRight)
     {
         FolderPair& newFolder = output.addFolder(dirLeft.first, dirLeft.second.first, dirRight.first, dirRight.second.first);
         const Zstringc* errorMsgNew = checkFailedRead(newFolder, errorMsg);
         mergeFolders(dirLeft.second.second, dirRight.second.second, errorMsgNew, newFolder); //recurse
     });
+    releaseMerged<SelectSide::left >(lhs.folders);
+    releaseMerged<SelectSide::right>(rhs.folders);
 }
 
 //-----------------------------------------------------------------------------------------------
@@ -926,7 +1116,7 @@ void stripExcludedDirectories(ContainerObject& conObj, const PathFilter& filter)
     /*  remove superfluous directories:
             this does not invalidate "std::vector<FilePair*>& undefinedFiles", since we delete folders only
             and there is no side-effect for memory positions of FilePair and SymlinkPair thanks to std::list!     */
-    static_assert(std::is_same_v<std::list<FolderPair>, ContainerObject::FolderList>);
+    static_assert(std::is_same_v<std::pmr::list<FolderPair>, ContainerObject::FolderList>);
 
     conObj.refSubFolders().remove_if([&](FolderPair& folder)
     {
@@ -947,7 +1137,7 @@ void stripExcludedDirectories(ContainerObject& conObj, const PathFilter& filter)
 SharedRef<BaseFolderPair> ComparisonBuffer::performComparison(const ResolvedFolderPair& fp,
                                                               const FolderPairCfg& fpCfg,
                                                               std::vector<FilePair*>& undefinedFiles,
-                                                              std::vector<SymlinkPair*>& undefinedSymlinks) const
+                                                              std::vector<SymlinkPair*>& undefinedSymlinks)
 {
     cb_.updateStatus(_("Generating file list...")); //throw X
     cb_.requestUiUpdate(true /*force*/); //throw X
@@ -958,11 +1148,15 @@ SharedRef<BaseFolderPair> ComparisonBuffer::performComparison(const ResolvedFold
 
     std::unordered_map<Zstring, Zstringc> failedReadsL; //base-relative paths or empty if read-error for whole base directory
     std::unordered_map<Zstring, Zstringc> failedReadsR; //
-    const FolderContainer* folderContL = nullptr;
-    const FolderContainer* folderContR = nullptr;
+    FolderContainer* folderContL = nullptr;
+    FolderContainer* folderContR = nullptr;
+    bool releaseL = false; //last folder pair using the traversal buffer => MergeSides may free it while merging
+    bool releaseR = false; //
 
 
-    const FolderContainer empty;
+    FolderContainer empty;
+    std::vector<DirectoryKey> mergedFolderKeys;
+
     if (folderStatusL == BaseFolderStatus::failure ||
         folderStatusR == BaseFolderStatus::failure)
     {
@@ -977,12 +1171,12 @@ SharedRef<BaseFolderPair> ComparisonBuffer::performComparison(const ResolvedFold
     }
     else
     {
-        auto evalBuffer = [&](const AbstractPath& folderPath, const FolderContainer*& folderCont, std::unordered_map<Zstring, Zstringc>& failedReads)
+        auto evalBuffer = [&](const AbstractPath& folderPath, FolderContainer*& folderCont, bool& releaseCont, std::unordered_map<Zstring, Zstringc>& failedReads)
         {
             auto it = folderBuffer_.find({folderPath, fpCfg.filter.nameFilter, fpCfg.handleSymlinks});
             if (it != folderBuffer_.end())
             {
-                const DirectoryValue& dirVal = it->second;
+                DirectoryValue& dirVal = it->second;
 
                 //mix failedFolderReads with failedItemReads:
                 //associate folder traversing errors with folder (instead of child items only) to show on GUI! See "MergeSides"
@@ -992,6 +1186,10 @@ SharedRef<BaseFolderPair> ComparisonBuffer::performComparison(const ResolvedFold
 
                 assert(getBaseFolderStatus(folderPath) == BaseFolderStatus::existing);
                 folderCont = &dirVal.folderCont;
+                mergedFolderKeys.push_back(it->first);
+
+                auto itRefs = folderBufferRefs_.find(it->first);
+                releaseCont = itRefs != folderBufferRefs_.end() && itRefs->second == 1; //left == right folder: 2 refs => keep
             }
             else
             {
@@ -999,8 +1197,8 @@ SharedRef<BaseFolderPair> ComparisonBuffer::performComparison(const ResolvedFold
                 folderCont = &empty;
             }
         };
-        evalBuffer(fp.folderPathLeft,  folderContL, failedReadsL);
-        evalBuffer(fp.folderPathRight, folderContR, failedReadsR);
+        evalBuffer(fp.folderPathLeft,  folderContL, releaseL, failedReadsL);
+        evalBuffer(fp.folderPathRight, folderContR, releaseR, failedReadsR);
     }
 
 
@@ -1030,12 +1228,21 @@ SharedRef<BaseFolderPair> ComparisonBuffer::performComparison(const ResolvedFold
                                                                      fpCfg.filter.nameFilter.ref().copyFilterAddingExclusion(excludeFilterFailedRead),
                                                                      fpCfg.compareVar,
                                                                      fileTimeTolerance_,
-                                                                     fpCfg.ignoreTimeShiftMinutes);
+                                                                     fpCfg.ignoreTimeShiftMinutes,
+                                                                     detectMovesByContent_);
     //PERF_START;
-    MergeSides::execute(*folderContL, *folderContR, failedReadsL, failedReadsR,
-                        output.ref(), undefinedFiles, undefinedSymlinks);
+    if (getenv("NOREL")) releaseL = releaseR = false;
+    dbgPeak = 0; dbgSample(); const size_t dbgStart = dbgPeak;
+    MergeSides::execute(*folderContL, releaseL, *folderContR, releaseR, failedReadsL, failedReadsR,
+                        output.ref(), undefinedFiles, undefinedSymlinks, names_);
     //PERF_STOP;
 
+    //traversal results are copied into "output" => free memory *before* merging the next folder pair
+    dbgSample();
+    for (const DirectoryKey& folderKey : mergedFolderKeys)
+        releaseFolderBuffer(folderKey);
+    fprintf(stderr, "MERGE heap start %zu peak %zu after %zu\n", dbgStart, dbgPeak, ::mallinfo2().uordblks);
+
     //##################### in/exclude rows according to filtering #####################
     //NOTE: we need to finish de-activating rows BEFORE binary comparison is run so that it can skip them!
 
@@ -1049,11 +1256,25 @@ SharedRef<BaseFolderPair> ComparisonBuffer::performComparison(const ResolvedFold
     //##################################################################################
     return output;
 }
+
+
+void ComparisonBuffer::releaseFolderBuffer(const DirectoryKey& folderKey)
+{
+    auto it = folderBufferRefs_.find(folderKey);
+    assert(it != folderBufferRefs_.end() && it->second > 0);
+    if (it != folderBufferRefs_.end())
+        if (--(it->second) == 0)
+        {
+            folderBuffer_.erase(folderKey);
+            folderBufferRefs_.erase(it);
+        }
+}
 }
 
 
 FolderComparison fff::compare(WarningDialogs& warnings,
                               int fileTimeTolerance,
+                              bool detectMovesByContent,
                               const AFS::RequestPasswordFun& requestPassword /*throw X*/,
                               bool runWithBackgroundPriority,
                               bool createDirLocks,
@@ -1061,6 +1282,8 @@ FolderComparison fff::compare(WarningDialogs& warnings,
                               const std::vector<FolderPairCfg>& fpCfgList,
                               ProcessCallback& callback /*throw X*/) //throw X
 {
+    TraceSpan span("compare");
+
     //indicator at the very beginning of the log to make sense of "total time"
     //init process: keep at beginning so that all gui elements are initialized properly
     callback.initNewPhase(-1, -1, ProcessPhase::scan); //throw X; it's unknown how many files will be scanned => -1 objects
@@ -1158,14 +1381,16 @@ FolderComparison fff::compare(WarningDialogs& warnings,
     try
     {
         FolderComparison output;
+        std::unordered_map<const BaseFolderPair*, SharedRef<const InSyncFolder>> lastSyncStates; //loaded during "compare by content" already
         //reduce peak memory by restricting lifetime of ComparisonBuffer to have ended when loading potentially huge InSyncFolder instance in redetermineSyncDirection()
         {
             //------------------- fill directory buffer: traverse/read folders --------------------------
             ComparisonBuffer cmpBuf(resInfo.baseFolderStatus,
-                                    fileTimeTolerance, callback);
+                                    fileTimeTolerance, detectMovesByContent, callback);
             //PERF_START;
             output = cmpBuf.execute(workLoad);
             //PERF_STOP;
+            lastSyncStates = cmpBuf.takeLastSyncStates();
         }
         assert(output.size() == fpCfgList.size());
 
@@ -1174,7 +1399,7 @@ FolderComparison fff::compare(WarningDialogs& warnings,
         for (auto it = output.begin(); it != output.end(); ++it)
             directCfgs.emplace_back(&it->ref(), fpCfgList[it - output.begin()].directionCfg);
 
-        redetermineSyncDirection(directCfgs,
+        redetermineSyncDirection(directCfgs, std::move(lastSyncStates),
                                  callback); //throw X
 
         return output;
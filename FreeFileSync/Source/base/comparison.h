@@ -49,6 +49,7 @@ std::vector<FolderPairCfg> extractCompareCfg(const MainConfiguration& mainCfg);
 //FFS core routine:     output.size() == fpCfgList.size() or 0 on fatal error
 FolderComparison compare(WarningDialogs& warnings,
                          int fileTimeTolerance,
+                         bool detectMovesByContent, //devices without file IDs: confirm move candidates by content
                          const AFS::RequestPasswordFun& requestPassword /*throw X*/,
                          bool runWithBackgroundPriority,
                          bool createDirLocks,
@@ -10,6 +10,7 @@
 #include <zen/crc.h>
 #include <zen/build_info.h>
 #include <zen/zlib_wrap.h>
+#include <zen/trace.h>
 #include "../afs/concrete.h"
 #include "../afs/native.h"
 #include "status_handler_impl.h"
@@ -24,7 +25,7 @@ namespace
 //-------------------------------------------------------------------------------------------------------------------------------
 const char DB_FILE_DESCR[] = "FreeFileSync";
 const int DB_FILE_VERSION   = 11; //2020-02-07
-const int DB_STREAM_VERSION =  5; //2023-07-29
+const int DB_STREAM_VERSION =  6; //2026-10-18
 //-------------------------------------------------------------------------------------------------------------------------------
 
 struct SessionData
@@ -278,6 +279,8 @@ private:
 
             writeFileDescr(inSyncData.left);
             writeFileDescr(inSyncData.right);
+
+            writeContainer(streamOutBigNum_, inSyncData.contentHash); //empty if not available
         }
 
         writeNumber<uint32_t>(streamOutSmallNum_, static_cast<uint32_t>(container.symlinks.size()));
@@ -330,7 +333,8 @@ public:
                                            const std::string& streamL,
                                            const std::string& streamR,
                                            const std::wstring& displayFilePathL, //for diagnostics only
-                                           const std::wstring& displayFilePathR)
+                                           const std::wstring& displayFilePathR,
+                                           NamePool& names)
     {
         try
         {
@@ -376,6 +380,7 @@ public:
             }
             else if (streamVersion == 3 || //TODO: remove migration code at some time! 2021-02-14
                      streamVersion == 4 || //TODO: remove migration code at some time! 2023-07-29
+                     streamVersion == 5 || //TODO: remove migration code at some time! 2026-10-18
                      streamVersion == DB_STREAM_VERSION)
             {
                 MemoryStreamIn& streamInPart1 = leadStreamLeft ? streamInL : streamInR;
@@ -397,7 +402,8 @@ public:
                 StreamParser parser(streamVersion,
                                     decompress(bufText),     //
                                     decompress(bufSmallNum), //throw SysError
-                                    decompress(bufBigNum));  //
+                                    decompress(bufBigNum),   //
+                                    names);
                 if (leadStreamLeft)
                     parser.recurse<SelectSide::left>(output.ref()); //throw SysError
                 else
@@ -417,11 +423,13 @@ private:
     StreamParser(int streamVersion,
                  std::string&& bufText,
                  std::string&& bufSmallNumbers,
-                 std::string&& bufBigNumbers) :
+                 std::string&& bufBigNumbers,
+                 NamePool& names) :
         streamVersion_(streamVersion),
         bufText_        (std::move(bufText)),
         bufSmallNumbers_(std::move(bufSmallNumbers)),
-        bufBigNumbers_  (std::move(bufBigNumbers)) {}
+        bufBigNumbers_  (std::move(bufBigNumbers)),
+        names_(names) {}
 
     template <SelectSide leadSide>
     void recurse(InSyncFolder& container) //throw SysError
@@ -436,9 +444,13 @@ private:
             const InSyncDescrFile descrL = readFileDescr(); //throw SysErrorUnexpectedEos
             const InSyncDescrFile descrT = readFileDescr(); //
 
+            Zstringc contentHash;
+            if (streamVersion_ >= 6) //TODO: remove condition after migration! 2026-10-18
+                contentHash = readContainer<Zstringc>(streamInBigNum_); //throw SysErrorUnexpectedEos
+
             container.addFile(itemName,
                               selectParam<leadSide>(descrL, descrT),
-                              selectParam<leadSide>(descrT, descrL), cmpVar, fileSize);
+                              selectParam<leadSide>(descrT, descrL), cmpVar, fileSize, contentHash);
         }
 
         size_t linkCount = readNumber<uint32_t>(streamInSmallNum_);
@@ -468,7 +480,7 @@ private:
         }
     }
 
-    Zstring readItemName() { return utfTo<Zstring>(readContainer<std::string>(streamInText_)); } //throw SysErrorUnexpectedEos
+    Zstring readItemName() { return names_.intern(utfTo<Zstring>(readContainer<std::string>(streamInText_))); } //throw SysErrorUnexpectedEos
 
     InSyncDescrFile readFileDescr() //throw SysErrorUnexpectedEos
     {
@@ -515,7 +527,7 @@ private:
                 /*const auto fileIdL =*/ readContainer<std::string>(inputLeft_);
                 const auto modTimeR = static_cast<time_t>(readNumber<int64_t>(inputRight_));
                 /*const auto fileIdR =*/ readContainer<std::string>(inputRight_);
-                container.addFile(itemName, InSyncDescrFile{modTimeL, AFS::FingerPrint()}, InSyncDescrFile{modTimeR, AFS::FingerPrint()}, cmpVar, fileSize);
+                container.addFile(itemName, InSyncDescrFile{modTimeL, AFS::FingerPrint()}, InSyncDescrFile{modTimeR, AFS::FingerPrint()}, cmpVar, fileSize, Zstringc());
             }
 
             size_t linkCount = readNumber<uint32_t>(inputBoth_);
@@ -555,6 +567,8 @@ private:
     MemoryStreamIn streamInText_    {bufText_};         //
     MemoryStreamIn streamInSmallNum_{bufSmallNumbers_}; //data with bias to lead side
     MemoryStreamIn streamInBigNum_  {bufBigNumbers_};   //
+
+    NamePool& names_; //same names recur in many folders: "src", "index.html", ...
 };
 
 //#######################################################################################################################################
@@ -606,6 +620,7 @@ private:
                         .right    = InSyncDescrFile{file.getLastWriteTime<SelectSide::right>(), file.getFilePrint<SelectSide::right>()},
                         .cmpVar   = activeCmpVar_,
                         .fileSize = file.getFileSize<SelectSide::left>(),
+                        .contentHash = activeCmpVar_ == CompareVariant::content ? file.getContentHash() : Zstringc(),
                     }
                                             );
                     toPreserve.insert(fileName);
@@ -796,8 +811,12 @@ std::pair<DbStreams::const_iterator,
 //#######################################################################################################################################
 
 std::unordered_map<const BaseFolderPair*, SharedRef<const InSyncFolder>> fff::loadLastSynchronousState(const std::vector<const BaseFolderPair*>& baseFolders,
+                                                                      NamePool& names,
                                                                       PhaseCallback& callback /*throw X*/) //throw X
 {
+    TraceSpan span("loadLastSynchronousState");
+    span.addItems(baseFolders.size());
+
     std::set<AbstractPath> dbFilePaths;
 
     for (const BaseFolderPair* baseFolder : baseFolders)
@@ -822,6 +841,10 @@ std::unordered_map<const BaseFolderPair*, SharedRef<const InSyncFolder>> fff::lo
             tryReportingError([&] //throw ThreadStopRequest
             {
                 StreamStatusNotifier notifyLoad(replaceCpy(_("Loading file %x..."), L"%x", fmtPath(AFS::getDisplayPath(ctx.itemPath))), ctx.acb);
+
+                TraceSpan spanFile("loadStreams");
+                if (spanFile)
+                    spanFile.setDevice(utfTo<std::string>(AFS::getDisplayPath(ctx.itemPath)));
                 try
                 {
                     DbStreams dbStreams = ::loadStreams(ctx.itemPath, notifyLoad); //throw FileError, FileErrorDatabaseNotExisting, FileErrorDatabaseCorrupted, ThreadStopRequest
@@ -867,7 +890,7 @@ std::unordered_map<const BaseFolderPair*, SharedRef<const InSyncFolder>> fff::lo
                                                                                       itStreamL->second.rawStream,
                                                                                       itStreamR->second.rawStream,
                                                                                       AFS::getDisplayPath(dbPathL),
-                                                                                      AFS::getDisplayPath(dbPathR)); //throw FileError
+                                                                                      AFS::getDisplayPath(dbPathR), names); //throw FileError
                         output.emplace(baseFolder, lastSyncState);
                     }
                 }
@@ -881,6 +904,8 @@ std::unordered_map<const BaseFolderPair*, SharedRef<const InSyncFolder>> fff::lo
 void fff::saveLastSynchronousState(const BaseFolderPair& baseFolder, bool transactionalCopy,
                                    PhaseCallback& callback /*throw X*/) //throw X
 {
+    TraceSpan span("saveLastSynchronousState");
+
     const AbstractPath dbPathL = getDatabaseFilePath<SelectSide::left >(baseFolder);
     const AbstractPath dbPathR = getDatabaseFilePath<SelectSide::right>(baseFolder);
 
@@ -926,6 +951,7 @@ void fff::saveLastSynchronousState(const BaseFolderPair& baseFolder, bool transa
     auto itStreamOldL = streamsL.cend();
     auto itStreamOldR = streamsR.cend();
     InSyncFolder lastSyncState;
+    NamePool names;
     try
     {
         //find associated session: there can be at most one session within intersection of left and right IDs
@@ -937,7 +963,7 @@ void fff::saveLastSynchronousState(const BaseFolderPair& baseFolder, bool transa
                                                             itStreamOldL->second.rawStream,
                                                             itStreamOldR->second.rawStream,
                                                             AFS::getDisplayPath(dbPathL),
-                                                            AFS::getDisplayPath(dbPathR)).ref()); //throw FileError
+                                                            AFS::getDisplayPath(dbPathR), names).ref()); //throw FileError
     }
     catch (const FileError& e) { callback.reportFatalError(e.toString()); } //throw X
     //if database files are corrupted: just overwrite! User is already informed about errors right after comparing!
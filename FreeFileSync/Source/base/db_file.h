@@ -11,6 +11,7 @@
 #include <zen/file_error.h>
 #include "file_hierarchy.h"
 #include "process_callback.h"
+#include "name_pool.h"
 
 
 namespace fff
@@ -36,6 +37,7 @@ struct InSyncFile
     InSyncDescrFile right; //
     CompareVariant cmpVar = CompareVariant::timeSize; //the one active while finding "file in sync"
     uint64_t fileSize = 0; //file size must be identical on both sides!
+    Zstringc contentHash; //optional: SHA-256 of file content (identical on both sides) if cmpVar == CompareVariant::content
 };
 
 struct InSyncSymlink
@@ -65,9 +67,9 @@ struct InSyncFolder
         return it->second;
     }
 
-    void addFile(const Zstring& fileName, const InSyncDescrFile& descrL, const InSyncDescrFile& descrR, CompareVariant cmpVar, uint64_t fileSize)
+    void addFile(const Zstring& fileName, const InSyncDescrFile& descrL, const InSyncDescrFile& descrR, CompareVariant cmpVar, uint64_t fileSize, const Zstringc& contentHash)
     {
-            files.emplace(fileName, InSyncFile {descrL, descrR, cmpVar, fileSize});
+            files.emplace(fileName, InSyncFile {descrL, descrR, cmpVar, fileSize, contentHash});
         assert(inserted);
     }
 
@@ -80,6 +82,7 @@ struct InSyncFolder
 
 
 std::unordered_map<const BaseFolderPair*, zen::SharedRef<const InSyncFolder>> loadLastSynchronousState(const std::vector<const BaseFolderPair*>& baseFolders,
+                                                                           NamePool& names, //item names are interned
                                                                            PhaseCallback& callback /*throw X*/); //throw X
 
 void saveLastSynchronousState(const BaseFolderPair& baseFolder, bool transactionalCopy, //throw X
@@ -57,7 +57,17 @@ std::wstring fff::getShortDisplayNameForFolderPair(const AbstractPath& itemPathL
 
 void ContainerObject::removeDoubleEmpty()
 {
-    auto isEmpty = [](const FileSystemObject& fsObj) { return fsObj.isPairEmpty(); };
+    auto isEmpty = [](FileSystemObject& fsObj)
+    {
+        if (!fsObj.isPairEmpty())
+            return false;
+
+        //views may still show the item (or its sub-items) => log removal
+        visitFSObjectRecursively(fsObj, [](FolderPair&   folder) { folder .notifyBeforeChange(); },
+                                        [](FilePair&     file  ) { file   .notifyBeforeChange(); },
+                                        [](SymlinkPair& symlink) { symlink.notifyBeforeChange(); });
+        return true;
+    };
 
     refSubFiles  ().remove_if(isEmpty);
     refSubLinks  ().remove_if(isEmpty);
@@ -68,6 +78,124 @@ void ContainerObject::removeDoubleEmpty()
 }
 
 
+FsObjectState fff::getObjectState(const FileSystemObject& fsObj)
+{
+    FsObjectState state
+    {
+        .objId  = fsObj.getId(),
+        .base   = &fsObj.base(),
+        .active = fsObj.isActive(),
+        .emptyL = fsObj.isEmpty<SelectSide::left >(),
+        .emptyR = fsObj.isEmpty<SelectSide::right>(),
+        .category = fsObj.getCategory(),
+        .syncOp   = fsObj.getSyncOperation(),
+    };
+    if (auto parentFolder = dynamic_cast<const FolderPair*>(&fsObj.parent()))
+        state.parentId = parentFolder->getId();
+
+    visitFSObject(fsObj, [&](const FolderPair& folder) { state.itemType = FsObjectState::ItemType::folder; },
+    [&](const FilePair& file)
+    {
+        state.itemType = FsObjectState::ItemType::file;
+        if (!state.emptyL) state.fileSizeL = file.getFileSize<SelectSide::left >();
+        if (!state.emptyR) state.fileSizeR = file.getFileSize<SelectSide::right>();
+    },
+    [&](const SymlinkPair& symlink) { state.itemType = FsObjectState::ItemType::symlink; });
+    return state;
+}
+
+
+void FileSystemObject::recordChange()
+{
+    BaseFolderPair& baseFolder = base();
+    assert(baseFolder.trackChanges_);
+
+    //the log is supposed to be small: manual operations, synchronization of a few items
+    //=> more changes are cheaper to handle via full view update
+    constexpr size_t CHANGE_LOG_MAX = 10'000;
+
+    auto recordWithParents = [&](FileSystemObject* fsObj)
+    {
+        for (; fsObj; fsObj = dynamic_cast<FolderPair*>(&fsObj->parent()))
+        {
+            if (fsObj->changeLogGen_ == baseFolder.changeLogGen_)
+                return; //=> parent folders already recorded, too
+            fsObj->changeLogGen_ = baseFolder.changeLogGen_;
+
+            if (baseFolder.changeLog_.size() >= CHANGE_LOG_MAX)
+            {
+                baseFolder.trackChanges_ = false;
+                baseFolder.changeLog_.clear();
+                return;
+            }
+            baseFolder.changeLog_.push_back(getObjectState(*fsObj));
+        }
+    };
+    recordWithParents(this);
+
+    //sync operation of a "move" pair depends on both ends:
+    if (auto file = dynamic_cast<const FilePair*>(this))
+        if (file->getMoveRef() && baseFolder.trackChanges_)
+            recordWithParents(FileSystemObject::retrieve(file->getMoveRef()));
+}
+
+
+bool BaseFolderPair::takeChanges(std::vector<FsObjectState>& changes)
+{
+    const bool changeLogComplete = trackChanges_;
+
+    if (changeLogComplete)
+        append(changes, changeLog_);
+
+    changeLog_.clear();
+    if (++changeLogGen_ == 0) //wrap-around: stale FileSystemObject::changeLogGen_ could become valid again
+    {
+        auto resetGen = [](FileSystemObject& fsObj) { fsObj.changeLogGen_ = 0; };
+        visitFSObjectRecursively(*this, resetGen, resetGen, resetGen);
+        changeLogGen_ = 1;
+    }
+    trackChanges_ = true;
+    return changeLogComplete;
+}
+
+
+void BaseFolderPair::setActiveAll(bool active)
+{
+    //dense array update instead of per-item change log + parent notification
+    trackChanges_ = false; //full view update
+    changeLog_.clear();
+
+    hotFields_.setActiveAll(active);
+
+    resetSyncOpBuffersRecursion(*this); //folder sync operations depend on child items
+}
+
+
+void BaseFolderPair::resetSyncOpBuffersRecursion(ContainerObject& conObj)
+{
+    for (FolderPair& folder : conObj.refSubFolders())
+    {
+        folder.syncOpBuffered_ = {};
+        resetSyncOpBuffersRecursion(folder);
+    }
+}
+
+
+HierarchyChanges fff::takeChanges(FolderComparison& folderCmp)
+{
+    HierarchyChanges changes;
+    std::for_each(begin(folderCmp), end(folderCmp), [&](BaseFolderPair& baseFolder)
+    {
+        if (!baseFolder.takeChanges(changes.items))
+            changes.fullUpdate = true;
+    });
+
+    if (changes.fullUpdate)
+        changes.items.clear();
+    return changes;
+}
+
+
 namespace
 {
 SyncOperation getIsolatedSyncOperation(const FileSystemObject& fsObj,
@@ -253,7 +381,8 @@ SyncOperation FileSystemObject::testSyncOperation(SyncDirection testSyncDir) con
 
 SyncOperation FileSystemObject::getSyncOperation() const
 {
-    return getIsolatedSyncOperation(*this, selectedForSync_, syncDir_, !syncDirectionConflict_.empty());
+    const ItemHotFields& hotFields = base().hotFields_;
+    return getIsolatedSyncOperation(*this, hotFields.isActive(hotIndex_), hotFields.getSyncDir(hotIndex_), !syncDirectionConflict_.empty());
     //do *not* make a virtual call to testSyncOperation()! See FilePair::testSyncOperation()! <- better not implement one in terms of the other!!!
 }
 
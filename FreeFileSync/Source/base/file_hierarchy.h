@@ -10,6 +10,10 @@
 #include <string>
 #include <memory>
 #include <list>
+#include <map>
+#include <memory_resource>
+#include <bit>
+#include <atomic>
 #include <functional>
 #include <unordered_set>
 #include <unordered_map>
@@ -155,6 +159,71 @@ class FilePair;
 class FolderPair;
 class BaseFolderPair;
 
+
+template <class T> class ObjectMgr;
+
+//weak reference to an ObjectMgr instance: slot index + generation => O(1) validation without hashing
+template <class T, bool isConst>
+class ObjectHandle
+{
+public:
+    ObjectHandle() {}
+    ObjectHandle(std::nullptr_t) {}
+    template <bool isConstOther> requires (isConst && !isConstOther) //ObjectId => ObjectIdConst
+    ObjectHandle(const ObjectHandle<T, isConstOther>& other) : index_(other.index_), generation_(other.generation_) {}
+
+    explicit operator bool() const { return generation_ != 0; }
+
+    bool operator==(const ObjectHandle&) const = default;
+    std::strong_ordering operator<=>(const ObjectHandle&) const = default;
+
+    uint32_t getSlotIndex() const { return index_; } //dense => suitable as index into flat lookup tables; reused after object destruction!
+
+private:
+    ObjectHandle(uint32_t index, uint32_t generation) : index_(index), generation_(generation) {}
+
+    friend class ObjectMgr<T>;
+    friend class ObjectHandle<T, !isConst>;
+    friend struct std::hash<ObjectHandle>;
+
+    uint32_t index_      = 0;
+    uint32_t generation_ = 0; //0 <=> nullptr
+};
+
+
+//snapshot of everything the grid views evaluate for a FileSystemObject: see takeChanges()
+struct FsObjectState
+{
+    enum class ItemType
+    {
+        file,
+        symlink,
+        folder,
+    };
+
+    ObjectHandle<FileSystemObject, true> objId;
+    ObjectHandle<FileSystemObject, true> parentId; //nullptr if parent is BaseFolderPair
+    const BaseFolderPair* base = nullptr; //weak pointer: *never dereference*!
+
+    ItemType itemType = ItemType::file;
+    bool active = true;
+    bool emptyL = true;
+    bool emptyR = true;
+    CompareFileResult category = FILE_EQUAL;
+    SyncOperation syncOp = SO_EQUAL;
+    uint64_t fileSizeL = 0; //files only
+    uint64_t fileSizeR = 0; //
+
+    //same interface as FileSystemObject => allow generic view filters
+    bool isActive() const { return active; }
+    CompareFileResult getCategory() const { return category; }
+    SyncOperation getSyncOperation() const { return syncOp; }
+    template <SelectSide side> bool isEmpty() const { return selectParam<side>(emptyL, emptyR); }
+    template <SelectSide side> uint64_t getFileSize() const { return selectParam<side>(fileSizeL, fileSizeR); }
+};
+
+FsObjectState getObjectState(const FileSystemObject& fsObj);
+
 /*------------------------------------------------------------------
     inheritance diagram:
 
@@ -198,9 +267,9 @@ class ContainerObject : public virtual PathInformation
     friend class FileSystemObject; //access to updateRelPathsRecursion()
 
 public:
-    using FileList    = std::list<FilePair>;    //MergeSides::execute() requires a structure that doesn't invalidate pointers after push_back()
-    using SymlinkList = std::list<SymlinkPair>; //
-    using FolderList  = std::list<FolderPair>;
+    using FileList    = std::pmr::list<FilePair>;    //MergeSides::execute() requires a structure that doesn't invalidate pointers after push_back()
+    using SymlinkList = std::pmr::list<SymlinkPair>; //
+    using FolderList  = std::pmr::list<FolderPair>;  //nodes are allocated from the BaseFolderPair's arena: see BaseFolderArena
 
     FolderPair& addFolder(const Zstring&          itemNameL, //file exists on both sides
                           const FolderAttributes& left,
@@ -246,7 +315,10 @@ public:
     virtual void flip();
 
 protected:
-    explicit ContainerObject(BaseFolderPair& baseFolder) : //used during BaseFolderPair constructor
+    ContainerObject(BaseFolderPair& baseFolder, std::pmr::memory_resource& arena) : //used during BaseFolderPair constructor
+        subFiles_  (&arena),
+        subLinks_  (&arena),
+        subFolders_(&arena),
         base_(baseFolder) //take reference only: baseFolder *not yet* fully constructed at this point!
     { assert(relPathL_.c_str() == relPathR_.c_str()); } //expected by the following contructor!
 
@@ -284,7 +356,66 @@ enum class BaseFolderStatus
     failure,
 };
 
-class BaseFolderPair : public ContainerObject
+//hot fields of all items of a BaseFolderPair in dense arrays (indexed by FileSystemObject::hotIndex_)
+//=> bulk passes over the whole hierarchy (e.g. setActiveAll()) don't touch the scattered objects
+class ItemHotFields
+{
+public:
+    uint32_t insert()
+    {
+        if (!freeIndexes_.empty())
+        {
+            const uint32_t index = freeIndexes_.back();
+            freeIndexes_.pop_back();
+            active_[index] = true;
+            syncDir_        [index] = SyncDirection::none;
+            contentCategory_[index] = FileContentCategory::unknown;
+            return index;
+        }
+        if (syncDir_.size() >= std::numeric_limits<uint32_t>::max())
+            throw std::bad_alloc();
+
+        active_.push_back(true);
+        syncDir_        .push_back(SyncDirection::none);
+        contentCategory_.push_back(FileContentCategory::unknown);
+        return static_cast<uint32_t>(syncDir_.size() - 1);
+    }
+
+    void erase(uint32_t index) { freeIndexes_.push_back(index); }
+
+    bool isActive(uint32_t index) const { return active_[index]; }
+    void setActive(uint32_t index, bool active) { active_[index] = active; }
+    void setActiveAll(bool active) { active_.assign(active_.size(), active); } //includes free slots: reset by insert() anyway
+
+    SyncDirection getSyncDir(uint32_t index) const { return syncDir_[index]; }
+    void setSyncDir(uint32_t index, SyncDirection syncDir) { syncDir_[index] = syncDir; }
+
+    FileContentCategory getContentCategory(uint32_t index) const { return contentCategory_[index]; } //files and symlinks only
+    void setContentCategory(uint32_t index, FileContentCategory category) { contentCategory_[index] = category; }
+
+    size_t getMemoryUsage() const { return active_.capacity() / 8 + syncDir_.capacity() + contentCategory_.capacity() + freeIndexes_.capacity() * sizeof(uint32_t); }
+
+private:
+    //not thread-safe (including std::vector<bool> bit-packing): same as BaseFolderArena; synchronization workers modify the hierarchy under "singleThread" lock only
+    std::vector<bool> active_;
+    std::vector<SyncDirection> syncDir_;
+    std::vector<FileContentCategory> contentCategory_;
+    std::vector<uint32_t> freeIndexes_;
+};
+
+
+//one heap allocation per FilePair/FolderPair/SymlinkPair is expensive for huge folder hierarchies: malloc overhead + fragmentation
+//=> allocate from a per-BaseFolderPair pool instead; released as a whole together with the BaseFolderPair
+//=> must be a base class *preceding* ContainerObject: the arena (and the hot fields) have to outlive all the pmr::list members!
+class BaseFolderArena
+{
+protected:
+    std::pmr::unsynchronized_pool_resource arena_; //not thread-safe: the hierarchy of a single BaseFolderPair is built by one thread at a time
+    ItemHotFields hotFields_;
+};
+
+
+class BaseFolderPair : private BaseFolderArena, public ContainerObject
 {
 public:
     BaseFolderPair(const AbstractPath& folderPathLeft,
@@ -294,9 +425,11 @@ public:
                    const FilterRef& filter,
                    CompareVariant cmpVar,
                    int fileTimeTolerance,
-                   const std::vector<unsigned int>& ignoreTimeShiftMinutes) :
-        ContainerObject(*this), //trust that ContainerObject knows that *this is not yet fully constructed!
+                   const std::vector<unsigned int>& ignoreTimeShiftMinutes,
+                   bool detectMovesByContent) :
+        ContainerObject(*this, arena_), //trust that ContainerObject knows that *this is not yet fully constructed!
         filter_(filter), cmpVar_(cmpVar), fileTimeTolerance_(fileTimeTolerance), ignoreTimeShiftMinutes_(ignoreTimeShiftMinutes),
+        detectMovesByContent_(detectMovesByContent),
         folderStatusLeft_ (folderStatusLeft),
         folderStatusRight_(folderStatusRight),
         folderPathLeft_(folderPathLeft),
@@ -310,23 +443,52 @@ public:
     CompareVariant getCompVariant() const { return cmpVar_; }
     int      getFileTimeTolerance() const { return fileTimeTolerance_; }
     const std::vector<unsigned int>& getIgnoredTimeShift() const { return ignoreTimeShiftMinutes_; }
+    bool  getDetectMovesByContent() const { return detectMovesByContent_; } //devices without file IDs: match moved files by (size, modTime) + content
+
+    //content check results for move candidates: read file content once per comparison, not on each redetermineSyncDirection()
+    std::optional<bool> getMoveCandidateContentCheck(ObjectHandle<FileSystemObject, true> objId1, ObjectHandle<FileSystemObject, true> objId2) const
+    {
+        if (const auto it = moveCandidateContentChecks_.find(std::minmax(objId1, objId2));
+            it != moveCandidateContentChecks_.end())
+            return it->second;
+        return {};
+    }
+    void setMoveCandidateContentCheck(ObjectHandle<FileSystemObject, true> objId1, ObjectHandle<FileSystemObject, true> objId2, bool sameContent)
+    { moveCandidateContentChecks_.insert_or_assign(std::minmax(objId1, objId2), sameContent); } //symmetric: survives flip()
 
     void flip() override;
 
+    void setActiveAll(bool active); //bulk FileSystemObject::setActive() for all items
+
+    const ItemHotFields& refHotFields() const { return hotFields_; }
+
+    //change log for incremental view updates: see fff::takeChanges()
+    bool takeChanges(std::vector<FsObjectState>& changes); //return false if change log is incomplete => full view update needed
+
 private:
+    friend class FileSystemObject; //recordChange()
+
     AbstractPath getAbstractPathL() const override { return folderPathLeft_; }
     AbstractPath getAbstractPathR() const override { return folderPathRight_; }
 
+    static void resetSyncOpBuffersRecursion(ContainerObject& conObj);
+
     const FilterRef filter_; //filter used while scanning directory: represents sub-view of actual files!
     const CompareVariant cmpVar_;
     const int fileTimeTolerance_;
     const std::vector<unsigned int> ignoreTimeShiftMinutes_;
+    const bool detectMovesByContent_;
+    std::map<std::pair<ObjectHandle<FileSystemObject, true>, ObjectHandle<FileSystemObject, true>>, bool> moveCandidateContentChecks_;
 
     BaseFolderStatus folderStatusLeft_;
     BaseFolderStatus folderStatusRight_;
 
     AbstractPath folderPathLeft_;
     AbstractPath folderPathRight_;
+
+    std::vector<FsObjectState> changeLog_; //item states *before* first modification since last takeChanges()
+    uint32_t changeLogGen_ = 1; //items already recorded: FileSystemObject::changeLogGen_ == changeLogGen_
+    bool trackChanges_ = false; //changes are only recorded after the first takeChanges() => comparison is not slowed down
 };
 
 
@@ -366,6 +528,19 @@ DerefIter<typename FolderComparison::iterator,             BaseFolderPair> inlin
 DerefIter<typename FolderComparison::const_iterator, const BaseFolderPair> inline begin(const FolderComparison& vect) { return vect.begin(); }
 DerefIter<typename FolderComparison::const_iterator, const BaseFolderPair> inline end  (const FolderComparison& vect) { return vect.end  (); }
 
+
+/*  incremental view updates: FileView/TreeView patch the rows affected by manual operations and synchronization
+    instead of re-evaluating the full FolderComparison
+    - items: state *before* the first modification since the previous call; current state: see getObjectState()
+    - items may have been deleted meanwhile: FileSystemObject::retrieve() returns nullptr
+    - includes all parent folders of modified items: a folder's sync operation depends on its child items  */
+struct HierarchyChanges
+{
+    std::vector<FsObjectState> items;
+    bool fullUpdate = false; //change log incomplete (e.g. new comparison, too many changes): views must be rebuilt
+};
+HierarchyChanges takeChanges(FolderComparison& folderCmp); //start recording next changes
+
 //------------------------------------------------------------------
 struct FSObjectVisitor
 {
@@ -382,29 +557,147 @@ template <class T>
 class ObjectMgr
 {
 public:
-    using ObjectId      =       ObjectMgr*;
-    using ObjectIdConst = const ObjectMgr*;
+    using ObjectId      = ObjectHandle<T, false>;
+    using ObjectIdConst = ObjectHandle<T, true>;
 
-    ObjectIdConst  getId() const { return this; }
-    /**/  ObjectId getId()       { return this; }
+    ObjectIdConst  getId() const { return id_; }
+    /**/  ObjectId getId()       { return id_; }
 
     static const T* retrieve(ObjectIdConst id) //returns nullptr if object is not valid anymore
     {
-        return static_cast<const T*>(activeObjects_.contains(id) ? id : nullptr);
+        return static_cast<const T*>(slots_.find(id.index_, id.generation_));
     }
     static T* retrieve(ObjectId id) { return const_cast<T*>(retrieve(static_cast<ObjectIdConst>(id))); }
 
 protected:
-    ObjectMgr () { activeObjects_.insert(this); }
-    ~ObjectMgr() { activeObjects_.erase (this); }
+    ObjectMgr () : id_(slots_.insert(this)) {} //throw std::bad_alloc
+    ~ObjectMgr() { slots_.erase(id_.index_); }
 
 private:
     ObjectMgr           (const ObjectMgr& rhs) = delete;
     ObjectMgr& operator=(const ObjectMgr& rhs) = delete; //it's not well-defined what copying an objects means regarding object-identity in this context
 
-    //our global ObjectMgr is not thread-safe (and currently does not need to be!)
-    //assert(runningOnMainThread()); -> still, may be accessed by synchronization worker threads, one thread at a time
-    static inline std::unordered_set<const ObjectMgr*> activeObjects_; //external linkage!
+    /* slot table: lock-free => objects may be created/destroyed by parallel worker threads (e.g. during comparison)
+        - slots are allocated in chunks of growing size and never move => no locking for find()
+        - freed slots are reused via a tagged Treiber stack (tag avoids ABA problem)
+        - retrieve() is *not* synchronized with concurrent destruction of the same object: same as before, that's the caller's job */
+    class SlotTable
+    {
+    public:
+        ~SlotTable() { for (std::atomic<Slot*>& chunk : chunks_) delete[] chunk.load(); }
+
+        ObjectId insert(const ObjectMgr* obj) //throw std::bad_alloc
+        {
+            uint32_t index = popFreeSlot();
+            if (index == NO_SLOT)
+            {
+                const uint64_t indexNew = nextIndex_++;
+                if (indexNew >= NO_SLOT)
+                    throw std::bad_alloc();
+                index = static_cast<uint32_t>(indexNew);
+            }
+            Slot& slot = getSlot(index); //throw std::bad_alloc
+
+            uint32_t generation = slot.generation + 1;
+            if (generation == 0) //wrap around: 0 is reserved for nullptr
+                generation = 1;
+            slot.generation = generation;
+            slot.obj = obj;
+            return {index, generation};
+        }
+
+        void erase(uint32_t index)
+        {
+            Slot& slot = *findSlot(index);
+            slot.obj = nullptr;
+            pushFreeSlot(index, slot);
+        }
+
+        const ObjectMgr* find(uint32_t index, uint32_t generation) const
+        {
+            if (generation != 0)
+                if (const Slot* slot = findSlot(index))
+                    if (slot->generation == generation)
+                        return slot->obj;
+            return nullptr;
+        }
+
+    private:
+        struct Slot
+        {
+            const ObjectMgr* obj = nullptr;
+            uint32_t generation = 0;
+            std::atomic<uint32_t> nextFree{NO_SLOT}; //read concurrently by popFreeSlot()
+        };
+
+        static constexpr uint32_t NO_SLOT = std::numeric_limits<uint32_t>::max();
+        static constexpr uint64_t CHUNK_SIZE_MIN = 1024; //chunk k holds CHUNK_SIZE_MIN * 2^k slots
+
+        static std::pair<size_t /*chunk*/, uint64_t /*offset*/> getChunkPos(uint32_t index)
+        {
+            const uint64_t n = index / CHUNK_SIZE_MIN + 1;
+            const size_t   k = std::bit_width(n) - 1;
+            return {k, index - ((uint64_t(1) << k) - 1) * CHUNK_SIZE_MIN};
+        }
+
+        Slot* findSlot(uint32_t index) const
+        {
+            const auto [k, offset] = getChunkPos(index);
+            if (Slot* chunk = chunks_[k].load(std::memory_order_acquire))
+                return chunk + offset;
+            return nullptr;
+        }
+
+        Slot& getSlot(uint32_t index) //throw std::bad_alloc
+        {
+            const auto [k, offset] = getChunkPos(index);
+            Slot* chunk = chunks_[k].load(std::memory_order_acquire);
+            if (!chunk)
+            {
+                Slot* chunkNew = new Slot[CHUNK_SIZE_MIN << k]; //throw std::bad_alloc
+                if (chunks_[k].compare_exchange_strong(chunk, chunkNew, std::memory_order_acq_rel))
+                    chunk = chunkNew;
+                else
+                    delete[] chunkNew; //lost the race: "chunk" was updated by compare_exchange_strong()
+            }
+            return chunk[offset];
+        }
+
+        uint32_t popFreeSlot()
+        {
+            uint64_t head = freeHead_.load(std::memory_order_acquire);
+            for (;;)
+            {
+                const auto index = static_cast<uint32_t>(head);
+                if (index == NO_SLOT)
+                    return NO_SLOT;
+
+                const uint64_t headNew = (((head >> 32) + 1) << 32) | findSlot(index)->nextFree.load(std::memory_order_relaxed);
+                if (freeHead_.compare_exchange_weak(head, headNew, std::memory_order_acquire))
+                    return index;
+            }
+        }
+
+        void pushFreeSlot(uint32_t index, Slot& slot)
+        {
+            uint64_t head = freeHead_.load(std::memory_order_relaxed);
+            uint64_t headNew = 0;
+            do
+            {
+                slot.nextFree.store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+                headNew = (((head >> 32) + 1) << 32) | index;
+            }
+            while (!freeHead_.compare_exchange_weak(head, headNew, std::memory_order_release, std::memory_order_relaxed));
+        }
+
+        std::atomic<Slot*> chunks_[23] = {}; //enough for 2^32 slots
+        std::atomic<uint64_t> nextIndex_{0};
+        std::atomic<uint64_t> freeHead_{NO_SLOT}; //high: ABA tag, low: slot index
+    };
+
+    const ObjectId id_;
+
+    static inline SlotTable slots_; //external linkage!
 };
 
 //------------------------------------------------------------------
@@ -433,7 +726,7 @@ public:
     void setSyncDir(SyncDirection newDir);
     void setSyncDirConflict(const Zstringc& description); //set syncDir = SyncDirection::none + fill conflict description
 
-    bool isActive() const { return selectedForSync_; }
+    bool isActive() const { return base().hotFields_.isActive(hotIndex_); }
     void setActive(bool active);
 
     //sync operation
@@ -457,16 +750,22 @@ protected:
     FileSystemObject(const Zstring& itemNameL,
                      const Zstring& itemNameR,
                      ContainerObject& parentObj) :
+        hotIndex_(parentObj.getBase().hotFields_.insert()), //throw std::bad_alloc
         itemNameL_(itemNameL),
         itemNameR_(itemNameL == itemNameR ? itemNameL : itemNameR), //perf: no measurable speed drawback; -3% peak memory => further needed by ContainerObject construction!
         parent_(parentObj)
     {
         assert(itemNameL_.c_str() == itemNameR_.c_str() || itemNameL_ != itemNameR_); //also checks ref-counted string precondition
         FileSystemObject::notifySyncCfgChanged(); //non-virtual call! (=> anyway in a constructor!)
+
+        base().trackChanges_ = false; //new items are not part of any view yet => full view update
     }
 
     virtual ~FileSystemObject() //don't need polymorphic deletion, but we have a vtable anyway
-    { assert(itemNameL_.c_str() == itemNameR_.c_str() || itemNameL_ != itemNameR_); }
+    {
+        assert(itemNameL_.c_str() == itemNameR_.c_str() || itemNameL_ != itemNameR_);
+        base().hotFields_.erase(hotIndex_);
+    }
 
     virtual void notifySyncCfgChanged()
     {
@@ -476,6 +775,16 @@ protected:
 
     template <SelectSide side> void removeFsObject();
 
+    FileContentCategory getHotContentCategory() const { return base().hotFields_.getContentCategory(hotIndex_); }
+    void setHotContentCategory(FileContentCategory category) { base().hotFields_.setContentCategory(hotIndex_, category); }
+
+    void notifyBeforeChange() //call *before* modifying anything a view might show
+    {
+        if (const BaseFolderPair& baseFolder = base();
+            baseFolder.trackChanges_ && changeLogGen_ != baseFolder.changeLogGen_) //not yet recorded
+            recordChange();
+    }
+
 private:
     FileSystemObject           (const FileSystemObject&) = delete;
     FileSystemObject& operator=(const FileSystemObject&) = delete;
@@ -486,9 +795,12 @@ private:
     template <SelectSide side>
     void propagateChangedItemName(); //required after any itemName changes
 
-    bool selectedForSync_ = true;
+    void recordChange();
+    friend class BaseFolderPair; //reset changeLogGen_
+    friend class ContainerObject; //removeDoubleEmpty() => notifyBeforeChange()
 
-    SyncDirection syncDir_ = SyncDirection::none;
+    const uint32_t hotIndex_; //selected for sync, sync direction, content category: see ItemHotFields
+    uint32_t changeLogGen_ = 0; //see BaseFolderPair::changeLogGen_
     Zstringc syncDirectionConflict_; //non-empty if we have a conflict setting sync-direction
     //conserve memory (avoid std::string SSO overhead + allow ref-counting!)
 
@@ -536,6 +848,8 @@ public:
     template <SelectSide side> void removeItem();
 
 private:
+    friend class BaseFolderPair; //resetSyncOpBuffersRecursion()
+
     void notifySyncCfgChanged() override { syncOpBuffered_ = {}; FileSystemObject::notifySyncCfgChanged(); }
 
     mutable std::optional<SyncOperation> syncOpBuffered_; //determining sync-op for directory may be expensive as it depends on child-objects => buffer
@@ -572,7 +886,7 @@ public:
     template <SelectSide side> AFS::FingerPrint getFilePrint() const;
     template <SelectSide side> void clearFilePrint();
 
-    void setMoveRef(ObjectId refId) { moveFileRef_ = refId; } //reference to corresponding renamed file
+    void setMoveRef(ObjectId refId) { notifyBeforeChange(); moveFileRef_ = refId; } //reference to corresponding renamed file
     ObjectId getMoveRef() const { assert(!moveFileRef_ || (isEmpty<SelectSide::left>() != isEmpty<SelectSide::right>())); return moveFileRef_; } //may be nullptr
 
     SyncOperation testSyncOperation(SyncDirection testSyncDir) const override; //semantics: "what if"! assumes "active, no conflict, no recursion (directory)!
@@ -596,6 +910,9 @@ public:
     void setContentCategory(FileContentCategory category);
     FileContentCategory getContentCategory() const;
 
+    void setContentHash(const Zstringc& hash) { assert(getHotContentCategory() == FileContentCategory::equal); contentHash_ = hash; }
+    const Zstringc& getContentHash() const { return contentHash_; } //optional: set by "compare by content" for FileContentCategory::equal
+
     template <SelectSide side> void removeItem();
 
 private:
@@ -609,8 +926,8 @@ private:
 
     ObjectId moveFileRef_ = nullptr; //optional, filled by redetermineSyncDirection()
 
-    FileContentCategory contentCategory_ = FileContentCategory::unknown;
     Zstringc categoryDescr_; //optional: custom category description (e.g. FileContentCategory::conflict or invalidTime)
+    Zstringc contentHash_;   //optional: SHA-256 of (identical) content on both sides; ref-counted to save memory
 };
 
 //------------------------------------------------------------------
@@ -656,7 +973,6 @@ private:
     LinkAttributes attrL_;
     LinkAttributes attrR_;
 
-    FileContentCategory contentCategory_ = FileContentCategory::unknown;
     Zstringc categoryDescr_; //optional: custom category description (e.g. FileContentCategory::conflict or invalidTime)
 };
 
@@ -797,7 +1113,8 @@ inline void SymlinkPair::accept(FSObjectVisitor& visitor) const { visitor.visit(
 inline
 void FileSystemObject::setSyncDir(SyncDirection newDir)
 {
-    syncDir_ = newDir;
+    notifyBeforeChange();
+    base().hotFields_.setSyncDir(hotIndex_, newDir);
     syncDirectionConflict_.clear();
 
     notifySyncCfgChanged();
@@ -808,7 +1125,8 @@ inline
 void FileSystemObject::setSyncDirConflict(const Zstringc& description)
 {
     assert(!description.empty());
-    syncDir_ = SyncDirection::none;
+    notifyBeforeChange();
+    base().hotFields_.setSyncDir(hotIndex_, SyncDirection::none);
     syncDirectionConflict_ = description;
 
     notifySyncCfgChanged();
@@ -826,7 +1144,8 @@ std::wstring FileSystemObject::getSyncOpConflict() const
 inline
 void FileSystemObject::setActive(bool active)
 {
-    selectedForSync_ = active;
+    notifyBeforeChange();
+    base().hotFields_.setActive(hotIndex_, active);
     notifySyncCfgChanged();
 }
 
@@ -889,8 +1208,10 @@ void FileSystemObject::removeFsObject()
 template <SelectSide side> inline
 void FilePair::removeItem()
 {
+    notifyBeforeChange();
     selectParam<side>(attrL_, attrR_) = FileAttributes();
-    contentCategory_ = FileContentCategory::unknown;
+    setHotContentCategory(FileContentCategory::unknown);
+    contentHash_.clear();
     removeFsObject<side>();
 
     //cut ties between "move" pairs
@@ -911,8 +1232,9 @@ void FilePair::removeItem()
 template <SelectSide side> inline
 void SymlinkPair::removeItem()
 {
+    notifyBeforeChange();
     selectParam<side>(attrL_, attrR_) = LinkAttributes();
-    contentCategory_ = FileContentCategory::unknown;
+    setHotContentCategory(FileContentCategory::unknown);
     removeFsObject<side>();
 }
 
@@ -920,6 +1242,7 @@ void SymlinkPair::removeItem()
 template <SelectSide side> inline
 void FolderPair::removeItem()
 {
+    notifyBeforeChange();
     for (FilePair& file : refSubFiles())
         file.removeItem<side>();
     for (SymlinkPair& symlink : refSubLinks())
@@ -937,6 +1260,7 @@ void FileSystemObject::setItemName(const Zstring& itemName)
 {
     assert(!itemName.empty());
     assert(!isPairEmpty());
+    notifyBeforeChange();
 
     selectParam<side>(itemNameL_, itemNameR_) = itemName;
 
@@ -994,6 +1318,9 @@ void ContainerObject::updateRelPathsRecursion(const FileSystemObject& fsAlias)
 
 inline
 ContainerObject::ContainerObject(const FileSystemObject& fsAlias) :
+    subFiles_  (fsAlias.parent().subFiles_.get_allocator()), //
+    subLinks_  (fsAlias.parent().subFiles_.get_allocator()), //share BaseFolderPair's arena
+    subFolders_(fsAlias.parent().subFiles_.get_allocator()), //
     relPathL_(appendPath(fsAlias.parent().relPathL_, fsAlias.getItemName<SelectSide::left>())),
     relPathR_(fsAlias.parent().relPathL_.c_str() ==               //
               fsAlias.parent().relPathR_.c_str() &&               //take advantage of FileSystemObject's Zstring reuse:
@@ -1113,6 +1440,7 @@ void ContainerObject::flip()
 inline
 void BaseFolderPair::flip()
 {
+    trackChanges_ = false; //full view update
     ContainerObject::flip();
     std::swap(folderStatusLeft_, folderStatusRight_);
     std::swap(folderPathLeft_,   folderPathRight_);
@@ -1134,7 +1462,7 @@ void FilePair::flip()
     FileSystemObject::flip(); //call base class version
     std::swap(attrL_, attrR_);
 
-    switch (contentCategory_)
+    switch (getHotContentCategory())
     {
         //*INDENT-OFF*
         case FileContentCategory::unknown:
@@ -1142,8 +1470,8 @@ void FilePair::flip()
         case FileContentCategory::invalidTime:
         case FileContentCategory::different:
         case FileContentCategory::conflict: break;
-        case FileContentCategory::leftNewer:  contentCategory_ = FileContentCategory::rightNewer; break;
-        case FileContentCategory::rightNewer: contentCategory_ = FileContentCategory::leftNewer; break;
+        case FileContentCategory::leftNewer:  setHotContentCategory(FileContentCategory::rightNewer); break;
+        case FileContentCategory::rightNewer: setHotContentCategory(FileContentCategory::leftNewer); break;
         //*INDENT-ON*
     }
 }
@@ -1155,7 +1483,7 @@ void SymlinkPair::flip()
     FileSystemObject::flip(); //call base class versions
     std::swap(attrL_, attrR_);
 
-    switch (contentCategory_)
+    switch (getHotContentCategory())
     {
         //*INDENT-OFF*
         case FileContentCategory::unknown:
@@ -1163,8 +1491,8 @@ void SymlinkPair::flip()
         case FileContentCategory::invalidTime:
         case FileContentCategory::different:
         case FileContentCategory::conflict: break;
-        case FileContentCategory::leftNewer:  contentCategory_ = FileContentCategory::rightNewer; break;
-        case FileContentCategory::rightNewer: contentCategory_ = FileContentCategory::leftNewer; break;
+        case FileContentCategory::leftNewer:  setHotContentCategory(FileContentCategory::rightNewer); break;
+        case FileContentCategory::rightNewer: setHotContentCategory(FileContentCategory::leftNewer); break;
         //*INDENT-ON*
     }
 }
@@ -1188,6 +1516,7 @@ inline
 void FolderPair::setCategoryConflict(const Zstringc& description)
 {
     assert(!description.empty());
+    notifyBeforeChange();
     categoryConflict_ = description;
 }
 
@@ -1196,8 +1525,10 @@ inline
 void FilePair::setCategoryConflict(const Zstringc& description)
 {
     assert(!description.empty());
+    notifyBeforeChange();
     categoryDescr_ = description;
-    contentCategory_ = FileContentCategory::conflict;
+    setHotContentCategory(FileContentCategory::conflict);
+    contentHash_.clear();
 }
 
 
@@ -1205,8 +1536,9 @@ inline
 void SymlinkPair::setCategoryConflict(const Zstringc& description)
 {
     assert(!description.empty());
+    notifyBeforeChange();
     categoryDescr_ = description;
-    contentCategory_ = FileContentCategory::conflict;
+    setHotContentCategory(FileContentCategory::conflict);
 }
 
 
@@ -1214,8 +1546,10 @@ inline
 void FilePair::setCategoryInvalidTime(const Zstringc& description)
 {
     assert(!description.empty());
+    notifyBeforeChange();
     categoryDescr_ = description;
-    contentCategory_ = FileContentCategory::invalidTime;
+    setHotContentCategory(FileContentCategory::invalidTime);
+    contentHash_.clear();
 }
 
 
@@ -1223,8 +1557,9 @@ inline
 void SymlinkPair::setCategoryInvalidTime(const Zstringc& description)
 {
     assert(!description.empty());
+    notifyBeforeChange();
     categoryDescr_ = description;
-    contentCategory_ = FileContentCategory::invalidTime;
+    setHotContentCategory(FileContentCategory::invalidTime);
 }
 
 
@@ -1238,7 +1573,8 @@ void FilePair::setContentCategory(FileContentCategory category)
 {
     assert(!isEmpty<SelectSide::left>() &&!isEmpty<SelectSide::right>());
     assert(category != FileContentCategory::unknown);
-    contentCategory_ = category;
+    notifyBeforeChange();
+    setHotContentCategory(category);
 }
 
 
@@ -1247,7 +1583,8 @@ void SymlinkPair::setContentCategory(FileContentCategory category)
 {
     assert(!isEmpty<SelectSide::left>() &&!isEmpty<SelectSide::right>());
     assert(category != FileContentCategory::unknown);
-    contentCategory_ = category;
+    notifyBeforeChange();
+    setHotContentCategory(category);
 }
 
 
@@ -1255,7 +1592,7 @@ inline
 FileContentCategory FilePair::getContentCategory() const
 {
     assert(!isEmpty<SelectSide::left>() &&!isEmpty<SelectSide::right>());
-    return contentCategory_;
+    return getHotContentCategory();
 }
 
 
@@ -1263,7 +1600,7 @@ inline
 FileContentCategory SymlinkPair::getContentCategory() const
 {
     assert(!isEmpty<SelectSide::left>() &&!isEmpty<SelectSide::right>());
-    return contentCategory_;
+    return getHotContentCategory();
 }
 
 
@@ -1293,11 +1630,11 @@ CompareFileResult FolderPair::getCategory() const
 inline
 CompareFileResult FilePair::getCategory() const
 {
-    assert(contentCategory_ == FileContentCategory::conflict ||
-           (isEmpty<SelectSide::left>() || isEmpty<SelectSide::right>()) == (contentCategory_ == FileContentCategory::unknown));
-    assert(contentCategory_ != FileContentCategory::conflict || !categoryDescr_.empty());
+    assert(getHotContentCategory() == FileContentCategory::conflict ||
+           (isEmpty<SelectSide::left>() || isEmpty<SelectSide::right>()) == (getHotContentCategory() == FileContentCategory::unknown));
+    assert(getHotContentCategory() != FileContentCategory::conflict || !categoryDescr_.empty());
 
-    if (contentCategory_ == FileContentCategory::conflict)
+    if (getHotContentCategory() == FileContentCategory::conflict)
     {
         assert(!categoryDescr_.empty());
         return FILE_CONFLICT;
@@ -1319,7 +1656,7 @@ CompareFileResult FilePair::getCategory() const
             //1. FILE_EQUAL may only be set if names match in case: InSyncFolder's mapping tables use file name as a key! see db_file.cpp
             //2. harmonize with "bool stillInSync()" in algorithm.cpp, FilePair::setSyncedTo() in file_hierarchy.h
             //3. FILE_EQUAL is expected to mean identical file sizes! See InSyncFile
-            switch (contentCategory_)
+            switch (getHotContentCategory())
             {
                 //*INDENT-OFF*
                 case FileContentCategory::unknown:
@@ -1339,11 +1676,11 @@ CompareFileResult FilePair::getCategory() const
 inline
 CompareFileResult SymlinkPair::getCategory() const
 {
-    assert(contentCategory_ == FileContentCategory::conflict ||
-           (isEmpty<SelectSide::left>() || isEmpty<SelectSide::right>()) == (contentCategory_ == FileContentCategory::unknown));
-    assert(contentCategory_ != FileContentCategory::conflict || !categoryDescr_.empty());
+    assert(getHotContentCategory() == FileContentCategory::conflict ||
+           (isEmpty<SelectSide::left>() || isEmpty<SelectSide::right>()) == (getHotContentCategory() == FileContentCategory::unknown));
+    assert(getHotContentCategory() != FileContentCategory::conflict || !categoryDescr_.empty());
 
-    if (contentCategory_ == FileContentCategory::conflict)
+    if (getHotContentCategory() == FileContentCategory::conflict)
     {
         assert(!categoryDescr_.empty());
         return FILE_CONFLICT;
@@ -1364,7 +1701,7 @@ CompareFileResult SymlinkPair::getCategory() const
             //Caveat:
             //1. SYMLINK_EQUAL may only be set if names match in case: InSyncFolder's mapping tables use link name as a key! see db_file.cpp
             //2. harmonize with "bool stillInSync()" in algorithm.cpp, FilePair::setSyncedTo() in file_hierarchy.h
-            switch (contentCategory_)
+            switch (getHotContentCategory())
             {
                 //*INDENT-OFF*
                 case FileContentCategory::unknown:
@@ -1440,6 +1777,7 @@ template <SelectSide sideTrg> inline
 void FolderPair::setSyncedTo(bool isSymlinkTrg,
                              bool isSymlinkSrc)
 {
+    notifyBeforeChange();
     selectParam<             sideTrg >(attrL_, attrR_) = {.isFollowedSymlink = isSymlinkTrg};
     selectParam<getOtherSide<sideTrg>>(attrL_, attrR_) = {.isFollowedSymlink = isSymlinkSrc};
 
@@ -1459,6 +1797,7 @@ void FilePair::setSyncedTo(uint64_t fileSize,
                            bool isSymlinkTrg,
                            bool isSymlinkSrc)
 {
+    notifyBeforeChange(); //includes move pair partner
     selectParam<             sideTrg >(attrL_, attrR_) = {lastWriteTimeTrg, fileSize, filePrintTrg, isSymlinkTrg};
     selectParam<getOtherSide<sideTrg>>(attrL_, attrR_) = {lastWriteTimeSrc, fileSize, filePrintSrc, isSymlinkSrc};
 
@@ -1474,8 +1813,9 @@ void FilePair::setSyncedTo(uint64_t fileSize,
 
     setItemName<sideTrg>(getItemName<getOtherSide<sideTrg>>());
 
-    contentCategory_ = FileContentCategory::equal;
+    setHotContentCategory(FileContentCategory::equal);
     categoryDescr_.clear();
+    contentHash_.clear(); //content was copied, but not hashed
     setSyncDir(SyncDirection::none);
 }
 
@@ -1484,12 +1824,13 @@ template <SelectSide sideTrg> inline
 void SymlinkPair::setSyncedTo(time_t lastWriteTimeTrg,
                               time_t lastWriteTimeSrc)
 {
+    notifyBeforeChange();
     selectParam<             sideTrg >(attrL_, attrR_) = {.modTime = lastWriteTimeTrg};
     selectParam<getOtherSide<sideTrg>>(attrL_, attrR_) = {.modTime = lastWriteTimeSrc};
 
     setItemName<sideTrg>(getItemName<getOtherSide<sideTrg>>());
 
-    contentCategory_ = FileContentCategory::equal;
+    setHotContentCategory(FileContentCategory::equal);
     categoryDescr_.clear();
     setSyncDir(SyncDirection::none);
 }
@@ -1555,4 +1896,11 @@ time_t SymlinkPair::getLastWriteTime() const
 }
 }
 
+
+template <class T, bool isConst>
+struct std::hash<fff::ObjectHandle<T, isConst>>
+{
+    size_t operator()(const fff::ObjectHandle<T, isConst>& id) const { return std::hash<uint64_t>()((static_cast<uint64_t>(id.generation_) << 32) | id.index_); }
+};
+
 #endif //FILE_HIERARCHY_H_257235289645296
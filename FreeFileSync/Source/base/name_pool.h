@@ -0,0 +1,77 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef NAME_POOL_H_3847102938475610293847
+#define NAME_POOL_H_3847102938475610293847
+
+#include <array>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <zen/zstring.h>
+
+
+namespace fff
+{
+/* intern item names: keep only one (ref-counted) Zstring per unique name
+    - huge folder hierarchies have lots of repetitive names: "index.html", "Thumbs.db", ".git", ...
+    - left/right names of the same item share memory => c_str() identity is the fast path, e.g. FileSystemObject::hasEquivalentItemNames()
+    - one pool per comparison: shared by folder traversal, database load and left/right matching (see ComparisonBuffer)
+    - interned strings stay shared after the pool is gone
+    - thread-safe: used by parallel folder traversal (one thread per device)                        */
+class NamePool
+{
+public:
+    //precomputed compare keys: Unicode normalization and upper-case conversion only once per unique name
+    struct CompareKeys
+    {
+        Zstring normalForm; //getUnicodeNormalForm()
+        Zstring upperCase;  //getUpperCase(): compareNoCase(lhs, rhs) == (upperCaseL <=> upperCaseR), equalNoCase() likewise
+    };
+
+    Zstring intern(const Zstring& name)
+    {
+        Shard& shard = getShard(name);
+        std::lock_guard dummy(shard.lock);
+        return shard.names.try_emplace(name).first->first;
+    }
+
+    //returned reference is valid for the pool's life time
+    const CompareKeys& getCompareKeys(const Zstring& name) //name need not be interned
+    {
+        Shard& shard = getShard(name);
+        std::lock_guard dummy(shard.lock);
+
+        std::optional<CompareKeys>& keys = shard.names.try_emplace(name).first->second; //std::unordered_map: node-based => stable references
+        if (!keys)
+        {
+            Zstring upperCase = getUpperCase(name);
+            if (upperCase == name)
+                upperCase = name; //share buffer, e.g. "README"
+
+            keys = CompareKeys{getUnicodeNormalForm(name) /*shares buffer if ASCII*/, std::move(upperCase)};
+        }
+        return *keys;
+    }
+
+private:
+    struct Shard
+    {
+        std::mutex lock;
+        std::unordered_map<Zstring, std::optional<CompareKeys>> names; //compare keys: created on demand
+    };
+
+    Shard& getShard(const Zstring& name)
+    {
+        const size_t hash = std::hash<Zstring>()(name);
+        return shards_[(hash ^ (hash >> 16)) % shards_.size()]; //don't use same bits as unordered_map's bucket index
+    }
+
+    std::array<Shard, 16> shards_; //reduce lock contention
+};
+}
+
+#endif //NAME_POOL_H_3847102938475610293847
@@ -9,6 +9,7 @@
 #include <zen/file_error.h>
 #include <zen/thread.h>
 #include <zen/scope_guard.h>
+#include <zen/trace.h>
 
 using namespace zen;
 using namespace fff;
@@ -213,6 +214,8 @@ struct TraverserConfig
     std::unordered_map<Zstring, Zstringc>& failedDirReads;
     std::unordered_map<Zstring, Zstringc>& failedItemReads;
 
+    NamePool& names; //shared by all worker threads: left/right items with equal names share one buffer; thread-safe
+
     AsyncCallback& acb;
     const int threadIdx;
     std::chrono::steady_clock::time_point& lastReportTime; //thread-level
@@ -252,7 +255,7 @@ class BaseDirCallback : public DirCallback
 {
 public:
     BaseDirCallback(const DirectoryKey& baseFolderKey, DirectoryValue& output,
-                    AsyncCallback& acb, int threadIdx, std::chrono::steady_clock::time_point& lastReportTime) :
+                    NamePool& names, AsyncCallback& acb, int threadIdx, std::chrono::steady_clock::time_point& lastReportTime) :
         DirCallback(travCfg_ /*not yet constructed!!!*/, Zstring(), output.folderCont, 0 /*level*/),
         travCfg_
     {
@@ -261,6 +264,7 @@ public:
         baseFolderKey.handleSymlinks,
         output.failedFolderReads,
         output.failedItemReads,
+        names,
         acb,
         threadIdx,
         lastReportTime,
@@ -291,7 +295,7 @@ void DirCallback::onFile(const AFS::FileInfo& fi) //throw ThreadStopRequest
         return;
     //note: sync.ffs_db database and lock files are excluded via path filter!
 
-    output_.addFile(fi.itemName,
+    output_.addFile(cfg_.names.intern(fi.itemName),
     {
         .modTime = fi.modTime,
         .fileSize = fi.fileSize,
@@ -321,7 +325,7 @@ std::shared_ptr<AFS::TraverserCallback> DirCallback::onFolder(const AFS::FolderI
         return nullptr; //do NOT traverse subdirs
     //else: ensure directory filtering is applied later to exclude actually filtered directories!!!
 
-    FolderContainer& subFolder = output_.addFolder(fi.itemName, {.isFollowedSymlink = fi.isFollowedSymlink});
+    FolderContainer& subFolder = output_.addFolder(cfg_.names.intern(fi.itemName), {.isFollowedSymlink = fi.isFollowedSymlink});
     if (passFilter)
         cfg_.acb.incItemsScanned(); //add 1 element to the progress indicator
 
@@ -360,7 +364,7 @@ DirCallback::HandleLink DirCallback::onSymlink(const AFS::SymlinkInfo& si) //thr
         case SymLinkHandling::asLink:
             if (cfg_.filter.ref().passFileFilter(relPath)) //always use file filter: Link type may not be "stable" on Linux!
             {
-                output_.addLink(si.itemName, {.modTime = si.modTime});
+                output_.addLink(cfg_.names.intern(si.itemName), {.modTime = si.modTime});
                 cfg_.acb.incItemsScanned(); //add 1 element to the progress indicator
             }
             return HandleLink::skip;
@@ -405,7 +409,8 @@ DirCallback::HandleError DirCallback::reportError(const ErrorInfo& errorInfo, co
 
 std::map<DirectoryKey, DirectoryValue> fff::parallelDeviceTraversal(const std::set<DirectoryKey>& foldersToRead,
                                                                     const TravErrorCb& onError, const TravStatusCb& onStatusUpdate,
-                                                                    std::chrono::milliseconds cbInterval)
+                                                                    std::chrono::milliseconds cbInterval,
+                                                                    NamePool& names)
 {
     std::map<DirectoryKey, DirectoryValue> output;
 
@@ -419,18 +424,18 @@ std::map<DirectoryKey, DirectoryValue> fff::parallelDeviceTraversal(const std::s
         perDeviceFolders[key.folderPath.afsDevice].insert(key);
 
     //communication channel used by threads
-    AsyncCallback acb(perDeviceFolders.size() /*threadsToFinish*/, cbInterval); //manage life time: enclose InterruptibleThread's!!!
+    AsyncCallback acb(perDeviceFolders.size() /*threadsToFinish*/, cbInterval); //manage life time: enclose ThreadGroup's!!!
 
-    std::vector<InterruptibleThread> worker;
-    ZEN_ON_SCOPE_SUCCESS( for (InterruptibleThread& wt : worker) wt.join(); ); //no stop needed in success case => preempt ~InterruptibleThread()
-    ZEN_ON_SCOPE_FAIL( for (InterruptibleThread& wt : worker) wt.requestStop(); ); //stop *all* at the same time before join!
+    std::vector<ThreadGroup<std::function<void()>>> deviceThreadGroups;
+    ZEN_ON_SCOPE_SUCCESS( for (auto& tg : deviceThreadGroups) tg.wait(); ); //no stop needed in success case => preempt ~ThreadGroup()
+    ZEN_ON_SCOPE_FAIL( for (auto& tg : deviceThreadGroups) tg.requestStop(); ); //stop *all* at the same time before join!
 
     //init worker threads
     for (const auto& [afsDevice, dirKeys] : perDeviceFolders)
     {
-        const int threadIdx = static_cast<int>(worker.size());
-        Zstring threadName = Zstr("Compare[") + numberTo<Zstring>(threadIdx + 1) + Zstr('/') + numberTo<Zstring>(perDeviceFolders.size()) + Zstr("] ") +
-                             utfTo<Zstring>(AFS::getDisplayPath({afsDevice, AfsPath()}));
+        const int threadIdx = static_cast<int>(deviceThreadGroups.size());
+        const Zstring threadGroupName = Zstr("Compare[") + numberTo<Zstring>(threadIdx + 1) + Zstr('/') + numberTo<Zstring>(perDeviceFolders.size()) + Zstr("] ") +
+                                        utfTo<Zstring>(AFS::getDisplayPath({afsDevice, AfsPath()}));
 
         const size_t parallelOps = 1;
         std::map<DirectoryKey, DirectoryValue*> workload;
@@ -438,13 +443,17 @@ std::map<DirectoryKey, DirectoryValue> fff::parallelDeviceTraversal(const std::s
         for (const DirectoryKey& key : dirKeys)
             workload.emplace(key, &output[key]); //=> DirectoryValue* unshared for lock-free worker-thread access
 
-        worker.emplace_back([afsDevice /*clang bug*/= afsDevice, workload, threadIdx, &acb, parallelOps, threadName = std::move(threadName)]() mutable
+        deviceThreadGroups.emplace_back(1, threadGroupName);
+        deviceThreadGroups.back().run([afsDevice /*clang bug*/= afsDevice, workload, threadIdx, &names, &acb, parallelOps]() mutable
         {
-            setCurrentThreadName(threadName);
-
             acb.notifyWorkBegin(threadIdx, parallelOps);
             ZEN_ON_SCOPE_EXIT(acb.notifyWorkEnd(threadIdx));
 
+            TraceSpan span("parallelDeviceTraversal");
+            if (span)
+                span.setDevice(utfTo<std::string>(AFS::getDisplayPath({afsDevice, AfsPath()})));
+            span.addItems(workload.size()); //base folders
+
             std::chrono::steady_clock::time_point lastReportTime; //keep thread-local!
 
             AFS::TraverserWorkload travWorkload;
@@ -452,7 +461,7 @@ std::map<DirectoryKey, DirectoryValue> fff::parallelDeviceTraversal(const std::s
             for (auto& [folderKey, folderVal] : workload)
             {
                 assert(folderKey.folderPath.afsDevice == afsDevice);
-                travWorkload.emplace_back(folderKey.folderPath.afsPath, std::make_shared<BaseDirCallback>(folderKey, *folderVal, acb, threadIdx, lastReportTime));
+                travWorkload.emplace_back(folderKey.folderPath.afsPath, std::make_shared<BaseDirCallback>(folderKey, *folderVal, names, acb, threadIdx, lastReportTime));
             }
             AFS::traverseFolderRecursive(afsDevice, travWorkload, parallelOps); //throw ThreadStopRequest
         });
@@ -14,6 +14,7 @@
 #include "structures.h"
 #include "file_hierarchy.h"
 #include "process_callback.h"
+#include "name_pool.h"
 
 
 namespace fff
@@ -48,7 +49,8 @@ using TravStatusCb = std::function<void(const std::wstring& statusLine, int item
 
 std::map<DirectoryKey, DirectoryValue> parallelDeviceTraversal(const std::set<DirectoryKey>& foldersToRead,
                                                                const TravErrorCb& onError, const TravStatusCb& onStatusUpdate, //NOT optional
-                                                               std::chrono::milliseconds cbInterval);
+                                                               std::chrono::milliseconds cbInterval,
+                                                               NamePool& names); //item names are interned
 }
 
 #endif //PARALLEL_SCAN_H_924588904275284572857
@@ -6,6 +6,7 @@
 
 #include "path_filter.h"
 #include <typeindex>
+#include <span>
 #include <zen/file_path.h>
 
 using namespace zen;
@@ -88,6 +89,9 @@ void NameFilter::parseFilterPhrase(const Zstring& filterPhrase, FilterSet& filte
             }
         }
     });
+
+    filter.fileMasks  .compile();
+    filter.folderMasks.compile();
 }
 
 
@@ -104,7 +108,12 @@ void NameFilter::MaskMatcher::insert(const Zstring& mask)
     {
         relPaths_   .insert(mask);
         relPathsCmp_.insert(mask); //little memory wasted thanks to COW string!
+
+        for (size_t pos = 0; pos + 1 < mask.size(); ++pos)
+            if (mask[pos] == FILE_NAME_SEPARATOR)
+                relPathParents_.emplace(mask.c_str(), pos);
     }
+    compiledMasks_.reset(); //outdated
 }
 
 
@@ -197,6 +206,304 @@ bool matchesMaskBegin<false /*haveWildcards*/>(const ZstringView relPath, const
            mask[relPath.size()] == FILE_NAME_SEPARATOR &&
            startsWith(mask, relPath);
 }
+
+
+/*  DFA for a group of wildcard masks: evaluate all masks in a single pass over the path instead of backtracking per mask
+    - subset construction over mask positions: '*' loops on any char (including FILE_NAME_SEPARATOR), '?' consumes any char but FILE_NAME_SEPARATOR
+    - alphabet is compressed into char classes: one per literal used in the masks + one for all other chars
+    - unlimited subset construction can blow up exponentially (e.g. many "*abc*def" masks) => give up at MAX_STATES    */
+class MaskDfa
+{
+public:
+    enum class Mode
+    {
+        match,      //equivalent to matchesMask() for each mask
+        matchBegin, //equivalent to matchesMaskBegin<true>() for each mask
+    };
+
+    //std::nullopt if masks exceed state limit
+    static std::optional<MaskDfa> compile(std::span<const Zstring> masks, Mode mode);
+
+    bool matches(const ZstringView relPath) const
+    {
+        assert(mode_ == Mode::match);
+        return run(relPath);
+    }
+
+    bool matchesBegin(const ZstringView relPath) const
+    {
+        assert(mode_ == Mode::matchBegin);
+        return run(relPath);
+    }
+
+private:
+    explicit MaskDfa(Mode mode) : mode_(mode) {}
+
+    bool run(const ZstringView relPath) const
+    {
+        uint32_t state = INITIAL;
+        for (const Zchar c : relPath)
+        {
+            if (flags_[state] == ACCEPT)
+                return true;
+            state = next_[state * classCount_ + charClass_[static_cast<unsigned char>(c)]];
+            if (state == DEAD)
+                return false;
+        }
+        return flags_[state] != NONE;
+    }
+
+    static constexpr uint32_t DEAD    = 0;
+    static constexpr uint32_t INITIAL = 1;
+    static constexpr size_t MAX_STATES = 1000;
+
+    //mask positions beyond char values:
+    static constexpr int MASK_END = -1;
+    static constexpr int SEP_OR_PATH_END = -2; //Mode::match: mask must be followed by FILE_NAME_SEPARATOR or path end
+
+    enum : uint8_t
+    {
+        NONE,
+        ACCEPT,        //mask matched => no need to look at the rest of the path
+        ACCEPT_AT_END, //mask matched if path ends here
+    };
+
+    Mode mode_;
+    std::array<uint8_t, 256> charClass_{};
+    size_t classCount_ = 0;
+    std::vector<uint32_t> next_;  //[state * classCount_ + class]
+    std::vector<uint8_t>  flags_; //[state]
+};
+static_assert(sizeof(Zchar) == 1);
+
+
+std::optional<MaskDfa> MaskDfa::compile(std::span<const Zstring> masks, Mode mode)
+{
+    assert(!masks.empty());
+
+    //concatenate all masks into one "NFA"
+    std::vector<int> nfa;
+    std::vector<uint32_t> startPos;
+    for (const Zstring& mask : masks)
+    {
+        startPos.push_back(static_cast<uint32_t>(nfa.size()));
+
+        ZstringView pattern = mask;
+        bool trailingAsterisk = false;
+        if (mode == Mode::match) //matchesMask(): trailing '*' matches immediately => perf: don't let it "survive" in the DFA states
+            while (endsWith(pattern, Zstr('*')))
+            {
+                pattern.remove_suffix(1);
+                trailingAsterisk = true;
+            }
+
+        for (const Zchar c : pattern)
+            nfa.push_back(static_cast<unsigned char>(c));
+
+        if (mode == Mode::match && !trailingAsterisk)
+            nfa.push_back(SEP_OR_PATH_END);
+        nfa.push_back(MASK_END);
+    }
+
+    MaskDfa dfa(mode);
+
+    //compress alphabet:
+    std::array<bool, 256> isLiteral{};
+    isLiteral[static_cast<unsigned char>(FILE_NAME_SEPARATOR)] = true;
+    for (const int c : nfa)
+        if (c >= 0 && c != Zstr('*') && c != Zstr('?'))
+            isLiteral[c] = true;
+
+    std::optional<uint8_t> otherClass;
+    for (int c = 0; c < 256; ++c)
+        if (isLiteral[c] || !otherClass)
+        {
+            if (!isLiteral[c])
+                otherClass = static_cast<uint8_t>(dfa.classCount_);
+            dfa.charClass_[c] = static_cast<uint8_t>(dfa.classCount_++);
+        }
+        else
+            dfa.charClass_[c] = *otherClass;
+
+    const int sepChar = static_cast<unsigned char>(FILE_NAME_SEPARATOR);
+
+    auto addPos = [&](std::vector<uint32_t>& posList, uint32_t pos)
+    {
+        posList.push_back(pos);
+        if (mode == Mode::match) //epsilon closure: '*' may match empty sequence
+            while (nfa[pos] == Zstr('*'))
+                posList.push_back(++pos);
+    };
+
+    auto getFlags = [&](const std::vector<uint32_t>& posList) -> uint8_t
+    {
+        uint8_t flags = NONE;
+        for (const uint32_t pos : posList)
+            if (mode == Mode::match ?
+                nfa[pos] == MASK_END :
+                nfa[pos] == Zstr('*'))
+                return ACCEPT;
+            else if (mode == Mode::match ?
+                     nfa[pos] == SEP_OR_PATH_END :
+                     nfa[pos] == sepChar && nfa[pos + 1] != MASK_END) //matchesMaskBegin(): require strict sub match
+                flags = ACCEPT_AT_END;
+        return flags;
+    };
+
+    struct PosListHash
+    {
+        size_t operator()(const std::vector<uint32_t>& posList) const { return static_cast<size_t>(impl::hashBytes(posList.data(), posList.size() * sizeof(posList[0]))); }
+    };
+    std::vector<std::vector<uint32_t>> states;
+    std::unordered_map<std::vector<uint32_t>, uint32_t, PosListHash> stateIds;
+
+    auto getStateId = [&](std::vector<uint32_t>&& posList) -> uint32_t
+    {
+        assert(std::is_sorted(posList.begin(), posList.end()));
+        auto [it, inserted] = stateIds.try_emplace(posList, static_cast<uint32_t>(states.size()));
+        if (inserted)
+        {
+            dfa.flags_.push_back(getFlags(posList));
+            states.push_back(std::move(posList));
+        }
+        return it->second;
+    };
+
+    auto sortUnique = [](std::vector<uint32_t>& posList)
+    {
+        std::sort(posList.begin(), posList.end());
+        posList.erase(std::unique(posList.begin(), posList.end()), posList.end());
+    };
+
+    getStateId({}); //DEAD
+    {
+        std::vector<uint32_t> initial;
+        for (const uint32_t pos : startPos)
+            addPos(initial, pos);
+        sortUnique(initial);
+        getStateId(std::move(initial)); //INITIAL
+    }
+
+    const uint8_t sepClass = dfa.charClass_[sepChar];
+
+    for (uint32_t stateId = 0; stateId < states.size(); ++stateId)
+    {
+        if (states.size() > MAX_STATES)
+            return std::nullopt;
+
+        if (stateId == DEAD || dfa.flags_[stateId] == ACCEPT) //final states: never left
+        {
+            dfa.next_.insert(dfa.next_.end(), dfa.classCount_, stateId);
+            continue;
+        }
+
+        //perf: distribute positions by char class in a single pass instead of once per class
+        std::vector<uint32_t> anyCharPos; //'*'
+        std::vector<uint32_t> nonSepPos;  //'?'
+        std::vector<std::vector<uint32_t>> classPos(dfa.classCount_); //literals
+
+        for (const uint32_t pos : states[stateId])
+            switch (nfa[pos])
+            {
+                case MASK_END:
+                    break;
+                case SEP_OR_PATH_END:
+                    addPos(classPos[sepClass], pos + 1);
+                    break;
+                case Zstr('*'):
+                    assert(mode == Mode::match);
+                    addPos(anyCharPos, pos);
+                    break;
+                case Zstr('?'):
+                    addPos(nonSepPos, pos + 1);
+                    break;
+                default:
+                    addPos(classPos[dfa.charClass_[nfa[pos]]], pos + 1);
+                    break;
+            }
+
+        sortUnique(anyCharPos);
+        std::vector<uint32_t> nonSepBase = anyCharPos; //positions reached by all chars but FILE_NAME_SEPARATOR
+        nonSepBase.insert(nonSepBase.end(), nonSepPos.begin(), nonSepPos.end());
+        sortUnique(nonSepBase);
+
+        for (size_t classId = 0; classId < dfa.classCount_; ++classId)
+        {
+            const std::vector<uint32_t>& basePos = classId == sepClass ? anyCharPos : nonSepBase;
+            std::vector<uint32_t>& litPos = classPos[classId];
+            sortUnique(litPos);
+
+            std::vector<uint32_t> nextPos;
+            nextPos.reserve(basePos.size() + litPos.size());
+            std::set_union(basePos.begin(), basePos.end(), litPos.begin(), litPos.end(), std::back_inserter(nextPos));
+
+            dfa.next_.push_back(getStateId(std::move(nextPos)));
+        }
+    }
+    return dfa;
+}
+}
+
+
+class NameFilter::MaskMatcher::CompiledMasks
+{
+public:
+    explicit CompiledMasks(const std::set<Zstring>& realMasks)
+    {
+        const std::vector<Zstring> masks(realMasks.begin(), realMasks.end()); //sorted: similar masks share DFA states
+
+        for (size_t i = 0; i < masks.size(); i += MASKS_PER_DFA)
+        {
+            const std::span<const Zstring> group(masks.begin() + i, std::min(masks.size() - i, MASKS_PER_DFA));
+            compileGroups(group, MaskDfa::Mode::match,      matchDfas_, matchFallback_);
+            compileGroups(group, MaskDfa::Mode::matchBegin, beginDfas_, beginFallback_);
+        }
+    }
+
+    bool matches(const ZstringView relPath) const
+    {
+        return std::any_of(matchDfas_.begin(), matchDfas_.end(), [&](const MaskDfa& dfa) { return dfa.matches(relPath); }) ||
+        /**/   std::any_of(matchFallback_.begin(), matchFallback_.end(), [&](const Zstring& mask) { return matchesMask(relPath.data(), relPath.data() + relPath.size(), mask.c_str()); });
+    }
+
+    bool matchesBegin(const ZstringView relPath) const
+    {
+        return std::any_of(beginDfas_.begin(), beginDfas_.end(), [&](const MaskDfa& dfa) { return dfa.matchesBegin(relPath); }) ||
+        /**/   std::any_of(beginFallback_.begin(), beginFallback_.end(), [&](const Zstring& mask) { return matchesMaskBegin<true /*haveWildcards*/>(relPath, mask); });
+    }
+
+private:
+    static constexpr size_t MASKS_PER_DFA = 32; //DFA size grows super-linearly with number of masks: trade matching speed for compile time
+
+    //split masks until each group fits into a DFA; pathological masks are matched one by one
+    static void compileGroups(std::span<const Zstring> masks, MaskDfa::Mode mode, std::vector<MaskDfa>& dfas, std::vector<Zstring>& fallback)
+    {
+        if (masks.empty())
+            return;
+
+        if (std::optional<MaskDfa> dfa = MaskDfa::compile(masks, mode))
+            dfas.push_back(std::move(*dfa));
+        else if (masks.size() == 1)
+            fallback.push_back(masks[0]);
+        else
+        {
+            compileGroups(masks.first  (masks.size() / 2), mode, dfas, fallback);
+            compileGroups(masks.subspan(masks.size() / 2), mode, dfas, fallback);
+        }
+    }
+
+    std::vector<MaskDfa> matchDfas_;
+    std::vector<Zstring> matchFallback_;
+    std::vector<MaskDfa> beginDfas_;
+    std::vector<Zstring> beginFallback_;
+};
+
+
+void NameFilter::MaskMatcher::compile()
+{
+    compiledMasks_.reset();
+    if (!realMasks_.empty())
+        compiledMasks_ = std::make_shared<const CompiledMasks>(realMasks_);
 }
 
 
@@ -204,8 +511,13 @@ bool NameFilter::MaskMatcher::matches(const ZstringView relPath) const
 {
     assert(!relPath.empty());
 
-    if (std::any_of(realMasks_.begin(), realMasks_.end(), [&](const Zstring& mask) { return matchesMask(relPath.data(), relPath.data() + relPath.size(), mask.c_str()); }))
-    /**/return true;
+    if (compiledMasks_)
+    {
+        if (compiledMasks_->matches(relPath))
+            return true;
+    }
+    else if (std::any_of(realMasks_.begin(), realMasks_.end(), [&](const Zstring& mask) { return matchesMask(relPath.data(), relPath.data() + relPath.size(), mask.c_str()); }))
+        return true;
 
     //perf: for relPaths_ we can go from linear to *constant* time!!! => annihilates https://freefilesync.org/forum/viewtopic.php?t=7768#p26519
 
@@ -224,8 +536,16 @@ bool NameFilter::MaskMatcher::matches(const ZstringView relPath) const
 
 bool NameFilter::MaskMatcher::matchesBegin(const ZstringView relPath) const
 {
-    return std::any_of(realMasks_.begin(), realMasks_.end(), [&](const Zstring& mask) { return matchesMaskBegin<true  /*haveWildcards*/>(relPath, mask); }) ||
-    /**/   std::any_of(relPaths_ .begin(), relPaths_ .end(), [&](const Zstring& mask) { return matchesMaskBegin<false /*haveWildcards*/>(relPath, mask); });
+    assert(relPathParents_.contains(relPath) ==
+           std::any_of(relPaths_.begin(), relPaths_.end(), [&](const Zstring& mask) { return matchesMaskBegin<false /*haveWildcards*/>(relPath, mask); }));
+
+    if (relPathParents_.contains(relPath)) //perf: constant time instead of linear search over relPaths_
+        return true;
+
+    if (compiledMasks_)
+        return compiledMasks_->matchesBegin(relPath);
+
+    return std::any_of(realMasks_.begin(), realMasks_.end(), [&](const Zstring& mask) { return matchesMaskBegin<true /*haveWildcards*/>(relPath, mask); });
 }
 
 //#################################################################################################
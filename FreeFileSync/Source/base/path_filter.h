@@ -92,6 +92,7 @@ private:
     {
     public:
         void insert(const Zstring& mask); //expected: upper-case + Unicode-normalized!
+        void compile(); //call after last insert(): combine wildcard masks into DFAs
         bool matches(const ZstringView relPath) const;
         bool matchesBegin(const ZstringView relPath) const;
 
@@ -108,9 +109,14 @@ private:
         //std::three_way_comparable requires __WeaklyEqualityComparableWith!! this is stupid on first sight. And on second. And on third.
 
     private:
+        class CompiledMasks;
+
         std::set<Zstring> realMasks_; //always containing ? or *       (use std::set<> to scrap duplicates!)
         std::unordered_set<Zstring, zen::StringHash, zen::StringEqual> relPaths_; //never containing ? or *
         std::set<Zstring>                                              relPathsCmp_; //req. for operator<=> only :(
+
+        std::unordered_set<Zstring, zen::StringHash, zen::StringEqual> relPathParents_; //all (strict) parent paths of relPaths_ => matchesBegin() in constant time
+        std::shared_ptr<const CompiledMasks> compiledMasks_; //derived from realMasks_: immutable => shared between copies
     };
 
     struct FilterSet
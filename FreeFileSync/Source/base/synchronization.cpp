@@ -10,6 +10,7 @@
 #include <zen/perf.h>
 #include <zen/guid.h>
 #include <zen/crc.h>
+#include <zen/trace.h>
 #include "algorithm.h"
 #include "db_file.h"
 #include "status_handler_impl.h"
@@ -665,6 +666,9 @@ void flushFileBuffers(const Zstring& nativeFilePath) //throw FileError
 
 void verifyFiles(const AbstractPath& sourcePath, const AbstractPath& targetPath, const IoCallback& notifyUnbufferedIO /*throw X*/) //throw FileError, X
 {
+    TraceSpan span("verifyFiles");
+    if (span)
+        span.setDevice(utfTo<std::string>(AFS::getDisplayPath(AbstractPath(targetPath.afsDevice, AfsPath()))));
     try
     {
         //do like "copy /v": 1. flush target file buffers, 2. read again as usual (using OS buffers)
@@ -1333,22 +1337,24 @@ Notes: - All threads share a single mutex, unlocked only during file I/O => do N
 
 void FolderPairSyncer::runPass(PassNo pass, SyncCtx& syncCtx, BaseFolderPair& baseFolder, PhaseCallback& cb) //throw X
 {
+    TraceSpan span(pass == PassNo::zero ? "FolderPairSyncer::runPass(0)" :
+                   pass == PassNo::one  ? "FolderPairSyncer::runPass(1)" :
+                   /**/                   "FolderPairSyncer::runPass(2)");
+    if (span)
+        span.setDevice(utfTo<std::string>(AFS::getDisplayPath(baseFolder.getAbstractPath<SelectSide::left >()) + L" | " +
+                                          AFS::getDisplayPath(baseFolder.getAbstractPath<SelectSide::right>())));
     std::mutex singleThread; //only a single worker thread may run at a time, except for parallel file I/O
 
     AsyncCallback acb;                                //
-    FolderPairSyncer fps(syncCtx, singleThread, acb); //manage life time: enclose InterruptibleThread's!!!
+    FolderPairSyncer fps(syncCtx, singleThread, acb); //manage life time: enclose ThreadGroup's!!!
     Workload workload(1, acb);
     workload.addWorkItems(fps.getFolderLevelWorkItems(pass, baseFolder, workload)); //initial workload: set *before* threads get access!
 
-    std::vector<InterruptibleThread> worker;
-    ZEN_ON_SCOPE_EXIT( for (InterruptibleThread& wt : worker) wt.requestStop(); ); //stop *all* at the same time before join!
+    ThreadGroup<std::function<void()>> worker(1, Zstr("Sync")); //~ThreadGroup(): stop + join
 
     size_t threadIdx = 0;
-    Zstring threadName = Zstr("Sync");
-        worker.emplace_back([threadIdx, &singleThread, &acb, &workload, threadName = std::move(threadName)]
+        worker.run([threadIdx, &singleThread, &acb, &workload]
         {
-            setCurrentThreadName(threadName);
-
             while (/*blocking call:*/ std::function<void()> workItem = workload.getNext(threadIdx)) //throw ThreadStopRequest
             {
                 acb.notifyTaskBegin(0 /*prio*/); //same prio, while processing only one folder pair at a time
@@ -2441,6 +2447,7 @@ void fff::synchronize(const std::chrono::system_clock::time_point& syncStartTime
                       ProcessCallback& callback /*throw X*/) //throw X
 {
     //PERF_START;
+    TraceSpan span("synchronize");
 
     if (syncConfig.size() != folderCmp.size())
         throw std::logic_error(std::string(__FILE__) + '[' + numberTo<std::string>(__LINE__) + "] Contract violation!");
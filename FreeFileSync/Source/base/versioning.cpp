@@ -458,9 +458,11 @@ void fff::applyVersioningLimit(const std::set<VersioningLimitFolder>& folderLimi
         callback.updateStatus(textScanning + statusLine); //throw X
     };
 
+    NamePool names; //items hold their own references => no need to outlive traversal
+
     const std::map<DirectoryKey, DirectoryValue> folderBuf = parallelDeviceTraversal(foldersToRead,
     [&](const PhaseCallback::ErrorInfo& errorInfo) { return callback.reportError(errorInfo); } /*throw X*/,
-    onStatusUpdate /*throw X*/, UI_UPDATE_INTERVAL / 2); //every ~50 ms
+    onStatusUpdate /*throw X*/, UI_UPDATE_INTERVAL / 2 /*every ~50 ms*/, names);
 
     //--------- group versions per (original) relative path ---------
     std::map<AbstractPath, VersionInfoMap> versionDetails; //versioningFolderPath => <version details>
@@ -7,6 +7,8 @@
 #include "base_tools.h"
 #include <wx/app.h>
 #include "base/path_filter.h"
+#include "afs/block_size_tuning.h"
+#include "afs/concrete.h"
 
 using namespace zen;
 using namespace fff;
@@ -79,11 +81,30 @@ void fff::logNonDefaultSettings(const XmlGlobalSettings& activeSettings, PhaseCa
     if (activeSettings.verifyFileCopy != defaultSettings.verifyFileCopy)
         changedSettingsMsg += L"\n" + (TAB_SPACE + _("Verify copied files")) + L": " + (activeSettings.verifyFileCopy ? _("Enabled") : _("Disabled"));
 
+    if (activeSettings.detectMovedFilesByContent != defaultSettings.detectMovedFilesByContent)
+        changedSettingsMsg += L"\n" + (TAB_SPACE + _("Detect moved files by content")) + L": " + (activeSettings.detectMovedFilesByContent ? _("Enabled") : _("Disabled"));
+
+    for (const BlockSizeTuningConfig& bst : activeSettings.blockSizeTuning)
+        changedSettingsMsg += L"\n" + (TAB_SPACE + _("Block size")) + L": " + utfTo<std::wstring>(bst.folderPathPhrase) +
+                              L" [" + _("Read:") + L" x" + numberTo<std::wstring>(bst.readMultiplier) + L", " + _("Written:") + L" x" + numberTo<std::wstring>(bst.writeMultiplier) + L']';
+
     if (!changedSettingsMsg.empty())
         callback.logMessage(_("Using non-default global settings:") + changedSettingsMsg, PhaseCallback::MsgType::info); //throw X
 }
 
 
+void fff::applyBlockSizeTuning(const std::vector<BlockSizeTuningConfig>& tuningCfg)
+{
+    std::vector<BlockSizeTuning> tuning;
+    for (const BlockSizeTuningConfig& bst : tuningCfg)
+        if (const AbstractPath folderPath = createAbstractPath(bst.folderPathPhrase);
+            !AFS::isNullPath(folderPath))
+            tuning.push_back({folderPath, bst.readMultiplier, bst.writeMultiplier});
+
+    setBlockSizeTuning(tuning);
+}
+
+
 namespace
 {
 FilterConfig mergeFilterConfig(const FilterConfig& global, const FilterConfig& local)
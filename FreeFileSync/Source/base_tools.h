@@ -21,6 +21,9 @@ std::wstring              toTimeShiftPhrase  (const std::vector<unsigned int>& i
 //inform about (important) non-default global settings related to comparison and synchronization
 void logNonDefaultSettings(const XmlGlobalSettings& currentSettings, PhaseCallback& callback);
 
+//resolve folder path phrases => AFS::copyFileAsStream(), zen::copyNewFile() use tuned block sizes from now on
+void applyBlockSizeTuning(const std::vector<BlockSizeTuningConfig>& tuningCfg);
+
 //facilitate drag & drop config merge:
 MainConfiguration merge(const std::vector<MainConfiguration>& mainCfgs);
 }
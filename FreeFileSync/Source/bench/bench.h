@@ -0,0 +1,139 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef BENCH_H_3801748591274039487
+#define BENCH_H_3801748591274039487
+
+#include <functional>
+#include <limits>
+#include <zen/utf.h>
+#include <zen/json.h>
+#include <zen/perf.h>
+#include <zen/sys_error.h>
+
+
+/*  ffs_bench: headless benchmarks and regression checks (not part of the release build)
+
+    ffs_bench <name> [--option value]...  => JSON results on stdout
+    ffs_bench verify                      => bit-exactness checks only; exit code != 0 on failure
+
+    Microbenchmarks compare against a copy of the previous implementation kept in the bench source
+    and verify that both produce the same results before reporting timings.                         */
+namespace fff::bench
+{
+class BenchArgs
+{
+public:
+    explicit BenchArgs(const std::vector<std::string>& args) //throw SysError
+    {
+        for (auto it = args.begin(); it != args.end(); ++it)
+        {
+            if (!zen::startsWith(*it, "--") || it + 1 == args.end())
+                throw zen::SysError(L"Invalid argument: " + zen::utfTo<std::wstring>(*it));
+            options_[it->substr(2)] = *(it + 1);
+            ++it;
+        }
+    }
+
+    std::string getString(const std::string& name, const std::string& defaultVal) const
+    {
+        auto it = options_.find(name);
+        return it != options_.end() ? it->second : defaultVal;
+    }
+
+    template <class Num>
+    Num getNumber(const std::string& name, Num defaultVal) const
+    {
+        auto it = options_.find(name);
+        return it != options_.end() ? zen::stringTo<Num>(it->second) : defaultVal;
+    }
+
+private:
+    std::map<std::string, std::string> options_;
+};
+
+
+//best of "runs": least affected by scheduling noise
+inline
+double timeBestMs(int runs, const std::function<void()>& fun)
+{
+    double bestMs = std::numeric_limits<double>::max();
+    for (int i = 0; i < runs; ++i)
+    {
+        const zen::StopWatch watch;
+        fun();
+        bestMs = std::min(bestMs, std::chrono::duration<double, std::milli>(watch.elapsed()).count());
+    }
+    return bestMs;
+}
+
+
+inline
+void setJson(zen::JsonValue& jobj, const std::string& name, zen::JsonValue&& val)
+{
+    if (jobj.type == zen::JsonValue::Type::null)
+        jobj.type = zen::JsonValue::Type::object;
+    jobj.objectVal[name] = std::move(val);
+}
+
+
+//old vs new implementation
+inline
+zen::JsonValue makeComparison(double oldMs, double newMs)
+{
+    zen::JsonValue jresult;
+    setJson(jresult, "old_ms",  zen::JsonValue(oldMs));
+    setJson(jresult, "new_ms",  zen::JsonValue(newMs));
+    setJson(jresult, "speedup", zen::JsonValue(newMs > 0 ? oldMs / newMs : 0.0));
+    return jresult;
+}
+
+
+//prevent the optimizer from discarding benchmark results
+template <class T> inline
+void doNotOptimize(const T& val) { asm volatile("" : : "g"(&val) : "memory"); }
+
+
+struct BenchCheckFailed
+{
+    std::string msg;
+};
+
+inline
+void benchCheck(bool condition, const std::string& msg) //throw BenchCheckFailed
+{
+    if (!condition)
+        throw BenchCheckFailed{msg};
+}
+
+
+//all benchmarks: throw SysError, BenchCheckFailed
+zen::JsonValue runSyncBench         (const BenchArgs& args);
+zen::JsonValue runHierarchyBench    (const BenchArgs& args);
+zen::JsonValue runNameBench         (const BenchArgs& args);
+zen::JsonValue runStringBench       (const BenchArgs& args);
+zen::JsonValue runFilterBench       (const BenchArgs& args);
+zen::JsonValue runStreamBench       (const BenchArgs& args);
+zen::JsonValue runCrcBench          (const BenchArgs& args);
+zen::JsonValue runXbrzBench         (const BenchArgs& args);
+zen::JsonValue runSortBench         (const BenchArgs& args);
+zen::JsonValue runImageCacheBench   (const BenchArgs& args);
+zen::JsonValue runErrorLogBench     (const BenchArgs& args);
+
+//regression checks: throw BenchCheckFailed
+void verifyHierarchyBench();
+void verifyNameBench();
+void verifyStringBench();
+void verifyFilterBench();
+void verifyStreamBench();
+void verifyCrcBench();
+void verifyXbrzBench();
+void verifySortBench();
+void verifyImageCacheBench();
+void verifyErrorLogBench();
+}
+
+#endif //BENCH_H_3801748591274039487
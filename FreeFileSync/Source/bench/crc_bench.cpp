@@ -0,0 +1,136 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include "bench.h"
+#include <list>
+#include <zen/crc.h>
+
+using namespace zen;
+using namespace fff;
+using namespace fff::bench;
+
+
+/*  CRC32 throughput (see zen/crc.cpp): database and lock file checksums, streamed verification via zen::Crc32
+
+    ffs_bench crc [--mb 256] [--runs 5]
+
+    old:       byte-wise table lookup (previous getCrc32())
+    slicing8:  portable path: eight table lookups per 8 bytes
+    new:       updateCrc32(): PCLMULQDQ folding on x86 (if supported) or ARMv8 CRC32 instructions, slicing-by-8 otherwise
+
+    sizes: 64 B (GUIDs, lock files), 1 kB, 64 kB, 16 MB (sync.ffs_db)  => each repeated up to "--mb" in total   */
+namespace
+{
+uint32_t updateCrc32Old(uint32_t crc, const unsigned char* p, size_t len) //previous implementation
+{
+    for (const unsigned char* const pEnd = p + len; p != pEnd; ++p)
+        crc = (crc >> 8) ^ impl::crc32Table[(crc ^ *p) & 0xFF];
+    return crc;
+}
+
+
+std::vector<unsigned char> generateBytes(size_t len)
+{
+    std::vector<unsigned char> bytes(len);
+    uint64_t rng = 0x9E3779B97F4A7C15ULL;
+    for (unsigned char& b : bytes)
+    {
+        rng ^= rng << 13; rng ^= rng >> 7; rng ^= rng << 17; //xorshift: reproducible
+        b = static_cast<unsigned char>(rng >> 56);
+    }
+    return bytes;
+}
+
+
+void verifyCrc() //throw BenchCheckFailed
+{
+    benchCheck(getCrc32(std::string_view("123456789")) == 0xCBF43926, "crc: wrong check value"); //CRC-32/ISO-HDLC
+
+    const std::vector<unsigned char> bytes = generateBytes(2000 + 16);
+
+    for (size_t align = 0; align < 16; ++align) //all alignments: unaligned loads + SIMD block/tail splits
+        for (size_t len = 0; len <= 2000; ++len)
+        {
+            const unsigned char* p = bytes.data() + align;
+            const uint32_t crcOld = updateCrc32Old(0xFFFFFFFF, p, len);
+
+            benchCheck(impl::updateCrc32        (0xFFFFFFFF, p, len) == crcOld, "crc: updateCrc32() differs from byte-wise CRC32");
+            benchCheck(impl::updateCrc32Slicing8(0xFFFFFFFF, p, len) == crcOld, "crc: slicing-by-8 differs from byte-wise CRC32");
+            benchCheck(getCrc32(p, p + len) == (crcOld ^ 0xFFFFFFFF), "crc: getCrc32() differs from byte-wise CRC32");
+        }
+
+    //non-contiguous iterators: byte-wise loop
+    const std::list<unsigned char> byteList(bytes.begin(), bytes.begin() + 1000);
+    benchCheck(getCrc32(byteList.begin(), byteList.end()) == getCrc32(bytes.data(), bytes.data() + 1000), "crc: getCrc32() differs for non-contiguous input");
+
+    //streaming: random chunking
+    const std::vector<unsigned char> stream = generateBytes(1'000'000);
+    uint64_t rng = 0x2545F4914F6CDD1DULL;
+    for (int round = 0; round < 20; ++round)
+    {
+        Crc32 crc;
+        for (size_t pos = 0; pos < stream.size();)
+        {
+            rng ^= rng << 13; rng ^= rng >> 7; rng ^= rng << 17;
+            const size_t chunkSize = std::min<size_t>(rng % (round < 10 ? 100 : 100'000), stream.size() - pos);
+            crc.update(stream.data() + pos, chunkSize);
+            pos += chunkSize;
+        }
+        benchCheck(crc.get() == getCrc32(stream.data(), stream.data() + stream.size()), "crc: Crc32 streaming differs from getCrc32()");
+    }
+}
+}
+
+
+JsonValue fff::bench::runCrcBench(const BenchArgs& args) //throw SysError, BenchCheckFailed
+{
+    const size_t totalBytes = std::max<size_t>(args.getNumber<size_t>("mb", 256), 1) * 1024 * 1024;
+    const int    runs       = args.getNumber<int>("runs", 5);
+
+    verifyCrc(); //throw BenchCheckFailed
+
+    JsonValue jresult;
+#if defined __x86_64__ || defined __i386__
+    setJson(jresult, "pclmul", JsonValue(__builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1")));
+#endif
+    for (const size_t blockSize : {64, 1024, 64 * 1024, 16 * 1024 * 1024})
+    {
+        const std::vector<unsigned char> bytes = generateBytes(blockSize);
+        const size_t repeat = std::max<size_t>(totalBytes / blockSize, 1);
+
+        auto timeCrc = [&](auto updateCrc)
+        {
+            uint32_t crcAll = 0;
+            const double ms = timeBestMs(runs, [&]
+            {
+                uint32_t crcSum = 0;
+                for (size_t i = 0; i < repeat; ++i)
+                    crcSum += updateCrc(0xFFFFFFFF, bytes.data(), blockSize);
+                doNotOptimize(crcSum);
+                crcAll = crcSum;
+            });
+            return std::pair(ms, crcAll);
+        };
+        const auto [oldMs,      crcOld     ] = timeCrc(updateCrc32Old);
+        const auto [slicing8Ms, crcSlicing8] = timeCrc([](uint32_t crc, const unsigned char* p, size_t len) { return impl::updateCrc32Slicing8(crc, p, len); });
+        const auto [newMs,      crcNew     ] = timeCrc([](uint32_t crc, const unsigned char* p, size_t len) { return impl::updateCrc32        (crc, p, len); });
+        benchCheck(crcSlicing8 == crcOld && crcNew == crcOld, "crc: checksums differ");
+
+        auto toMbPerSec = [&](double ms) { return JsonValue(static_cast<double>(repeat * blockSize) / (1024 * 1024) / (ms / 1000)); };
+
+        JsonValue jsize = makeComparison(oldMs, newMs);
+        setJson(jsize, "slicing8_ms",      JsonValue(slicing8Ms));
+        setJson(jsize, "slicing8_speedup", JsonValue(slicing8Ms > 0 ? oldMs / slicing8Ms : 0.0));
+        setJson(jsize, "old_mb_per_s",      toMbPerSec(oldMs));
+        setJson(jsize, "slicing8_mb_per_s", toMbPerSec(slicing8Ms));
+        setJson(jsize, "new_mb_per_s",      toMbPerSec(newMs));
+        setJson(jresult, "block_" + numberTo<std::string>(blockSize), std::move(jsize));
+    }
+    return jresult;
+}
+
+
+void fff::bench::verifyCrcBench() { verifyCrc(); } //throw BenchCheckFailed
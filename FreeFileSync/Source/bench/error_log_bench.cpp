@@ -0,0 +1,324 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include "bench.h"
+#include <unordered_map>
+#include <zen/file_access.h>
+#include <zen/file_traverser.h>
+#include "../afs/native.h"
+#include "../afs/io_metrics.h"
+#include "../log_file.h"
+    #include <malloc.h>
+
+using namespace zen;
+using namespace fff;
+using namespace fff::bench;
+
+
+/*  ErrorLog memory per entry (see zen/error_log.h) and batch mode log spooling (see LogSpool in log_file.h)
+
+    ffs_bench errorlog [--entries 1000000] [--runs 3]
+
+    old:  std::vector<LogEntry>: one heap-allocated string per entry (before columnar storage)
+    prev: columnar arrays + message arena, deduplication via std::unordered_map<std::string_view, uint32_t>
+    new:  columnar arrays + message arena, deduplication via open-addressed table of message ids
+
+    unique:    all message texts differ (e.g. one error per file)
+    templates: 20 distinct message texts (e.g. retries, repeated warnings)
+    bytes_per_entry: heap growth (mallinfo2) divided by entries
+    push: ErrorLog::push_back() of all entries; push_prev_ms: previous deduplication
+    spool_heap_bytes: heap growth after LogSpool::push_back() of all entries: bounded, entries are on disk
+    save_log: write text log file from ErrorLog (old) vs from LogSpool (new)                                */
+namespace
+{
+//=========================== previous implementations ===========================
+struct LogEntryOld
+{
+    time_t      time = 0;
+    MessageType type = MSG_TYPE_ERROR;
+    Zstringc message;
+};
+using ErrorLogOld = std::vector<LogEntryOld>;
+
+
+class ErrorLogPrev
+{
+public:
+    void push_back(const LogEntry& entry)
+    {
+        times_ .push_back(entry.time);
+        types_ .push_back(static_cast<uint8_t>(entry.type));
+        msgIds_.push_back(internMessage(entry.message));
+    }
+
+private:
+    uint32_t internMessage(std::string_view msg)
+    {
+        if (auto it = msgIdByText_.find(msg);
+            it != msgIdByText_.end())
+            return it->second;
+
+        char* msgStored = nullptr;
+        if (msg.empty())
+            ;
+        else if (msg.size() > ARENA_CHUNK_SIZE / 4)
+            msgStored = msgArena_.insert(msgArena_.empty() ? msgArena_.end() : msgArena_.end() - 1, std::make_unique<char[]>(msg.size()))->get();
+        else
+        {
+            if (ARENA_CHUNK_SIZE - msgArenaChunkUsed_ < msg.size())
+            {
+                msgArena_.push_back(std::make_unique<char[]>(ARENA_CHUNK_SIZE));
+                msgArenaChunkUsed_ = 0;
+            }
+            msgStored = msgArena_.back().get() + msgArenaChunkUsed_;
+            msgArenaChunkUsed_ += msg.size();
+        }
+        if (msgStored)
+            std::memcpy(msgStored, msg.data(), msg.size());
+
+        const uint32_t msgId = static_cast<uint32_t>(messages_.size());
+        messages_.emplace_back(msgStored, msg.size());
+        msgIdByText_.emplace(messages_.back(), msgId);
+        return msgId;
+    }
+
+    std::vector<time_t>   times_;
+    std::vector<uint8_t>  types_;
+    std::vector<uint32_t> msgIds_;
+
+    std::vector<std::string_view> messages_;
+    std::unordered_map<std::string_view, uint32_t> msgIdByText_;
+
+    static constexpr size_t ARENA_CHUNK_SIZE = 64 * 1024;
+    std::vector<std::unique_ptr<char[]>> msgArena_;
+    size_t msgArenaChunkUsed_ = ARENA_CHUNK_SIZE;
+};
+//===============================================================================
+
+int64_t getHeapBytes()
+{
+    const struct mallinfo2 mi = ::mallinfo2();
+    return static_cast<int64_t>(mi.uordblks + mi.hblkhd); //large vectors are mmap()ed
+}
+
+
+//"Cannot copy file..." with file path: unique per entry, or one of "templateCount" texts
+std::vector<LogEntry> generateEntries(size_t entryCount, size_t templateCount /*0: all unique*/, uint64_t seed, std::vector<std::string>& msgBuf)
+{
+    uint64_t rng = seed;
+    auto random = [&](size_t count) { rng ^= rng << 13; rng ^= rng >> 7; rng ^= rng << 17; return static_cast<size_t>(rng % count); }; //xorshift: reproducible
+
+    const size_t msgCount = templateCount == 0 ? entryCount : templateCount;
+    msgBuf.clear();
+    msgBuf.reserve(msgCount);
+    for (size_t i = 0; i < msgCount; ++i)
+        msgBuf.push_back("Cannot copy file \"/home/user/Documents/folder" + numberTo<std::string>(random(1000)) +
+                         "/file" + numberTo<std::string>(i) + ".txt\".\n\nEACCES: Permission denied [open]");
+
+    std::vector<LogEntry> entries;
+    entries.reserve(entryCount);
+    for (size_t i = 0; i < entryCount; ++i)
+        entries.push_back({static_cast<time_t>(1'700'000'000 + i / 100),
+                           i % 7 == 0 ? MSG_TYPE_INFO : i % 3 == 0 ? MSG_TYPE_WARNING : MSG_TYPE_ERROR,
+                           msgBuf[templateCount == 0 ? i : random(templateCount)]});
+    return entries;
+}
+
+
+bool equalEntry(const LogEntry& lhs, const LogEntry& rhs)
+{
+    return lhs.time == rhs.time && lhs.type == rhs.type && lhs.message == rhs.message;
+}
+
+
+//create + clean up temporary folder
+template <class Function>
+void withTempFolder(Function fun) //throw FileError, BenchCheckFailed
+{
+    const Zstring folderPath = appendPath(getTempFolderPath(), Zstr("ffs_bench_") + numberTo<Zstring>(::getpid())); //throw FileError
+    createDirectoryIfMissingRecursion(folderPath); //throw FileError
+    ZEN_ON_SCOPE_EXIT(try { removeDirectoryPlainRecursion(folderPath); } catch (FileError&) {});
+
+    fun(folderPath);
+}
+
+
+std::vector<Zstring> getFileNames(const Zstring& folderPath)
+{
+    std::vector<Zstring> fileNames;
+    traverseFolder(folderPath, [&](const FileInfo& fi) { fileNames.push_back(fi.itemName); }, nullptr, nullptr); //throw FileError
+    return fileNames;
+}
+
+
+std::string saveLogAndRead(const Zstring& filePath, const ProcessSummary& summary, const auto& log, LogFileFormat logFormat) //throw FileError
+{
+    resetIoMetrics(); //log file footer must not depend on previous benchmark I/O
+    saveLogFile(createItemPathNative(filePath), summary, log, 0 /*logfilesMaxAgeDays*/, logFormat, {} /*logFilePathsToKeep*/, nullptr /*notifyStatus*/); //throw FileError
+    std::string content = getFileContent(filePath, nullptr /*notifyUnbufferedIO*/); //throw FileError
+    removeFilePlain(filePath); //throw FileError
+    return content;
+}
+
+
+void verifyErrorLog() //throw BenchCheckFailed
+{
+    std::vector<std::string> msgBuf;
+    std::vector<LogEntry> entries = generateEntries(20'000, 0, 1, msgBuf); //=> several rehashes
+    std::vector<std::string> msgBuf2;
+    for (const LogEntry& entry : generateEntries(20'000, 50, 2, msgBuf2))
+        entries.push_back(entry);
+
+    const std::string bigMsg(100'000, 'x'); //outlier: dedicated arena chunk
+    entries.push_back({1, MSG_TYPE_ERROR, bigMsg});
+    entries.push_back({2, MSG_TYPE_INFO, ""});
+    entries.push_back({0, MSG_TYPE_WARNING, bigMsg});
+    entries.push_back({3, MSG_TYPE_INFO, ""});
+
+    ErrorLog log;
+    for (const LogEntry& entry : entries)
+        log.push_back(entry);
+
+    auto equalLog = [&](const ErrorLog& log2, const std::vector<LogEntry>& ref)
+    {
+        return log2.size() == ref.size() && std::equal(log2.begin(), log2.end(), ref.begin(), equalEntry);
+    };
+    benchCheck(equalLog(log, entries), "errorlog: entries differ after push_back()");
+
+    ErrorLog logCopy = log;
+    ErrorLog logMoved = std::move(logCopy);
+    benchCheck(equalLog(logMoved, entries), "errorlog: entries differ after copy/move");
+
+    const ErrorLogStats stats = getStats(log);
+    benchCheck(stats.info    == std::count_if(entries.begin(), entries.end(), [](const LogEntry& e) { return e.type == MSG_TYPE_INFO;    }) &&
+               stats.warning == std::count_if(entries.begin(), entries.end(), [](const LogEntry& e) { return e.type == MSG_TYPE_WARNING; }) &&
+               stats.error   == std::count_if(entries.begin(), entries.end(), [](const LogEntry& e) { return e.type == MSG_TYPE_ERROR;   }), "errorlog: wrong statistics");
+
+    std::vector<LogEntry> entriesSorted = entries;
+    std::stable_sort(entriesSorted.begin(), entriesSorted.end(), [](const LogEntry& lhs, const LogEntry& rhs) { return lhs.time < rhs.time; });
+    log.sortByTime();
+    benchCheck(equalLog(log, entriesSorted), "errorlog: sortByTime() differs from std::stable_sort()");
+}
+
+
+void verifyLogSpool(const Zstring& folderPath) //throw FileError, BenchCheckFailed
+{
+    std::vector<std::string> msgBuf;
+    const std::vector<LogEntry> entries = generateEntries(150'000, 0, 3, msgBuf); //more than kept in memory
+
+    const ProcessSummary summary{std::chrono::system_clock::from_time_t(1'700'000'000), TaskResult::error, {L"Bench"}};
+
+    ErrorLog log;
+    for (const LogEntry& entry : entries)
+        log.push_back(entry);
+
+    for (const size_t entryCount : {size_t(0), size_t(1), size_t(1000), entries.size()})
+    {
+        ErrorLog logRef;
+        std::for_each(entries.begin(), entries.begin() + entryCount, [&](const LogEntry& entry) { logRef.push_back(entry); });
+        {
+            LogSpool logSpool(folderPath, {L"Bench"}, std::chrono::system_clock::now());
+            benchCheck(getFileNames(folderPath).size() == 1 && endsWith(getFileNames(folderPath)[0], Zstr(".spool")), "errorlog: spool file not created");
+
+            logSpool.append(logRef);
+            benchCheck(logSpool.size() == entryCount, "errorlog: wrong spool size");
+
+            size_t i = 0;
+            bool equalEntries = true;
+            logSpool.forEachEntry([&](const LogEntry& entry) { equalEntries &= i < entryCount && equalEntry(entry, entries[i++]); }); //throw FileError
+            benchCheck(equalEntries && i == entryCount, "errorlog: spooled entries differ");
+
+            const ErrorLogStats stats = getStats(logRef);
+            benchCheck(logSpool.getStats().info    == stats.info &&
+                       logSpool.getStats().warning == stats.warning &&
+                       logSpool.getStats().error   == stats.error, "errorlog: wrong spool statistics");
+            benchCheck(entryCount < 150'000 ? logSpool.getLog().ref().size() == entryCount :
+                       logSpool.getLog().ref().size() < entryCount, "errorlog: in-memory entries not bounded");
+
+            for (const LogFileFormat logFormat : {LogFileFormat::text, LogFileFormat::html})
+                benchCheck(saveLogAndRead(appendPath(folderPath, Zstr("log_old.txt")), summary, logRef,   logFormat) ==
+                           saveLogAndRead(appendPath(folderPath, Zstr("log_new.txt")), summary, logSpool, logFormat), //throw FileError
+                           "errorlog: log file from LogSpool differs");
+        }
+        benchCheck(getFileNames(folderPath).empty(), "errorlog: spool file not removed");
+    }
+}
+}
+
+
+JsonValue fff::bench::runErrorLogBench(const BenchArgs& args) //throw SysError, BenchCheckFailed
+{
+    const size_t entryCount = std::max<size_t>(args.getNumber<size_t>("entries", 1'000'000), 1);
+    const int    runs       = args.getNumber<int>("runs", 3);
+
+    JsonValue jresult;
+    try
+    {
+        withTempFolder([&](const Zstring& folderPath) //throw FileError, BenchCheckFailed
+        {
+            verifyErrorLog(); //throw BenchCheckFailed
+            verifyLogSpool(folderPath); //throw FileError, BenchCheckFailed
+
+            setJson(jresult, "entries", JsonValue(static_cast<int64_t>(entryCount)));
+
+            auto measureLog = [&](const std::vector<LogEntry>& entries)
+            {
+                auto bytesPerEntry = [&](auto pushAll)
+                {
+                    const int64_t heapBefore = getHeapBytes();
+                    auto log = pushAll();
+                    return JsonValue(static_cast<double>(getHeapBytes() - heapBefore) / entries.size());
+                };
+                auto pushOld  = [&] { ErrorLogOld  log; for (const LogEntry& e : entries) log.push_back({e.time, e.type, Zstringc(e.message)}); return log; };
+                auto pushPrev = [&] { ErrorLogPrev log; for (const LogEntry& e : entries) log.push_back(e); return log; };
+                auto pushNew  = [&] { ErrorLog     log; for (const LogEntry& e : entries) log.push_back(e); return log; };
+
+                JsonValue jbytes;
+                setJson(jbytes, "old",  bytesPerEntry(pushOld));
+                setJson(jbytes, "prev", bytesPerEntry(pushPrev));
+                setJson(jbytes, "new",  bytesPerEntry(pushNew));
+
+                JsonValue jlog;
+                setJson(jlog, "bytes_per_entry", std::move(jbytes));
+                setJson(jlog, "push", makeComparison(timeBestMs(runs, [&] { doNotOptimize(pushOld()); }),
+                                                     timeBestMs(runs, [&] { doNotOptimize(pushNew()); })));
+                setJson(jlog, "push_prev_ms", JsonValue(timeBestMs(runs, [&] { doNotOptimize(pushPrev()); })));
+                return jlog;
+            };
+            std::vector<std::string> msgBuf;
+            setJson(jresult, "unique",    measureLog(generateEntries(entryCount, 0,  42, msgBuf)));
+            setJson(jresult, "templates", measureLog(generateEntries(entryCount, 20, 42, msgBuf)));
+
+            //------------------------------------------------------------------
+            const std::vector<LogEntry> entries = generateEntries(entryCount, 0, 42, msgBuf);
+            const ProcessSummary summary{std::chrono::system_clock::from_time_t(1'700'000'000), TaskResult::error, {L"Bench"}};
+            const Zstring logFilePath = appendPath(folderPath, Zstr("bench.log"));
+
+            ErrorLog log;
+            for (const LogEntry& entry : entries)
+                log.push_back(entry);
+
+            const int64_t heapBefore = getHeapBytes();
+            LogSpool logSpool(folderPath, {L"Bench"}, std::chrono::system_clock::now());
+            const double spoolMs = timeBestMs(1, [&] { logSpool.append(log); });
+            setJson(jresult, "spool_heap_bytes", JsonValue(getHeapBytes() - heapBefore));
+            setJson(jresult, "spool_ms", JsonValue(spoolMs));
+
+            setJson(jresult, "save_log", makeComparison(timeBestMs(runs, [&] { saveLogAndRead(logFilePath, summary, log,      LogFileFormat::text); }), //throw FileError
+                                                        timeBestMs(runs, [&] { saveLogAndRead(logFilePath, summary, logSpool, LogFileFormat::text); })));
+        });
+    }
+    catch (const FileError& e) { throw SysError(e.toString()); }
+    return jresult;
+}
+
+
+void fff::bench::verifyErrorLogBench() //throw BenchCheckFailed
+{
+    verifyErrorLog(); //throw BenchCheckFailed
+    try { withTempFolder(verifyLogSpool); } //throw FileError, BenchCheckFailed
+    catch (const FileError& e) { throw BenchCheckFailed{utfTo<std::string>(e.toString())}; }
+}
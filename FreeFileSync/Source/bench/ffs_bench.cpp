@@ -0,0 +1,100 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include "bench.h"
+#include <iostream>
+#include "../afs/concrete.h"
+#include "../ffs_paths.h"
+
+using namespace zen;
+using namespace fff;
+using namespace fff::bench;
+
+
+namespace
+{
+struct BenchEntry
+{
+    const char* name;
+    JsonValue (*run)(const BenchArgs& args); //throw SysError, BenchCheckFailed
+    void (*verify)(); //throw BenchCheckFailed; optional: regression check without timing
+};
+
+const BenchEntry benchmarks[] =
+{
+    {"sync",        runSyncBench,       nullptr},
+    {"hierarchy",   runHierarchyBench,  verifyHierarchyBench},
+    {"names",       runNameBench,       verifyNameBench},
+    {"strings",     runStringBench,     verifyStringBench},
+    {"filter",      runFilterBench,     verifyFilterBench},
+    {"stream",      runStreamBench,     verifyStreamBench},
+    {"crc",         runCrcBench,        verifyCrcBench},
+    {"xbrz",        runXbrzBench,       verifyXbrzBench},
+    {"sort",        runSortBench,       verifySortBench},
+    {"image_cache", runImageCacheBench, verifyImageCacheBench},
+    {"errorlog",    runErrorLogBench,   verifyErrorLogBench},
+};
+
+
+int showUsage()
+{
+    std::cerr << "Usage: ffs_bench <benchmark> [--option value]...\n"
+              "       ffs_bench verify\n\nBenchmarks:";
+    for (const BenchEntry& entry : benchmarks)
+        std::cerr << ' ' << entry.name;
+    std::cerr << '\n';
+    return 2;
+}
+}
+
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+        return showUsage();
+
+    const std::string benchName = argv[1];
+    const std::vector<std::string> args(argv + 2, argv + argc);
+
+    initAfs({getResourceDirPath(), getConfigDirPath()});
+    ZEN_ON_SCOPE_EXIT(teardownAfs());
+    try
+    {
+        const BenchArgs benchArgs(args); //throw SysError
+
+        if (benchName == "verify")
+        {
+            for (const BenchEntry& entry : benchmarks)
+                if (entry.verify)
+                {
+                    std::cerr << "Verifying " << entry.name << "...\n";
+                    entry.verify(); //throw BenchCheckFailed
+                }
+            std::cout << "All checks passed.\n";
+            return 0;
+        }
+
+        JsonValue jresults;
+        for (const BenchEntry& entry : benchmarks)
+            if (benchName == entry.name)
+                setJson(jresults, entry.name, entry.run(benchArgs)); //throw SysError, BenchCheckFailed
+
+        if (jresults.type == JsonValue::Type::null)
+            return showUsage();
+
+        std::cout << serializeJson(jresults) << '\n';
+        return 0;
+    }
+    catch (const SysError& e)
+    {
+        std::cerr << utfTo<std::string>(e.toString()) << '\n';
+    }
+    catch (const BenchCheckFailed& e)
+    {
+        std::cerr << "CHECK FAILED: " << e.msg << '\n';
+    }
+    return 1;
+}
@@ -0,0 +1,276 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include "bench.h"
+#include "../afs/native.h"
+#include "../ui/file_view_sort.h"
+
+using namespace zen;
+using namespace fff;
+using namespace fff::bench;
+
+
+/*  FileView: sort rows by relative/full path (see ui/file_view_sort.h)
+
+    ffs_bench sort [--files 1000000] [--fanout 20] [--runs 5]
+
+    old: component-wise comparison: dynamic_cast + parent chain walk per comparison (previous lessFilePath())
+    new: precomputed key per row: folder rank of a depth-first traversal + item name
+
+    rows: hierarchy order shuffled, two folder pairs; path_asc/path_desc: left side, ascending/descending    */
+namespace
+{
+//=========================== previous implementation ===========================
+template <bool ascending, SelectSide side> inline
+bool lessFilePathOld(const FileSystemObject& fsObjL, const FileSystemObject& fsObjR, std::vector<const FolderPair*>& tempBuf)
+{
+    //------- sort component-wise ----------
+    const auto folderL = dynamic_cast<const FolderPair*>(&fsObjL);
+    const auto folderR = dynamic_cast<const FolderPair*>(&fsObjR);
+
+    std::vector<const FolderPair*>& parentsBuf = tempBuf; //from bottom to top of hierarchy, excluding base
+    parentsBuf.clear();
+
+    const auto collectParents = [&](const FileSystemObject* fsObj)
+    {
+        for (;;)
+            if (const auto folder = dynamic_cast<const FolderPair*>(&fsObj->parent())) //perf: most expensive part of this function!
+            {
+                parentsBuf.push_back(folder);
+                fsObj = folder;
+            }
+            else
+                break;
+    };
+    if (folderL)
+        parentsBuf.push_back(folderL);
+    collectParents(&fsObjL);
+    const size_t parentsSizeL = parentsBuf.size();
+
+    if (folderR)
+        parentsBuf.push_back(folderR);
+    collectParents(&fsObjR);
+
+    const std::span<const FolderPair*> parentsL(parentsBuf.data(), parentsSizeL);
+    const std::span<const FolderPair*> parentsR(parentsBuf.data() + parentsSizeL, parentsBuf.size() - parentsSizeL);
+
+    const auto& [itL, itR] = std::mismatch(parentsL.rbegin(), parentsL.rend(),
+                                           parentsR.rbegin(), parentsR.rend());
+    if (itL == parentsL.rend())
+    {
+        if (itR == parentsR.rend())
+        {
+            //make folders always appear before contained files
+            if (folderR)
+                return false;
+            else if (folderL)
+                return true;
+
+            return zen::makeSortDirection(LessNaturalSort(), std::bool_constant<ascending>())(fsObjL.getItemName<side>(), fsObjR.getItemName<side>());
+        }
+        else
+            return true;
+    }
+    else if (itR == parentsR.rend())
+        return false;
+
+    //different components...
+    if (const std::weak_ordering cmp = compareNatural((*itL)->getItemName<side>(), (*itR)->getItemName<side>());
+        cmp != std::weak_ordering::equivalent)
+    {
+        if constexpr (ascending)
+            return std::is_lt(cmp);
+        else
+            return std::is_gt(cmp);
+    }
+    return *itL < *itR;
+}
+
+
+struct PathSortValueOld
+{
+    size_t basePos = 0; //position of folder pair
+    const FileSystemObject* fsObj = nullptr;
+};
+
+
+template <bool ascending, SelectSide side>
+struct LessFilePathOld
+{
+    bool operator()(const PathSortValueOld& lhs, const PathSortValueOld& rhs) const
+    {
+        //------- presort by folder pair ----------
+        if (lhs.basePos != rhs.basePos)
+            return zen::makeSortDirection(std::less(), std::bool_constant<ascending>())(lhs.basePos, rhs.basePos);
+
+        return lessFilePathOld<ascending, side>(*lhs.fsObj, *rhs.fsObj, tempBuf_);
+    }
+
+private:
+    mutable std::vector<const FolderPair*> tempBuf_; //avoid repeated memory allocation in lessFilePath()
+};
+
+
+template <bool ascending, SelectSide side>
+void sortByFilePathOld(std::vector<FileSystemObject::ObjectId>& rows, const std::unordered_map<const void* /*BaseFolderPair*/, size_t /*position*/>& basePositions)
+{
+    sortByKey<false /*stable*/>(rows, [&](const FileSystemObject& fsObj)
+    {
+        auto it = basePositions.find(&fsObj.base());
+        if (it == basePositions.end()) //invalid rows shall appear at the end
+            return std::pair(RANK_INVALID, PathSortValueOld());
+
+        return std::pair(0, PathSortValueOld{it->second, &fsObj});
+    },
+    LessFilePathOld<ascending, side>());
+}
+//===============================================================================
+
+struct Hierarchy
+{
+    std::vector<SharedRef<BaseFolderPair>> baseFolders;
+    std::unordered_map<const void* /*BaseFolderPair*/, size_t /*position*/> basePositions;
+    std::vector<FileSystemObject::ObjectId> rows; //hierarchy order, shuffled
+};
+
+
+/*  - "fanout" files + symlinks and up to "fanout / 4" sub folders per folder, up to 6 levels deep
+    - names with small alphabet: equivalent names (differing case), numbers for natural sort order, one-sided items   */
+Hierarchy createHierarchy(size_t fileCount, size_t fanout, uint64_t seed)
+{
+    Hierarchy hierarchy;
+    uint64_t rng = seed;
+    auto random = [&](size_t count) { rng ^= rng << 13; rng ^= rng >> 7; rng ^= rng << 17; return static_cast<size_t>(rng % count); }; //xorshift: reproducible
+
+    auto makeName = [&](const Zstring& prefix)
+    {
+        const Zstring name = prefix + numberTo<Zstring>(random(fanout * 2));
+        return random(4) == 0 ? getUpperCase(name) : name;
+    };
+    const FileAttributes attr{.modTime = 1'000'000'000, .fileSize = 4096};
+
+    size_t filesLeft = fileCount;
+    auto fillFolder = [&](ContainerObject& conObj, int depth, auto& fillFolderRec) -> void
+    {
+        for (size_t i = random(fanout) + 1; i > 0 && filesLeft > 0; --i, --filesLeft)
+            switch (random(8))
+            {
+                case 0:  conObj.addFile<SelectSide::left >(makeName(Zstr("file")), attr); break;
+                case 1:  conObj.addFile<SelectSide::right>(makeName(Zstr("file")), attr); break;
+                case 2:  conObj.addLink<SelectSide::left >(makeName(Zstr("link")), LinkAttributes()); break;
+                default: { const Zstring name = makeName(Zstr("file")); conObj.addFile(name, attr, name, attr); } break;
+            }
+
+        if (depth < 6)
+            for (size_t i = random(fanout / 4 + 1) + (depth == 0 ? 1 : 0); i > 0 && filesLeft > 0; --i)
+            {
+                const Zstring name = makeName(Zstr("folder"));
+                FolderPair& folder = random(6) == 0 ?
+                                     conObj.addFolder<SelectSide::left>(name, FolderAttributes()) :
+                                     conObj.addFolder(name, FolderAttributes(), name, FolderAttributes());
+                fillFolderRec(folder, depth + 1, fillFolderRec);
+            }
+    };
+
+    for (size_t basePos = 0; basePos < 2; ++basePos)
+    {
+        auto baseFolder = makeSharedRef<BaseFolderPair>(createItemPathNative(Zstr("/left")  + numberTo<Zstring>(basePos)), BaseFolderStatus::existing,
+                                                        createItemPathNative(Zstr("/right") + numberTo<Zstring>(basePos)), BaseFolderStatus::existing,
+                                                        makeSharedRef<NullFilter>(), CompareVariant::timeSize, 2, std::vector<unsigned int>(), false);
+        filesLeft = fileCount / 2 + (basePos == 0 ? fileCount % 2 : 0);
+        while (filesLeft > 0)
+            fillFolder(baseFolder.ref(), 0, fillFolder);
+
+        auto onFsItem = [&](FileSystemObject& fsObj) { hierarchy.rows.push_back(fsObj.getId()); };
+        visitFSObjectRecursively(baseFolder.ref(), onFsItem, onFsItem, onFsItem);
+
+        hierarchy.basePositions.emplace(&baseFolder.ref(), basePos);
+        hierarchy.baseFolders.push_back(baseFolder);
+    }
+
+    for (size_t i = hierarchy.rows.size(); i > 1; --i) //Fisher-Yates
+        std::swap(hierarchy.rows[i - 1], hierarchy.rows[random(i)]);
+    return hierarchy;
+}
+
+
+template <bool ascending, SelectSide side>
+void verifySortByFilePath(const Hierarchy& hierarchy) //throw BenchCheckFailed
+{
+    std::vector<FileSystemObject::ObjectId> rowsOld = hierarchy.rows;
+    std::vector<FileSystemObject::ObjectId> rowsNew = hierarchy.rows;
+    sortByFilePathOld<ascending, side>(rowsOld, hierarchy.basePositions);
+    sortByFilePath   <ascending, side>(rowsNew, hierarchy.basePositions);
+
+    //unstable sort: files with equivalent names may be swapped => new order must be sorted according to previous comparator
+    std::vector<FileSystemObject::ObjectId> rowsOldSorted = rowsOld;
+    std::vector<FileSystemObject::ObjectId> rowsNewSorted = rowsNew;
+    std::sort(rowsOldSorted.begin(), rowsOldSorted.end());
+    std::sort(rowsNewSorted.begin(), rowsNewSorted.end());
+    benchCheck(rowsNewSorted == rowsOldSorted, "sort: rows lost or duplicated");
+
+    const LessFilePathOld<ascending, side> lessOld;
+    for (size_t i = 1; i < rowsNew.size(); ++i)
+    {
+        const FileSystemObject& fsObjPrev = *FileSystemObject::retrieve(rowsNew[i - 1]);
+        const FileSystemObject& fsObj     = *FileSystemObject::retrieve(rowsNew[i]);
+
+        benchCheck(!lessOld(PathSortValueOld{hierarchy.basePositions.find(&fsObj    .base())->second, &fsObj},
+                            PathSortValueOld{hierarchy.basePositions.find(&fsObjPrev.base())->second, &fsObjPrev}),
+                   "sort: path order differs from component-wise comparison");
+    }
+}
+
+
+void verifySort() //throw BenchCheckFailed
+{
+    for (const size_t fanout : {1, 3, 8})
+        for (const size_t fileCount : {0, 1, 50, 5000})
+        {
+            const Hierarchy hierarchy = createHierarchy(fileCount, fanout, 0x9E3779B97F4A7C15ULL + fileCount * fanout);
+
+            verifySortByFilePath<true,  SelectSide::left >(hierarchy);
+            verifySortByFilePath<false, SelectSide::left >(hierarchy);
+            verifySortByFilePath<true,  SelectSide::right>(hierarchy);
+            verifySortByFilePath<false, SelectSide::right>(hierarchy);
+        }
+}
+}
+
+
+JsonValue fff::bench::runSortBench(const BenchArgs& args) //throw SysError, BenchCheckFailed
+{
+    const size_t fileCount = args.getNumber<size_t>("files", 1'000'000);
+    const size_t fanout    = std::max<size_t>(args.getNumber<size_t>("fanout", 20), 1);
+    const int    runs      = args.getNumber<int>("runs", 5);
+
+    verifySort(); //throw BenchCheckFailed
+
+    const Hierarchy hierarchy = createHierarchy(fileCount, fanout, 42);
+
+    auto timeSort = [&](auto sortRows)
+    {
+        return timeBestMs(runs, [&]
+        {
+            std::vector<FileSystemObject::ObjectId> rows = hierarchy.rows;
+            sortRows(rows, hierarchy.basePositions);
+            doNotOptimize(rows);
+        });
+    };
+
+    JsonValue jresult;
+    setJson(jresult, "rows",    JsonValue(static_cast<int64_t>(hierarchy.rows.size())));
+    setJson(jresult, "threads", JsonValue(static_cast<int64_t>(getSortThreadCount(hierarchy.rows.size()))));
+
+    setJson(jresult, "path_asc",  makeComparison(timeSort(sortByFilePathOld<true,  SelectSide::left>),
+                                                 timeSort(sortByFilePath   <true,  SelectSide::left>)));
+    setJson(jresult, "path_desc", makeComparison(timeSort(sortByFilePathOld<false, SelectSide::left>),
+                                                 timeSort(sortByFilePath   <false, SelectSide::left>)));
+    return jresult;
+}
+
+
+void fff::bench::verifySortBench() { verifySort(); } //throw BenchCheckFailed
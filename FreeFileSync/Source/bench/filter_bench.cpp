@@ -0,0 +1,377 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include "bench.h"
+#include "../base/path_filter.h"
+#include <zen/file_path.h>
+
+using namespace zen;
+using namespace fff;
+using namespace fff::bench;
+
+
+/*  NameFilter matching (see MaskMatcher in path_filter.cpp):
+
+    ffs_bench filter [--masks 300] [--paths 200000] [--runs 5]
+
+    old: one backtracking matchesMask() call per wildcard mask + linear scan of literal paths for matchesBegin() (previous implementation)
+    new: wildcard masks combined into DFAs: single pass over the path per group of masks
+
+    - compile:  NameFilter construction incl. DFA compilation (new only)
+    - match:    passFileFilter() + passDirFilter() incl. "childItemMightMatch" for every path
+    - masks: "--masks" random exclude masks: extensions, folder names, paths with '?'/'*', literal paths, file/folder-only tags  */
+namespace
+{
+//=========================== previous implementation ===========================
+bool matchesMaskOld(const Zchar* path, const Zchar* const pathEnd, const Zchar* mask /*0-terminated*/)
+{
+    for (;; ++mask, ++path)
+    {
+        Zchar m = *mask;
+        switch (m)
+        {
+            case 0:
+                return path == pathEnd || *path == FILE_NAME_SEPARATOR;
+
+            case Zstr('?'):
+                if (path == pathEnd || *path == FILE_NAME_SEPARATOR)
+                    return false;
+                break;
+
+            case Zstr('*'):
+                do
+                {
+                    m = *++mask;
+                }
+                while (m == Zstr('*'));
+
+                if (m == 0)
+                    return true;
+
+                ++mask;
+                if (m == Zstr('?'))
+                {
+                    while (path != pathEnd)
+                        if (*path++ != FILE_NAME_SEPARATOR)
+                            if (matchesMaskOld(path, pathEnd, mask))
+                                return true;
+                }
+                else
+                    while (path != pathEnd)
+                        if (*path++ == m)
+                            if (matchesMaskOld(path, pathEnd, mask))
+                                return true;
+                return false;
+
+            default:
+                if (path == pathEnd || *path != m)
+                    return false;
+        }
+    }
+}
+
+
+bool matchesMaskBeginOld(const ZstringView relPath, const Zstring& mask)
+{
+    auto itP = relPath.begin();
+    for (auto itM = mask.begin(); itM != mask.end(); ++itM, ++itP)
+    {
+        const Zchar m = *itM;
+        switch (m)
+        {
+            case Zstr('?'):
+                if (itP == relPath.end() || *itP == FILE_NAME_SEPARATOR)
+                    return false;
+                break;
+
+            case Zstr('*'):
+                return true;
+
+            default:
+                if (itP == relPath.end())
+                    return m == FILE_NAME_SEPARATOR && mask.end() - itM > 1;
+
+                if (*itP != m)
+                    return false;
+        }
+    }
+    return false;
+}
+
+
+class MaskMatcherOld
+{
+public:
+    void insert(const Zstring& mask)
+    {
+        if (mask.empty())
+            return;
+
+        if (contains(mask, Zstr('?')) ||
+            contains(mask, Zstr('*')))
+            realMasks_.insert(mask);
+        else
+            relPaths_.insert(mask);
+    }
+
+    bool matches(const ZstringView relPath) const
+    {
+        if (std::any_of(realMasks_.begin(), realMasks_.end(), [&](const Zstring& mask) { return matchesMaskOld(relPath.data(), relPath.data() + relPath.size(), mask.c_str()); }))
+            return true;
+
+        for (ZstringView parentPath = relPath; !parentPath.empty(); parentPath = beforeLast(parentPath, FILE_NAME_SEPARATOR, IfNotFoundReturn::none))
+            if (relPaths_.contains(parentPath))
+                return true;
+        return false;
+    }
+
+    bool matchesBegin(const ZstringView relPath) const
+    {
+        return std::any_of(realMasks_.begin(), realMasks_.end(), [&](const Zstring& mask) { return matchesMaskBeginOld(relPath, mask); }) ||
+               std::any_of(relPaths_ .begin(), relPaths_ .end(), [&](const Zstring& mask)
+        {
+            return mask.size() > relPath.size() + 1 && mask[relPath.size()] == FILE_NAME_SEPARATOR && startsWith(mask, relPath);
+        });
+    }
+
+private:
+    std::set<Zstring> realMasks_;
+    std::unordered_set<Zstring, StringHash, StringEqual> relPaths_;
+};
+
+
+class NameFilterOld
+{
+public:
+    NameFilterOld(const Zstring& includePhrase, const Zstring& excludePhrase)
+    {
+        parseFilterPhrase(includePhrase, include_);
+        parseFilterPhrase(excludePhrase, exclude_);
+    }
+
+    bool passFileFilter(const Zstring& relFilePath) const
+    {
+        const Zstring& pathFmt = getUpperCase(relFilePath);
+        const ZstringView parentPath = beforeLast<ZstringView>(pathFmt, FILE_NAME_SEPARATOR, IfNotFoundReturn::none);
+
+        if (exclude_.fileMasks.matches(pathFmt) ||
+            (!parentPath.empty() && exclude_.folderMasks.matches(parentPath)))
+            return false;
+
+        return include_.fileMasks.matches(pathFmt) ||
+               (!parentPath.empty() && include_.folderMasks.matches(parentPath));
+    }
+
+    bool passDirFilter(const Zstring& relDirPath, bool* childItemMightMatch) const
+    {
+        const Zstring& pathFmt = getUpperCase(relDirPath);
+
+        if (exclude_.folderMasks.matches(pathFmt))
+        {
+            *childItemMightMatch = false;
+            return false;
+        }
+        if (include_.folderMasks.matches(pathFmt))
+            return true;
+
+        *childItemMightMatch = include_.fileMasks  .matchesBegin(pathFmt) ||
+                               include_.folderMasks.matchesBegin(pathFmt);
+        return false;
+    }
+
+private:
+    struct FilterSet
+    {
+        MaskMatcherOld fileMasks;
+        MaskMatcherOld folderMasks;
+    };
+
+    //unchanged: see NameFilter::parseFilterPhrase()
+    static void parseFilterPhrase(const Zstring& filterPhrase, FilterSet& filter)
+    {
+        const Zstring filterPhraseNorm = getUpperCase(filterPhrase);
+        const Zstring sepAsterisk = Zstr("/*");
+        const Zstring asteriskSep = Zstr("*/");
+
+        auto processTail = [&](const ZstringView phrase)
+        {
+            if (endsWith(phrase, Zstr(':')))
+                filter.fileMasks.insert({phrase.begin(), phrase.end() - 1});
+            else if (endsWith(phrase, FILE_NAME_SEPARATOR) ||
+                     endsWith(phrase, sepAsterisk))
+                filter.folderMasks.insert(Zstring(beforeLast(phrase, FILE_NAME_SEPARATOR, IfNotFoundReturn::none)));
+            else
+            {
+                filter.fileMasks  .insert(Zstring(phrase));
+                filter.folderMasks.insert(Zstring(phrase));
+            }
+        };
+
+        split2(filterPhraseNorm, [](Zchar c) { return c == FILTER_ITEM_SEPARATOR || c == Zstr('\n'); },
+        [&](ZstringView itemPhrase)
+        {
+            itemPhrase = trimCpy(itemPhrase);
+            if (!itemPhrase.empty())
+            {
+                if (startsWith(itemPhrase, FILE_NAME_SEPARATOR))
+                    processTail(afterFirst(itemPhrase, FILE_NAME_SEPARATOR, IfNotFoundReturn::none));
+                else
+                {
+                    processTail(itemPhrase);
+                    if (startsWith(itemPhrase, asteriskSep))
+                        processTail(afterFirst(itemPhrase, asteriskSep, IfNotFoundReturn::none));
+                }
+            }
+        });
+    }
+
+    FilterSet include_;
+    FilterSet exclude_;
+};
+//===============================================================================
+
+class Random //xorshift: reproducible
+{
+public:
+    explicit Random(uint64_t seed) : state_(seed) {}
+    size_t operator()(size_t range) { state_ ^= state_ << 13; state_ ^= state_ >> 7; state_ ^= state_ << 17; return state_ % range; }
+private:
+    uint64_t state_;
+};
+
+const std::vector<Zstring> folderNames{Zstr("src"), Zstr("Build"), Zstr("obj"), Zstr(".git"), Zstr("node_modules"), Zstr("docs"), Zstr("Temp"), Zstr("cache"), Zstr("a"), Zstr("ab")};
+const std::vector<Zstring> fileNames  {Zstr("main.cpp"), Zstr("readme.md"), Zstr("Thumbs.db"), Zstr("file.tmp"), Zstr("notes.txt~"), Zstr("a.bak"), Zstr("x"), Zstr("report_2024.pdf")};
+
+
+std::vector<Zstring> generateMasks(size_t count, Random& rand)
+{
+    std::vector<Zstring> masks;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const Zstring folder = folderNames[rand(folderNames.size())] + (i % 7 == 0 ? Zstring() : numberTo<Zstring>(i));
+        const Zstring file   = fileNames  [rand(fileNames  .size())];
+        switch (rand(9))
+        {
+            case 0: masks.push_back(Zstr("*.") + afterLast(file, Zstr('.'), IfNotFoundReturn::all) + numberTo<Zstring>(i % 3 == 0 ? i : 0)); break;
+            case 1: masks.push_back(Zstr("*/") + folder + Zstr('/')); break;
+            case 2: masks.push_back(folder + Zstr("/*/") + folderNames[rand(folderNames.size())]); break;
+            case 3: masks.push_back(folder + Zstr("/?") + Zstring(file.begin() + 1, file.end())); break;
+            case 4: masks.push_back(Zstr("*") + Zstring(file.begin(), file.begin() + std::min<size_t>(file.size(), 3)) + Zstr("*") + numberTo<Zstring>(i) + Zstr(':')); break;
+            case 5: masks.push_back(folder + Zstr('/') + file); break; //literal path
+            case 6: masks.push_back(folder + Zstr("*/")); break;
+            case 7: masks.push_back(Zstr("*/") + folder + Zstr("/??") + Zstr("*")); break;
+            case 8: masks.push_back(Zstr("*") + numberTo<Zstring>(i) + Zstr("*") + numberTo<Zstring>(i + 1) + Zstr("*") + numberTo<Zstring>(i + 2)); break; //state explosion candidate
+        }
+    }
+    return masks;
+}
+
+
+std::vector<Zstring> generatePaths(size_t count, size_t maskCount, Random& rand)
+{
+    std::vector<Zstring> paths;
+    for (size_t i = 0; i < count; ++i)
+    {
+        Zstring path;
+        const size_t depth = 1 + rand(5);
+        for (size_t d = 0; d < depth; ++d)
+        {
+            if (!path.empty())
+                path += FILE_NAME_SEPARATOR;
+            path += folderNames[rand(folderNames.size())];
+            if (rand(2) == 0)
+                path += numberTo<Zstring>(rand(maskCount + 1)); //hit some mask-specific names
+        }
+        if (rand(3) != 0)
+            path += FILE_NAME_SEPARATOR + fileNames[rand(fileNames.size())];
+        paths.push_back(std::move(path));
+    }
+    return paths;
+}
+
+
+Zstring joinPhrase(const std::vector<Zstring>& masks)
+{
+    Zstring phrase;
+    for (const Zstring& mask : masks)
+        phrase += mask + Zstr('\n');
+    return phrase;
+}
+
+
+size_t matchAll(const auto& filter, const std::vector<Zstring>& paths)
+{
+    size_t passCount = 0;
+    for (const Zstring& path : paths)
+    {
+        bool childItemMightMatch = true;
+        passCount += filter.passFileFilter(path);
+        passCount += filter.passDirFilter(path, &childItemMightMatch);
+        passCount += childItemMightMatch;
+    }
+    return passCount;
+}
+
+
+void verifyFilter() //throw BenchCheckFailed
+{
+    Random rand(0x9E3779B97F4A7C15ULL);
+
+    for (const size_t maskCount : {1, 5, 40, 150})
+        for (int round = 0; round < 10; ++round)
+        {
+            const Zstring includePhrase = round % 2 == 0 ? Zstr("*") : joinPhrase(generateMasks(maskCount, rand));
+            const Zstring excludePhrase = joinPhrase(generateMasks(maskCount, rand));
+
+            const NameFilter    filterNew(includePhrase, excludePhrase);
+            const NameFilterOld filterOld(includePhrase, excludePhrase);
+
+            for (const Zstring& path : generatePaths(2000, maskCount, rand))
+            {
+                benchCheck(filterNew.passFileFilter(path) == filterOld.passFileFilter(path), "filter: passFileFilter() differs from per-mask matching");
+
+                bool childNew = true;
+                bool childOld = true;
+                benchCheck(filterNew.passDirFilter(path, &childNew) == filterOld.passDirFilter(path, &childOld), "filter: passDirFilter() differs from per-mask matching");
+                benchCheck(childNew == childOld, "filter: childItemMightMatch differs from per-mask matching");
+            }
+        }
+}
+}
+
+
+JsonValue fff::bench::runFilterBench(const BenchArgs& args) //throw SysError, BenchCheckFailed
+{
+    const size_t maskCount = std::max<size_t>(args.getNumber<size_t>("masks", 300), 1);
+    const size_t pathCount = args.getNumber<size_t>("paths", 200'000);
+    const int    runs      = args.getNumber<int>("runs", 5);
+
+    verifyFilter(); //throw BenchCheckFailed
+
+    Random rand(0x2545F4914F6CDD1DULL);
+    const Zstring excludePhrase = joinPhrase(generateMasks(maskCount, rand));
+    const std::vector<Zstring> paths = generatePaths(pathCount, maskCount, rand);
+
+    std::optional<NameFilter> filterNew;
+    const double compileMs = timeBestMs(runs, [&] { filterNew.emplace(Zstr("*"), excludePhrase); });
+    const NameFilterOld filterOld(Zstr("*"), excludePhrase);
+
+    size_t passCountOld = 0;
+    size_t passCountNew = 0;
+    const double oldMs = timeBestMs(runs, [&] { passCountOld = matchAll(filterOld,  paths); });
+    const double newMs = timeBestMs(runs, [&] { passCountNew = matchAll(*filterNew, paths); });
+    benchCheck(passCountOld == passCountNew, "filter: pass count differs");
+
+    JsonValue jresult;
+    setJson(jresult, "masks",      JsonValue(static_cast<int64_t>(maskCount)));
+    setJson(jresult, "paths",      JsonValue(static_cast<int64_t>(pathCount)));
+    setJson(jresult, "compile_ms", JsonValue(compileMs));
+    setJson(jresult, "match",      makeComparison(oldMs, newMs));
+    return jresult;
+}
+
+
+void fff::bench::verifyFilterBench() { verifyFilter(); } //throw BenchCheckFailed
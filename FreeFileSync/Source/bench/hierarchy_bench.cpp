@@ -0,0 +1,141 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include "bench.h"
+#include "../base/algorithm.h"
+#include "../afs/native.h"
+
+using namespace zen;
+using namespace fff;
+using namespace fff::bench;
+
+
+/*  Comparison hierarchy memory and full-hierarchy passes:
+
+    ffs_bench hierarchy [--files 1000000] [--fanout 100] [--runs 5]
+
+    - bytes per item: object sizes + list node + dense hot fields (see ItemHotFields)
+    - count_active:   visitor over all objects vs scan of the dense hot field arrays
+    - set_active:     per-item FileSystemObject::setActive() (previous setActiveStatus()) vs BaseFolderPair::setActiveAll()  */
+namespace
+{
+SharedRef<BaseFolderPair> createHierarchy(size_t fileCount, size_t fanout)
+{
+    auto baseFolder = makeSharedRef<BaseFolderPair>(createItemPathNative(Zstr("/left")),  BaseFolderStatus::existing,
+                                                    createItemPathNative(Zstr("/right")), BaseFolderStatus::existing,
+                                                    makeSharedRef<NullFilter>(), CompareVariant::timeSize, 2, std::vector<unsigned int>(), false);
+    const FileAttributes attr{.modTime = 1'000'000'000, .fileSize = 4096};
+
+    FolderPair* folder = nullptr;
+    for (size_t i = 0; i < fileCount; ++i)
+    {
+        if (i % fanout == 0)
+            folder = &baseFolder.ref().addFolder(Zstr("folder") + numberTo<Zstring>(i / fanout), FolderAttributes(),
+                                                 Zstr("folder") + numberTo<Zstring>(i / fanout), FolderAttributes());
+
+        const Zstring fileName = Zstr("file") + numberTo<Zstring>(i % fanout) + Zstr(".txt");
+        FilePair* file = nullptr;
+        switch (i % 3)
+        {
+            case 0: file = &folder->addFile(fileName, attr, fileName, attr); file->setContentCategory(FileContentCategory::equal); break;
+            case 1: file = &folder->addFile<SelectSide::left >(fileName, attr); break;
+            case 2: file = &folder->addFile<SelectSide::right>(fileName, attr); break;
+        }
+        file->setSyncDir(i % 2 == 0 ? SyncDirection::right : SyncDirection::left);
+    }
+    return baseFolder;
+}
+
+
+//previous setActiveStatus(): notifies each item's parent chain
+void setActiveStatusPerItem(bool newStatus, BaseFolderPair& baseFolder)
+{
+    auto onFsItem = [newStatus](FileSystemObject& fsObj) { fsObj.setActive(newStatus); };
+    visitFSObjectRecursively(baseFolder, onFsItem, onFsItem, onFsItem);
+}
+
+
+std::vector<SyncOperation> getSyncOperations(BaseFolderPair& baseFolder)
+{
+    std::vector<SyncOperation> syncOps;
+    auto onFsItem = [&](const FileSystemObject& fsObj) { syncOps.push_back(fsObj.getSyncOperation()); };
+    visitFSObjectRecursively(baseFolder, onFsItem, onFsItem, onFsItem);
+    return syncOps;
+}
+
+
+void verifyHierarchy() //throw BenchCheckFailed
+{
+    SharedRef<BaseFolderPair> basePerItem = createHierarchy(10'000, 37);
+    SharedRef<BaseFolderPair> baseBulk    = createHierarchy(10'000, 37);
+
+    const std::vector<SyncOperation> syncOpsBefore = getSyncOperations(baseBulk.ref()); //buffer folder sync operations
+
+    for (const bool active : {false, true})
+    {
+        setActiveStatusPerItem(active, basePerItem.ref());
+        baseBulk.ref().setActiveAll(active);
+
+        benchCheck(getSyncOperations(baseBulk.ref()) == getSyncOperations(basePerItem.ref()), "setActiveAll(): sync operations differ from per-item setActive()");
+    }
+    benchCheck(getSyncOperations(baseBulk.ref()) == syncOpsBefore, "setActiveAll(): sync operations not restored");
+}
+}
+
+
+JsonValue fff::bench::runHierarchyBench(const BenchArgs& args) //throw SysError, BenchCheckFailed
+{
+    const size_t fileCount = args.getNumber<size_t>("files", 1'000'000);
+    const size_t fanout    = std::max<size_t>(args.getNumber<size_t>("fanout", 100), 1);
+    const int    runs      = args.getNumber<int>("runs", 5);
+
+    verifyHierarchy(); //throw BenchCheckFailed
+
+    SharedRef<BaseFolderPair> baseFolder = createHierarchy(fileCount, fanout);
+    const size_t itemCount = fileCount + (fileCount + fanout - 1) / fanout;
+
+    const size_t listNodeOverhead = 2 * sizeof(void*);
+    const double hotFieldBytes = static_cast<double>(baseFolder.ref().refHotFields().getMemoryUsage()) / itemCount;
+
+    JsonValue jmemory;
+    setJson(jmemory, "sizeof_file_pair",    JsonValue(static_cast<int64_t>(sizeof(FilePair))));
+    setJson(jmemory, "sizeof_folder_pair",  JsonValue(static_cast<int64_t>(sizeof(FolderPair))));
+    setJson(jmemory, "sizeof_symlink_pair", JsonValue(static_cast<int64_t>(sizeof(SymlinkPair))));
+    setJson(jmemory, "hot_fields_per_item", JsonValue(hotFieldBytes));
+    setJson(jmemory, "bytes_per_file_item", JsonValue(sizeof(FilePair) + listNodeOverhead + hotFieldBytes)); //excluding names
+
+    size_t activeCountObj = 0;
+    const double countObjMs = timeBestMs(runs, [&]
+    {
+        activeCountObj = 0;
+        auto onFsItem = [&](const FileSystemObject& fsObj) { activeCountObj += fsObj.isActive(); };
+        visitFSObjectRecursively(baseFolder.ref(), onFsItem, onFsItem, onFsItem);
+    });
+
+    //free slots are active, too: no items are removed here
+    const ItemHotFields& hotFields = baseFolder.ref().refHotFields();
+    size_t activeCountDense = 0;
+    const double countDenseMs = timeBestMs(runs, [&]
+    {
+        activeCountDense = 0;
+        for (uint32_t i = 0; i < itemCount; ++i)
+            activeCountDense += hotFields.isActive(i);
+    });
+    benchCheck(activeCountObj == itemCount && activeCountDense == itemCount, "count_active: unexpected result");
+
+    const double setPerItemMs = timeBestMs(runs, [&] { setActiveStatusPerItem(false, baseFolder.ref()); });
+    const double setBulkMs    = timeBestMs(runs, [&] { baseFolder.ref().setActiveAll(false); });
+
+    JsonValue jresult;
+    setJson(jresult, "items",        JsonValue(static_cast<int64_t>(itemCount)));
+    setJson(jresult, "memory",       std::move(jmemory));
+    setJson(jresult, "count_active", makeComparison(countObjMs, countDenseMs));
+    setJson(jresult, "set_active",   makeComparison(setPerItemMs, setBulkMs));
+    return jresult;
+}
+
+
+void fff::bench::verifyHierarchyBench() { verifyHierarchy(); } //throw BenchCheckFailed
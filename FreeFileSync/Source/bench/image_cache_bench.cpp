@@ -0,0 +1,288 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include "bench.h"
+#include <array>
+#include <zen/file_io.h>
+#include <zen/file_access.h>
+#include <zen/serialize.h>
+#include <zen/extra_log.h>
+#include <wx+/image_cache.h>
+
+using namespace zen;
+using namespace fff;
+using namespace fff::bench;
+
+
+/*  Startup: xBRZ-scaled image cache (see wx+/image_cache.cpp), warm start
+
+    ffs_bench image_cache [--images 195] [--used 40] [--runs 10]
+
+    old:  read whole cache file into memory, scan all entries (previous HqDiskCache), kept for process lifetime
+    new:  memory-mapped file, table of contents only; images are copied out on first use
+
+    load:        construct + load()
+    load_used:   load() + getImage() for the images shown at startup ("--used")
+    old_heap_bytes: file content held by the previous implementation after load(); new: index only, file is mapped
+    icon sizes 16-128 px (2x scaled), file in OS cache; PNG decoding (wxWidgets) is not part of this benchmark  */
+namespace
+{
+const int HQ_SCALE = 2;
+
+//=========================== previous implementation ===========================
+class HqDiskCacheOld
+{
+public:
+    HqDiskCacheOld(const Zstring& filePath, int hqScale, uint64_t resourceHash) : filePath_(filePath), hqScale_(hqScale), resourceHash_(resourceHash) {}
+
+    bool load() //noexcept; false if missing or stale
+    {
+        try
+        {
+            byteStream_ = getFileContent(filePath_, nullptr /*notifyUnbufferedIO*/); //throw FileError
+            MemoryStreamIn memIn(byteStream_);
+
+            if (readNumber<int32_t >(memIn) != 1 || //throw SysErrorUnexpectedEos
+                readNumber<int32_t >(memIn) != hqScale_ ||
+                readNumber<uint64_t>(memIn) != resourceHash_)
+                return false;
+
+            const size_t count = readNumber<uint32_t>(memIn); //throw SysErrorUnexpectedEos
+
+            for (size_t pos = memIn.pos(), i = 0; i < count; ++i)
+            {
+                MemoryStreamIn memInImg(std::string_view(byteStream_).substr(pos));
+                std::string imageName = readContainer<std::string>(memInImg); //throw SysErrorUnexpectedEos
+                const size_t posImage = pos + memInImg.pos();
+                const int width  = readNumber<int32_t>(memInImg); //throw SysErrorUnexpectedEos
+                const int height = readNumber<int32_t>(memInImg); //
+
+                const size_t imageBytes = static_cast<size_t>(width) * height * 4; //rgb + alpha
+                pos += memInImg.pos();
+                if (width <= 0 || height <= 0 || imageBytes > byteStream_.size() - pos) //don't trust size before allocating
+                    throw SysErrorUnexpectedEos();
+                pos += imageBytes;
+
+                index_.emplace(std::move(imageName), posImage);
+            }
+            return true;
+        }
+        catch (FileError&) {}
+        catch (SysError&) {}
+
+        byteStream_.clear();
+        index_.clear();
+        return false;
+    }
+
+    ImageHolder getImage(const std::string& imageName) const
+    {
+        auto it = index_.find(imageName);
+        if (it == index_.end())
+            return {};
+
+        MemoryStreamIn memIn(std::string_view(byteStream_).substr(it->second));
+        const int width  = readNumber<int32_t>(memIn); //no SysErrorUnexpectedEos: checked by load()
+        const int height = readNumber<int32_t>(memIn); //
+
+        ImageHolder ih(width, height, true /*withAlpha*/);
+        readArray(memIn, ih.getRgb(),   width * height * 3); //
+        readArray(memIn, ih.getAlpha(), width * height);     //
+        return ih;
+    }
+
+    static void save(const Zstring& filePath, int hqScale, uint64_t resourceHash, const std::vector<ImageDiskCache::ImageRef>& images) //throw FileError
+    {
+        MemoryStreamOut memOut;
+        writeNumber<int32_t >(memOut, 1);
+        writeNumber<int32_t >(memOut, hqScale);
+        writeNumber<uint64_t>(memOut, resourceHash);
+        writeNumber<uint32_t>(memOut, static_cast<uint32_t>(images.size()));
+
+        for (const ImageDiskCache::ImageRef& img : images)
+        {
+            writeContainer(memOut, img.name);
+            writeNumber<int32_t>(memOut, img.width);
+            writeNumber<int32_t>(memOut, img.height);
+            writeArray(memOut, img.rgb,   img.width * img.height * 3);
+            writeArray(memOut, img.alpha, img.width * img.height);
+        }
+        setFileContent(filePath, memOut.ref(), nullptr /*notifyUnbufferedIO*/); //throw FileError
+    }
+
+    size_t getHeapBytes() const { return byteStream_.capacity(); }
+
+private:
+    const Zstring filePath_;
+    const int hqScale_;
+    const uint64_t resourceHash_;
+
+    std::string byteStream_;
+    std::unordered_map<std::string, size_t /*stream position*/> index_;
+};
+//===============================================================================
+
+struct TestImage
+{
+    std::string name;
+    int width  = 0;
+    int height = 0;
+    std::vector<unsigned char> rgb;
+    std::vector<unsigned char> alpha;
+};
+
+
+std::vector<TestImage> generateImages(size_t count, uint64_t seed)
+{
+    std::vector<TestImage> images;
+    uint64_t rng = seed;
+    for (size_t i = 0; i < count; ++i)
+    {
+        rng ^= rng << 13; rng ^= rng >> 7; rng ^= rng << 17; //xorshift: reproducible
+        const int size = HQ_SCALE * std::array{16, 20, 24, 32, 48, 64, 96, 128}[rng % 8];
+
+        TestImage img{.name = "icon_" + numberTo<std::string>(i), .width = size, .height = size * (i % 5 == 0 ? 2 : 1)};
+        img.rgb  .resize(static_cast<size_t>(img.width) * img.height * 3);
+        img.alpha.resize(static_cast<size_t>(img.width) * img.height);
+        for (unsigned char& b : img.rgb)   { rng ^= rng << 13; rng ^= rng >> 7; rng ^= rng << 17; b = static_cast<unsigned char>(rng); }
+        for (unsigned char& b : img.alpha) { rng ^= rng << 13; rng ^= rng >> 7; rng ^= rng << 17; b = static_cast<unsigned char>(rng); }
+        images.push_back(std::move(img));
+    }
+    return images;
+}
+
+
+std::vector<ImageDiskCache::ImageRef> getImageRefs(const std::vector<TestImage>& images)
+{
+    std::vector<ImageDiskCache::ImageRef> refs;
+    for (const TestImage& img : images)
+        refs.push_back({img.name, img.width, img.height, img.rgb.data(), img.alpha.data()});
+    return refs;
+}
+
+
+bool equalImage(ImageHolder& ih, const TestImage& img)
+{
+    const size_t pixelCount = static_cast<size_t>(img.width) * img.height;
+    return ih && ih.getWidth() == img.width && ih.getHeight() == img.height &&
+           std::equal(img.rgb  .begin(), img.rgb  .end(), ih.getRgb  (), ih.getRgb  () + pixelCount * 3) &&
+           std::equal(img.alpha.begin(), img.alpha.end(), ih.getAlpha(), ih.getAlpha() + pixelCount);
+}
+
+
+//create + clean up temporary folder
+template <class Function>
+void withTempFolder(Function fun) //throw FileError, BenchCheckFailed
+{
+    const Zstring folderPath = appendPath(getTempFolderPath(), Zstr("ffs_bench_") + numberTo<Zstring>(::getpid())); //throw FileError
+    createDirectoryIfMissingRecursion(folderPath); //throw FileError
+    ZEN_ON_SCOPE_EXIT(try { removeDirectoryPlainRecursion(folderPath); } catch (FileError&) {});
+
+    fun(folderPath);
+}
+
+
+void verifyImageCache(const Zstring& folderPath) //throw FileError, BenchCheckFailed
+{
+    const Zstring filePath = appendPath(folderPath, Zstr("Icons@2x.cache"));
+    const std::vector<TestImage> images = generateImages(50, 1);
+
+    benchCheck(!ImageDiskCache(filePath, HQ_SCALE, 123).load(), "image_cache: missing file reported as cached");
+
+    ImageDiskCache(filePath, HQ_SCALE, 123).save(getImageRefs(images));
+    {
+        ImageDiskCache cache(filePath, HQ_SCALE, 123);
+        benchCheck(cache.load(), "image_cache: load() failed after save()");
+        for (const TestImage& img : images)
+        {
+            ImageHolder ih = cache.getImage(img.name);
+            benchCheck(equalImage(ih, img), "image_cache: image differs after round trip");
+        }
+        benchCheck(!cache.getImage("unknown"), "image_cache: unknown image found");
+    }
+    benchCheck(!ImageDiskCache(filePath, HQ_SCALE + 1, 123).load(), "image_cache: stale scale factor not detected");
+    benchCheck(!ImageDiskCache(filePath, HQ_SCALE,     124).load(), "image_cache: stale resource hash not detected");
+
+    //truncated at every position of the table of contents, and within image data
+    const std::string content = getFileContent(filePath, nullptr /*notifyUnbufferedIO*/); //throw FileError
+    for (size_t len = 0; len < content.size(); len += len < 2000 ? 1 : 9973)
+    {
+        setFileContent(filePath, std::string_view(content).substr(0, len), nullptr /*notifyUnbufferedIO*/); //throw FileError
+        benchCheck(!ImageDiskCache(filePath, HQ_SCALE, 123).load(), "image_cache: truncated file not detected");
+    }
+    benchCheck(!fetchExtraLog().empty(), "image_cache: corrupted file not logged"); //drain log: expected errors
+
+    //previous format
+    HqDiskCacheOld::save(filePath, HQ_SCALE, 123, getImageRefs(images)); //throw FileError
+    benchCheck(!ImageDiskCache(filePath, HQ_SCALE, 123).load(), "image_cache: previous file format not detected");
+}
+}
+
+
+JsonValue fff::bench::runImageCacheBench(const BenchArgs& args) //throw SysError, BenchCheckFailed
+{
+    const size_t imageCount = std::max<size_t>(args.getNumber<size_t>("images", 195), 1);
+    const size_t usedCount  = std::min(args.getNumber<size_t>("used", 40), imageCount);
+    const int    runs       = args.getNumber<int>("runs", 10);
+
+    JsonValue jresult;
+    try
+    {
+        withTempFolder([&](const Zstring& folderPath) //throw FileError, BenchCheckFailed
+        {
+            verifyImageCache(folderPath); //throw FileError, BenchCheckFailed
+
+            const std::vector<TestImage> images = generateImages(imageCount, 42);
+            const Zstring filePathOld = appendPath(folderPath, Zstr("Old@2x.cache"));
+            const Zstring filePathNew = appendPath(folderPath, Zstr("New@2x.cache"));
+            HqDiskCacheOld::save(filePathOld, HQ_SCALE, 123, getImageRefs(images)); //throw FileError
+            ImageDiskCache(filePathNew, HQ_SCALE, 123).save(getImageRefs(images));
+
+            auto timeLoad = [&](auto loadCache)
+            {
+                return timeBestMs(runs, [&] { doNotOptimize(loadCache()); });
+            };
+            auto loadOld = [&](bool getUsed)
+            {
+                HqDiskCacheOld cache(filePathOld, HQ_SCALE, 123);
+                benchCheck(cache.load(), "image_cache: load() failed");
+                size_t pixels = 0;
+                for (size_t i = 0; getUsed && i < usedCount; ++i)
+                    pixels += cache.getImage(images[i].name).getWidth();
+                return pixels;
+            };
+            auto loadNew = [&](bool getUsed)
+            {
+                ImageDiskCache cache(filePathNew, HQ_SCALE, 123);
+                benchCheck(cache.load(), "image_cache: load() failed");
+                size_t pixels = 0;
+                for (size_t i = 0; getUsed && i < usedCount; ++i)
+                    pixels += cache.getImage(images[i].name).getWidth();
+                return pixels;
+            };
+
+            HqDiskCacheOld cacheOld(filePathOld, HQ_SCALE, 123);
+            ImageDiskCache cacheNew(filePathNew, HQ_SCALE, 123);
+            benchCheck(cacheOld.load() && cacheNew.load(), "image_cache: load() failed");
+
+            setJson(jresult, "images",     JsonValue(static_cast<int64_t>(imageCount)));
+            setJson(jresult, "used",       JsonValue(static_cast<int64_t>(usedCount)));
+            setJson(jresult, "file_bytes", JsonValue(static_cast<int64_t>(cacheNew.getMappedSize())));
+            setJson(jresult, "load",       makeComparison(timeLoad([&] { return loadOld(false); }), timeLoad([&] { return loadNew(false); })));
+            setJson(jresult, "load_used",  makeComparison(timeLoad([&] { return loadOld(true);  }), timeLoad([&] { return loadNew(true);  })));
+            setJson(jresult, "old_heap_bytes", JsonValue(static_cast<int64_t>(cacheOld.getHeapBytes())));
+        });
+    }
+    catch (const FileError& e) { throw SysError(e.toString()); }
+    return jresult;
+}
+
+
+void fff::bench::verifyImageCacheBench() //throw BenchCheckFailed
+{
+    try { withTempFolder(verifyImageCache); } //throw FileError, BenchCheckFailed
+    catch (const FileError& e) { throw BenchCheckFailed{utfTo<std::string>(e.toString())}; }
+}
@@ -0,0 +1,144 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include "bench.h"
+#include "../base/name_pool.h"
+
+using namespace zen;
+using namespace fff;
+using namespace fff::bench;
+
+
+/*  Left/right name matching of the comparison (see matchFolders() in comparison.cpp):
+
+    ffs_bench names [--files 1000000] [--unique 5000] [--fanout 200] [--runs 5]
+
+    old: sort by compareNoCase(), equal ranges by equalNoCase() (previous implementation)
+    new: sort and split by the NamePool's precomputed upper-case keys: one key per unique name and comparison
+
+    names: "--unique" distinct names, every 5th one non-ASCII, left and right folder each get "--fanout" of them  */
+namespace
+{
+using NameFolder = std::vector<Zstring>; //left + right names of one folder
+
+
+std::vector<NameFolder> generateFolders(size_t fileCount, size_t uniqueCount, size_t fanout)
+{
+    std::vector<Zstring> vocabulary;
+    for (size_t i = 0; i < uniqueCount; ++i)
+        vocabulary.push_back(i % 5 == 0 ?
+                             Zstr("\xc3\x9c" "berweisung ") + numberTo<Zstring>(i) + Zstr(".pdf") : //"Überweisung"
+                             (i % 2 == 0 ? Zstr("file") : Zstr("File")) + numberTo<Zstring>(i / 2) + Zstr(".txt")); //case-insensitive duplicates
+
+    std::vector<NameFolder> folders;
+    uint64_t rng = 0x9E3779B97F4A7C15ULL;
+    for (size_t i = 0; i < fileCount; i += 2 * fanout)
+    {
+        NameFolder& folder = folders.emplace_back();
+        for (size_t j = 0; j < 2 * fanout; ++j)
+        {
+            rng ^= rng << 13; rng ^= rng >> 7; rng ^= rng << 17; //xorshift: reproducible
+            folder.push_back(vocabulary[rng % vocabulary.size()]);
+        }
+    }
+    return folders;
+}
+
+
+//returns size of each equal range in sort order
+std::vector<size_t> matchOld(NameFolder& folder)
+{
+    std::sort(folder.begin(), folder.end(), [](const Zstring& lhs, const Zstring& rhs) { return compareNoCase(lhs, rhs) < 0; });
+
+    std::vector<size_t> ranges;
+    for (auto it = folder.begin(); it != folder.end();)
+    {
+        auto itEndEq = std::find_if(it + 1, folder.end(), [&](const Zstring& name) { return !equalNoCase(name, *it); });
+        ranges.push_back(itEndEq - it);
+        it = itEndEq;
+    }
+    return ranges;
+}
+
+
+std::vector<size_t> matchNew(const NameFolder& folder, NamePool& names, std::vector<const Zstring*>& upperKeys)
+{
+    upperKeys.clear();
+    for (const Zstring& name : folder)
+        upperKeys.push_back(&names.getCompareKeys(name).upperCase);
+
+    std::sort(upperKeys.begin(), upperKeys.end(), [](const Zstring* lhs, const Zstring* rhs) { return *lhs < *rhs; });
+
+    std::vector<size_t> ranges;
+    for (auto it = upperKeys.begin(); it != upperKeys.end();)
+    {
+        auto itEndEq = std::find_if(it + 1, upperKeys.end(), [&](const Zstring* key) { return *key != **it; });
+        ranges.push_back(itEndEq - it);
+        it = itEndEq;
+    }
+    return ranges;
+}
+
+
+void verifyNames() //throw BenchCheckFailed
+{
+    std::vector<NameFolder> folders = generateFolders(20'000, 500, 50);
+    folders.push_back({Zstr("a"), Zstr("A"), Zstr("\xc3\xa4"), Zstr("a\xcc\x88"), Zstr("\xc3\x84"), Zstr("ss"), Zstr("SS"), Zstr("\xc3\x9f"), Zstr("")}); //ä (NFC, NFD), Ä, ß
+
+    NamePool names;
+    std::vector<const Zstring*> upperKeys;
+    for (NameFolder& folder : folders)
+    {
+        const std::vector<size_t> rangesNew = matchNew(folder, names, upperKeys);
+        const std::vector<size_t> rangesOld = matchOld(folder);
+        benchCheck(rangesOld == rangesNew, "names: equal ranges differ from compareNoCase()/equalNoCase()");
+
+        for (size_t i = 0; i < folder.size(); ++i) //same sort order up to ties
+            benchCheck(*upperKeys[i] == getUpperCase(folder[i]), "names: sort order differs from compareNoCase()");
+
+        for (const Zstring& name : folder)
+            benchCheck(names.getCompareKeys(name).normalForm == getUnicodeNormalForm(name), "names: wrong normal form");
+    }
+}
+}
+
+
+JsonValue fff::bench::runNameBench(const BenchArgs& args) //throw SysError, BenchCheckFailed
+{
+    const size_t fileCount   = args.getNumber<size_t>("files", 1'000'000);
+    const size_t uniqueCount = std::max<size_t>(args.getNumber<size_t>("unique", 5000), 1);
+    const size_t fanout      = std::max<size_t>(args.getNumber<size_t>("fanout", 200), 1);
+    const int    runs        = args.getNumber<int>("runs", 5);
+
+    verifyNames(); //throw BenchCheckFailed
+
+    const std::vector<NameFolder> folders = generateFolders(fileCount, uniqueCount, fanout);
+
+    const double oldMs = timeBestMs(runs, [&]
+    {
+        std::vector<NameFolder> foldersTmp = folders; //not timed separately: same copy cost as below
+        for (NameFolder& folder : foldersTmp)
+            doNotOptimize(matchOld(folder));
+    });
+
+    const double newMs = timeBestMs(runs, [&]
+    {
+        std::vector<NameFolder> foldersTmp = folders;
+        NamePool names; //one pool per comparison: compare keys are computed in the first folders, reused afterwards
+        std::vector<const Zstring*> upperKeys;
+        for (const NameFolder& folder : foldersTmp)
+            doNotOptimize(matchNew(folder, names, upperKeys));
+    });
+
+    JsonValue jresult;
+    setJson(jresult, "files",  JsonValue(static_cast<int64_t>(folders.size() * 2 * fanout)));
+    setJson(jresult, "unique", JsonValue(static_cast<int64_t>(uniqueCount)));
+    setJson(jresult, "match",  makeComparison(oldMs, newMs));
+    return jresult;
+}
+
+
+void fff::bench::verifyNameBench() { verifyNames(); } //throw BenchCheckFailed
@@ -0,0 +1,241 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include "bench.h"
+#include <condition_variable>
+#include <zen/ring_buffer.h>
+#include <zen/stream_buffer.h>
+#include <zen/thread.h>
+
+using namespace zen;
+using namespace fff;
+using namespace fff::bench;
+
+
+/*  AsyncStreamBuffer throughput: output thread write()s, input thread tryRead()s (e.g. HTTP download in zen/http.cpp)
+
+    ffs_bench stream [--mb 512] [--capacity 524288] [--runs 5]
+
+    old: mutex + condition variables per tryRead()/tryWrite() (previous implementation)
+    new: lock-free single-producer/single-consumer ring: blocking only if empty/full, batched wakeups
+
+    - write_1k, write_16k: chunk size of writer (16 kB = CURL_MAX_WRITE_SIZE), reader requests 64 kB    */
+namespace
+{
+//=========================== previous implementation ===========================
+class AsyncStreamBufferOld
+{
+public:
+    explicit AsyncStreamBufferOld(size_t capacity) { ringBuf_.reserve(capacity); }
+
+    size_t tryRead(void* buffer, size_t bytesToRead) //throw <write error>
+    {
+        size_t bytesRead = 0;
+        {
+            std::unique_lock dummy(lockStream_);
+            conditionBytesWritten_.wait(dummy, [this] { return errorWrite_ || !ringBuf_.empty() || eof_; });
+
+            if (errorWrite_)
+                std::rethrow_exception(errorWrite_); //throw <write error>
+
+            bytesRead = std::min(bytesToRead, ringBuf_.size());
+            ringBuf_.extract_front(static_cast<std::byte*>(buffer),
+                                   static_cast<std::byte*>(buffer) + bytesRead);
+        }
+        if (bytesRead > 0)
+            conditionBytesRead_.notify_all();
+        return bytesRead;
+    }
+
+    void write(const void* buffer, size_t bytesToWrite) //throw <read error>
+    {
+        std::unique_lock dummy(lockStream_);
+        while (bytesToWrite > 0)
+        {
+            conditionBytesRead_.wait(dummy, [this] { return errorRead_ || ringBuf_.size() < ringBuf_.capacity(); });
+
+            if (errorRead_)
+                std::rethrow_exception(errorRead_); //throw <read error>
+
+            const size_t junkSize = std::min(bytesToWrite, ringBuf_.capacity() - ringBuf_.size());
+            ringBuf_.insert_back(static_cast<const std::byte*>(buffer),
+                                 static_cast<const std::byte*>(buffer) + junkSize);
+            conditionBytesWritten_.notify_all();
+            buffer = static_cast<const std::byte*>(buffer) + junkSize;
+            bytesToWrite -= junkSize;
+        }
+    }
+
+    void closeStream()
+    {
+        {
+            std::lock_guard dummy(lockStream_);
+            eof_ = true;
+        }
+        conditionBytesWritten_.notify_all();
+    }
+
+    void setReadError(const std::exception_ptr& error)
+    {
+        {
+            std::lock_guard dummy(lockStream_);
+            if (!errorRead_)
+                errorRead_ = error;
+        }
+        conditionBytesRead_.notify_all();
+    }
+
+    void setWriteError(const std::exception_ptr& error)
+    {
+        {
+            std::lock_guard dummy(lockStream_);
+            if (!errorWrite_)
+                errorWrite_ = error;
+        }
+        conditionBytesWritten_.notify_all();
+    }
+
+private:
+    std::mutex lockStream_;
+    RingBuffer<std::byte> ringBuf_;
+    bool eof_ = false;
+    std::exception_ptr errorWrite_;
+    std::exception_ptr errorRead_;
+    std::condition_variable conditionBytesWritten_;
+    std::condition_variable conditionBytesRead_;
+};
+//===============================================================================
+
+struct StreamError
+{
+    std::string msg;
+};
+
+
+std::byte getPatternByte(uint64_t pos) { return static_cast<std::byte>((pos * 0x9E3779B1u) >> 24); }
+
+
+/*  stream "totalBytes" from an output thread to the calling thread
+    - chunk sizes vary between 1 and "writeChunk"/"readChunk" if "randomChunks"
+    - "failAfter": output thread sets a write error after writing this many bytes
+    returns bytes read (== totalBytes unless failing) and whether the content is byte-exact  */
+template <class Buffer>
+std::pair<uint64_t, bool> streamBytes(size_t capacity, uint64_t totalBytes, size_t writeChunk, size_t readChunk, bool randomChunks,
+                                      std::optional<uint64_t> failAfter = std::nullopt) //throw StreamError
+{
+    auto streamBuf = std::make_shared<Buffer>(capacity);
+
+    InterruptibleThread writer([streamBuf, totalBytes, writeChunk, randomChunks, failAfter]
+    {
+        std::vector<std::byte> chunk(writeChunk);
+        uint64_t rng = 0x2545F4914F6CDD1DULL;
+        try
+        {
+            for (uint64_t pos = 0; pos < totalBytes;)
+            {
+                if (failAfter && pos >= *failAfter)
+                    throw StreamError{"write error"};
+
+                rng ^= rng << 13; rng ^= rng >> 7; rng ^= rng << 17;
+                const size_t junkSize = static_cast<size_t>(std::min<uint64_t>(randomChunks ? 1 + rng % writeChunk : writeChunk, totalBytes - pos));
+                if (randomChunks) //verification only: don't let pattern generation dominate timings
+                    for (size_t i = 0; i < junkSize; ++i)
+                        chunk[i] = getPatternByte(pos + i);
+
+                streamBuf->write(chunk.data(), junkSize); //throw <read error>
+                pos += junkSize;
+            }
+            streamBuf->closeStream();
+        }
+        catch (...) { streamBuf->setWriteError(std::current_exception()); }
+    });
+    ZEN_ON_SCOPE_EXIT(writer.join());
+
+    std::vector<std::byte> buf(readChunk);
+    uint64_t rng = 0x9E3779B97F4A7C15ULL;
+    uint64_t bytesRead = 0;
+    bool byteExact = true;
+    try
+    {
+        for (;;)
+        {
+            rng ^= rng << 13; rng ^= rng >> 7; rng ^= rng << 17;
+            const size_t bytesWanted = randomChunks ? 1 + rng % readChunk : readChunk;
+            const size_t junkSize = streamBuf->tryRead(buf.data(), bytesWanted); //throw StreamError
+            if (junkSize == 0)
+                break;
+
+            if (randomChunks)
+                for (size_t i = 0; i < junkSize; ++i)
+                    byteExact &= buf[i] == getPatternByte(bytesRead + i);
+            bytesRead += junkSize;
+        }
+    }
+    catch (const StreamError&)
+    {
+        streamBuf->setReadError(std::current_exception()); //unblock writer (if still writing)
+        throw;
+    }
+    return {bytesRead, byteExact};
+}
+
+
+void verifyStream() //throw BenchCheckFailed
+{
+    for (const size_t capacity : {1, 2, 3, 7, 13, 64, 4096})
+        for (const uint64_t totalBytes : {0, 1, 1000, 100'000})
+        {
+            const auto [bytesRead, byteExact] = streamBytes<AsyncStreamBuffer>(capacity, totalBytes, 97, 61, true /*randomChunks*/);
+            benchCheck(bytesRead == totalBytes && byteExact, "stream: data differs after round trip");
+        }
+
+    //write error => propagated to reader
+    for (const size_t capacity : {1, 13, 4096})
+    {
+        bool errorSeen = false;
+        try { streamBytes<AsyncStreamBuffer>(capacity, 100'000, 97, 61, true, 5000); }
+        catch (const StreamError&) { errorSeen = true; }
+        benchCheck(errorSeen, "stream: write error not propagated");
+    }
+}
+}
+
+
+JsonValue fff::bench::runStreamBench(const BenchArgs& args) //throw SysError, BenchCheckFailed
+{
+    const uint64_t totalBytes = args.getNumber<uint64_t>("mb", 512) * 1024 * 1024;
+    const size_t   capacity   = std::max<size_t>(args.getNumber<size_t>("capacity", 512 * 1024), 1);
+    const int      runs       = args.getNumber<int>("runs", 5);
+
+    verifyStream(); //throw BenchCheckFailed
+
+    JsonValue jresult;
+    setJson(jresult, "bytes",    JsonValue(static_cast<int64_t>(totalBytes)));
+    setJson(jresult, "capacity", JsonValue(static_cast<int64_t>(capacity)));
+
+    for (const size_t writeChunk : {1024, 16 * 1024})
+    {
+        auto timeStream = [&]<class Buffer>(std::type_identity<Buffer>)
+        {
+            return timeBestMs(runs, [&]
+            {
+                const auto [bytesRead, byteExact] = streamBytes<Buffer>(capacity, totalBytes, writeChunk, 64 * 1024, false /*randomChunks*/);
+                benchCheck(bytesRead == totalBytes, "stream: unexpected byte count");
+            });
+        };
+        const double oldMs = timeStream(std::type_identity<AsyncStreamBufferOld>());
+        const double newMs = timeStream(std::type_identity<AsyncStreamBuffer   >());
+
+        JsonValue jcmp = makeComparison(oldMs, newMs);
+        setJson(jcmp, "old_mb_per_s", JsonValue(totalBytes / (1024.0 * 1024) / (oldMs / 1000)));
+        setJson(jcmp, "new_mb_per_s", JsonValue(totalBytes / (1024.0 * 1024) / (newMs / 1000)));
+        setJson(jresult, "write_" + numberTo<std::string>(writeChunk / 1024) + "k", std::move(jcmp));
+    }
+    return jresult;
+}
+
+
+void fff::bench::verifyStreamBench() { verifyStream(); } //throw BenchCheckFailed
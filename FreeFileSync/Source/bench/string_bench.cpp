@@ -0,0 +1,160 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include "bench.h"
+#include <zen/zstring.h>
+
+using namespace zen;
+using namespace fff;
+using namespace fff::bench;
+
+
+/*  String kernels (see zen/string_kernels.h) on item names and full paths:
+
+    ffs_bench strings [--count 1000000] [--runs 5]
+
+    hash:      FNV-1a per character (previous StringHash) vs hashBytes()        => different values by design: throughput only
+    ascii:     scalar std::all_of() (previous isAsciiString()) vs findNonAscii()
+    upper:     scalar asciiToUpper() loop (previous getUpperCaseAscii()) vs asciiToUpperInPlace()
+    utf8_to_wide, wide_to_utf8: full decode per code point (previous utfTo<>()) vs ASCII run copy + decode of non-ASCII runs
+
+    strings: every 4th one non-ASCII, every 2nd one a full path                                                                 */
+namespace
+{
+std::vector<std::string> generateStrings(size_t count)
+{
+    std::vector<std::string> strings;
+    strings.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        std::string name = i % 4 == 0 ?
+                           "\xc3\x9c" "berweisung " + numberTo<std::string>(i) + " \xe2\x82\xac.pdf" : //"Überweisung ... €"
+                           "file_" + numberTo<std::string>(i) + ".txt";
+        if (i % 2 == 0)
+            name = "/home/user/Documents/Projects/FreeFileSync/Source/" + numberTo<std::string>(i % 97) + '/' + name;
+        strings.push_back(std::move(name));
+    }
+    return strings;
+}
+
+
+//previous implementations:
+template <class S>
+bool isAsciiStringOld(const S& str)
+{
+    const auto* const first = strBegin(str);
+    return std::all_of(first, first + strLength(str), [](auto c) { return isAsciiChar(c); });
+}
+
+
+template <class TargetString, class SourceString>
+TargetString utfToOld(const SourceString& str)
+{
+    using CharTrg = GetCharTypeT<TargetString>;
+
+    TargetString output;
+    UtfDecoder<GetCharTypeT<SourceString>> decoder(strBegin(str), strLength(str));
+    while (const std::optional<impl::CodePoint> cp = decoder.getNext())
+        codePointToUtf<CharTrg>(*cp, [&](CharTrg c) { output += c; });
+    return output;
+}
+
+
+//both in-place: no allocation in the timed loop
+size_t toUpperOld(std::string& str) { for (char& c : str) c = asciiToUpper(c); return str.size(); }
+size_t toUpperNew(std::string& str) { impl::asciiToUpperInPlace(str.data(), str.data() + str.size()); return str.size(); }
+
+
+void verifyStrings() //throw BenchCheckFailed
+{
+    std::vector<std::string> strings = generateStrings(10'000);
+    for (size_t len = 0; len <= 40; ++len) //all block/word/tail splits
+        for (size_t pos = 0; pos <= len; ++pos)
+        {
+            std::string str(len, 'a');
+            for (size_t i = 0; i < len; ++i)
+                str[i] = static_cast<char>("az@[`{AZ09"[i % 10]);
+            if (pos < len)
+                str[pos] = '\x80';
+            strings.push_back(str);
+        }
+    for (const char* broken : {"\xc3", "a\xc3" "b", "\xe2\x82" "x", "\xed\xa0\x80", "\xf4\x90\x80\x80", "\xff" "abc", "abc\x80\x80"}) //truncated, surrogate, out of range, invalid
+        strings.push_back(broken);
+
+    for (const std::string& str : strings)
+    {
+        benchCheck(isAsciiString(str) == isAsciiStringOld(str), "strings: isAsciiString() differs from scalar version");
+
+        const std::wstring wstr = utfToOld<std::wstring>(str);
+        benchCheck(utfTo<std::wstring>(str) == wstr, "strings: UTF8 -> wide conversion differs from full decode");
+        benchCheck(utfTo<std::string>(wstr) == utfToOld<std::string>(wstr), "strings: wide -> UTF8 conversion differs from full decode");
+        benchCheck(isAsciiString(wstr) == isAsciiStringOld(wstr), "strings: isAsciiString(wchar_t) differs from scalar version");
+
+        std::string upperOld = str;
+        std::erase_if(upperOld, [](char c) { return !isAsciiChar(c); });
+        std::string upperNew = upperOld;
+        toUpperOld(upperOld);
+        toUpperNew(upperNew);
+        benchCheck(upperNew == upperOld, "strings: asciiToUpperInPlace() differs from scalar version");
+    }
+}
+}
+
+
+JsonValue fff::bench::runStringBench(const BenchArgs& args) //throw SysError, BenchCheckFailed
+{
+    const size_t count = args.getNumber<size_t>("count", 1'000'000);
+    const int    runs  = args.getNumber<int>("runs", 5);
+
+    verifyStrings(); //throw BenchCheckFailed
+
+    const std::vector<std::string> strings = generateStrings(count);
+    std::vector<std::wstring> wstrings;
+    std::vector<std::string> asciiStrings;
+    size_t totalBytes = 0;
+    for (const std::string& str : strings)
+    {
+        wstrings.push_back(utfTo<std::wstring>(str));
+        asciiStrings.push_back(str);
+        std::erase_if(asciiStrings.back(), [](char c) { return !isAsciiChar(c); });
+        totalBytes += str.size();
+    }
+
+    auto timeAll = [&](auto&& container, auto fun)
+    {
+        return timeBestMs(runs, [&]
+        {
+            size_t dummy = 0;
+            for (auto& str : container)
+                dummy += fun(str);
+            doNotOptimize(dummy);
+        });
+    };
+
+    JsonValue jresult;
+    setJson(jresult, "strings", JsonValue(static_cast<int64_t>(count)));
+    setJson(jresult, "bytes",   JsonValue(static_cast<int64_t>(totalBytes)));
+
+    setJson(jresult, "hash", makeComparison(timeAll(strings, [](const std::string& str) { return hashString<size_t>(str); }),
+                                            timeAll(strings, [](const std::string& str) { return StringHash()(str); })));
+
+    setJson(jresult, "ascii", makeComparison(timeAll(strings, [](const std::string& str) { return static_cast<size_t>(isAsciiStringOld(str)); }),
+                                             timeAll(strings, [](const std::string& str) { return static_cast<size_t>(isAsciiString   (str)); })));
+
+    std::vector<std::string> asciiStringsOld = asciiStrings; //upper-case after first run: same work for old and new
+    setJson(jresult, "upper", makeComparison(timeAll(asciiStringsOld, toUpperOld),
+                                             timeAll(asciiStrings,    toUpperNew)));
+
+    setJson(jresult, "utf8_to_wide", makeComparison(timeAll(strings, [](const std::string& str) { return utfToOld<std::wstring>(str).size(); }),
+                                                    timeAll(strings, [](const std::string& str) { return utfTo   <std::wstring>(str).size(); })));
+
+    setJson(jresult, "wide_to_utf8", makeComparison(timeAll(wstrings, [](const std::wstring& str) { return utfToOld<std::string>(str).size(); }),
+                                                    timeAll(wstrings, [](const std::wstring& str) { return utfTo   <std::string>(str).size(); })));
+    return jresult;
+}
+
+
+void fff::bench::verifyStringBench() { verifyStrings(); } //throw BenchCheckFailed
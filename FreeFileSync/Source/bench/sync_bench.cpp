@@ -0,0 +1,406 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include "bench.h"
+#include <cmath>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <unistd.h>
+#include <zen/file_access.h>
+#include <zen/file_io.h>
+#include "../base/algorithm.h"
+#include "../base/comparison.h"
+#include "../base/db_file.h"
+#include "../base/parallel_scan.h"
+#include "../base/synchronization.h"
+#include "../afs/concrete.h"
+#include "../afs/io_metrics.h"
+
+using namespace zen;
+using namespace fff;
+using namespace fff::bench;
+
+
+/*  End-to-end benchmark on a synthetic folder tree:
+
+    ffs_bench sync [--files 10000] [--depth 3] [--fanout 8] [--size-min 0] [--size-max 65536]
+                   [--changed 5] [--seed 0] [--compare time_size|content] [--work <local folder>] [--target <folder path phrase>]
+
+    1. generate left folder tree: "--depth" levels with "--fanout" subfolders each, "--files" files with log-uniform size distribution
+    2. initial two-way sync into "--target" (default: <work>/right), e.g. "sftp://user@localhost/tmp/ffs_bench" => also creates sync.ffs_db
+    3. change "--changed" percent of the files on the left: 1/3 updated, 1/3 deleted, 1/3 new
+    4. time traversal, comparison, sync directions, database load, synchronization and database save
+
+    Same seed => same tree, same changes.                                                                                            */
+namespace
+{
+class TreeGenerator
+{
+public:
+    TreeGenerator(uint64_t seed, uint64_t sizeMin, uint64_t sizeMax) : rng_(seed), sizeMin_(sizeMin), sizeMax_(std::max(sizeMin, sizeMax)) {}
+
+    size_t nextIndex(size_t count) { return static_cast<size_t>(rng_() % count); } //std::uniform_int_distribution is not portable => keep results reproducible
+
+    uint64_t nextFileSize() //log-uniform: many small, few big files
+    {
+        const double lo = std::log(static_cast<double>(sizeMin_ + 1));
+        const double hi = std::log(static_cast<double>(sizeMax_ + 1));
+        const double frac = static_cast<double>(rng_() >> 11) / static_cast<double>(1ULL << 53);
+        return std::min(sizeMax_, static_cast<uint64_t>(std::exp(lo + frac * (hi - lo))) - 1);
+    }
+
+    std::string nextFileContent(uint64_t fileSize)
+    {
+        std::string content(fileSize, '\0');
+        for (size_t i = 0; i < content.size(); i += sizeof(uint64_t))
+        {
+            const uint64_t val = rng_();
+            std::memcpy(content.data() + i, &val, std::min(sizeof(val), content.size() - i));
+        }
+        return content;
+    }
+
+private:
+    std::mt19937_64 rng_; //same sequence on all platforms
+    const uint64_t sizeMin_;
+    const uint64_t sizeMax_;
+};
+
+
+const time_t GENERATED_MOD_TIME = 1'600'000'000; //2020-09-13
+
+
+struct GeneratedTree
+{
+    std::vector<Zstring> folderPaths; //including root
+    std::vector<Zstring> filePaths;
+    int64_t totalBytes = 0;
+};
+
+
+void writeFile(const Zstring& filePath, const std::string& content, time_t modTime) //throw FileError
+{
+    setFileContent(filePath, content, nullptr /*notifyUnbufferedIO*/); //throw FileError
+    setFileTime(filePath, modTime, ProcSymlink::follow); //throw FileError
+}
+
+
+GeneratedTree generateTree(const Zstring& rootPath, size_t fileCount, size_t depth, size_t fanout, TreeGenerator& gen) //throw FileError
+{
+    GeneratedTree tree;
+    tree.folderPaths.push_back(rootPath);
+    createDirectoryIfMissingRecursion(rootPath); //throw FileError
+
+    size_t levelBegin = 0;
+    for (size_t level = 0; level < depth; ++level)
+    {
+        const size_t levelEnd = tree.folderPaths.size();
+        for (size_t i = levelBegin; i < levelEnd; ++i)
+            for (size_t j = 0; j < fanout; ++j)
+            {
+                const Zstring folderPath = appendPath(tree.folderPaths[i], Zstr("dir") + numberTo<Zstring>(j));
+                createDirectory(folderPath); //throw FileError, ErrorTargetExisting
+                tree.folderPaths.push_back(folderPath);
+            }
+        levelBegin = levelEnd;
+    }
+
+    for (size_t i = 0; i < fileCount; ++i)
+    {
+        const Zstring filePath = appendPath(tree.folderPaths[gen.nextIndex(tree.folderPaths.size())], Zstr("file") + numberTo<Zstring>(i) + Zstr(".dat"));
+        const std::string content = gen.nextFileContent(gen.nextFileSize());
+
+        writeFile(filePath, content, GENERATED_MOD_TIME + static_cast<time_t>(gen.nextIndex(365 * 24 * 3600))); //throw FileError
+        tree.filePaths.push_back(filePath);
+        tree.totalBytes += content.size();
+    }
+    return tree;
+}
+
+
+struct TreeChanges
+{
+    int updated = 0;
+    int deleted = 0;
+    int created = 0;
+};
+
+
+TreeChanges changeTree(GeneratedTree& tree, double changedPercent, TreeGenerator& gen) //throw FileError
+{
+    //Fisher-Yates: std::shuffle is implementation-defined
+    std::vector<size_t> fileIdxs(tree.filePaths.size());
+    std::iota(fileIdxs.begin(), fileIdxs.end(), 0);
+    for (size_t i = fileIdxs.size(); i > 1; --i)
+        std::swap(fileIdxs[i - 1], fileIdxs[gen.nextIndex(i)]);
+
+    const size_t changeCount = std::min(fileIdxs.size(), static_cast<size_t>(tree.filePaths.size() * changedPercent / 100));
+
+    TreeChanges changes;
+    for (size_t i = 0; i < changeCount; ++i)
+    {
+        const Zstring& filePath = tree.filePaths[fileIdxs[i]];
+        switch (i % 3)
+        {
+            case 0: //newer and (probably) different size
+                writeFile(filePath, gen.nextFileContent(gen.nextFileSize()), GENERATED_MOD_TIME + 400 * 24 * 3600); //throw FileError
+                ++changes.updated;
+                break;
+            case 1:
+                removeFilePlain(filePath); //throw FileError
+                ++changes.deleted;
+                break;
+            case 2:
+                writeFile(appendPath(tree.folderPaths[gen.nextIndex(tree.folderPaths.size())], Zstr("new") + numberTo<Zstring>(i) + Zstr(".dat")),
+                          gen.nextFileContent(gen.nextFileSize()), GENERATED_MOD_TIME + 400 * 24 * 3600); //throw FileError
+                ++changes.created;
+                break;
+        }
+    }
+    return changes;
+}
+
+
+//headless: log errors and carry on
+class BenchCallback : public ProcessCallback
+{
+public:
+    void initNewPhase(int itemsTotal, int64_t bytesTotal, ProcessPhase phaseId) override
+    {
+        itemsTotal_ = itemsTotal;
+        bytesTotal_ = bytesTotal;
+        itemsProcessed_ = 0;
+        bytesProcessed_ = 0;
+    }
+
+    void updateDataProcessed(int itemsDelta, int64_t bytesDelta) override { itemsProcessed_ += itemsDelta; bytesProcessed_ += bytesDelta; }
+    void updateDataTotal    (int itemsDelta, int64_t bytesDelta) override { itemsTotal_     += itemsDelta; bytesTotal_     += bytesDelta; }
+
+    void requestUiUpdate(bool force) override {}
+    void updateStatus(std::wstring&& msg) override {}
+
+    void logMessage(const std::wstring& msg, MsgType type) override
+    {
+        if (type != MsgType::info)
+            std::cerr << utfTo<std::string>(msg) << '\n';
+    }
+
+    void reportWarning(const std::wstring& msg, bool& warningActive) override { ++warningCount_; logMessage(msg, MsgType::warning); }
+
+    Response reportError(const ErrorInfo& errorInfo) override { ++errorCount_; logMessage(errorInfo.msg, MsgType::error); return ignore; }
+
+    void reportFatalError(const std::wstring& msg) override { ++errorCount_; logMessage(msg, MsgType::error); }
+
+    int     getItemsProcessed() const { return itemsProcessed_; }
+    int64_t getBytesProcessed() const { return bytesProcessed_; }
+    int getErrorCount  () const { return errorCount_; }
+    int getWarningCount() const { return warningCount_; }
+
+private:
+    int     itemsTotal_     = 0;
+    int64_t bytesTotal_     = 0;
+    int     itemsProcessed_ = 0;
+    int64_t bytesProcessed_ = 0;
+    int errorCount_   = 0;
+    int warningCount_ = 0;
+};
+
+
+class SyncRunner
+{
+public:
+    SyncRunner(const MainConfiguration& mainCfg, BenchCallback& cb) : mainCfg_(mainCfg), cb_(cb) {}
+
+    FolderComparison compare() //throw FileError
+    {
+        std::unique_ptr<LockHolder> dirLocks;
+        FolderComparison cmpResult = fff::compare(warnings_,
+                                                  FILE_TIME_TOLERANCE,
+                                                  false /*detectMovesByContent*/,
+                                                  nullptr /*requestPassword*/,
+                                                  false /*runWithBackgroundPriority*/,
+                                                  false /*createDirLocks*/,
+                                                  dirLocks,
+                                                  extractCompareCfg(mainCfg_),
+                                                  cb_);
+        if (cmpResult.empty())
+            throw FileError(L"Comparison failed.");
+        return cmpResult;
+    }
+
+    void synchronize(FolderComparison& cmpResult)
+    {
+        fff::synchronize(std::chrono::system_clock::now(),
+                         false /*verifyCopiedFiles*/,
+                         false /*copyLockedFiles*/,
+                         false /*copyFilePermissions*/,
+                         true  /*failSafeFileCopy*/,
+                         false /*runWithBackgroundPriority*/,
+                         extractSyncCfg(mainCfg_),
+                         cmpResult,
+                         warnings_,
+                         cb_);
+    }
+
+private:
+    static constexpr int FILE_TIME_TOLERANCE = 2; //default of GlobalSettings.xml
+
+    const MainConfiguration mainCfg_;
+    BenchCallback& cb_;
+    WarningDialogs warnings_;
+};
+
+
+int64_t countDifferences(FolderComparison& cmpResult)
+{
+    int64_t count = 0;
+    for (zen::SharedRef<BaseFolderPair>& baseFolder : cmpResult)
+        visitFSObjectRecursively(baseFolder.ref(), [&](const FolderPair& folder) { if (folder.getCategory() != FILE_EQUAL) ++count; },
+    [&](const FilePair& file) { if (file.getCategory() != FILE_EQUAL) ++count; },
+    [&](const SymlinkPair& symlink) { if (symlink.getCategory() != FILE_EQUAL) ++count; });
+    return count;
+}
+
+
+double msSince(const StopWatch& watch) { return std::chrono::duration<double, std::milli>(watch.elapsed()).count(); }
+}
+
+
+JsonValue fff::bench::runSyncBench(const BenchArgs& args) //throw SysError
+{
+    const size_t fileCount = args.getNumber<size_t>("files",   10'000);
+    const size_t depth     = args.getNumber<size_t>("depth",   3);
+    const size_t fanout    = args.getNumber<size_t>("fanout",  8);
+    const uint64_t sizeMin = args.getNumber<uint64_t>("size-min", 0);
+    const uint64_t sizeMax = args.getNumber<uint64_t>("size-max", 64 * 1024);
+    const double changedPercent = args.getNumber<double>("changed", 5);
+    const uint64_t seed    = args.getNumber<uint64_t>("seed", 0);
+    const std::string cmpVarName = args.getString("compare", "time_size");
+
+    try
+    {
+        const Zstring workPath = utfTo<Zstring>(args.getString("work", utfTo<std::string>(appendPath(getTempFolderPath(), //throw FileError
+                                                                                                       Zstr("ffs_bench_") + numberTo<Zstring>(::getpid())))));
+        const Zstring leftPath = appendPath(workPath, Zstr("left"));
+        const Zstring targetPhrase = utfTo<Zstring>(args.getString("target", utfTo<std::string>(appendPath(workPath, Zstr("right")))));
+        const AbstractPath targetPath = createAbstractPath(targetPhrase);
+
+        if (itemExists(workPath)) //throw FileError
+            throw FileError(replaceCpy<std::wstring>(L"Folder %x already exists.", L"%x", fmtPath(workPath)));
+        if (AFS::itemExists(targetPath)) //throw FileError
+            throw FileError(replaceCpy<std::wstring>(L"Folder %x already exists.", L"%x", fmtPath(AFS::getDisplayPath(targetPath))));
+
+        auto cleanUp = [&]
+        {
+            try { AFS::removeFolderIfExistsRecursion(targetPath, nullptr, nullptr, nullptr); } catch (FileError&) {}
+            try { removeDirectoryPlainRecursion(workPath); } catch (FileError&) {}
+        };
+        ZEN_ON_SCOPE_EXIT(cleanUp());
+
+        MainConfiguration mainCfg;
+        mainCfg.cmpCfg.compareVar = cmpVarName == "content" ? CompareVariant::content : CompareVariant::timeSize;
+        mainCfg.syncCfg.directionCfg = getDefaultSyncCfg(SyncVariant::twoWay); //uses sync.ffs_db
+        mainCfg.syncCfg.deletionVariant = DeletionVariant::permanent;
+        mainCfg.firstPair.folderPathPhraseLeft  = leftPath;
+        mainCfg.firstPair.folderPathPhraseRight = targetPhrase;
+
+        JsonValue jresult;
+        {
+            JsonValue jparams;
+            setJson(jparams, "files",    JsonValue(static_cast<int64_t>(fileCount)));
+            setJson(jparams, "depth",    JsonValue(static_cast<int64_t>(depth)));
+            setJson(jparams, "fanout",   JsonValue(static_cast<int64_t>(fanout)));
+            setJson(jparams, "size_min", JsonValue(static_cast<int64_t>(sizeMin)));
+            setJson(jparams, "size_max", JsonValue(static_cast<int64_t>(sizeMax)));
+            setJson(jparams, "changed_percent", JsonValue(changedPercent));
+            setJson(jparams, "seed",     JsonValue(static_cast<int64_t>(seed)));
+            setJson(jparams, "compare",  JsonValue(cmpVarName));
+            setJson(jparams, "target",   JsonValue(utfTo<std::string>(AFS::getDisplayPath(targetPath))));
+            setJson(jresult, "parameters", std::move(jparams));
+        }
+
+        TreeGenerator gen(seed, sizeMin, sizeMax);
+        BenchCallback cb;
+        SyncRunner runner(mainCfg, cb);
+        JsonValue jphases;
+        //---------------------------------------------------------------------------
+        StopWatch watch;
+        GeneratedTree tree = generateTree(leftPath, fileCount, depth, fanout, gen); //throw FileError
+        setJson(jphases, "generate_ms", JsonValue(msSince(watch)));
+        setJson(jresult, "folders", JsonValue(static_cast<int64_t>(tree.folderPaths.size())));
+        setJson(jresult, "bytes",   JsonValue(tree.totalBytes));
+
+        watch = StopWatch();
+        {
+            FolderComparison cmpResult = runner.compare(); //throw FileError
+            runner.synchronize(cmpResult);
+        }
+        setJson(jphases, "initial_sync_ms", JsonValue(msSince(watch)));
+
+        const TreeChanges changes = changeTree(tree, changedPercent, gen); //throw FileError
+        setJson(jresult, "changes_updated", JsonValue(changes.updated));
+        setJson(jresult, "changes_deleted", JsonValue(changes.deleted));
+        setJson(jresult, "changes_created", JsonValue(changes.created));
+        //---------------------------------------------------------------------------
+        resetIoMetrics();
+        const StopWatch totalWatch;
+
+        watch = StopWatch();
+        {
+            const std::vector<FolderPairCfg> fpCfgs = extractCompareCfg(mainCfg);
+            std::set<DirectoryKey> foldersToRead;
+            for (const AbstractPath& folderPath : {createAbstractPath(leftPath), targetPath})
+                foldersToRead.insert({folderPath, fpCfgs[0].filter.nameFilter, fpCfgs[0].handleSymlinks});
+
+            NamePool names;
+            const std::map<DirectoryKey, DirectoryValue> folderBuffer = parallelDeviceTraversal(foldersToRead,
+            [&](const PhaseCallback::ErrorInfo& errorInfo) { return cb.reportError(errorInfo); },
+            [](const std::wstring& statusLine, int itemsTotal) {}, UI_UPDATE_INTERVAL / 2, names);
+            doNotOptimize(folderBuffer);
+        }
+        setJson(jphases, "traversal_ms", JsonValue(msSince(watch)));
+
+        watch = StopWatch();
+        FolderComparison cmpResult = runner.compare(); //throw FileError
+        setJson(jphases, "compare_ms", JsonValue(msSince(watch)));
+        setJson(jresult, "differences", JsonValue(countDifferences(cmpResult)));
+
+        watch = StopWatch();
+        redetermineSyncDirection(extractDirectionCfg(cmpResult, mainCfg), cb);
+        setJson(jphases, "sync_direction_ms", JsonValue(msSince(watch)));
+
+        watch = StopWatch();
+        {
+            NamePool names;
+            doNotOptimize(loadLastSynchronousState({&cmpResult[0].ref()}, names, cb));
+        }
+        setJson(jphases, "db_load_ms", JsonValue(msSince(watch)));
+
+        watch = StopWatch();
+        runner.synchronize(cmpResult);
+        setJson(jphases, "sync_ms", JsonValue(msSince(watch)));
+        setJson(jresult, "sync_items", JsonValue(cb.getItemsProcessed()));
+        setJson(jresult, "sync_bytes", JsonValue(cb.getBytesProcessed()));
+
+        watch = StopWatch();
+        saveLastSynchronousState(cmpResult[0].ref(), true /*transactionalCopy*/, cb);
+        setJson(jphases, "db_save_ms", JsonValue(msSince(watch)));
+
+        setJson(jresult, "phases", std::move(jphases));
+        setJson(jresult, "errors",   JsonValue(cb.getErrorCount()));
+        setJson(jresult, "warnings", JsonValue(cb.getWarningCount()));
+        try
+        {
+            setJson(jresult, "io_metrics", parseJson(getIoMetricsJson(getIoMetrics(), //throw JsonParsingError
+                                                                      std::chrono::duration_cast<std::chrono::milliseconds>(totalWatch.elapsed()))));
+        }
+        catch (JsonParsingError&) { assert(false); }
+
+        return jresult;
+    }
+    catch (const FileError& e) { throw SysError(e.toString()); }
+}
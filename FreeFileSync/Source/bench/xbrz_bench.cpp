@@ -0,0 +1,220 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include "bench.h"
+#include <zen/scope_guard.h>
+#include <xBRZ/src/xbrz.cpp> //access to the internal kernels and CPU dispatch: xbrz.cpp is NOT part of benchCppFiles!
+
+using namespace zen;
+using namespace fff;
+using namespace fff::bench;
+
+
+/*  xBRZ image scaling (see AVX2 kernels in xBRZ/src/xbrz.cpp): high-DPI icons and images
+
+    ffs_bench xbrz [--width 1024] [--height 1024] [--target 2560] [--runs 5]
+
+    old:  previous implementation: generic bilinearScaleSimple()/nearestNeighborScale() of xbrz_tools.h
+    new:  xbrz::bilinearScale()/nearestNeighborScale(): AVX2 if supported
+    dist_table: distYCbCrBuffered() lookup table (one-time cost of the first xbrz::scale()): scalar vs AVX2
+    scale_Nx:   xbrz::scale() throughput (not changed by the AVX2 kernels except for the table)
+
+    results: target megapixels per second                                                                   */
+namespace
+{
+//=========================== previous implementation ===========================
+void bilinearScaleOld(const uint32_t* src, int srcWidth, int srcHeight,
+                      /**/  uint32_t* trg, int trgWidth, int trgHeight)
+{
+    const auto pixReader = [src, srcWidth](int x, int y, xbrz::BytePixel& pix)
+    {
+        const uint32_t pixSrc = src[y * srcWidth + x];
+
+        const unsigned char a = getAlpha(pixSrc);
+        pix[0] = a;
+        pix[1] = xbrz::premultiply(getRed  (pixSrc), a); //r
+        pix[2] = xbrz::premultiply(getGreen(pixSrc), a); //g
+        pix[3] = xbrz::premultiply(getBlue (pixSrc), a); //b
+    };
+
+    const auto pixWriter = [trg](const xbrz::BytePixel& pix) mutable
+    {
+        const unsigned char a = pix[0];
+        *trg++ = makePixel(a,
+                           xbrz::demultiply(pix[1], a),  //r
+                           xbrz::demultiply(pix[2], a),  //g
+                           xbrz::demultiply(pix[3], a)); //b
+    };
+
+    xbrz::bilinearScaleSimple(pixReader, srcWidth, srcHeight,
+                              pixWriter, trgWidth, trgHeight, 0, trgHeight);
+}
+
+
+void nearestNeighborScaleOld(const uint32_t* src, int srcWidth, int srcHeight,
+                             /**/  uint32_t* trg, int trgWidth, int trgHeight)
+{
+    const auto imgReader = [src, srcWidth](int x, int y, xbrz::BytePixel& pix) { std::memcpy(pix, src + y * srcWidth + x, sizeof(pix)); };
+    const auto imgWriter = [trg](const xbrz::BytePixel& pix) mutable { std::memcpy(trg++, pix, sizeof(pix)); };
+
+    xbrz::nearestNeighborScale(imgReader, srcWidth, srcHeight,
+                               imgWriter, trgWidth, trgHeight, 0, trgHeight);
+}
+//===============================================================================
+
+//icon-like: flat color areas, anti-aliased edges, transparent and semi-transparent pixels
+std::vector<uint32_t> generateImage(int width, int height, uint64_t seed)
+{
+    std::vector<uint32_t> img(static_cast<size_t>(width) * height);
+    uint64_t rng = seed;
+    for (int y = 0; y < height; ++y)
+        for (int x = 0; x < width; ++x)
+        {
+            rng ^= rng << 13; rng ^= rng >> 7; rng ^= rng << 17; //xorshift: reproducible
+            const uint32_t noise = static_cast<uint32_t>(rng >> 32);
+            const uint32_t alpha = (x / 7 + y / 5) % 4 == 0 ? 0 : (x + y) % 9 == 0 ? (noise >> 24) : 255;
+            const uint32_t color = (x / 16 + y / 16) % 3 == 0 ? noise : 0x3080c0 + ((x / 16) << 4);
+
+            img[static_cast<size_t>(y) * width + x] = (alpha << 24) | (color & 0xffffff);
+        }
+    return img;
+}
+
+
+//run with AVX2 dispatch, then with scalar code paths only
+template <class Function>
+void forEachCodePath(Function fun)
+{
+#if defined __x86_64__
+    const bool cpuHasAvx2Orig = cpuHasAvx2;
+    ZEN_ON_SCOPE_EXIT(cpuHasAvx2 = cpuHasAvx2Orig);
+
+    for (const bool avx2 : {true, false})
+        if (!avx2 || cpuHasAvx2Orig)
+        {
+            cpuHasAvx2 = avx2;
+            fun(avx2 ? "avx2" : "scalar");
+        }
+#else
+    fun("scalar");
+#endif
+}
+
+
+void verifyXbrz() //throw BenchCheckFailed
+{
+#if defined __x86_64__
+    if (cpuHasAvx2) //all 2^24 distance table entries
+    {
+        std::vector<float> distScalar(256 * 256 * 256);
+        std::vector<float> distAvx2  (256 * 256 * 256);
+        fillDiffToDist    (distScalar.data());
+        fillDiffToDistAvx2(distAvx2  .data());
+        benchCheck(std::memcmp(distScalar.data(), distAvx2.data(), distAvx2.size() * sizeof(float)) == 0, "xbrz: AVX2 distance table differs from scalar");
+    }
+#endif
+
+    const std::pair<int, int> srcSizes[] = {{1, 1}, {1, 7}, {3, 2}, {16, 16}, {33, 17}, {128, 96}};
+    const std::pair<int, int> trgSizes[] = {{1, 1}, {2, 9}, {7, 5}, {24, 24}, {40, 40}, {79, 31}, {256, 250}};
+
+    forEachCodePath([&](const char* codePath)
+    {
+        uint64_t seed = 1;
+        for (const auto [srcWidth, srcHeight] : srcSizes)
+            for (const auto [trgWidth, trgHeight] : trgSizes)
+            {
+                const std::vector<uint32_t> src = generateImage(srcWidth, srcHeight, seed++);
+                std::vector<uint32_t> trgOld(static_cast<size_t>(trgWidth) * trgHeight);
+                std::vector<uint32_t> trgNew(trgOld.size());
+
+                bilinearScaleOld    (src.data(), srcWidth, srcHeight, trgOld.data(), trgWidth, trgHeight);
+                xbrz::bilinearScale (src.data(), srcWidth, srcHeight, trgNew.data(), trgWidth, trgHeight);
+                benchCheck(trgNew == trgOld, std::string("xbrz: bilinearScale() differs from previous implementation: ") + codePath);
+
+                nearestNeighborScaleOld   (src.data(), srcWidth, srcHeight, trgOld.data(), trgWidth, trgHeight);
+                xbrz::nearestNeighborScale(src.data(), srcWidth, srcHeight, trgNew.data(), trgWidth, trgHeight);
+                benchCheck(trgNew == trgOld, std::string("xbrz: nearestNeighborScale() differs from previous implementation: ") + codePath);
+            }
+    });
+}
+}
+
+
+JsonValue fff::bench::runXbrzBench(const BenchArgs& args) //throw SysError, BenchCheckFailed
+{
+    const int srcWidth  = std::max(args.getNumber<int>("width",  1024), 1);
+    const int srcHeight = std::max(args.getNumber<int>("height", 1024), 1);
+    const int trgSize   = std::max(args.getNumber<int>("target", 2560), 1);
+    const int runs      = args.getNumber<int>("runs", 5);
+
+    verifyXbrz(); //throw BenchCheckFailed
+
+    const std::vector<uint32_t> src = generateImage(srcWidth, srcHeight, 42);
+
+    auto toMpPerSec = [](size_t pixels, double ms) { return JsonValue(pixels / 1e6 / (ms / 1000)); };
+
+    JsonValue jresult;
+    setJson(jresult, "source", JsonValue(numberTo<std::string>(srcWidth) + 'x' + numberTo<std::string>(srcHeight)));
+    setJson(jresult, "target", JsonValue(numberTo<std::string>(trgSize)  + 'x' + numberTo<std::string>(trgSize)));
+#if defined __x86_64__
+    setJson(jresult, "avx2", JsonValue(cpuHasAvx2));
+#endif
+
+    //bilinear, nearest neighbor: old vs new (for each code path)
+    {
+        std::vector<uint32_t> trg(static_cast<size_t>(trgSize) * trgSize);
+        const size_t trgPixels = trg.size();
+
+        const double bilinearOldMs = timeBestMs(runs, [&] { bilinearScaleOld       (src.data(), srcWidth, srcHeight, trg.data(), trgSize, trgSize); });
+        const double nearestOldMs  = timeBestMs(runs, [&] { nearestNeighborScaleOld(src.data(), srcWidth, srcHeight, trg.data(), trgSize, trgSize); });
+
+        forEachCodePath([&](const char* codePath)
+        {
+            const double bilinearNewMs = timeBestMs(runs, [&] { xbrz::bilinearScale       (src.data(), srcWidth, srcHeight, trg.data(), trgSize, trgSize); });
+            const double nearestNewMs  = timeBestMs(runs, [&] { xbrz::nearestNeighborScale(src.data(), srcWidth, srcHeight, trg.data(), trgSize, trgSize); });
+
+            JsonValue jbilinear = makeComparison(bilinearOldMs, bilinearNewMs);
+            setJson(jbilinear, "old_mp_per_s", toMpPerSec(trgPixels, bilinearOldMs));
+            setJson(jbilinear, "new_mp_per_s", toMpPerSec(trgPixels, bilinearNewMs));
+
+            JsonValue jnearest = makeComparison(nearestOldMs, nearestNewMs);
+            setJson(jnearest, "old_mp_per_s", toMpPerSec(trgPixels, nearestOldMs));
+            setJson(jnearest, "new_mp_per_s", toMpPerSec(trgPixels, nearestNewMs));
+
+            setJson(jresult, std::string("bilinear_") + codePath, std::move(jbilinear));
+            setJson(jresult, std::string("nearest_")  + codePath, std::move(jnearest));
+        });
+    }
+
+    //distance table build
+    {
+        std::vector<float> dist(256 * 256 * 256);
+        const double scalarMs = timeBestMs(runs, [&] { fillDiffToDist(dist.data()); });
+#if defined __x86_64__
+        if (cpuHasAvx2)
+            setJson(jresult, "dist_table", makeComparison(scalarMs, timeBestMs(runs, [&] { fillDiffToDistAvx2(dist.data()); })));
+        else
+#endif
+            setJson(jresult, "dist_table_scalar_ms", JsonValue(scalarMs));
+    }
+
+    //xBRZ scaling: unchanged besides distance table => throughput reference only
+    xbrz::scale(2, src.data(), std::vector<uint32_t>(src.size() * 4).data(), srcWidth, srcHeight, xbrz::ColorFormat::argb); //build distance table: not timed
+    for (size_t factor = 2; factor <= xbrz::SCALE_FACTOR_MAX; ++factor)
+    {
+        std::vector<uint32_t> trg(src.size() * factor * factor);
+        const double ms = timeBestMs(runs, [&] { xbrz::scale(factor, src.data(), trg.data(), srcWidth, srcHeight, xbrz::ColorFormat::argb); });
+
+        JsonValue jscale;
+        setJson(jscale, "ms",       JsonValue(ms));
+        setJson(jscale, "mp_per_s", toMpPerSec(trg.size(), ms));
+        setJson(jresult, "scale_" + numberTo<std::string>(factor) + "x", std::move(jscale));
+    }
+    return jresult;
+}
+
+
+void fff::bench::verifyXbrzBench() { verifyXbrz(); } //throw BenchCheckFailed
@@ -23,7 +23,7 @@ using namespace fff; //required for correct overload resolution!
 namespace
 {
 //-------------------------------------------------------------------------------------------------------------------------------
-const int XML_FORMAT_GLOBAL_CFG = 27; //2023-05-13
+const int XML_FORMAT_GLOBAL_CFG = 28; //2026-10-18
 const int XML_FORMAT_SYNC_CFG   = 23; //2023-08-24
 //-------------------------------------------------------------------------------------------------------------------------------
 }
@@ -780,6 +780,25 @@ bool readStruc(const XmlElement& input, ExternalApp& value)
 }
 
 
+template <> inline
+void writeStruc(const BlockSizeTuningConfig& value, XmlElement& output)
+{
+    output.setAttribute("Path",  value.folderPathPhrase);
+    output.setAttribute("Read",  value.readMultiplier);
+    output.setAttribute("Write", value.writeMultiplier);
+}
+
+template <> inline
+bool readStruc(const XmlElement& input, BlockSizeTuningConfig& value)
+{
+    bool success = true;
+    success = input.getAttribute("Path",  value.folderPathPhrase) && success;
+    success = input.getAttribute("Read",  value.readMultiplier)   && success;
+    success = input.getAttribute("Write", value.writeMultiplier)  && success;
+    return success; //[!] avoid short-circuit evaluation
+}
+
+
 template <> inline
 void writeText(const TaskResult& value, std::string& output)
 {
@@ -1374,6 +1393,12 @@ void readConfig(const XmlIn& in, XmlGlobalSettings& cfg, int formatVer)
     in2["RunWithBackgroundPriority"].attribute("Enabled", cfg.runWithBackgroundPriority);
     in2["LockDirectoriesDuringSync"].attribute("Enabled", cfg.createLockFile);
     in2["VerifyCopiedFiles"        ].attribute("Enabled", cfg.verifyFileCopy);
+    if (formatVer >= 28) //TODO: remove condition after migration! 2026-10-18
+    {
+        in2["DetectMovedFilesByContent"].attribute("Enabled", cfg.detectMovedFilesByContent);
+        in2["Tracing"                  ].attribute("Enabled", cfg.enableTracing);
+        in2["BlockSizeTuning"](cfg.blockSizeTuning);
+    }
     in2["LogFiles"                 ].attribute("MaxAge",  cfg.logfilesMaxAgeDays);
     in2["LogFiles"                 ].attribute("Format",  cfg.logFormat);
 
@@ -1511,6 +1536,8 @@ void readConfig(const XmlIn& in, XmlGlobalSettings& cfg, int formatVer)
         inFilePanel.attribute("ShowIcons", cfg.mainDlg.showIcons);
         inFilePanel.attribute("IconSize",  cfg.mainDlg.iconSize);
     }
+    if (formatVer >= 28) //TODO: remove condition after migration! 2026-10-18
+        inFilePanel.attribute("IconThreads", cfg.mainDlg.iconLoaderThreads);
     inFilePanel.attribute("SashOffset", cfg.mainDlg.sashOffset);
 
     //TODO: remove if parameter migration after some time! 2020-01-30
@@ -2145,6 +2172,9 @@ void writeConfig(const XmlGlobalSettings& cfg, XmlOut& out)
     out["RunWithBackgroundPriority"].attribute("Enabled", cfg.runWithBackgroundPriority);
     out["LockDirectoriesDuringSync"].attribute("Enabled", cfg.createLockFile);
     out["VerifyCopiedFiles"        ].attribute("Enabled", cfg.verifyFileCopy);
+    out["DetectMovedFilesByContent"].attribute("Enabled", cfg.detectMovedFilesByContent);
+    out["Tracing"                  ].attribute("Enabled", cfg.enableTracing);
+    out["BlockSizeTuning"](cfg.blockSizeTuning);
     out["LogFiles"                 ].attribute("MaxAge",  cfg.logfilesMaxAgeDays);
     out["LogFiles"                 ].attribute("Format",  cfg.logFormat);
 
@@ -2200,6 +2230,7 @@ void writeConfig(const XmlGlobalSettings& cfg, XmlOut& out)
     XmlOut outFilePanel = outMainWin["FilePanel"];
     outFilePanel.attribute("ShowIcons",  cfg.mainDlg.showIcons);
     outFilePanel.attribute("IconSize",   cfg.mainDlg.iconSize);
+    outFilePanel.attribute("IconThreads", cfg.mainDlg.iconLoaderThreads);
     outFilePanel.attribute("SashOffset", cfg.mainDlg.sashOffset);
     outFilePanel.attribute("FolderPairsMax", cfg.mainDlg.folderPairsVisibleMax);
     outFilePanel.attribute("PathFormatLeft",  cfg.mainDlg.itemPathFormatLeftGrid);
@@ -2409,14 +2440,14 @@ ErrorLog fff::loadErrorLog(const Zstring& filePath) //throw FileError
         Zstring timeStr;
         inMsg.attribute("Time", timeStr);
 
-        Zstringc msg;
+        std::string msg;
         inMsg(msg);
 
         log.push_back(
         {
             .time = localToTimeT(parseTime(formatIsoDateTimeTag, timeStr)).first,
             .type = *inMsg.getName() == "Error" ? MessageType::MSG_TYPE_ERROR : (*inMsg.getName() == "Warning" ? MessageType::MSG_TYPE_WARNING : MessageType::MSG_TYPE_INFO),
-            .message = std::move(msg),
+            .message = msg,
         });
     });
 
@@ -40,6 +40,14 @@ struct ExternalApp
     Zstring cmdLine;
 };
 
+
+struct BlockSizeTuningConfig
+{
+    Zstring folderPathPhrase;
+    size_t readMultiplier  = 1; //see afs/block_size_tuning.h
+    size_t writeMultiplier = 1; //
+};
+
 extern const ExternalApp extCommandFileManager;
 extern const ExternalApp extCommandOpenDefault;
 
@@ -154,6 +162,9 @@ struct XmlGlobalSettings
     bool runWithBackgroundPriority = false;
     bool createLockFile = true;
     bool verifyFileCopy = false;
+    bool detectMovedFilesByContent = false; //devices without file IDs (e.g. FTP): expensive => opt-in
+    bool enableTracing = false; //save Chrome trace-event JSON next to log file
+    std::vector<BlockSizeTuningConfig> blockSizeTuning; //batch mode: determined via "-calibrate" command line option
     int logfilesMaxAgeDays = 30; //<= 0 := no limit; for log files under %AppData%\FreeFileSync\Logs
     LogFileFormat logFormat = LogFileFormat::html;
 
@@ -206,6 +217,7 @@ struct XmlGlobalSettings
 
         bool showIcons = true;
         GridIconSize iconSize = GridIconSize::small;
+        size_t iconLoaderThreads = 2; //thumbnails: decoding full image files is CPU-bound
         int sashOffset = 0;
 
         ItemPathFormat itemPathFormatLeftGrid  = defaultItemPathFormatLeftGrid;
@@ -10,11 +10,18 @@
 #include <variant>
 #include <zen/thread.h> //includes <std/thread.hpp>
 #include <zen/scope_guard.h>
+#include <zen/file_access.h>
+#include <zen/file_io.h>
+#include <zen/file_traverser.h>
+#include <zen/serialize.h>
+#include <zen/zlib_wrap.h>
+#include <zen/extra_log.h>
 #include <wx+/dc.h>
 #include <wx+/image_resources.h>
 #include <wx+/image_tools.h>
 #include <wx+/std_button_layout.h>
 #include "base/icon_loader.h"
+#include "ffs_paths.h"
 
 
 using namespace zen;
@@ -26,13 +33,146 @@ namespace
 {
 const size_t BUFFER_SIZE_MAX = 1000; //maximum number of icons to hold in buffer: must be big enough to hold visible icons + preload buffer!
 
-
+const uint64_t THUMBNAIL_CACHE_BYTES_MAX = 200 * 1024 * 1024;
+const int      THUMBNAIL_CACHE_FORMAT_VER = 1;
 }
 
+//---------------------- Thumbnail Disk Cache -------------------------
+/*  getThumbnailImage() reads and decodes the *full* image file => slow for large photos and network shares, so keep thumbnails across sessions:
+    - content-addressed: file name := hash(display path, file size, modification time, thumbnail size) => modified files are simply not hit anymore
+    - LRU eviction: cache file modification time is refreshed on each hit
+    - safe to call from multiple loader threads: setFileContent() writes via temp file + rename                                                  */
+class ThumbnailDiskCache
+{
+public:
+    explicit ThumbnailDiskCache(const Zstring& folderPath) : folderPath_(folderPath) {}
+
+    static std::optional<std::string> getKey(const IconBuffer::IconSource& item, int thumbnailSize)
+    {
+        if (item.modTime == 0)
+            return {};
+        return utfTo<std::string>(AFS::getDisplayPath(item.filePath)) + '|' + numberTo<std::string>(item.fileSize) + '|' +
+               numberTo<std::string>(item.modTime) + '|' + numberTo<std::string>(thumbnailSize);
+    }
+
+    ImageHolder load(const std::string& key) //noexcept; empty if not cached
+    {
+        initOnce();
+        const Zstring& filePath = getFilePath(key);
+        try
+        {
+            const std::string byteStream = decompress(getFileContent(filePath, nullptr /*notifyUnbufferedIO*/)); //throw FileError, SysError
+            MemoryStreamIn memIn(byteStream);
+
+            if (readNumber<int32_t>(memIn) != THUMBNAIL_CACHE_FORMAT_VER || //throw SysErrorUnexpectedEos
+                readContainer<std::string>(memIn) != key) //hash collision
+                return {};
+
+            const int  width    = readNumber<int32_t>(memIn); //
+            const int  height   = readNumber<int32_t>(memIn); //throw SysErrorUnexpectedEos
+            const bool hasAlpha = readNumber<int8_t >(memIn) != 0; //
+
+            if (width <= 0 || height <= 0 ||
+                static_cast<size_t>(width) * height * (hasAlpha ? 4 : 3) != byteStream.size() - memIn.pos()) //don't trust size before allocating
+                return {};
+
+            ImageHolder ih(width, height, hasAlpha);
+            readArray(memIn, ih.getRgb(), width * height * 3); //throw SysErrorUnexpectedEos
+            if (hasAlpha)
+                readArray(memIn, ih.getAlpha(), width * height); //
+
+            try { setFileTime(filePath, std::time(nullptr), ProcSymlink::follow); } //throw FileError
+            catch (const FileError& e) { logExtraError(e.toString()); } //no big deal: just gets evicted earlier
+
+            return ih;
+        }
+        catch (FileError&) {} //not cached (yet)
+        catch (const SysError& e) { logExtraError(e.toString()); } //corrupted => will be overwritten
+
+        return {};
+    }
+
+    void store(const std::string& key, ImageHolder& ih) //noexcept
+    {
+        assert(ih);
+        initOnce();
+        const int width  = ih.getWidth();
+        const int height = ih.getHeight();
+
+        MemoryStreamOut memOut;
+        writeNumber<int32_t>(memOut, THUMBNAIL_CACHE_FORMAT_VER);
+        writeContainer(memOut, key);
+        writeNumber<int32_t>(memOut, width);
+        writeNumber<int32_t>(memOut, height);
+        writeNumber<int8_t >(memOut, ih.getAlpha() ? 1 : 0);
+        writeArray(memOut, ih.getRgb(), width * height * 3);
+        if (ih.getAlpha())
+            writeArray(memOut, ih.getAlpha(), width * height);
+        try
+        {
+            setFileContent(getFilePath(key), compress(memOut.ref(), 3 /*level*/), nullptr /*notifyUnbufferedIO*/); //throw FileError, SysError
+        }
+        catch (const FileError& e) { logExtraError(e.toString()); }
+        catch (const SysError&  e) { logExtraError(e.toString()); }
+    }
+
+private:
+    ThumbnailDiskCache           (const ThumbnailDiskCache&) = delete;
+    ThumbnailDiskCache& operator=(const ThumbnailDiskCache&) = delete;
+
+    Zstring getFilePath(const std::string& key) const
+    {
+        return appendPath(folderPath_, printNumber<Zstring>(Zstr("%016llx"), static_cast<unsigned long long>(hashString<uint64_t>(key))));
+    }
+
+    void initOnce() //run on first access by *some* loader thread: don't block main thread with folder traversal
+    {
+        std::call_once(initDone_, [this]
+        {
+            try
+            {
+                createDirectoryIfMissingRecursion(folderPath_); //throw FileError
+
+                std::vector<FileInfo> cacheFiles;
+                uint64_t totalBytes = 0;
+                traverseFolder(folderPath_, [&](const FileInfo& fi) //throw FileError
+                {
+                    cacheFiles.push_back(fi);
+                    totalBytes += fi.fileSize;
+                }, nullptr, nullptr);
+
+                if (totalBytes > THUMBNAIL_CACHE_BYTES_MAX)
+                {
+                    //remove least-recently used (including stale temp files after crash)
+                    std::sort(cacheFiles.begin(), cacheFiles.end(), [](const FileInfo& lhs, const FileInfo& rhs) { return lhs.modTime < rhs.modTime; });
+
+                    for (const FileInfo& fi : cacheFiles)
+                    {
+                        if (totalBytes <= THUMBNAIL_CACHE_BYTES_MAX)
+                            break;
+                        try
+                        {
+                            removeFilePlain(fi.fullPath); //throw FileError
+                            totalBytes -= fi.fileSize;
+                        }
+                        catch (const FileError& e) { logExtraError(e.toString()); }
+                    }
+                }
+            }
+            catch (const FileError& e) { logExtraError(e.toString()); }
+        });
+    }
+
+    const Zstring folderPath_;
+    std::once_flag initDone_;
+};
+
 //################################################################################################################################################
 
-std::variant<ImageHolder, FileIconHolder> getDisplayIcon(const AbstractPath& itemPath, IconBuffer::IconSize sz)
+std::variant<ImageHolder, FileIconHolder> getDisplayIcon(const IconBuffer::IconSource& item, IconBuffer::IconSize sz, ThumbnailDiskCache& diskCache)
 {
+    const AbstractPath& itemPath = item.filePath;
+
     //1. try to load thumbnails
     switch (sz)
     {
@@ -40,12 +180,22 @@ std::variant<ImageHolder, FileIconHolder> getDisplayIcon(const AbstractPath& ite
             break;
         case IconBuffer::IconSize::medium:
         case IconBuffer::IconSize::large:
+        {
+            const std::optional<std::string> cacheKey = ThumbnailDiskCache::getKey(item, IconBuffer::getSize(sz));
+            if (cacheKey)
+                if (ImageHolder ih = diskCache.load(*cacheKey))
+                    return ih;
             try
             {
                 if (ImageHolder ih = AFS::getThumbnailImage(itemPath, IconBuffer::getSize(sz))) //throw FileError; optional return value
+                {
+                    if (cacheKey)
+                        diskCache.store(*cacheKey, ih);
                     return ih;
+                }
             }
             catch (FileError&) {}
+        }
 
             //else: fallback to non-thumbnail icon
             break;
@@ -71,7 +221,7 @@ class WorkLoad
 {
 public:
     //context of main thread
-    void set(const std::vector<AbstractPath>& newLoad)
+    void set(const std::vector<IconBuffer::IconSource>& newLoad)
     {
         assert(runningOnMainThread());
         {
@@ -82,34 +232,45 @@ public:
         //condition handling, see: https://www.boost.org/doc/libs/1_43_0/doc/html/thread/synchronization.html#thread.synchronization.condvar_ref
     }
 
-    void add(const AbstractPath& filePath) //context of main thread
+    void add(const IconBuffer::IconSource& item) //context of main thread
     {
         assert(runningOnMainThread());
         {
             std::lock_guard dummy(lockFiles_);
-            workLoad_.emplace_back(filePath); //set as next item to retrieve
+            workLoad_.push_back(item); //set as next item to retrieve
         }
         conditionNewWork_.notify_all();
     }
 
     //context of worker thread, blocking:
-    AbstractPath extractNext() //throw ThreadStopRequest
+    IconBuffer::IconSource extractNext() //throw ThreadStopRequest
     {
         assert(!runningOnMainThread());
         std::unique_lock dummy(lockFiles_);
+        for (;;)
+        {
+            interruptibleWait(conditionNewWork_, dummy, [this] { return !workLoad_.empty(); }); //throw ThreadStopRequest
+
+            IconBuffer::IconSource item = workLoad_.    back(); //yes, no strong exception guarantee (std::bad_alloc)
+            /**/                          workLoad_.pop_back(); //
 
-        interruptibleWait(conditionNewWork_, dummy, [this] { return !workLoad_.empty(); }); //throw ThreadStopRequest
+            if (inProgress_.insert(item.filePath).second) //workload may contain duplicates: don't load the same icon on two threads
+                return item;
+        }
+    }
 
-        AbstractPath filePath = workLoad_.    back(); //yes, no strong exception guarantee (std::bad_alloc)
-        /**/                    workLoad_.pop_back(); //
-        return filePath;
+    void markDone(const AbstractPath& filePath) //context of worker thread: call *after* Buffer::insert()
+    {
+        std::lock_guard dummy(lockFiles_);
+        inProgress_.erase(filePath);
     }
 
 private:
     //AbstractPath is thread-safe like an int!
     std::mutex                lockFiles_;
     std::condition_variable   conditionNewWork_; //signal event: data for processing available
-    std::vector<AbstractPath> workLoad_; //processes last elements of vector first!
+    std::vector<IconBuffer::IconSource> workLoad_; //processes last elements of vector first!
+    std::set<AbstractPath>    inProgress_;
 };
 
 
@@ -284,27 +445,31 @@ struct IconBuffer::Impl
     //communication channel used by threads:
     WorkLoad workload; //manage life time: enclose InterruptibleThread's (until joined)!!!
     Buffer   buffer;   //
+    ThumbnailDiskCache diskCache{appendPath(getConfigDirPath(), Zstr("Thumbnails"))}; //
 
-    InterruptibleThread worker;
+    std::vector<InterruptibleThread> workers;
     //-------------------------
     //-------------------------
     std::unordered_map<Zstring, wxImage, StringHashAsciiNoCase, StringEqualAsciiNoCase> extensionIcons; //no item count limit!? Test case C:\ ~ 3800 unique file extensions
 };
 
 
-IconBuffer::IconBuffer(IconSize sz) : pimpl_(std::make_unique<Impl>()), iconSizeType_(sz)
+IconBuffer::IconBuffer(IconSize sz, size_t loaderThreads) : pimpl_(std::make_unique<Impl>()), iconSizeType_(sz)
 {
-    pimpl_->worker = InterruptibleThread([&workload = pimpl_->workload, &buffer = pimpl_->buffer, sz]
+    for (size_t i = 0; i < std::max<size_t>(loaderThreads, 1); ++i)
+        pimpl_->workers.emplace_back([&workload = pimpl_->workload, &buffer = pimpl_->buffer, &diskCache = pimpl_->diskCache, sz]
     {
         setCurrentThreadName(Zstr("Icon Buffer"));
 
         for (;;)
         {
             //start work: blocks until next icon to load is retrieved:
-            const AbstractPath itemPath = workload.extractNext(); //throw ThreadStopRequest
+            const IconSource item = workload.extractNext(); //throw ThreadStopRequest
+
+            if (!buffer.hasIcon(item.filePath)) //perf: workload may contain duplicate entries?
+                buffer.insert(item.filePath, getDisplayIcon(item, sz, diskCache));
 
-            if (!buffer.hasIcon(itemPath)) //perf: workload may contain duplicate entries?
-                buffer.insert(itemPath, getDisplayIcon(itemPath, sz));
+            workload.markDone(item.filePath);
         }
     });
 }
@@ -313,8 +478,10 @@ IconBuffer::IconBuffer(IconSize sz) : pimpl_(std::make_unique<Impl>()), iconSize
 IconBuffer::~IconBuffer()
 {
     setWorkload({}); //make sure interruption point is always reached! needed???
-    pimpl_->worker.requestStop(); //end thread life time *before*
-    pimpl_->worker.join();        //IconBuffer::Impl member clean up!
+    for (InterruptibleThread& worker : pimpl_->workers) //end thread life time *before*
+        worker.requestStop();                           //IconBuffer::Impl member clean up!
+    for (InterruptibleThread& worker : pimpl_->workers) //
+        worker.join();                                  //
 }
 
 
@@ -341,10 +508,10 @@ bool IconBuffer::readyForRetrieval(const AbstractPath& filePath)
 }
 
 
-std::optional<wxImage> IconBuffer::retrieveFileIcon(const AbstractPath& filePath)
+std::optional<wxImage> IconBuffer::retrieveFileIcon(const IconSource& item)
 {
-    const Zstring fileName = AFS::getItemName(filePath);
-    if (std::optional<wxImage> ico = pimpl_->buffer.retrieve(filePath))
+    const Zstring fileName = AFS::getItemName(item.filePath);
+    if (std::optional<wxImage> ico = pimpl_->buffer.retrieve(item.filePath))
     {
         if (ico->IsOk())
             return ico;
@@ -353,13 +520,13 @@ std::optional<wxImage> IconBuffer::retrieveFileIcon(const AbstractPath& filePath
     }
 
     //since this icon seems important right now, we don't want to wait until next setWorkload() to start retrieving
-    pimpl_->workload.add(filePath);
+    pimpl_->workload.add(item);
     pimpl_->buffer.limitSize();
     return {};
 }
 
 
-void IconBuffer::setWorkload(const std::vector<AbstractPath>& load)
+void IconBuffer::setWorkload(const std::vector<IconSource>& load)
 {
     assert(load.size() < BUFFER_SIZE_MAX / 2);
 
@@ -26,15 +26,22 @@ public:
         large
     };
 
-    explicit IconBuffer(IconSize sz);
+    IconBuffer(IconSize sz, size_t loaderThreads);
     ~IconBuffer();
 
     static int getSize(IconSize sz); //expected and *maximum* icon size in pixel
     int getSize() const { return getSize(iconSizeType_); } //
 
-    void                   setWorkload      (const std::vector<AbstractPath>& load); //(re-)set new workload of icons to be retrieved;
+    struct IconSource
+    {
+        AbstractPath filePath;
+        uint64_t fileSize = 0; //thumbnail disk cache: file content is considered unchanged if size and modification time match
+        time_t   modTime  = 0; //0 if unknown (e.g. symlinks) => bypass disk cache
+    };
+
+    void                   setWorkload      (const std::vector<IconSource>& load); //(re-)set new workload of icons to be retrieved;
     bool                   readyForRetrieval(const AbstractPath& filePath);
-    std::optional<wxImage> retrieveFileIcon (const AbstractPath& filePath); //... and mark as hot
+    std::optional<wxImage> retrieveFileIcon (const IconSource& item); //... and mark as hot
     wxImage getIconByExtension(const Zstring& filePath); //...and add to buffer
     //retrieveFileIcon() + getIconByExtension() are safe to call from within WM_PAINT handler! no COM calls (...on calling thread)
 
@@ -5,9 +5,11 @@
 // *****************************************************************************
 
 #include "log_file.h"
+#include <zen/file_access.h>
 #include <zen/file_io.h>
 #include <zen/http.h>
 #include <zen/sys_info.h>
+#include <zen/trace.h>
 #include "afs/concrete.h"
 
 using namespace zen;
@@ -28,7 +30,7 @@ const int EMAIL_SHORT_ITEMS_MAX   = 0; //
 const int SEPARATION_LINE_LEN = 40;
 
 
-std::string generateLogHeaderTxt(const ProcessSummary& s, const ErrorLog& log, int logPreviewMax)
+std::string generateLogHeaderTxt(const ProcessSummary& s, const ErrorLogStats& logCount, const ErrorLog& logPreview, int logPreviewMax)
 {
     const auto tabSpace = utfTo<std::string>(TAB_SPACE);
 
@@ -48,8 +50,6 @@ std::string generateLogHeaderTxt(const ProcessSummary& s, const ErrorLog& log, i
     summary.push_back(tabSpace + utfTo<std::string>(getSyncResultLabel(s.result)));
     summary.emplace_back();
 
-    const ErrorLogStats logCount = getStats(log);
-
     if (logCount.error   > 0) summary.push_back(tabSpace + utfTo<std::string>(_("Errors:")   + L' ' + formatNumber(logCount.error)));
     if (logCount.warning > 0) summary.push_back(tabSpace + utfTo<std::string>(_("Warnings:") + L' ' + formatNumber(logCount.warning)));
 
@@ -86,11 +86,12 @@ std::string generateLogHeaderTxt(const ProcessSummary& s, const ErrorLog& log, i
         output += std::string(SEPARATION_LINE_LEN, '_') + '\n';
 
         int previewCount = 0;
-        for (const LogEntry& entry : log)
+        for (const LogEntry& entry : logPreview)
             if (entry.type & (MSG_TYPE_WARNING | MSG_TYPE_ERROR))
             {
-                if (previewCount++ >= logPreviewMax)
+                if (previewCount >= logPreviewMax) //count shown items only: "Showing %y of %x items"
                     break;
+                ++previewCount;
                 output += utfTo<std::string>(formatMessage(entry));
             }
 
@@ -103,7 +104,80 @@ std::string generateLogHeaderTxt(const ProcessSummary& s, const ErrorLog& log, i
 }
 
 
-std::string generateLogFooterTxt(const std::wstring& logFilePath /*optional*/, int logItemsTotal, int logItemsMax) //throw FileError
+std::wstring formatLatency(std::chrono::microseconds latency)
+{
+    if (latency < std::chrono::milliseconds(1))
+        return numberTo<std::wstring>(latency.count()) + L" \u00b5s";
+    if (latency < std::chrono::seconds(1))
+        return numberTo<std::wstring>(std::chrono::duration_cast<std::chrono::milliseconds>(latency).count()) + L" ms";
+    return formatTwoDigitPrecision(std::chrono::duration<double>(latency).count()) + L" s";
+}
+
+
+std::wstring formatIoThroughput(int64_t bytes, std::chrono::milliseconds totalTime)
+{
+    std::wstring output = formatFilesizeShort(bytes);
+    if (bytes > 0 && totalTime > std::chrono::milliseconds(0))
+        output += L" (" + replaceCpy(_("%x/sec"), L"%x", formatFilesizeShort(bytes * 1000 / totalTime.count())) + L')';
+    return output;
+}
+
+
+struct IoOpSummary
+{
+    std::string name;
+    std::wstring count;
+    std::wstring errors;
+    std::wstring opsPerSec;
+    std::wstring latencyAvg;
+    std::wstring latencyP50;
+    std::wstring latencyP99;
+};
+std::vector<IoOpSummary> getIoOpSummaries(const DeviceIoMetrics& dm, std::chrono::milliseconds totalTime)
+{
+    std::vector<IoOpSummary> output;
+    for (size_t i = 0; i < IO_OP_COUNT; ++i)
+        if (const IoOpStats& stats = dm.ops[i];
+            stats.count > 0)
+            output.push_back(
+        {
+            getIoOpName(static_cast<IoOp>(i)),
+            formatNumber(stats.count),
+            formatNumber(stats.errors),
+            totalTime > std::chrono::milliseconds(0) ? formatTwoDigitPrecision(stats.count * 1000.0 / totalTime.count()) + L"/s" : L"",
+            formatLatency(std::chrono::duration_cast<std::chrono::microseconds>(stats.totalTime / stats.count)),
+            L"< " + formatLatency(getLatencyPercentile(stats, 0.50)),
+            L"< " + formatLatency(getLatencyPercentile(stats, 0.99)),
+        });
+    return output;
+}
+
+
+std::string generateIoMetricsTxt(const std::vector<DeviceIoMetrics>& ioMetrics, std::chrono::milliseconds totalTime)
+{
+    const auto tabSpace = utfTo<std::string>(TAB_SPACE);
+
+    std::string output = '\n' + utfTo<std::string>(_("I/O statistics:")) + '\n' +
+                         std::string(SEPARATION_LINE_LEN, '_') + '\n';
+
+    for (const DeviceIoMetrics& dm : ioMetrics)
+    {
+        output += utfTo<std::string>(AFS::getDisplayPath(AbstractPath(dm.afsDevice, AfsPath()))) + '\n';
+
+        if (dm.bytesRead > 0 || dm.bytesWritten > 0)
+            output += tabSpace + utfTo<std::string>(_("Read:")    + L' ' + formatIoThroughput(dm.bytesRead,    totalTime) + L"  " +
+                                                    _("Written:") + L' ' + formatIoThroughput(dm.bytesWritten, totalTime)) + '\n';
+
+        for (const IoOpSummary& ios : getIoOpSummaries(dm, totalTime))
+            output += tabSpace + ios.name + ": " + utfTo<std::string>(ios.count + L" [" + _("Errors:") + L' ' + ios.errors + L"] " + ios.opsPerSec +
+                                                                      L"  avg " + ios.latencyAvg + L"  p50 " + ios.latencyP50 + L"  p99 " + ios.latencyP99) + '\n';
+    }
+    return output;
+}
+
+
+std::string generateLogFooterTxt(const std::wstring& logFilePath /*optional*/, int logItemsTotal, int logItemsMax, //throw FileError
+                                 const std::vector<DeviceIoMetrics>& ioMetrics, std::chrono::milliseconds totalTime)
 {
     const ComputerModel cm = getComputerModel(); //throw FileError
 
@@ -112,6 +186,9 @@ std::string generateLogFooterTxt(const std::wstring& logFilePath /*optional*/, i
         output += "  [...]  " + utfTo<std::string>(replaceCpy(_P("Showing %y of 1 item", "Showing %y of %x items", logItemsTotal), //%x used as plural form placeholder!
                                                               L"%y", formatNumber(logItemsMax))) + '\n';
 
+    if (!ioMetrics.empty())
+        output += generateIoMetricsTxt(ioMetrics, totalTime);
+
     output += std::string(SEPARATION_LINE_LEN, '_') + '\n' +
 
               utfTo<std::string>(getOsDescription() + /*throw FileError*/ +
@@ -174,7 +251,7 @@ std::string formatMessageHtml(const LogEntry& entry)
     return R"(		<tr>
             <td valign="top">)" + htmlTxt(formatTime(formatTimeTag, getLocalTime(entry.time))) + R"(</td>
             <td valign="top"><img src="https://freefilesync.org/images/log/)" + typeImage + R"(" height="16" alt=")" + typeLabel + R"(:"></td>
-            <td>)" + htmlTxt(makeStringView(entry.message.begin(), entry.message.end())) + R"(</td>
+            <td>)" + htmlTxt(entry.message) + R"(</td>
         </tr>
 )";
 }
@@ -202,7 +279,7 @@ std::wstring generateLogTitle(const ProcessSummary& s)
 }
 
 
-std::string generateLogHeaderHtml(const ProcessSummary& s, const ErrorLog& log, int logPreviewMax)
+std::string generateLogHeaderHtml(const ProcessSummary& s, const ErrorLogStats& logCount, const ErrorLog& logPreview, int logPreviewMax)
 {
     //caveat: non-inline CSS is often ignored by email clients!
     std::string output = R"(<!DOCTYPE html>
@@ -220,6 +297,10 @@ std::string generateLogHeaderHtml(const ProcessSummary& s, const ErrorLog& log,
         .log-items td { padding-bottom: 0.1em; }
         .log-items td:nth-child(1) { padding-right: 10px; white-space: nowrap; }
         .log-items td:nth-child(2) { padding-right: 10px; }
+
+        .io-stats th { font-weight: normal; color: gray; text-align: right; padding-left: 15px; }
+        .io-stats td { text-align: right; padding-left: 15px; }
+        .io-stats td:nth-child(1) { text-align: left; padding-left: 10px; }
     </style>
 </head>
 <body style="font-family: -apple-system, 'Segoe UI', Arial, Tahoma, Helvetica, sans-serif;">
@@ -249,8 +330,6 @@ std::string generateLogHeaderHtml(const ProcessSummary& s, const ErrorLog& log,
         </div>
         <table role="presentation" class="summary-table" style="border-spacing:0; margin-left:10px; padding:5px 10px;">)";
 
-    const ErrorLogStats logCount = getStats(log);
-
     if (logCount.error > 0) 
         output += R"(
             <tr>
@@ -308,11 +387,12 @@ std::string generateLogHeaderHtml(const ProcessSummary& s, const ErrorLog& log,
     <table class="log-items" style="line-height:1em; border-spacing:0;">
 )";
         int previewCount = 0;
-        for (const LogEntry& entry : log)
+        for (const LogEntry& entry : logPreview)
             if (entry.type & (MSG_TYPE_WARNING | MSG_TYPE_ERROR))
             {
-                if (previewCount++ >= logPreviewMax)
+                if (previewCount >= logPreviewMax) //count shown items only: "Showing %y of %x items"
                     break;
+                ++previewCount;
                 output += formatMessageHtml(entry);
             }
 
@@ -334,7 +414,35 @@ std::string generateLogHeaderHtml(const ProcessSummary& s, const ErrorLog& log,
 }
 
 
-std::string generateLogFooterHtml(const std::wstring& logFilePath /*optional*/, int logItemsTotal, int logItemsMax) //throw FileError
+std::string generateIoMetricsHtml(const std::vector<DeviceIoMetrics>& ioMetrics, std::chrono::milliseconds totalTime)
+{
+    std::string output = R"(
+    <div style="border-bottom:1px solid #AAA; margin:5px 0;"></div>
+    <div style="font-weight:600; font-size: large;">)" + htmlTxt(_("I/O statistics:")) + R"(</div>
+)";
+    for (const DeviceIoMetrics& dm : ioMetrics)
+    {
+        output += R"(	<div style="font-weight:600; margin-top:5px;">)" + htmlTxt(AFS::getDisplayPath(AbstractPath(dm.afsDevice, AfsPath()))) + "</div>\n";
+
+        if (dm.bytesRead > 0 || dm.bytesWritten > 0)
+            output += R"(	<div>)" + htmlTxt(_("Read:")    + L' ' + formatIoThroughput(dm.bytesRead,    totalTime)) + " &nbsp;" +
+                                      htmlTxt(_("Written:") + L' ' + formatIoThroughput(dm.bytesWritten, totalTime)) + "</div>\n";
+
+        output += R"(	<table class="io-stats" style="border-spacing:0;">
+        <tr><th></th><th>count</th><th>)" + htmlTxt(_("Errors:")) + R"(</th><th>ops/s</th><th>avg</th><th>p50</th><th>p99</th></tr>
+)";
+        for (const IoOpSummary& ios : getIoOpSummaries(dm, totalTime))
+            output += "		<tr><td>" + ios.name + "</td><td>" + htmlTxt(ios.count) + "</td><td>" + htmlTxt(ios.errors) + "</td><td>" + htmlTxt(ios.opsPerSec) +
+                      "</td><td>" + htmlTxt(ios.latencyAvg) + "</td><td>" + htmlTxt(ios.latencyP50) + "</td><td>" + htmlTxt(ios.latencyP99) + "</td></tr>\n";
+
+        output += "	</table>\n";
+    }
+    return output;
+}
+
+
+std::string generateLogFooterHtml(const std::wstring& logFilePath /*optional*/, int logItemsTotal, int logItemsMax, //throw FileError
+                                  const std::vector<DeviceIoMetrics>& ioMetrics, std::chrono::milliseconds totalTime)
 {
     const std::string osImage = "os-linux.png";
     const ComputerModel cm = getComputerModel(); //throw FileError
@@ -347,6 +455,9 @@ std::string generateLogFooterHtml(const std::wstring& logFilePath /*optional*/,
                   htmlTxt(replaceCpy(_P("Showing %y of 1 item", "Showing %y of %x items", logItemsTotal), //%x used as plural form placeholder!
                           L"%y", formatNumber(logItemsMax))) + "</div>\n";
 
+    if (!ioMetrics.empty())
+        output += generateIoMetricsHtml(ioMetrics, totalTime);
+
     output += R"(
     <div style="border-bottom:1px solid #AAA; margin:5px 0;"></div>
     <div style="font-size:smaller;">
@@ -374,34 +485,61 @@ std::string generateLogFooterHtml(const std::wstring& logFilePath /*optional*/,
 //-> Astyle fucks up! => no INDENT-ON
 
 
+//ErrorLog or LogSpool
+struct LogItems
+{
+    ErrorLogStats stats;
+    const ErrorLog& preview; //errors/warnings for the log header (other entries are skipped)
+    size_t count = 0;
+    std::function<void(const std::function<void(const LogEntry& entry)>& onEntry /*throw X*/)> forEachEntry; //throw FileError, X
+};
+
+LogItems getLogItems(const ErrorLog& log)
+{
+    return {getStats(log), log, log.size(), [&log](const std::function<void(const LogEntry& entry)>& onEntry)
+    {
+        for (const LogEntry& entry : log)
+            onEntry(entry); //throw X
+    }};
+}
+
+LogItems getLogItems(const LogSpool& log)
+{
+    return {log.getStats(), log.getPreview(), log.size(), [&log](const std::function<void(const LogEntry& entry)>& onEntry)
+    {
+        log.forEachEntry(onEntry); //throw FileError, X
+    }};
+}
+
+
 //write log items in blocks instead of creating one big string: memory allocation might fail; think 1 million entries!
 template <class Function> 
-void streamToLogFile(const ProcessSummary& summary, const ErrorLog& log,
+void streamToLogFile(const ProcessSummary& summary, const LogItems& log,
                      int logPreviewMax, int logItemsMax, 
                      const std::wstring& logFilePath /*optional*/,
-                     LogFileFormat logFormat, Function stringOut /*(const std::string& s); throw X*/) //throw SysError, X
+                     const std::vector<DeviceIoMetrics>& ioMetrics /*optional*/,
+                     LogFileFormat logFormat, Function stringOut /*(const std::string& s); throw X*/) //throw SysError, FileError, X
 {
     stringOut(logFormat == LogFileFormat::html ?
-              generateLogHeaderHtml(summary, log, logPreviewMax) :
-              generateLogHeaderTxt (summary, log, logPreviewMax)); //throw X
+              generateLogHeaderHtml(summary, log.stats, log.preview, logPreviewMax) :
+              generateLogHeaderTxt (summary, log.stats, log.preview, logPreviewMax)); //throw X
 
     int itemCount = 0;
-    for (const LogEntry& entry : log)
+    log.forEachEntry([&](const LogEntry& entry) //throw FileError, X
     {
-        if (itemCount++ >= logItemsMax)
-            break;
-        stringOut(logFormat == LogFileFormat::html ?
-                    formatMessageHtml(entry) :
-                    formatMessage    (entry)); //throw X
-    }
+        if (itemCount++ < logItemsMax) //LogSpool can't stop early: reads are sequential anyway
+            stringOut(logFormat == LogFileFormat::html ?
+                      formatMessageHtml(entry) :
+                      formatMessage    (entry)); //throw X
+    });
 
     const std::string footer = [&]
     {
         try
         {
             return logFormat == LogFileFormat::html ?
-                   generateLogFooterHtml(logFilePath, static_cast<int>(log.size()), logItemsMax): //throw FileError
-                   generateLogFooterTxt (logFilePath, static_cast<int>(log.size()), logItemsMax); //
+                   generateLogFooterHtml(logFilePath, static_cast<int>(log.count), logItemsMax, ioMetrics, summary.totalTime): //throw FileError
+                   generateLogFooterTxt (logFilePath, static_cast<int>(log.count), logItemsMax, ioMetrics, summary.totalTime); //
         }
         catch (const FileError& e) { throw SysError(replaceCpy(e.toString(), L"\n\n", L'\n')); } //errors should be further enriched by context info => SysError
     }(); //caveat: don't catch exceptions thrown by stringOut()!
@@ -413,7 +551,8 @@ void streamToLogFile(const ProcessSummary& summary, const ErrorLog& log,
 void saveNewLogFile(const AbstractPath& logFilePath, //throw FileError, X
                     LogFileFormat logFormat,
                     const ProcessSummary& summary,
-                    const ErrorLog& log,
+                    const LogItems& log,
+                    const std::vector<DeviceIoMetrics>& ioMetrics,
                     const std::function<void(std::wstring&& msg)>& notifyStatus /*throw X*/)
 {
     //create logfile folder if required
@@ -451,7 +590,7 @@ void saveNewLogFile(const AbstractPath& logFilePath, //throw FileError, X
     try
     {
         streamToLogFile(summary, log, LOG_PREVIEW_MAX, std::numeric_limits<int>::max() /*logItemsMax*/, 
-                        std::wstring() /*logFilePath -> superfluous*/, logFormat, 
+                        std::wstring() /*logFilePath -> superfluous*/, ioMetrics, logFormat, 
                         [&](const std::string& str){ streamOut.write(str.data(), str.size()); } /*throw FileError, X*/); //throw SysError, FileError, X
     }
     catch (const SysError& e)
@@ -465,6 +604,42 @@ void saveNewLogFile(const AbstractPath& logFilePath, //throw FileError, X
 }
 
 
+//sidecar files share the log file's name => aged out by limitLogfileCount() along with it
+const Zchar TRACE_FILE_ENDING[]      = Zstr(".trace.json");
+const Zchar IO_METRICS_FILE_ENDING[] = Zstr(".io.json");
+const Zchar SPOOL_FILE_ENDING[]      = Zstr(".spool"); //see LogSpool: left behind only if the process died
+
+AbstractPath getSidecarFilePath(const AbstractPath& logFilePath, const Zchar* fileEnding)
+{
+    const Zstring logFileName = AFS::getItemName(logFilePath);
+    const std::optional<AbstractPath> parentPath = AFS::getParentPath(logFilePath);
+    assert(parentPath);
+    if (!parentPath) //logFilePath == device root; not possible with generateLogFilePath()
+        return logFilePath;
+
+    return AFS::appendRelPath(*parentPath, beforeLast(logFileName, Zstr('.'), IfNotFoundReturn::all) + fileEnding);
+}
+
+
+void saveNewSidecarFile(const AbstractPath& filePath, const std::string& content) //throw FileError
+{
+    //already existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
+    std::unique_ptr<AFS::OutputStream> fileOut = AFS::getOutputStream(filePath,
+                                                                      content.size() /*streamSize*/,
+                                                                      std::nullopt /*modTime*/); //throw FileError
+    BufferedOutputStream streamOut([&](const void* buffer, size_t bytesToWrite)
+    {
+        return fileOut->tryWrite(buffer, bytesToWrite, nullptr /*notifyUnbufferedIO*/); //throw FileError
+    },
+    fileOut->getBlockSize());
+
+    streamOut.write(content.data(), content.size()); //throw FileError
+    streamOut.flushBuffer(); //throw FileError
+
+    fileOut->finalize(nullptr /*notifyUnbufferedIO*/); //throw FileError
+}
+
+
 const int TIME_STAMP_LENGTH = 21;
 const Zchar STATUS_BEGIN_TOKEN[] = Zstr(" [");
 const Zchar STATUS_END_TOKEN     = Zstr(']');
@@ -473,6 +648,7 @@ const Zchar STATUS_END_TOKEN     = Zstr(']');
 struct LogFileInfo
 {
     AbstractPath filePath;
+    AbstractPath stemPath; //without file ending: shared by log file and its sidecar files
     time_t       timeStamp;
     std::wstring jobNames; //may be empty
 };
@@ -485,12 +661,21 @@ std::vector<LogFileInfo> getLogFiles(const AbstractPath& logFolderPath) //throw
         //"Backup FreeFileSync 2013-09-15 015052.123.html"
         //"Jobname1 + Jobname2 2013-09-15 015052.123.log"
         //"2013-09-15 015052.123 [Error].log"
+        //"2013-09-15 015052.123 [Error].trace.json"
+        //"2013-09-15 015052.123.spool"
         static_assert(TIME_STAMP_LENGTH == 21);
 
+        const Zchar* sidecarEnding = endsWith(fi.itemName, TRACE_FILE_ENDING     ) ? TRACE_FILE_ENDING :
+                                     endsWith(fi.itemName, IO_METRICS_FILE_ENDING) ? IO_METRICS_FILE_ENDING :
+                                     endsWith(fi.itemName, SPOOL_FILE_ENDING     ) ? SPOOL_FILE_ENDING : nullptr;
+
         if (endsWith(fi.itemName, Zstr(".log")) || //case-sensitive: e.g. ".LOG" is not from FFS, right?
-            endsWith(fi.itemName, Zstr(".html")))
+            endsWith(fi.itemName, Zstr(".html")) ||
+            sidecarEnding)
         {
-            ZstringView itemPhrase = beforeLast<ZstringView>(fi.itemName, Zstr('.'), IfNotFoundReturn::none);
+            ZstringView itemPhrase = sidecarEnding ?
+                                     makeStringView(fi.itemName.begin(), fi.itemName.end() - strLength(sidecarEnding)) :
+                                     beforeLast<ZstringView>(fi.itemName, Zstr('.'), IfNotFoundReturn::none);
             
             if (endsWith(itemPhrase, STATUS_END_TOKEN))
                 itemPhrase = beforeLast(itemPhrase, STATUS_BEGIN_TOKEN, IfNotFoundReturn::all);
@@ -512,7 +697,12 @@ std::vector<LogFileInfo> getLogFiles(const AbstractPath& logFolderPath) //throw
                         itemPhrase = trimCpy(itemPhrase);
                     }
 
-                    logfiles.push_back({AFS::appendRelPath(logFolderPath, fi.itemName), localTime, utfTo<std::wstring>(itemPhrase)});
+                    const Zstring fileStem = sidecarEnding ?
+                                             Zstring(fi.itemName.begin(), fi.itemName.end() - strLength(sidecarEnding)) :
+                                             beforeLast(fi.itemName, Zstr('.'), IfNotFoundReturn::all);
+
+                    logfiles.push_back({AFS::appendRelPath(logFolderPath, fi.itemName),
+                                        AFS::appendRelPath(logFolderPath, fileStem), localTime, utfTo<std::wstring>(itemPhrase)});
                 }
             }
         }
@@ -547,11 +737,17 @@ void limitLogfileCount(const AbstractPath& logFolderPath, //throw FileError, X
         }();
         const time_t cutOffTime = lastMidnightTime - static_cast<time_t>(logfilesMaxAgeDays) * 24 * 3600;
 
+        //keep sidecar files (".trace.json", ".io.json") along with their log file
+        std::set<AbstractPath> stemPathsToKeep;
+        for (const AbstractPath& logFilePath : logFilePathsToKeep)
+            stemPathsToKeep.insert(getSidecarFilePath(logFilePath, Zstr("")));
+
         std::exception_ptr firstError;
 
         for (const LogFileInfo& lfi : logFiles)
             if (lfi.timeStamp < cutOffTime &&
-                !logFilePathsToKeep.contains(lfi.filePath)) //don't trim latest log files corresponding to last used config files!
+                !logFilePathsToKeep.contains(lfi.filePath) && //don't trim latest log files corresponding to last used config files!
+                !stemPathsToKeep.contains(lfi.stemPath))
                 //nitpicker's corner: what about path differences due to case? e.g. user-overriden log file path changed in case
             {
                 if (notifyStatus) notifyStatus(statusPrefix + fmtPath(AFS::getDisplayPath(lfi.filePath))); //throw X
@@ -630,21 +826,178 @@ Zstring fff::generateLogFileName(LogFileFormat logFormat, const ProcessSummary&
 }
 
 
-void fff::saveLogFile(const AbstractPath& logFilePath, //throw FileError, X
-                      const ProcessSummary& summary,
-                      const ErrorLog& log,
-                      int logfilesMaxAgeDays,
-                      LogFileFormat logFormat,
-                      const std::set<AbstractPath>& logFilePathsToKeep,
-                      const std::function<void(std::wstring&& msg)>& notifyStatus /*throw X*/)
+namespace
+{
+const size_t LOG_ENTRIES_IN_MEMORY_MAX = 100'000; //progress dialog: the log file has them all
+const size_t SPOOL_BLOCK_SIZE = 64 * 1024;
+}
+
+
+fff::LogSpool::LogSpool(const Zstring& logFolderPath, const std::vector<std::wstring>& jobNames, const std::chrono::system_clock::time_point& startTime) //noexcept
+{
+    try
+    {
+        const Zstring logFileName = generateLogFileName(LogFileFormat::text, {startTime, TaskResult::success, jobNames}); //throw FileError
+        spoolFilePath_ = appendPath(logFolderPath, beforeLast(logFileName, Zstr('.'), IfNotFoundReturn::all) + SPOOL_FILE_ENDING);
+
+        createDirectoryIfMissingRecursion(logFolderPath); //throw FileError
+        spoolOut_ = std::make_unique<FileOutputPlain>(spoolFilePath_); //throw FileError, ErrorTargetExisting
+    }
+    catch (const FileError& e) { logMsg(log_.ref(), e.toString(), MSG_TYPE_WARNING); } //=> not spooled: keep complete log in memory
+}
+
+
+fff::LogSpool::~LogSpool()
+{
+    if (spoolOut_)
+        try
+        {
+            spoolOut_.reset(); //close file handle first
+            removeFilePlain(spoolFilePath_); //throw FileError
+        }
+        catch (FileError&) {} //left-over is aged out by limitLogfileCount()
+}
+
+
+void fff::LogSpool::push_back(const LogEntry& entry) //noexcept
+{
+    ++itemCount_;
+    switch (entry.type)
+    {
+        //*INDENT-OFF*
+        case MSG_TYPE_INFO:    ++stats_.info;    break;
+        case MSG_TYPE_WARNING: ++stats_.warning; break;
+        case MSG_TYPE_ERROR:   ++stats_.error;   break;
+        //*INDENT-ON*
+    }
+    if ((entry.type & (MSG_TYPE_WARNING | MSG_TYPE_ERROR)) && preview_.size() < static_cast<size_t>(LOG_PREVIEW_MAX))
+        preview_.push_back(entry);
+
+    if (!spoolOut_ || log_.ref().size() < LOG_ENTRIES_IN_MEMORY_MAX)
+        log_.ref().push_back(entry);
+    else if (log_.ref().size() == LOG_ENTRIES_IN_MEMORY_MAX) //display only: not part of the log file
+        logMsg(log_.ref(), L"[...]  " + _("Further entries are written to the log file only."), MSG_TYPE_INFO, entry.time);
+
+    if (!spoolOut_)
+        return;
+
+    MemoryStreamOut memOut;
+    writeNumber<int64_t>(memOut, entry.time);
+    writeNumber<uint8_t>(memOut, static_cast<uint8_t>(entry.type));
+    writeNumber<uint32_t>(memOut, static_cast<uint32_t>(entry.message.size()));
+    writeArray(memOut, entry.message.data(), entry.message.size());
+    spoolBuf_ += memOut.ref();
+
+    if (spoolBuf_.size() >= SPOOL_BLOCK_SIZE && !spoolFailed_)
+        try
+        {
+            flushSpool(); //throw FileError
+        }
+        catch (const FileError& e)
+        {
+            spoolFailed_ = true; //keep buffering: memory is no longer bounded, but nothing is lost
+            push_back({std::time(nullptr), MSG_TYPE_ERROR, utfTo<std::string>(e.toString())});
+        }
+}
+
+
+void fff::LogSpool::flushSpool() //throw FileError
+{
+    unbufferedSave(spoolBuf_, [&](const void* buffer, size_t bytesToWrite)
+    {
+        return spoolOut_->tryWrite(buffer, bytesToWrite); //throw FileError
+    },
+    SPOOL_BLOCK_SIZE);
+
+    spoolBytesWritten_ += spoolBuf_.size();
+    spoolBuf_.clear();
+}
+
+
+void fff::LogSpool::forEachEntry(const std::function<void(const LogEntry& entry)>& onEntry /*throw X*/) const //throw FileError, X
 {
+    if (!spoolOut_)
+    {
+        for (const LogEntry& entry : log_.ref())
+            onEntry(entry); //throw X
+        return;
+    }
+
+    std::string msgBuf;
+    auto readRecords = [&](auto& streamIn, uint64_t bytesTotal) //throw SysErrorUnexpectedEos, X
+    {
+        for (uint64_t bytesRead = 0; bytesRead < bytesTotal;)
+        {
+            const time_t      time = readNumber<int64_t>(streamIn); //throw SysErrorUnexpectedEos
+            const MessageType type = static_cast<MessageType>(readNumber<uint8_t>(streamIn)); //
+            const size_t    msgLen = readNumber<uint32_t>(streamIn); //
+            if (msgLen > bytesTotal - bytesRead) //don't trust size before allocating
+                throw SysErrorUnexpectedEos();
+
+            msgBuf.resize(msgLen);
+            readArray(streamIn, msgBuf.data(), msgLen); //throw SysErrorUnexpectedEos
+            bytesRead += sizeof(int64_t) + sizeof(uint8_t) + sizeof(uint32_t) + msgLen;
+
+            onEntry({time, type, msgBuf}); //throw X
+        }
+    };
+
+    try
+    {
+        if (spoolBytesWritten_ > 0)
+        {
+            FileInputBuffered fileIn(spoolFilePath_, nullptr /*notifyUnbufferedIO*/); //throw FileError, ErrorFileLocked
+            readRecords(fileIn, spoolBytesWritten_); //throw SysErrorUnexpectedEos, FileError, X
+        }
+        MemoryStreamIn memIn(spoolBuf_); //not yet written
+        readRecords(memIn, spoolBuf_.size()); //throw SysErrorUnexpectedEos, X
+    }
+    catch (const SysError& e)
+    {
+        throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(spoolFilePath_)), e.toString());
+    }
+}
+
+
+void fff::logMsg(LogSpool& log, const std::wstring& msg, MessageType type, time_t time)
+{
+    log.push_back({time, type, utfTo<std::string>(msg)});
+}
+
+
+namespace
+{
+void saveLogFileImpl(const AbstractPath& logFilePath, //throw FileError, X
+                     const ProcessSummary& summary,
+                     const LogItems& log,
+                     int logfilesMaxAgeDays,
+                     LogFileFormat logFormat,
+                     const std::set<AbstractPath>& logFilePathsToKeep,
+                     const std::function<void(std::wstring&& msg)>& notifyStatus /*throw X*/)
+{
+    const std::vector<DeviceIoMetrics> ioMetrics = getIoMetrics();
+
     std::exception_ptr firstError;
     try
     {
-        saveNewLogFile(logFilePath, logFormat, summary, log, notifyStatus); //throw FileError, X
+        saveNewLogFile(logFilePath, logFormat, summary, log, ioMetrics, notifyStatus); //throw FileError, X
     }
     catch (const FileError&) { if (!firstError) firstError = std::current_exception(); };
 
+    if (!ioMetrics.empty())
+        try
+        {
+            saveNewSidecarFile(getSidecarFilePath(logFilePath, IO_METRICS_FILE_ENDING), getIoMetricsJson(ioMetrics, summary.totalTime)); //throw FileError
+        }
+        catch (const FileError&) { if (!firstError) firstError = std::current_exception(); };
+
+    if (isTracingEnabled())
+        try
+        {
+            saveNewSidecarFile(getSidecarFilePath(logFilePath, TRACE_FILE_ENDING), getTraceEventsJson()); //throw FileError
+        }
+        catch (const FileError&) { if (!firstError) firstError = std::current_exception(); };
+
     try
     {
         const std::optional<AbstractPath> logFolderPath = AFS::getParentPath(logFilePath);
@@ -657,6 +1010,31 @@ void fff::saveLogFile(const AbstractPath& logFilePath, //throw FileError, X
     if (firstError) //late failure!
         std::rethrow_exception(firstError);
 }
+}
+
+
+void fff::saveLogFile(const AbstractPath& logFilePath, //throw FileError, X
+                      const ProcessSummary& summary,
+                      const ErrorLog& log,
+                      int logfilesMaxAgeDays,
+                      LogFileFormat logFormat,
+                      const std::set<AbstractPath>& logFilePathsToKeep,
+                      const std::function<void(std::wstring&& msg)>& notifyStatus /*throw X*/)
+{
+    saveLogFileImpl(logFilePath, summary, getLogItems(log), logfilesMaxAgeDays, logFormat, logFilePathsToKeep, notifyStatus); //throw FileError, X
+}
+
+
+void fff::saveLogFile(const AbstractPath& logFilePath, //throw FileError, X
+                      const ProcessSummary& summary,
+                      const LogSpool& log,
+                      int logfilesMaxAgeDays,
+                      LogFileFormat logFormat,
+                      const std::set<AbstractPath>& logFilePathsToKeep,
+                      const std::function<void(std::wstring&& msg)>& notifyStatus /*throw X*/)
+{
+    saveLogFileImpl(logFilePath, summary, getLogItems(log), logfilesMaxAgeDays, logFormat, logFilePathsToKeep, notifyStatus); //throw FileError, X
+}
 
 
 
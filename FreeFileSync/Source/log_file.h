@@ -9,6 +9,7 @@
 
 #include <chrono>
 #include <zen/error_log.h>
+#include <zen/file_io.h>
 #include "return_codes.h"
 #include "status_handler.h"
 #include "afs/abstract.h"
@@ -24,6 +25,52 @@ enum class LogFileFormat
 
 Zstring generateLogFileName(LogFileFormat logFormat, const ProcessSummary& summary);
 
+
+/*  batch mode: bounded memory for multi-million entry logs
+    - log entries are written to a spool file in the (local) log folder while the sync is running => already on disk if the process dies
+        "Backup FreeFileSync 2013-09-15 015052.123.spool": left-overs are aged out by saveLogFile() like regular log files
+    - in memory: statistics, errors/warnings preview (log file header) and the first LOG_ENTRIES_IN_MEMORY_MAX entries (progress dialog)
+    - saveLogFile() streams the spooled entries into the log file: name and header depend on the final result             */
+class LogSpool
+{
+public:
+    LogSpool(const Zstring& logFolderPath, const std::vector<std::wstring>& jobNames, const std::chrono::system_clock::time_point& startTime); //noexcept: log in memory if spool file can't be created
+    ~LogSpool(); //remove spool file
+
+    void push_back(const zen::LogEntry& entry); //noexcept
+    void append(const zen::ErrorLog& log) { for (const zen::LogEntry& entry : log) push_back(entry); }
+
+    void sortByTime() { if (!spoolOut_) log_.ref().sortByTime(); } //spooled entries are already on disk: keep logging order
+
+    size_t size() const { return itemCount_; }
+    zen::ErrorLogStats getStats() const { return stats_; }
+
+    zen::SharedRef<const zen::ErrorLog> getLog() const { return log_; } //all entries, or the first LOG_ENTRIES_IN_MEMORY_MAX if spooled
+    const zen::ErrorLog& getPreview() const { return preview_; } //first errors/warnings
+
+    void forEachEntry(const std::function<void(const zen::LogEntry& entry)>& onEntry /*throw X*/) const; //throw FileError, X
+
+private:
+    LogSpool           (const LogSpool&) = delete;
+    LogSpool& operator=(const LogSpool&) = delete;
+
+    void flushSpool(); //throw FileError
+
+    zen::SharedRef<zen::ErrorLog> log_ = zen::makeSharedRef<zen::ErrorLog>();
+    zen::ErrorLog preview_;
+    zen::ErrorLogStats stats_;
+    size_t itemCount_ = 0;
+
+    Zstring spoolFilePath_;
+    std::unique_ptr<zen::FileOutputPlain> spoolOut_; //nullptr: not spooled, log_ is complete
+    uint64_t spoolBytesWritten_ = 0;
+    std::string spoolBuf_; //records not yet written: int64 time, uint8 type, uint32 length, UTF-8 message
+    bool spoolFailed_ = false; //write error: keep buffering => nothing is lost
+};
+
+void logMsg(LogSpool& log, const std::wstring& msg, zen::MessageType type, time_t time = std::time(nullptr));
+
+
 void saveLogFile(const AbstractPath& logFilePath, //throw FileError, X
                  const ProcessSummary& summary,
                  const zen::ErrorLog& log,
@@ -32,6 +79,14 @@ void saveLogFile(const AbstractPath& logFilePath, //throw FileError, X
                  const std::set<AbstractPath>& logFilePathsToKeep,
                  const std::function<void(std::wstring&& msg)>& notifyStatus /*throw X*/);
 
+void saveLogFile(const AbstractPath& logFilePath, //throw FileError, X
+                 const ProcessSummary& summary,
+                 const LogSpool& log,
+                 int logfilesMaxAgeDays,
+                 LogFileFormat logFormat,
+                 const std::set<AbstractPath>& logFilePathsToKeep,
+                 const std::function<void(std::wstring&& msg)>& notifyStatus /*throw X*/);
+
 void sendLogAsEmail(const std::string& email, //throw FileError, X
                     const ProcessSummary& summary,
                     const zen::ErrorLog& log,
@@ -32,6 +32,7 @@ BatchStatusHandler::BatchStatusHandler(bool showProgress,
     autoRetryDelay_(autoRetryDelay),
     soundFileSyncComplete_(soundFileSyncComplete),
     soundFileAlertPending_(soundFileAlertPending),
+    logSpool_(makeSharedRef<LogSpool>(getLogFolderDefaultPath() /*local*/, std::vector<std::wstring>{jobName}, startTime)),
     batchErrorHandling_(batchErrorHandling)
 {
     //set *after* initializer list => callbacks during construction to getErrorStats()!
@@ -71,8 +72,8 @@ BatchStatusHandler::Result BatchStatusHandler::prepareResult()
     if (const ErrorLog extraLog = fetchExtraLog();
         !extraLog.empty())
     {
-        append(errorLog_.ref(), extraLog);
-        std::stable_sort(errorLog_.ref().begin(), errorLog_.ref().end(), [](const LogEntry& lhs, const LogEntry& rhs) { return lhs.time < rhs.time; });
+        logSpool_.ref().append(extraLog);
+        logSpool_.ref().sortByTime();
     }
 
     //determine post-sync status irrespective of further errors during tear-down
@@ -81,17 +82,17 @@ BatchStatusHandler::Result BatchStatusHandler::prepareResult()
     {
         if (taskCancelled())
         {
-            logMsg(errorLog_.ref(), _("Stopped"), MSG_TYPE_ERROR); //= user cancel or "stop on first error"
+            logMsg(logSpool_.ref(), _("Stopped"), MSG_TYPE_ERROR); //= user cancel or "stop on first error"
             return TaskResult::cancelled;
         }
-        const ErrorLogStats logCount = getStats(errorLog_.ref());
+        const ErrorLogStats logCount = logSpool_.ref().getStats();
         if (logCount.error > 0)
             return TaskResult::error;
         else if (logCount.warning > 0)
             return TaskResult::warning;
 
         if (getTotalStats() == ProgressStats())
-            logMsg(errorLog_.ref(), _("Nothing to synchronize"), MSG_TYPE_INFO);
+            logMsg(logSpool_.ref(), _("Nothing to synchronize"), MSG_TYPE_INFO);
         return TaskResult::success;
     }();
 
@@ -105,7 +106,7 @@ BatchStatusHandler::Result BatchStatusHandler::prepareResult()
         totalTime
     };
 
-    return {summary, errorLog_};
+    return {summary, logSpool_};
 }
 
 
@@ -182,7 +183,7 @@ BatchStatusHandler::DlgOptions BatchStatusHandler::showResult()
         {
             suspendSystem(); //throw FileError
         }
-        catch (const FileError& e) { logMsg(errorLog_.ref(), e.toString(), MSG_TYPE_ERROR); }
+        catch (const FileError& e) { logMsg(logSpool_.ref(), e.toString(), MSG_TYPE_ERROR); }
 
     //--------------------- sound notification ----------------------
     if (taskCancelled() && *taskCancelled() == CancelReason::user)
@@ -201,8 +202,8 @@ BatchStatusHandler::DlgOptions BatchStatusHandler::showResult()
 
     const auto [autoCloseDialog, dim] = progressDlg_->destroy(autoClose,
                                                               true /*restoreParentFrame: n/a here*/,
-                                                              *syncResult_, errorLog_);
-    //caveat: calls back to getErrorStats() => share errorLog_
+                                                              *syncResult_, logSpool_.ref().getLog());
+    //caveat: calls back to getErrorStats() => share logSpool_
     progressDlg_ = nullptr;
 
     return {dim, finalRequest};
@@ -237,7 +238,7 @@ void BatchStatusHandler::updateDataProcessed(int itemsDelta, int64_t bytesDelta)
 
 void BatchStatusHandler::logMessage(const std::wstring& msg, MsgType type)
 {
-    logMsg(errorLog_.ref(), msg, [&]
+    logMsg(logSpool_.ref(), msg, [&]
     {
         switch (type)
         {
@@ -258,7 +259,7 @@ void BatchStatusHandler::reportWarning(const std::wstring& msg, bool& warningAct
 {
     PauseTimers dummy(*progressDlg_);
 
-    logMsg(errorLog_.ref(), msg, MSG_TYPE_WARNING);
+    logMsg(logSpool_.ref(), msg, MSG_TYPE_WARNING);
 
     if (!warningActive)
         return;
@@ -282,7 +283,7 @@ void BatchStatusHandler::reportWarning(const std::wstring& msg, bool& warningAct
                         break;
 
                     case QuestionButton2::no: //switch
-                        logMsg(errorLog_.ref(), _("Switching to FreeFileSync's main window"), MSG_TYPE_INFO);
+                        logMsg(logSpool_.ref(), _("Switching to FreeFileSync's main window"), MSG_TYPE_INFO);
                         switchToGuiRequested_ = true; //treat as a special kind of cancel
                         cancelProcessNow(CancelReason::user); //throw CancelProcess
 
@@ -310,7 +311,7 @@ ProcessCallback::Response BatchStatusHandler::reportError(const ErrorInfo& error
     //auto-retry
     if (errorInfo.retryNumber < autoRetryCount_)
     {
-        logMsg(errorLog_.ref(), errorInfo.msg + L"\n-> " + _("Automatic retry"), MSG_TYPE_INFO, failTime);
+        logMsg(logSpool_.ref(), errorInfo.msg + L"\n-> " + _("Automatic retry"), MSG_TYPE_INFO, failTime);
         delayAndCountDown(errorInfo.failTime + autoRetryDelay_,
                           [&, statusPrefix  = _("Automatic retry") +
                                               (errorInfo.retryNumber == 0 ? L"" : L' ' + formatNumber(errorInfo.retryNumber + 1)) + SPACED_DASH,
@@ -320,7 +321,7 @@ ProcessCallback::Response BatchStatusHandler::reportError(const ErrorInfo& error
     }
 
     //always, except for "retry":
-    auto guardWriteLog = makeGuard<ScopeGuardRunMode::onExit>([&] { logMsg(errorLog_.ref(), errorInfo.msg, MSG_TYPE_ERROR, failTime); });
+    auto guardWriteLog = makeGuard<ScopeGuardRunMode::onExit>([&] { logMsg(logSpool_.ref(), errorInfo.msg, MSG_TYPE_ERROR, failTime); });
 
     if (!progressDlg_->getOptionIgnoreErrors())
     {
@@ -344,7 +345,7 @@ ProcessCallback::Response BatchStatusHandler::reportError(const ErrorInfo& error
 
                     case ConfirmationButton3::decline: //retry
                         guardWriteLog.dismiss();
-                        logMsg(errorLog_.ref(), errorInfo.msg + L"\n-> " + _("Retrying operation..."), MSG_TYPE_INFO, failTime);
+                        logMsg(logSpool_.ref(), errorInfo.msg + L"\n-> " + _("Retrying operation..."), MSG_TYPE_INFO, failTime);
                         return ProcessCallback::retry;
 
                     case ConfirmationButton3::cancel:
@@ -371,7 +372,7 @@ void BatchStatusHandler::reportFatalError(const std::wstring& msg)
 {
     PauseTimers dummy(*progressDlg_);
 
-    logMsg(errorLog_.ref(), msg, MSG_TYPE_ERROR);
+    logMsg(logSpool_.ref(), msg, MSG_TYPE_ERROR);
 
     if (!progressDlg_->getOptionIgnoreErrors())
         switch (batchErrorHandling_)
@@ -408,24 +409,8 @@ void BatchStatusHandler::reportFatalError(const std::wstring& msg)
 
 Statistics::ErrorStats BatchStatusHandler::getErrorStats() const
 {
-    //errorLog_ is an "append only" structure, so we can make getErrorStats() complexity "constant time":
-    std::for_each(errorLog_.ref().begin() + errorStatsRowsChecked_, errorLog_.ref().end(), [&](const LogEntry& entry)
-    {
-        switch (entry.type)
-        {
-            case MSG_TYPE_INFO:
-                break;
-            case MSG_TYPE_WARNING:
-                ++errorStatsBuf_.warningCount;
-                break;
-            case MSG_TYPE_ERROR:
-                ++errorStatsBuf_.errorCount;
-                break;
-        }
-    });
-    errorStatsRowsChecked_ = errorLog_.ref().size();
-
-    return errorStatsBuf_;
+    const ErrorLogStats logCount = logSpool_.ref().getStats(); //constant time
+    return {logCount.error, logCount.warning};
 }
 
 
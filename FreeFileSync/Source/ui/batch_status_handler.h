@@ -11,6 +11,7 @@
 #include "progress_indicator.h"
 #include "../config.h"
 #include "../status_handler.h"
+#include "../log_file.h"
 
 
 namespace fff
@@ -46,7 +47,7 @@ public:
     struct Result
     {
         ProcessSummary summary;
-        zen::SharedRef<zen::ErrorLog> errorLog;
+        zen::SharedRef<LogSpool> log;
     };
     Result prepareResult();
 
@@ -74,9 +75,7 @@ private:
     const Zstring soundFileAlertPending_;
 
     SyncProgressDialog* progressDlg_; //managed to have the same lifetime as this handler!
-    zen::SharedRef<zen::ErrorLog> errorLog_ = zen::makeSharedRef<zen::ErrorLog>();
-    mutable Statistics::ErrorStats errorStatsBuf_{};
-    mutable size_t errorStatsRowsChecked_ = 0;
+    zen::SharedRef<LogSpool> logSpool_; //bounded memory: think multi-million entries for long batch runs
     const BatchErrorHandling batchErrorHandling_;
     bool switchToGuiRequested_ = false;
     std::optional<TaskResult> syncResult_;
@@ -538,10 +538,10 @@ private:
         switch (static_cast<ColumnTypeCfg>(colType))
         {
             case ColumnTypeCfg::name:
-                return getColumnGapLeft() + getDefaultMenuIconSize() + getColumnGapLeft() + dc.GetTextExtent(getValue(row, colType)).GetWidth() + getColumnGapLeft();
+                return getColumnGapLeft() + getDefaultMenuIconSize() + getColumnGapLeft() + getTextExtentBuffered(dc, getValue(row, colType)).GetWidth() + getColumnGapLeft();
 
             case ColumnTypeCfg::lastSync:
-                return getColumnGapLeft() + dc.GetTextExtent(getValue(row, colType)).GetWidth() + getColumnGapLeft();
+                return getColumnGapLeft() + getTextExtentBuffered(dc, getValue(row, colType)).GetWidth() + getColumnGapLeft();
 
             case ColumnTypeCfg::lastLog:
                 return getDefaultMenuIconSize();
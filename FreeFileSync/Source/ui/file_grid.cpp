@@ -222,7 +222,7 @@ struct IconManager
 {
     IconManager() {}
 
-    IconManager(GridDataLeft& provLeft, GridDataRight& provRight, IconBuffer::IconSize sz, bool showFileIcons) :
+    IconManager(GridDataLeft& provLeft, GridDataRight& provRight, IconBuffer::IconSize sz, bool showFileIcons, size_t loaderThreads) :
         fileIcon_        (IconBuffer::genericFileIcon (showFileIcons ? sz : IconBuffer::IconSize::small)),
         dirIcon_         (IconBuffer::genericDirIcon  (showFileIcons ? sz : IconBuffer::IconSize::small)),
         linkOverlayIcon_ (IconBuffer::linkOverlayIcon (showFileIcons ? sz : IconBuffer::IconSize::small)),
@@ -231,7 +231,7 @@ struct IconManager
     {
         if (showFileIcons)
         {
-            iconBuffer_  = std::make_unique<IconBuffer>(sz);
+            iconBuffer_  = std::make_unique<IconBuffer>(sz, loaderThreads);
             iconUpdater_ = std::make_unique<IconUpdater>(provLeft, provRight, *iconBuffer_);
         }
     }
@@ -308,7 +308,6 @@ struct SharedComponents //...between left, center, and right grids
     NavigationMarker navMarker;
     std::unique_ptr<GridEventManager> evtMgr;
     GridViewType gridViewType = GridViewType::action;
-    std::unordered_map<std::wstring, wxSize> compExtentsBuf_; //buffer expensive wxDC::GetTextExtent() calls!
 };
 
 //########################################################################################################
@@ -323,7 +322,6 @@ public:
     {
         sharedComp_.ref().gridDataView = makeSharedRef<FileView>(); //clear old data view first! avoid memory peaks!
         sharedComp_.ref().gridDataView = makeSharedRef<FileView>(folderCmp);
-        sharedComp_.ref().compExtentsBuf_.clear(); //doesn't become stale! but still: re-calculate and save some memory...
     }
 
     GridEventManager* getEventManager() { return sharedComp_.ref().evtMgr.get(); }
@@ -351,18 +349,6 @@ public:
 
     const FileSystemObject* getFsObject(size_t row) const { return getDataView().getFsObject(row); }
 
-    const wxSize& getTextExtentBuffered(wxDC& dc, const std::wstring& text)
-    {
-        auto& compExtentsBuf = sharedComp_.ref().compExtentsBuf_;
-        //- only used for parent path names and file names on view => should not grow "too big"
-        //- cleaned up during GridDataBase::setData()
-
-        auto it = compExtentsBuf.find(text);
-        if (it == compExtentsBuf.end())
-            it = compExtentsBuf.emplace(text, dc.GetTextExtent(text)).first;
-        return it->second;
-    }
-
 private:
     size_t getRowCount() const override { return getDataView().rowsOnView(); }
 
@@ -380,7 +366,7 @@ public:
 
     void setItemPathForm(ItemPathFormat fmt) { itemPathFormat_ = fmt; groupItemNamesWidthBuf_.clear(); }
 
-    void getUnbufferedIconsForPreload(std::vector<std::pair<ptrdiff_t, AbstractPath>>& newLoad) //return (priority, filepath) list
+    void getUnbufferedIconsForPreload(std::vector<std::pair<ptrdiff_t, IconBuffer::IconSource>>& newLoad) //return (priority, icon source) list
     {
         if (IconBuffer* iconBuf = getIconManager().getIconBuffer())
         {
@@ -398,13 +384,13 @@ public:
                 if (const FileSystemObject* fsObj = getFsObject(currentRow))
                     if (getIconInfo(*fsObj).type == IconType::standard)
                         if (!iconBuf->readyForRetrieval(fsObj->template getAbstractPath<side>()))
-                            newLoad.emplace_back(i, fsObj->template getAbstractPath<side>()); //insert least-important items on outer rim first
+                            newLoad.emplace_back(i, getIconSource(*fsObj)); //insert least-important items on outer rim first
             }
         }
         else assert(false);
     }
 
-    void updateNewAndGetUnbufferedIcons(std::vector<AbstractPath>& newLoad) //loads all not yet drawn icons
+    void updateNewAndGetUnbufferedIcons(std::vector<IconBuffer::IconSource>& newLoad) //loads all not yet drawn icons
     {
         if (IconBuffer* iconBuf = getIconManager().getIconBuffer())
         {
@@ -428,7 +414,7 @@ public:
                                 setFailedLoad(currentRow, false);
                             }
                             else //not yet in buffer: mark for async. loading
-                                newLoad.push_back(fsObj->template getAbstractPath<side>());
+                                newLoad.push_back(getIconSource(*fsObj));
                         }
             }
         }
@@ -947,7 +933,7 @@ private:
                             rectGroupParentText.x     += gapSize_;
                             rectGroupParentText.width -= stackedGroupRender ? gapSize_ + gapSizeWide_ : gapSize_;
 
-                            drawCellText(dc, rectGroupParentText, groupParentFolder, wxALIGN_LEFT | wxALIGN_CENTER_VERTICAL, &getTextExtentBuffered(dc, groupParentFolder));
+                            drawCellText(dc, rectGroupParentText, groupParentFolder);
                         }
 
                         if (!groupName.empty() &&
@@ -988,7 +974,7 @@ private:
                                 drawRectangleBorder(dc, rectGroupNameBack, *wxBLUE, fastFromDIP(1));
 
                             if (!pdi.folderGroupObj->isEmpty<side>())
-                                drawCellText(dc, rectGroupName, groupName, wxALIGN_LEFT | wxALIGN_CENTER_VERTICAL, &getTextExtentBuffered(dc, groupName));
+                                drawCellText(dc, rectGroupName, groupName);
                         }
                     }
 
@@ -1032,7 +1018,7 @@ private:
                                     break;
 
                                 case IconType::standard:
-                                    if (std::optional<wxImage> tmpIco = iconBuf->retrieveFileIcon(pdi.fsObj->template getAbstractPath<side>()))
+                                    if (std::optional<wxImage> tmpIco = iconBuf->retrieveFileIcon(getIconSource(*pdi.fsObj)))
                                         fileIcon = *tmpIco;
                                     else
                                     {
@@ -1059,7 +1045,7 @@ private:
                             drawRectangleBorder(dc, rectItemsBack, *wxBLUE, fastFromDIP(1));
 
                         if (!pdi.fsObj->isEmpty<side>())
-                            drawCellText(dc, rectGroupItems, itemName, wxALIGN_LEFT | wxALIGN_CENTER_VERTICAL, &getTextExtentBuffered(dc, itemName));
+                            drawCellText(dc, rectGroupItems, itemName);
                     }
 
                     //if not done yet:
@@ -1155,7 +1141,7 @@ private:
         else
         {
             const std::wstring cellValue = getValue(row, colType);
-            return gapSize_ + dc.GetTextExtent(cellValue).GetWidth() + gapSize_;
+            return gapSize_ + getTextExtentBuffered(dc, cellValue).GetWidth() + gapSize_;
         }
     }
 
@@ -1284,6 +1270,20 @@ private:
         return out;
     }
 
+    static IconBuffer::IconSource getIconSource(const FileSystemObject& fsObj)
+    {
+        IconBuffer::IconSource out{fsObj.template getAbstractPath<side>()};
+
+        visitFSObject(fsObj, [](const FolderPair& folder) {},
+        [&](const FilePair& file)
+        {
+            out.fileSize = file.getFileSize<side>();
+            out.modTime  = file.getLastWriteTime<side>();
+        },
+        [](const SymlinkPair& symlink) {}); //target size and time are unknown => no thumbnail disk cache
+        return out;
+    }
+
     const int gapSize_     = fastFromDIP(FILE_GRID_GAP_SIZE_DIP);
     const int gapSizeWide_ = fastFromDIP(FILE_GRID_GAP_SIZE_WIDE_DIP);
 
@@ -2078,7 +2078,7 @@ namespace
 //resolve circular linker dependencies
 void IconUpdater::loadIconsAsynchronously(wxEvent& event) //loads all (not yet) drawn icons
 {
-    std::vector<std::pair<ptrdiff_t, AbstractPath>> prefetchLoad;
+    std::vector<std::pair<ptrdiff_t, IconBuffer::IconSource>> prefetchLoad;
     provLeft_ .getUnbufferedIconsForPreload(prefetchLoad);
     provRight_.getUnbufferedIconsForPreload(prefetchLoad);
 
@@ -2087,9 +2087,9 @@ void IconUpdater::loadIconsAsynchronously(wxEvent& event) //loads all (not yet)
     std::sort(prefetchLoad.begin(), prefetchLoad.end(), [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
 
     //last inserted items are processed first in icon buffer:
-    std::vector<AbstractPath> newLoad;
-    for (const auto& [priority, filePath] : prefetchLoad)
-        newLoad.push_back(filePath);
+    std::vector<IconBuffer::IconSource> newLoad;
+    for (const auto& [priority, item] : prefetchLoad)
+        newLoad.push_back(item);
 
     provRight_.updateNewAndGetUnbufferedIcons(newLoad);
     provLeft_ .updateNewAndGetUnbufferedIcons(newLoad);
@@ -2102,14 +2102,14 @@ void IconUpdater::loadIconsAsynchronously(wxEvent& event) //loads all (not yet)
 }
 
 
-void filegrid::setupIcons(Grid& gridLeft, Grid& gridCenter, Grid& gridRight, bool showFileIcons, IconBuffer::IconSize sz)
+void filegrid::setupIcons(Grid& gridLeft, Grid& gridCenter, Grid& gridRight, bool showFileIcons, IconBuffer::IconSize sz, size_t loaderThreads)
 {
     auto* provLeft  = dynamic_cast<GridDataLeft*>(gridLeft .getDataProvider());
     auto* provRight = dynamic_cast<GridDataRight*>(gridRight.getDataProvider());
 
     if (provLeft && provRight)
     {
-        auto iconMgr = makeSharedRef<IconManager>(*provLeft, *provRight, sz, showFileIcons);
+        auto iconMgr = makeSharedRef<IconManager>(*provLeft, *provRight, sz, showFileIcons, loaderThreads);
         provLeft ->setIconManager(iconMgr);
 
         const int newRowHeight = std::max(iconMgr.ref().getIconSize(), gridLeft.getMainWin().GetCharHeight()) + fastFromDIP(1); //add some space
@@ -5,9 +5,9 @@
 // *****************************************************************************
 
 #include "file_view.h"
+#include "file_view_sort.h"
 #include <zen/stl_tools.h>
 #include <zen/perf.h>
-#include <zen/thread.h>
 #include "../base/synchronization.h"
 
 using namespace zen;
@@ -65,22 +65,103 @@ FileView::FileView(FolderComparison& folderCmp)
                                   baseObj.getAbstractPath<SelectSide::left >(),
                                   baseObj.getAbstractPath<SelectSide::right>());
     });
+
+    uint32_t slotIndexEnd = 0;
+    for (const FileSystemObject::ObjectId& objId : sortedRef_)
+        slotIndexEnd = std::max(slotIndexEnd, objId.getSlotIndex() + 1);
+
+    rowPositions_          .resize(slotIndexEnd);
+    rowPositionsFirstChild_.resize(slotIndexEnd);
+}
+
+
+void FileView::clearRowPositions()
+{
+    if (++rowPosViewStamp_ == 0) //wrap-around: stale entries could become valid again
+    {
+        std::fill(rowPositions_.begin(), rowPositions_.end(), RowPosition());
+        rowPosViewStamp_ = 1;
+    }
+    rowPositionsFirstChildValid_ = false;
+}
+
+
+void FileView::updateRowPositionsFirstChild() const
+{
+    rowPositionsFirstChildBase_.clear();
+
+    if (++rowPosFirstChildStamp_ == 0) //wrap-around: stale entries could become valid again
+    {
+        std::fill(rowPositionsFirstChild_.begin(), rowPositionsFirstChild_.end(), RowPosition());
+        rowPosFirstChildStamp_ = 1;
+    }
+
+    for (size_t row = 0; row < viewRef_.size(); ++row)
+        if (const FileSystemObject* const fsObj = FileSystemObject::retrieve(viewRef_[row].objId))
+            //save row position to identify first child *on sorted subview* of FolderPair or BaseFolderPair in case latter are filtered out
+            for (const FileSystemObject* fsObj2 = fsObj;;)
+            {
+                const ContainerObject& parent = fsObj2->parent();
+
+                if (const auto folder = dynamic_cast<const FolderPair*>(&parent))
+                {
+                    RowPosition& rowPos = rowPositionsFirstChild_[folder->getId().getSlotIndex()];
+                    if (rowPos.viewStamp == rowPosFirstChildStamp_) //=> parents further up in hierarchy already inserted!
+                        break;
+                    rowPos = {rowPosFirstChildStamp_, static_cast<uint32_t>(row)};
+                    fsObj2 = folder;
+                }
+                else
+                {
+                    if (std::none_of(rowPositionsFirstChildBase_.begin(), rowPositionsFirstChildBase_.end(), [&](const auto& item) { return item.first == &parent; }))
+                        rowPositionsFirstChildBase_.emplace_back(&parent, row);
+                    break;
+                }
+            }
+
+    rowPositionsFirstChildValid_ = true;
+}
+
+
+namespace
+{
+uint64_t getNextViewUpdateId()
+{
+    static uint64_t globalViewUpdateId;
+    return ++globalViewUpdateId;
+}
+}
+
+
+inline
+size_t FileView::addRowToGroup(size_t row, const FileSystemObject& fsObj, const ContainerObject*& groupStartObj)
+{
+    //------ save info to aggregate rows by parent folders ------
+    if (const auto folder = dynamic_cast<const FolderPair*>(&fsObj))
+    {
+        groupStartObj = folder;
+        groupDetails_.push_back({row});
+    }
+    else if (&fsObj.parent() != groupStartObj)
+    {
+        groupStartObj = &fsObj.parent();
+        groupDetails_.push_back({row});
+    }
+    assert(!groupDetails_.empty());
+    return groupDetails_.size() - 1;
 }
 
 
 template <class Predicate>
 void FileView::updateView(Predicate pred)
 {
-    viewRef_               .clear();
-    groupDetails_          .clear();
-    rowPositions_          .clear();
-    rowPositionsFirstChild_.clear();
+    viewRef_     .clear();
+    groupDetails_.clear();
+    clearRowPositions();
 
-    static uint64_t globalViewUpdateId;
-    viewUpdateId_ = ++globalViewUpdateId;
+    viewUpdateId_ = getNextViewUpdateId();
     assert(runningOnMainThread());
 
-    std::vector<const ContainerObject*> parentsBuf; //from bottom to top of hierarchy
     const ContainerObject* groupStartObj = nullptr;
 
     for (const FileSystemObject::ObjectId& objId : sortedRef_)
@@ -88,97 +169,253 @@ void FileView::updateView(Predicate pred)
             if (pred(*fsObj))
             {
                 const size_t row = viewRef_.size();
+                assert(row < std::numeric_limits<uint32_t>::max());
 
                 //save row position for direct random access to FilePair or FolderPair
-                rowPositions_.emplace(objId, row); //costs: 0.28 µs per call - MSVC based on std::set
+                rowPositions_[objId.getSlotIndex()] = {rowPosViewStamp_, static_cast<uint32_t>(row)};
 
-                parentsBuf.clear();
-                for (const FileSystemObject* fsObj2 = fsObj;;)
-                {
-                    const ContainerObject& parent = fsObj2->parent();
-                    parentsBuf.push_back(&parent);
+                const size_t groupIdx = addRowToGroup(row, *fsObj, groupStartObj);
+                viewRef_.push_back({objId, groupIdx});
+            }
+}
 
-                    fsObj2 = dynamic_cast<const FolderPair*>(&parent);
-                    if (!fsObj2)
-                        break;
-                }
 
-                //save row position to identify first child *on sorted subview* of FolderPair or BaseFolderPair in case latter are filtered out
-                for (const ContainerObject* parent : parentsBuf)
-                    if (const auto [it, inserted] = this->rowPositionsFirstChild_.emplace(parent, row);
-                        !inserted) //=> parents further up in hierarchy already inserted!
-                        break;
+void FileView::updateRowPositions(size_t rowFirst)
+{
+    while (!groupDetails_.empty() && groupDetails_.back().groupFirstRow >= rowFirst)
+        groupDetails_.pop_back();
 
-                //------ save info to aggregate rows by parent folders ------
-                if (const auto folder = dynamic_cast<const FolderPair*>(fsObj))
-                {
-                    groupStartObj = folder;
-                    groupDetails_.push_back({row});
-                }
-                else if (&fsObj->parent() != groupStartObj)
-                {
-                    groupStartObj = &fsObj->parent();
-                    groupDetails_.push_back({row});
-                }
-                assert(!groupDetails_.empty());
-                const size_t groupIdx = groupDetails_.size() - 1;
-                //-----------------------------------------------------------
-                viewRef_.push_back({objId, groupIdx});
-            }
+    const ContainerObject* groupStartObj = nullptr; //continue group of previous row:
+    if (rowFirst > 0)
+        if (const FileSystemObject* const fsObj = FileSystemObject::retrieve(viewRef_[rowFirst - 1].objId))
+        {
+            if (const auto folder = dynamic_cast<const FolderPair*>(fsObj))
+                groupStartObj = folder;
+            else
+                groupStartObj = &fsObj->parent();
+        }
+
+    for (size_t row = rowFirst; row < viewRef_.size(); ++row)
+        if (const FileSystemObject* const fsObj = FileSystemObject::retrieve(viewRef_[row].objId))
+        {
+            rowPositions_[viewRef_[row].objId.getSlotIndex()] = {rowPosViewStamp_, static_cast<uint32_t>(row)};
+            viewRef_[row].groupIdx = addRowToGroup(row, *fsObj, groupStartObj);
+        }
+        else assert(false); //deleted items were removed by applyChanges()
 }
 
 
 ptrdiff_t FileView::findRowDirect(FileSystemObject::ObjectIdConst objId) const
 {
-    auto it = rowPositions_.find(objId);
-    return it != rowPositions_.end() ? it->second : -1;
+    if (objId.getSlotIndex() < rowPositions_.size())
+        if (const RowPosition& rowPos = rowPositions_[objId.getSlotIndex()];
+            rowPos.viewStamp == rowPosViewStamp_ &&
+            FileSystemObject::ObjectIdConst(viewRef_[rowPos.row].objId) == objId) //slot may have been reused by a different object
+            return rowPos.row;
+    return -1;
 }
 
 
-ptrdiff_t FileView::findRowFirstChild(const ContainerObject* conObj) const
+ptrdiff_t FileView::findRowFirstChild(FileSystemObject::ObjectIdConst folderId) const
 {
-    auto it = rowPositionsFirstChild_.find(conObj);
-    return it != rowPositionsFirstChild_.end() ? it->second : -1;
+    if (!rowPositionsFirstChildValid_)
+        updateRowPositionsFirstChild();
+
+    if (folderId.getSlotIndex() < rowPositionsFirstChild_.size())
+        if (const RowPosition& rowPos = rowPositionsFirstChild_[folderId.getSlotIndex()];
+            rowPos.viewStamp == rowPosFirstChildStamp_ &&
+            FileSystemObject::retrieve(folderId)) //slot may have been reused by a different object
+            return rowPos.row;
+    return -1;
+}
+
+
+ptrdiff_t FileView::findRowFirstChild(const BaseFolderPair* baseObj) const
+{
+    if (!rowPositionsFirstChildValid_)
+        updateRowPositionsFirstChild();
+
+    for (const auto& [baseObj2, row] : rowPositionsFirstChildBase_)
+        if (baseObj2 == baseObj)
+            return row;
+    return -1;
 }
 
 
 namespace
 {
+inline
+void addBytes(uint64_t& bytes, uint64_t delta, int sign)
+{
+    if (sign > 0)
+        bytes += delta;
+    else
+        bytes -= delta;
+}
+
+
 template <class ViewStats>
-void addNumbers(const FileSystemObject& fsObj, ViewStats& stats)
+void addNumbers(const FileSystemObject& fsObj, ViewStats& stats, int sign)
 {
     visitFSObject(fsObj, [&](const FolderPair& folder)
     {
         if (!folder.isEmpty<SelectSide::left>())
-            ++stats.fileStatsLeft.folderCount;
+            stats.fileStatsLeft.folderCount += sign;
 
         if (!folder.isEmpty<SelectSide::right>())
-            ++stats.fileStatsRight.folderCount;
+            stats.fileStatsRight.folderCount += sign;
     },
 
     [&](const FilePair& file)
     {
         if (!file.isEmpty<SelectSide::left>())
         {
-            stats.fileStatsLeft.bytes += file.getFileSize<SelectSide::left>();
-            ++stats.fileStatsLeft.fileCount;
+            addBytes(stats.fileStatsLeft.bytes, file.getFileSize<SelectSide::left>(), sign);
+            stats.fileStatsLeft.fileCount += sign;
         }
         if (!file.isEmpty<SelectSide::right>())
         {
-            stats.fileStatsRight.bytes += file.getFileSize<SelectSide::right>();
-            ++stats.fileStatsRight.fileCount;
+            addBytes(stats.fileStatsRight.bytes, file.getFileSize<SelectSide::right>(), sign);
+            stats.fileStatsRight.fileCount += sign;
         }
     },
 
     [&](const SymlinkPair& symlink)
     {
         if (!symlink.isEmpty<SelectSide::left>())
-            ++stats.fileStatsLeft.fileCount;
+            stats.fileStatsLeft.fileCount += sign;
 
         if (!symlink.isEmpty<SelectSide::right>())
-            ++stats.fileStatsRight.fileCount;
+            stats.fileStatsRight.fileCount += sign;
     });
 }
+
+
+template <class ViewStats>
+void addNumbers(const FsObjectState& state, ViewStats& stats, int sign)
+{
+    auto addSide = [&]<SelectSide side>(FileView::FileStats& fileStats)
+    {
+        if (!state.isEmpty<side>())
+            switch (state.itemType)
+            {
+                case FsObjectState::ItemType::folder:
+                    fileStats.folderCount += sign;
+                    break;
+                case FsObjectState::ItemType::file:
+                    addBytes(fileStats.bytes, state.getFileSize<side>(), sign);
+                    fileStats.fileCount += sign;
+                    break;
+                case FsObjectState::ItemType::symlink:
+                    fileStats.fileCount += sign;
+                    break;
+            }
+    };
+    addSide.template operator()<SelectSide::left >(stats.fileStatsLeft);
+    addSide.template operator()<SelectSide::right>(stats.fileStatsRight);
+}
+}
+
+
+template <class FsItem>
+bool FileView::categorize(const FsItem& item, DifferenceView& view, int sign)
+{
+    const DifferenceFilter& filter = view.filter;
+    DifferenceViewStats& stats = view.stats;
+
+    auto categorizeImpl = [&](bool showCategory, int& categoryCount)
+    {
+        if (!item.isActive())
+        {
+            stats.excluded += sign;
+            if (!filter.showExcluded)
+                return false;
+        }
+        categoryCount += sign;
+        if (!showCategory)
+            return false;
+
+        addNumbers(item, stats, sign); //calculate total number of bytes for each side
+        return true;
+    };
+
+    switch (item.getCategory())
+    {
+        case FILE_LEFT_ONLY:
+            return categorizeImpl(filter.showLeftOnly, stats.leftOnly);
+        case FILE_RIGHT_ONLY:
+            return categorizeImpl(filter.showRightOnly, stats.rightOnly);
+        case FILE_LEFT_NEWER:
+            return categorizeImpl(filter.showLeftNewer, stats.leftNewer);
+        case FILE_RIGHT_NEWER:
+            return categorizeImpl(filter.showRightNewer, stats.rightNewer);
+        case FILE_DIFFERENT_CONTENT:
+            return categorizeImpl(filter.showDifferent, stats.different);
+        case FILE_EQUAL:
+            return categorizeImpl(filter.showEqual, stats.equal);
+        case FILE_RENAMED:
+        case FILE_CONFLICT:
+        case FILE_TIME_INVALID:
+            return categorizeImpl(filter.showConflict, stats.conflict);
+    }
+    assert(false);
+    return true;
+}
+
+
+template <class FsItem>
+bool FileView::categorize(const FsItem& item, ActionView& view, int sign)
+{
+    const ActionFilter& filter = view.filter;
+    ActionViewStats& stats = view.stats;
+
+    auto categorizeImpl = [&](bool showCategory, int& categoryCount)
+    {
+        if (!item.isActive())
+        {
+            stats.excluded += sign;
+            if (!filter.showExcluded)
+                return false;
+        }
+        categoryCount += sign;
+        if (!showCategory)
+            return false;
+
+        addNumbers(item, stats, sign); //calculate total number of bytes for each side
+        return true;
+    };
+
+    switch (item.getSyncOperation()) //evaluate comparison result and sync direction
+    {
+        case SO_CREATE_LEFT:
+            return categorizeImpl(filter.showCreateLeft, stats.createLeft);
+        case SO_CREATE_RIGHT:
+            return categorizeImpl(filter.showCreateRight, stats.createRight);
+        case SO_DELETE_LEFT:
+            return categorizeImpl(filter.showDeleteLeft, stats.deleteLeft);
+        case SO_DELETE_RIGHT:
+            return categorizeImpl(filter.showDeleteRight, stats.deleteRight);
+        case SO_OVERWRITE_LEFT:
+        case SO_RENAME_LEFT:
+            return categorizeImpl(filter.showUpdateLeft, stats.updateLeft);
+        case SO_MOVE_LEFT_FROM:
+        case SO_MOVE_LEFT_TO:
+            return categorizeImpl(filter.showUpdateLeft, view.moveLeft);
+        case SO_OVERWRITE_RIGHT:
+        case SO_RENAME_RIGHT:
+            return categorizeImpl(filter.showUpdateRight, stats.updateRight);
+        case SO_MOVE_RIGHT_FROM:
+        case SO_MOVE_RIGHT_TO:
+            return categorizeImpl(filter.showUpdateRight, view.moveRight);
+        case SO_DO_NOTHING:
+            return categorizeImpl(filter.showDoNothing, stats.updateNone);
+        case SO_EQUAL:
+            return categorizeImpl(filter.showEqual, stats.equal);
+        case SO_UNRESOLVED_CONFLICT:
+            return categorizeImpl(filter.showConflict, stats.conflict);
+    }
+    assert(false);
+    return true;
 }
 
 
@@ -191,50 +428,17 @@ FileView::DifferenceViewStats FileView::applyDifferenceFilter(bool showExcluded,
                                                               bool showEqual,
                                                               bool showConflict)
 {
-    DifferenceViewStats stats;
+    const DifferenceFilter filter{showExcluded, showLeftOnly, showRightOnly, showLeftNewer, showRightNewer, showDifferent, showEqual, showConflict};
 
-    updateView([&](const FileSystemObject& fsObj)
-    {
-        auto categorize = [&](bool showCategory, int& categoryCount)
-        {
-            if (!fsObj.isActive())
-            {
-                ++stats.excluded;
-                if (!showExcluded)
-                    return false;
-            }
-            ++categoryCount;
-            if (!showCategory)
-                return false;
+    if (const DifferenceView* viewOld = std::get_if<DifferenceView>(&currentView_);
+        viewOld && viewOld->filter == filter)
+        return viewOld->stats; //viewRef_ is up to date: see applyChanges()
 
-            addNumbers(fsObj, stats); //calculate total number of bytes for each side
-            return true;
-        };
+    DifferenceView view{.filter = filter};
+    updateView([&](const FileSystemObject& fsObj) { return categorize(fsObj, view, 1); });
+    currentView_ = view;
 
-        switch (fsObj.getCategory())
-        {
-            case FILE_LEFT_ONLY:
-                return categorize(showLeftOnly, stats.leftOnly);
-            case FILE_RIGHT_ONLY:
-                return categorize(showRightOnly, stats.rightOnly);
-            case FILE_LEFT_NEWER:
-                return categorize(showLeftNewer, stats.leftNewer);
-            case FILE_RIGHT_NEWER:
-                return categorize(showRightNewer, stats.rightNewer);
-            case FILE_DIFFERENT_CONTENT:
-                return categorize(showDifferent, stats.different);
-            case FILE_EQUAL:
-                return categorize(showEqual, stats.equal);
-            case FILE_RENAMED:
-            case FILE_CONFLICT:
-            case FILE_TIME_INVALID:
-                return categorize(showConflict, stats.conflict);
-        }
-        assert(false);
-        return true;
-    });
-
-    return stats;
+    return view.stats;
 }
 
 
@@ -249,67 +453,151 @@ FileView::ActionViewStats FileView::applyActionFilter(bool showExcluded, //maps
                                                       bool showEqual,
                                                       bool showConflict)
 {
-    ActionViewStats stats;
+    const ActionFilter filter{showExcluded, showCreateLeft, showCreateRight, showDeleteLeft, showDeleteRight,
+                              showUpdateLeft, showUpdateRight, showDoNothing, showEqual, showConflict};
+
+    auto getStats = [](const ActionView& view)
+    {
+        assert(view.moveLeft % 2 == 0 && view.moveRight % 2 == 0);
+        ActionViewStats stats = view.stats;
+        stats.updateLeft  += view.moveLeft  / 2; //count move operations as single update
+        stats.updateRight += view.moveRight / 2; //=> harmonize with SyncStatistics::processFile()
+        return stats;
+    };
+
+    if (const ActionView* viewOld = std::get_if<ActionView>(&currentView_);
+        viewOld && viewOld->filter == filter)
+        return getStats(*viewOld); //viewRef_ is up to date: see applyChanges()
+
+    ActionView view{.filter = filter};
+    updateView([&](const FileSystemObject& fsObj) { return categorize(fsObj, view, 1); });
+    currentView_ = view;
+
+    return getStats(view);
+}
+
+
+void FileView::applyChanges(const HierarchyChanges& changes)
+{
+    if (changes.fullUpdate ||
+        (std::holds_alternative<std::monostate>(currentView_) && !changes.items.empty()))
+        return removeInvalidRows(); //=> full update
+
+    if (changes.items.empty())
+        return;
 
-    int moveLeft  = 0;
-    int moveRight = 0;
+    //1. update statistics and find rows to show/hide
+    enum class RowChange : unsigned char
+    {
+        none,
+        show,
+        hide,
+        remove, //item was deleted
+    };
+    std::vector<RowChange> rowChanges(rowPositions_.size()); //indexed by slot: no hashing in merge loop below
+    std::vector<size_t> rowsHidden;
+    size_t rowsShownCount = 0;
+    bool itemsRemoved = false;
 
-    updateView([&](const FileSystemObject& fsObj)
+    auto categorizeChanges = [&](auto& view)
     {
-        auto categorize = [&](bool showCategory, int& categoryCount)
+        for (const FsObjectState& stateOld : changes.items)
         {
-            if (!fsObj.isActive())
+            const uint32_t slotIdx = stateOld.objId.getSlotIndex();
+            assert(slotIdx < rowChanges.size()); //new items require full update: see FileSystemObject constructor
+            if (slotIdx >= rowChanges.size())
+                return false;
+
+            const bool shownOld = categorize(stateOld, view, -1);
+            assert(shownOld == (findRowDirect(stateOld.objId) >= 0));
+
+            const FileSystemObject* fsObj = FileSystemObject::retrieve(stateOld.objId);
+            const bool shownNew = fsObj && categorize(getObjectState(*fsObj), view, 1);
+
+            if (!fsObj)
             {
-                ++stats.excluded;
-                if (!showExcluded)
-                    return false;
+                rowChanges[slotIdx] = RowChange::remove;
+                itemsRemoved = true;
             }
-            ++categoryCount;
-            if (!showCategory)
-                return false;
+            else if (shownOld != shownNew)
+                rowChanges[slotIdx] = shownNew ? RowChange::show : RowChange::hide;
 
-            addNumbers(fsObj, stats); //calculate total number of bytes for each side
-            return true;
-        };
+            if (shownOld && !shownNew)
+                if (const ptrdiff_t row = findRowDirect(stateOld.objId);
+                    row >= 0)
+                {
+                    rowsHidden.push_back(row);
+                    rowPositions_[slotIdx].viewStamp = 0; //invalidate
+                }
+            if (!shownOld && shownNew)
+                ++rowsShownCount;
+        }
+        return true;
+    };
+
+    bool changesApplied = false;
+    if (auto diffView = std::get_if<DifferenceView>(&currentView_))
+        changesApplied = categorizeChanges(*diffView);
+    else if (auto actionView = std::get_if<ActionView>(&currentView_))
+        changesApplied = categorizeChanges(*actionView);
+
+    if (!changesApplied)
+        return removeInvalidRows(); //=> full update
+
+    viewUpdateId_ = getNextViewUpdateId(); //item names and group layout may have changed
+    rowPositionsFirstChildValid_ = false;
+
+    //2. patch viewRef_: rows before first change remain valid!
+    size_t rowFirst = 0;
+
+    if (rowsShownCount == 0 && !itemsRemoved) //fast path: only remove rows
+    {
+        if (rowsHidden.empty())
+            return;
+        std::sort(rowsHidden.begin(), rowsHidden.end());
+        rowFirst = rowsHidden[0];
+
+        auto itHidden = rowsHidden.begin();
+        size_t rowOut = rowFirst;
+        for (size_t row = rowFirst; row < viewRef_.size(); ++row)
+            if (itHidden != rowsHidden.end() && *itHidden == row)
+                ++itHidden;
+            else
+                viewRef_[rowOut++] = viewRef_[row];
+        viewRef_.resize(rowOut);
+    }
+    else //merge changes while preserving sort order of sortedRef_
+    {
+        std::vector<ViewRow> viewRefNew;
+        viewRefNew.reserve(viewRef_.size() + rowsShownCount);
 
-        switch (fsObj.getSyncOperation()) //evaluate comparison result and sync direction
+        size_t rowOld = 0;
+        size_t sortedOut = 0;
+        for (const FileSystemObject::ObjectId& objId : sortedRef_)
         {
-            case SO_CREATE_LEFT:
-                return categorize(showCreateLeft, stats.createLeft);
-            case SO_CREATE_RIGHT:
-                return categorize(showCreateRight, stats.createRight);
-            case SO_DELETE_LEFT:
-                return categorize(showDeleteLeft, stats.deleteLeft);
-            case SO_DELETE_RIGHT:
-                return categorize(showDeleteRight, stats.deleteRight);
-            case SO_OVERWRITE_LEFT:
-            case SO_RENAME_LEFT:
-                return categorize(showUpdateLeft, stats.updateLeft);
-            case SO_MOVE_LEFT_FROM:
-            case SO_MOVE_LEFT_TO:
-                return categorize(showUpdateLeft, moveLeft);
-            case SO_OVERWRITE_RIGHT:
-            case SO_RENAME_RIGHT:
-                return categorize(showUpdateRight, stats.updateRight);
-            case SO_MOVE_RIGHT_FROM:
-            case SO_MOVE_RIGHT_TO:
-                return categorize(showUpdateRight, moveRight);
-            case SO_DO_NOTHING:
-                return categorize(showDoNothing, stats.updateNone);
-            case SO_EQUAL:
-                return categorize(showEqual, stats.equal);
-            case SO_UNRESOLVED_CONFLICT:
-                return categorize(showConflict, stats.conflict);
+            const bool onViewOld = rowOld < viewRef_.size() && viewRef_[rowOld].objId == objId;
+            if (onViewOld)
+                ++rowOld;
+
+            const RowChange rowChange = rowChanges[objId.getSlotIndex()];
+            if (rowChange != RowChange::remove)
+                sortedRef_[sortedOut++] = objId; //remove references to deleted rows
+
+            if (onViewOld ? rowChange == RowChange::none : rowChange == RowChange::show)
+                viewRefNew.push_back({objId, 0});
         }
-        assert(false);
-        return true;
-    });
+        sortedRef_.resize(sortedOut);
+        assert(rowOld == viewRef_.size());
 
-    assert(moveLeft % 2 == 0 && moveRight % 2 == 0);
-    stats.updateLeft  += moveLeft  / 2; //count move operations as single update
-    stats.updateRight += moveRight / 2; //=> harmonize with SyncStatistics::processFile()
+        rowFirst = 0;
+        for (; rowFirst < viewRef_.size() && rowFirst < viewRefNew.size() && viewRef_[rowFirst].objId == viewRefNew[rowFirst].objId; ++rowFirst)
+            viewRefNew[rowFirst].groupIdx = viewRef_[rowFirst].groupIdx; //unchanged prefix
 
-    return stats;
+        viewRef_.swap(viewRefNew);
+    }
+
+    //3. update row positions and groups of moved rows
+    updateRowPositions(rowFirst);
 }
 
 
@@ -353,15 +641,21 @@ FileView::PathDrawInfo FileView::getDrawInfo(size_t row)
 }
 
 
+void FileView::resetView()
+{
+    viewRef_     .clear();
+    groupDetails_.clear();
+    clearRowPositions();
+    currentView_ = std::monostate();
+}
+
+
 void FileView::removeInvalidRows()
 {
     //remove rows that have been deleted meanwhile
     std::erase_if(sortedRef_, [&](const FileSystemObject::ObjectId& objId) { return !FileSystemObject::retrieve(objId); });
 
-    viewRef_               .clear();
-    groupDetails_          .clear();
-    rowPositions_          .clear();
-    rowPositionsFirstChild_.clear();
+    resetView();
 }
 
 
@@ -388,401 +682,146 @@ struct CompileTimeReminder : public FSObjectVisitor
 } checkDymanicCasts; //just a compile-time reminder to manually check dynamic casts in this file if ever needed
 
 
-inline
-bool isDirectoryPair(const FileSystemObject& fsObj)
-{
-    return dynamic_cast<const FolderPair*>(&fsObj) != nullptr;
-}
-
-
-template <bool ascending, SelectSide side> inline
-bool lessFileName(const FileSystemObject& lhs, const FileSystemObject& rhs)
+template <bool ascending, SelectSide side>
+void sortByFileName(std::vector<FileSystemObject::ObjectId>& rows)
 {
-    //sort order: first files/symlinks, then directories then empty rows
-
-    //empty rows always last
-    if (lhs.isEmpty<side>())
-        return false;
-    else if (rhs.isEmpty<side>())
-        return true;
-
-    //directories after files/symlinks:
-    if (isDirectoryPair(lhs))
+    sortByKey<false /*stable*/>(rows, [](const FileSystemObject& fsObj)
     {
-        if (!isDirectoryPair(rhs))
-            return false;
-    }
-    else if (isDirectoryPair(rhs))
-        return true;
+        //sort order: first files/symlinks, then directories then empty rows
+        if (fsObj.isEmpty<side>())
+            return std::pair(2, Zstring());
 
-    return zen::makeSortDirection(LessNaturalSort() /*even on Linux*/, std::bool_constant<ascending>())(lhs.getItemName<side>(), rhs.getItemName<side>());
+        return std::pair(isDirectoryPair(fsObj) ? 1 : 0, fsObj.getItemName<side>());
+    },
+    zen::makeSortDirection(LessNaturalSort() /*even on Linux*/, std::bool_constant<ascending>()));
 }
 
 
-template <bool ascending, SelectSide side>  inline
-bool lessFilePath(const FileSystemObject::ObjectId& lhs, const FileSystemObject::ObjectId& rhs,
-                  const std::unordered_map<const void* /*BaseFolderPair*/, size_t /*position*/>& sortedPos,
-                  std::vector<const FolderPair*>& tempBuf)
+//full path: calculate positions of base folders sorted by name
+template <SelectSide side>
+std::unordered_map<const void* /*BaseFolderPair*/, size_t> getBasePositionsByName(std::vector<std::tuple<const void* /*BaseFolderPair*/, AbstractPath, AbstractPath>> folderPairs)
 {
-    const FileSystemObject* fsObjL = FileSystemObject::retrieve(lhs);
-    const FileSystemObject* fsObjR = FileSystemObject::retrieve(rhs);
-    if (!fsObjL) //invalid rows shall appear at the end
-        return false;
-    else if (!fsObjR)
-        return true;
-
-    //------- presort by folder pair ----------
+    std::sort(folderPairs.begin(), folderPairs.end(), [](const auto& a, const auto& b)
     {
-        auto itL = sortedPos.find(&fsObjL->base());
-        auto itR = sortedPos.find(&fsObjR->base());
-        assert(itL != sortedPos.end() && itR != sortedPos.end());
-        if (itL == sortedPos.end()) //invalid rows shall appear at the end
-            return false;
-        else if (itR == sortedPos.end())
-            return true;
+        const auto& [baseObjA, basePathLA, basePathRA] = a;
+        const auto& [baseObjB, basePathLB, basePathRB] = b;
 
-        const size_t basePosL = itL->second;
-        const size_t basePosR = itR->second;
+        const AbstractPath& basePathA = selectParam<side>(basePathLA, basePathRA);
+        const AbstractPath& basePathB = selectParam<side>(basePathLB, basePathRB);
 
-        if (basePosL != basePosR)
-            return zen::makeSortDirection(std::less(), std::bool_constant<ascending>())(basePosL, basePosR);
-    }
-
-    //------- sort component-wise ----------
-    const auto folderL = dynamic_cast<const FolderPair*>(fsObjL);
-    const auto folderR = dynamic_cast<const FolderPair*>(fsObjR);
-
-    std::vector<const FolderPair*>& parentsBuf = tempBuf; //from bottom to top of hierarchy, excluding base
-    parentsBuf.clear();
-
-    const auto collectParents = [&](const FileSystemObject* fsObj)
-    {
-        for (;;)
-            if (const auto folder = dynamic_cast<const FolderPair*>(&fsObj->parent())) //perf: most expensive part of this function!
-            {
-                parentsBuf.push_back(folder);
-                fsObj = folder;
-            }
-            else
-                break;
-    };
-    if (folderL)
-        parentsBuf.push_back(folderL);
-    collectParents(fsObjL);
-    const size_t parentsSizeL = parentsBuf.size();
-
-    if (folderR)
-        parentsBuf.push_back(folderR);
-    collectParents(fsObjR);
-
-    const std::span<const FolderPair*> parentsL(parentsBuf.data(), parentsSizeL); //no construction via iterator (yet): https://github.com/cplusplus/draft/pull/3456
-    const std::span<const FolderPair*> parentsR(parentsBuf.data() + parentsSizeL, parentsBuf.size() - parentsSizeL);
-
-    const auto& [itL, itR] = std::mismatch(parentsL.rbegin(), parentsL.rend(),
-                                           parentsR.rbegin(), parentsR.rend());
-    if (itL == parentsL.rend())
-    {
-        if (itR == parentsR.rend())
-        {
-            //make folders always appear before contained files
-            if (folderR)
-                return false;
-            else if (folderL)
-                return true;
-
-            return zen::makeSortDirection(LessNaturalSort(), std::bool_constant<ascending>())(fsObjL->getItemName<side>(), fsObjR->getItemName<side>());
-        }
-        else
-            return true;
-    }
-    else if (itR == parentsR.rend())
-        return false;
-
-    //different components...
-    if (const std::weak_ordering cmp = compareNatural((*itL)->getItemName<side>(), (*itR)->getItemName<side>());
-        cmp != std::weak_ordering::equivalent)
-    {
-        if constexpr (ascending)
-            return std::is_lt(cmp);
-        else
-            return std::is_gt(cmp);
-    }
-    //return zen::makeSortDirection(std::less(), std::bool_constant<ascending>())(rv, 0);
-
-    /*...with equivalent names:
-        1. functional correctness => must not compare equal!  e.g. a/a/x and a/A/y
-        2. ensure stable sort order                                                            */
-    return *itL < *itR;
-}
-
-
-template <bool ascending, SelectSide side> inline
-bool lessFilesize(const FileSystemObject& lhs, const FileSystemObject& rhs)
-{
-    //empty rows always last
-    if (lhs.isEmpty<side>())
-        return false;
-    else if (rhs.isEmpty<side>())
-        return true;
-
-    //directories second last
-    if (isDirectoryPair(lhs))
-        return false;
-    else if (isDirectoryPair(rhs))
-        return true;
-
-    const FilePair* fileL = dynamic_cast<const FilePair*>(&lhs);
-    const FilePair* fileR = dynamic_cast<const FilePair*>(&rhs);
-
-    //then symlinks
-    if (!fileL)
-        return false;
-    else if (!fileR)
-        return true;
+        return LessNaturalSort()/*even on Linux*/(zen::utfTo<Zstring>(AFS::getDisplayPath(basePathA)),
+                                                  zen::utfTo<Zstring>(AFS::getDisplayPath(basePathB)));
+    });
 
-    //return list beginning with largest files first
-    return zen::makeSortDirection(std::less(), std::bool_constant<ascending>())(fileL->getFileSize<side>(), fileR->getFileSize<side>());
+    std::unordered_map<const void*, size_t> output;
+    size_t pos = 0;
+    for (const auto& [baseObj, basePathL, basePathR] : folderPairs)
+        output.emplace(baseObj, pos++);
+    return output;
 }
 
 
-template <bool ascending, SelectSide side> inline
-bool lessFiletime(const FileSystemObject& lhs, const FileSystemObject& rhs)
+//relative path: take over positions of base folders as set up by user
+std::unordered_map<const void* /*BaseFolderPair*/, size_t> getBasePositionsAsConfigured(const std::vector<std::tuple<const void* /*BaseFolderPair*/, AbstractPath, AbstractPath>>& folderPairs)
 {
-    if (lhs.isEmpty<side>())
-        return false; //empty rows always last
-    else if (rhs.isEmpty<side>())
-        return true; //empty rows always last
-
-    const FilePair* fileL = dynamic_cast<const FilePair*>(&lhs);
-    const FilePair* fileR = dynamic_cast<const FilePair*>(&rhs);
-
-    const SymlinkPair* symlinkL = dynamic_cast<const SymlinkPair*>(&lhs);
-    const SymlinkPair* symlinkR = dynamic_cast<const SymlinkPair*>(&rhs);
-
-    if (!fileL && !symlinkL)
-        return false; //directories last
-    else if (!fileR && !symlinkR)
-        return true; //directories last
-
-    const int64_t dateL = fileL ? fileL->getLastWriteTime<side>() : symlinkL->getLastWriteTime<side>();
-    const int64_t dateR = fileR ? fileR->getLastWriteTime<side>() : symlinkR->getLastWriteTime<side>();
-
-    //return list beginning with newest files first
-    return zen::makeSortDirection(std::less(), std::bool_constant<ascending>())(dateL, dateR);
+    std::unordered_map<const void*, size_t> output;
+    size_t pos = 0;
+    for (const auto& [baseObj, basePathL, basePathR] : folderPairs)
+        output.emplace(baseObj, pos++);
+    return output;
 }
 
 
-template <bool ascending, SelectSide side> inline
-bool lessExtension(const FileSystemObject& lhs, const FileSystemObject& rhs)
+template <bool ascending, SelectSide side>
+void sortByFileSize(std::vector<FileSystemObject::ObjectId>& rows)
 {
-    if (lhs.isEmpty<side>())
-        return false; //empty rows always last
-    else if (rhs.isEmpty<side>())
-        return true; //empty rows always last
-
-    if (dynamic_cast<const FolderPair*>(&lhs))
-        return false; //directories last
-    else if (dynamic_cast<const FolderPair*>(&rhs))
-        return true; //directories last
-
-    auto getExtension = [](const FileSystemObject& fsObj)
+    sortByKey<false /*stable*/>(rows, [](const FileSystemObject& fsObj)
     {
-        return afterLast(fsObj.getItemName<side>(), Zstr('.'), zen::IfNotFoundReturn::none);
-    };
+        //empty rows always last
+        if (fsObj.isEmpty<side>())
+            return std::pair(3, uint64_t(0));
 
-    return zen::makeSortDirection(LessNaturalSort() /*even on Linux*/, std::bool_constant<ascending>())(getExtension(lhs), getExtension(rhs));
-}
+        //directories second last
+        if (isDirectoryPair(fsObj))
+            return std::pair(2, uint64_t(0));
 
+        //then symlinks
+        if (const FilePair* file = dynamic_cast<const FilePair*>(&fsObj))
+            return std::pair(0, file->getFileSize<side>());
 
-template <bool ascending> inline
-bool lessCmpResult(const FileSystemObject& lhs, const FileSystemObject& rhs)
-{
-    return zen::makeSortDirection([](CompareFileResult lhs2, CompareFileResult rhs2)
-    {
-        //presort: equal shall appear at end of list
-        if (lhs2 == FILE_EQUAL)
-            return false;
-        if (rhs2 == FILE_EQUAL)
-            return true;
-        return lhs2 < rhs2;
+        return std::pair(1, uint64_t(0));
     },
-    std::bool_constant<ascending>())(lhs.getCategory(), rhs.getCategory());
+    zen::makeSortDirection(std::less(), std::bool_constant<ascending>())); //return list beginning with largest files first
 }
 
 
-template <bool ascending> inline
-bool lessSyncDirection(const FileSystemObject& lhs, const FileSystemObject& rhs)
-{
-    return zen::makeSortDirection(std::less(), std::bool_constant<ascending>())(lhs.getSyncOperation(), rhs.getSyncOperation());
-}
-
-
-template <bool ascending, SelectSide side>
-struct LessFullPath
-{
-    LessFullPath(std::vector<std::tuple<const void* /*BaseFolderPair*/, AbstractPath, AbstractPath>> folderPairs)
-    {
-        //calculate positions of base folders sorted by name
-        std::sort(folderPairs.begin(), folderPairs.end(), [](const auto& a, const auto& b)
-        {
-            const auto& [baseObjA, basePathLA, basePathRA] = a;
-            const auto& [baseObjB, basePathLB, basePathRB] = b;
-
-            const AbstractPath& basePathA = selectParam<side>(basePathLA, basePathRA);
-            const AbstractPath& basePathB = selectParam<side>(basePathLB, basePathRB);
-
-            return LessNaturalSort()/*even on Linux*/(zen::utfTo<Zstring>(AFS::getDisplayPath(basePathA)),
-                                                      zen::utfTo<Zstring>(AFS::getDisplayPath(basePathB)));
-        });
-
-        size_t pos = 0;
-        for (const auto& [baseObj, basePathL, basePathR] : folderPairs)
-            sortedPos_.ref().emplace(baseObj, pos++);
-    }
-
-    bool operator()(const FileSystemObject::ObjectId& lhs, const FileSystemObject::ObjectId& rhs) const
-    {
-        return lessFilePath<ascending, side>(lhs, rhs, sortedPos_.ref(), tempBuf_);
-    }
-
-private:
-    SharedRef<std::unordered_map<const void* /*BaseFolderPair*/, size_t /*position*/>> sortedPos_ = makeSharedRef<std::unordered_map<const void*, size_t>>();
-    mutable std::vector<const FolderPair*> tempBuf_; //avoid repeated memory allocation in lessFilePath()
-};
-
-
-template <bool ascending, SelectSide side>
-struct LessRelativeFolder
-{
-    LessRelativeFolder(const std::vector<std::tuple<const void* /*BaseFolderPair*/, AbstractPath, AbstractPath>>& folderPairs)
-    {
-        //take over positions of base folders as set up by user
-        size_t pos = 0;
-        for (const auto& [baseObj, basePathL, basePathR] : folderPairs)
-            sortedPos_.ref().emplace(baseObj, pos++);
-    }
-
-    bool operator()(const FileSystemObject::ObjectId& lhs, const FileSystemObject::ObjectId& rhs) const
-    {
-        return lessFilePath<ascending, side>(lhs, rhs, sortedPos_.ref(), tempBuf_);
-    }
-
-private:
-    SharedRef<std::unordered_map<const void* /*BaseFolderPair*/, size_t /*position*/>> sortedPos_ = makeSharedRef<std::unordered_map<const void*, size_t>>();
-    mutable std::vector<const FolderPair*> tempBuf_; //avoid repeated memory allocation in lessFilePath()
-};
-
-
 template <bool ascending, SelectSide side>
-struct LessFileName
+void sortByFileTime(std::vector<FileSystemObject::ObjectId>& rows)
 {
-    bool operator()(const FileSystemObject::ObjectId& lhs, const FileSystemObject::ObjectId& rhs) const
+    sortByKey<false /*stable*/>(rows, [](const FileSystemObject& fsObj)
     {
-        const FileSystemObject* fsObjA = FileSystemObject::retrieve(lhs);
-        const FileSystemObject* fsObjB = FileSystemObject::retrieve(rhs);
-        if (!fsObjA) //invalid rows shall appear at the end
-            return false;
-        else if (!fsObjB)
-            return true;
+        if (fsObj.isEmpty<side>())
+            return std::pair(2, time_t(0)); //empty rows always last
 
-        return lessFileName<ascending, side>(*fsObjA, *fsObjB);
-    }
-};
+        if (const FilePair* file = dynamic_cast<const FilePair*>(&fsObj))
+            return std::pair(0, file->getLastWriteTime<side>());
 
+        if (const SymlinkPair* symlink = dynamic_cast<const SymlinkPair*>(&fsObj))
+            return std::pair(0, symlink->getLastWriteTime<side>());
 
-template <bool ascending, SelectSide side>
-struct LessFilesize
-{
-    bool operator()(const FileSystemObject::ObjectId& lhs, const FileSystemObject::ObjectId& rhs) const
-    {
-        const FileSystemObject* fsObjA = FileSystemObject::retrieve(lhs);
-        const FileSystemObject* fsObjB = FileSystemObject::retrieve(rhs);
-        if (!fsObjA) //invalid rows shall appear at the end
-            return false;
-        else if (!fsObjB)
-            return true;
-
-        return lessFilesize<ascending, side>(*fsObjA, *fsObjB);
-    }
-};
+        return std::pair(1, time_t(0)); //directories last
+    },
+    zen::makeSortDirection(std::less(), std::bool_constant<ascending>())); //return list beginning with newest files first
+}
 
 
 template <bool ascending, SelectSide side>
-struct LessFiletime
+void sortByExtension(std::vector<FileSystemObject::ObjectId>& rows)
 {
-    bool operator()(const FileSystemObject::ObjectId& lhs, const FileSystemObject::ObjectId& rhs) const
+    sortByKey<true /*stable*/>(rows, [](const FileSystemObject& fsObj)
     {
-        const FileSystemObject* fsObjA = FileSystemObject::retrieve(lhs);
-        const FileSystemObject* fsObjB = FileSystemObject::retrieve(rhs);
-        if (!fsObjA) //invalid rows shall appear at the end
-            return false;
-        else if (!fsObjB)
-            return true;
-
-        return lessFiletime<ascending, side>(*fsObjA, *fsObjB);
-    }
-};
-
+        if (fsObj.isEmpty<side>())
+            return std::pair(2, Zstring()); //empty rows always last
 
-template <bool ascending, SelectSide side>
-struct LessExtension
-{
-    bool operator()(const FileSystemObject::ObjectId& lhs, const FileSystemObject::ObjectId& rhs) const
-    {
-        const FileSystemObject* fsObjA = FileSystemObject::retrieve(lhs);
-        const FileSystemObject* fsObjB = FileSystemObject::retrieve(rhs);
-        if (!fsObjA) //invalid rows shall appear at the end
-            return false;
-        else if (!fsObjB)
-            return true;
+        if (isDirectoryPair(fsObj))
+            return std::pair(1, Zstring()); //directories last
 
-        return lessExtension<ascending, side>(*fsObjA, *fsObjB);
-    }
-};
+        return std::pair(0, afterLast(fsObj.getItemName<side>(), Zstr('.'), zen::IfNotFoundReturn::none));
+    },
+    zen::makeSortDirection(LessNaturalSort() /*even on Linux*/, std::bool_constant<ascending>()));
+}
 
 
 template <bool ascending>
-struct LessCmpResult
+void sortByCmpResult(std::vector<FileSystemObject::ObjectId>& rows)
 {
-    bool operator()(const FileSystemObject::ObjectId& lhs, const FileSystemObject::ObjectId& rhs) const
+    sortByKey<true /*stable*/>(rows, [](const FileSystemObject& fsObj) { return std::pair(0, fsObj.getCategory()); },
+                                zen::makeSortDirection([](CompareFileResult lhs, CompareFileResult rhs)
     {
-        const FileSystemObject* fsObjA = FileSystemObject::retrieve(lhs);
-        const FileSystemObject* fsObjB = FileSystemObject::retrieve(rhs);
-        if (!fsObjA) //invalid rows shall appear at the end
+        //presort: equal shall appear at end of list
+        if (lhs == FILE_EQUAL)
             return false;
-        else if (!fsObjB)
+        if (rhs == FILE_EQUAL)
             return true;
-
-        return lessCmpResult<ascending>(*fsObjA, *fsObjB);
-    }
-};
+        return lhs < rhs;
+    },
+    std::bool_constant<ascending>()));
+}
 
 
 template <bool ascending>
-struct LessSyncDirection
+void sortBySyncDirection(std::vector<FileSystemObject::ObjectId>& rows)
 {
-    bool operator()(const FileSystemObject::ObjectId& lhs, const FileSystemObject::ObjectId& rhs) const
-    {
-        const FileSystemObject* fsObjA = FileSystemObject::retrieve(lhs);
-        const FileSystemObject* fsObjB = FileSystemObject::retrieve(rhs);
-        if (!fsObjA) //invalid rows shall appear at the end
-            return false;
-        else if (!fsObjB)
-            return true;
-
-        return lessSyncDirection<ascending>(*fsObjA, *fsObjB);
-    }
-};
+    sortByKey<true /*stable*/>(rows, [](const FileSystemObject& fsObj) { return std::pair(0, fsObj.getSyncOperation()); },
+                                zen::makeSortDirection(std::less(), std::bool_constant<ascending>()));
+}
 }
 
 //-------------------------------------------------------------------------------------------------------
 
 void FileView::sortView(ColumnTypeRim type, ItemPathFormat pathFmt, bool onLeft, bool ascending)
 {
-    viewRef_               .clear();
-    groupDetails_          .clear();
-    rowPositions_          .clear();
-    rowPositionsFirstChild_.clear();
+    resetView();
     currentSort_ = SortInfo({type, onLeft, ascending});
 
     switch (type)
@@ -791,45 +830,45 @@ void FileView::sortView(ColumnTypeRim type, ItemPathFormat pathFmt, bool onLeft,
             switch (pathFmt)
             {
                 case ItemPathFormat::name:
-                    if      ( ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFileName<true,  SelectSide::left >());
-                    else if ( ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFileName<true,  SelectSide::right>());
-                    else if (!ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFileName<false, SelectSide::left >());
-                    else if (!ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFileName<false, SelectSide::right>());
+                    if      ( ascending &&  onLeft) sortByFileName<true,  SelectSide::left >(sortedRef_);
+                    else if ( ascending && !onLeft) sortByFileName<true,  SelectSide::right>(sortedRef_);
+                    else if (!ascending &&  onLeft) sortByFileName<false, SelectSide::left >(sortedRef_);
+                    else if (!ascending && !onLeft) sortByFileName<false, SelectSide::right>(sortedRef_);
                     break;
 
                 case ItemPathFormat::relative:
-                    if      ( ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessRelativeFolder<true,  SelectSide::left >(folderPairs_));
-                    else if ( ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessRelativeFolder<true,  SelectSide::right>(folderPairs_));
-                    else if (!ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessRelativeFolder<false, SelectSide::left >(folderPairs_));
-                    else if (!ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessRelativeFolder<false, SelectSide::right>(folderPairs_));
+                    if      ( ascending &&  onLeft) sortByFilePath<true,  SelectSide::left >(sortedRef_, getBasePositionsAsConfigured(folderPairs_));
+                    else if ( ascending && !onLeft) sortByFilePath<true,  SelectSide::right>(sortedRef_, getBasePositionsAsConfigured(folderPairs_));
+                    else if (!ascending &&  onLeft) sortByFilePath<false, SelectSide::left >(sortedRef_, getBasePositionsAsConfigured(folderPairs_));
+                    else if (!ascending && !onLeft) sortByFilePath<false, SelectSide::right>(sortedRef_, getBasePositionsAsConfigured(folderPairs_));
                     break;
 
                 case ItemPathFormat::full:
-                    if      ( ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFullPath<true,  SelectSide::left >(folderPairs_));
-                    else if ( ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFullPath<true,  SelectSide::right>(folderPairs_));
-                    else if (!ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFullPath<false, SelectSide::left >(folderPairs_));
-                    else if (!ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFullPath<false, SelectSide::right>(folderPairs_));
+                    if      ( ascending &&  onLeft) sortByFilePath<true,  SelectSide::left >(sortedRef_, getBasePositionsByName<SelectSide::left >(folderPairs_));
+                    else if ( ascending && !onLeft) sortByFilePath<true,  SelectSide::right>(sortedRef_, getBasePositionsByName<SelectSide::right>(folderPairs_));
+                    else if (!ascending &&  onLeft) sortByFilePath<false, SelectSide::left >(sortedRef_, getBasePositionsByName<SelectSide::left >(folderPairs_));
+                    else if (!ascending && !onLeft) sortByFilePath<false, SelectSide::right>(sortedRef_, getBasePositionsByName<SelectSide::right>(folderPairs_));
                     break;
             }
             break;
 
         case ColumnTypeRim::size:
-            if      ( ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFilesize<true,  SelectSide::left >());
-            else if ( ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFilesize<true,  SelectSide::right>());
-            else if (!ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFilesize<false, SelectSide::left >());
-            else if (!ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFilesize<false, SelectSide::right>());
+            if      ( ascending &&  onLeft) sortByFileSize<true,  SelectSide::left >(sortedRef_);
+            else if ( ascending && !onLeft) sortByFileSize<true,  SelectSide::right>(sortedRef_);
+            else if (!ascending &&  onLeft) sortByFileSize<false, SelectSide::left >(sortedRef_);
+            else if (!ascending && !onLeft) sortByFileSize<false, SelectSide::right>(sortedRef_);
             break;
         case ColumnTypeRim::date:
-            if      ( ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFiletime<true,  SelectSide::left >());
-            else if ( ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFiletime<true,  SelectSide::right>());
-            else if (!ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFiletime<false, SelectSide::left >());
-            else if (!ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFiletime<false, SelectSide::right>());
+            if      ( ascending &&  onLeft) sortByFileTime<true,  SelectSide::left >(sortedRef_);
+            else if ( ascending && !onLeft) sortByFileTime<true,  SelectSide::right>(sortedRef_);
+            else if (!ascending &&  onLeft) sortByFileTime<false, SelectSide::left >(sortedRef_);
+            else if (!ascending && !onLeft) sortByFileTime<false, SelectSide::right>(sortedRef_);
             break;
         case ColumnTypeRim::extension:
-            if      ( ascending &&  onLeft) std::stable_sort(sortedRef_.begin(), sortedRef_.end(), LessExtension<true,  SelectSide::left >());
-            else if ( ascending && !onLeft) std::stable_sort(sortedRef_.begin(), sortedRef_.end(), LessExtension<true,  SelectSide::right>());
-            else if (!ascending &&  onLeft) std::stable_sort(sortedRef_.begin(), sortedRef_.end(), LessExtension<false, SelectSide::left >());
-            else if (!ascending && !onLeft) std::stable_sort(sortedRef_.begin(), sortedRef_.end(), LessExtension<false, SelectSide::right>());
+            if      ( ascending &&  onLeft) sortByExtension<true,  SelectSide::left >(sortedRef_);
+            else if ( ascending && !onLeft) sortByExtension<true,  SelectSide::right>(sortedRef_);
+            else if (!ascending &&  onLeft) sortByExtension<false, SelectSide::left >(sortedRef_);
+            else if (!ascending && !onLeft) sortByExtension<false, SelectSide::right>(sortedRef_);
             break;
     }
 }
@@ -837,10 +876,7 @@ void FileView::sortView(ColumnTypeRim type, ItemPathFormat pathFmt, bool onLeft,
 
 void FileView::sortView(ColumnTypeCenter type, bool ascending)
 {
-    viewRef_               .clear();
-    groupDetails_          .clear();
-    rowPositions_          .clear();
-    rowPositionsFirstChild_.clear();
+    resetView();
     currentSort_ = SortInfo({type, false, ascending});
 
     switch (type)
@@ -849,12 +885,12 @@ void FileView::sortView(ColumnTypeCenter type, bool ascending)
             assert(false);
             break;
         case ColumnTypeCenter::difference:
-            if      ( ascending) std::stable_sort(sortedRef_.begin(), sortedRef_.end(), LessCmpResult<true >());
-            else if (!ascending) std::stable_sort(sortedRef_.begin(), sortedRef_.end(), LessCmpResult<false>());
+            if      ( ascending) sortByCmpResult<true >(sortedRef_);
+            else if (!ascending) sortByCmpResult<false>(sortedRef_);
             break;
         case ColumnTypeCenter::action:
-            if      ( ascending) std::stable_sort(sortedRef_.begin(), sortedRef_.end(), LessSyncDirection<true >());
-            else if (!ascending) std::stable_sort(sortedRef_.begin(), sortedRef_.end(), LessSyncDirection<false>());
+            if      ( ascending) sortBySyncDirection<true >(sortedRef_);
+            else if (!ascending) sortBySyncDirection<false>(sortedRef_);
             break;
     }
 }
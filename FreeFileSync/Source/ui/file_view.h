@@ -104,7 +104,11 @@ public:
                                       bool showEqual,
                                       bool showConflict);
 
-    void removeInvalidRows(); //remove references to rows that have been deleted meanwhile: call after manual deletion and synchronization!
+    //patch view and statistics for items modified since last takeChanges() (e.g. manual operations, synchronization)
+    //=> avoid full update by applyDifferenceFilter()/applyActionFilter(); call *before* these!
+    void applyChanges(const HierarchyChanges& changes);
+
+    void removeInvalidRows(); //remove references to rows that have been deleted meanwhile; requires full view update: prefer applyChanges()
 
     //sorting...
     void sortView(ColumnTypeRim type, ItemPathFormat pathFmt, bool onLeft, bool ascending); //always call these; never sort externally!
@@ -119,8 +123,9 @@ public:
     const SortInfo* getSortConfig() const { return zen::get(currentSort_); } //return nullptr if currently not sorted
 
     ptrdiff_t findRowDirect(FileSystemObject::ObjectIdConst objId) const; //find an object's row position on view list directly, return < 0 if not found
-    ptrdiff_t findRowFirstChild(const ContainerObject* conObj)    const; //find first child of FolderPair or BaseFolderPair *on sorted sub view*
-    //"conObj" may be invalid, it is NOT dereferenced, return < 0 if not found
+    ptrdiff_t findRowFirstChild(FileSystemObject::ObjectIdConst folderId) const; //find first child of FolderPair or BaseFolderPair *on sorted sub view*
+    ptrdiff_t findRowFirstChild(const BaseFolderPair* baseObj)            const; //
+    //"baseObj" may be invalid, it is NOT dereferenced, return < 0 if not found
 
     //count non-empty pairs to distinguish single/multiple folder pair cases
     size_t getEffectiveFolderPairCount() const;
@@ -129,12 +134,78 @@ private:
     FileView           (const FileView&) = delete;
     FileView& operator=(const FileView&) = delete;
 
+    struct DifferenceFilter
+    {
+        bool showExcluded   = false;
+        bool showLeftOnly   = false;
+        bool showRightOnly  = false;
+        bool showLeftNewer  = false;
+        bool showRightNewer = false;
+        bool showDifferent  = false;
+        bool showEqual      = false;
+        bool showConflict   = false;
+        bool operator==(const DifferenceFilter&) const = default;
+    };
+
+    struct ActionFilter
+    {
+        bool showExcluded    = false;
+        bool showCreateLeft  = false;
+        bool showCreateRight = false;
+        bool showDeleteLeft  = false;
+        bool showDeleteRight = false;
+        bool showUpdateLeft  = false;
+        bool showUpdateRight = false;
+        bool showDoNothing   = false;
+        bool showEqual       = false;
+        bool showConflict    = false;
+        bool operator==(const ActionFilter&) const = default;
+    };
+
+    struct DifferenceView
+    {
+        DifferenceFilter filter;
+        DifferenceViewStats stats;
+    };
+
+    struct ActionView
+    {
+        ActionFilter filter;
+        ActionViewStats stats; //move operations not yet included:
+        int moveLeft  = 0;     //
+        int moveRight = 0;     //
+    };
+
+    //return "show row" + add item to statistics (sign = -1: remove); FsItem: FileSystemObject or FsObjectState
+    template <class FsItem> static bool categorize(const FsItem& item, DifferenceView& view, int sign);
+    template <class FsItem> static bool categorize(const FsItem& item, ActionView& view, int sign);
+
     template <class Predicate> void updateView(Predicate pred);
 
+    void resetView(); //=> full update on next applyDifferenceFilter()/applyActionFilter()
+
+    size_t addRowToGroup(size_t row, const FileSystemObject& fsObj, const ContainerObject*& groupStartObj); //return group index
+    void updateRowPositions(size_t rowFirst); //for rows [rowFirst, end) after applyChanges()
 
-    std::unordered_map<FileSystemObject::ObjectIdConst, size_t> rowPositions_; //find row positions on viewRef_ directly
-    std::unordered_map<const void* /*ContainerObject*/, size_t> rowPositionsFirstChild_; //find first child on sortedRef of a hierarchy object
-    //void* instead of ContainerObject*: these are weak pointers and should *never be dereferenced*!
+    void clearRowPositions();
+    void updateRowPositionsFirstChild() const; //lazy evaluation: only needed for tree view navigation
+
+    /*  10M+ rows: flat tables indexed by ObjectId slot index instead of hash maps
+        - no per-row allocations and no hashing in updateView()
+        - entries of previous views are invalidated by bumping rowPosViewStamp_ => no need to clear the tables */
+    struct RowPosition
+    {
+        uint32_t viewStamp = 0;
+        uint32_t row = 0;
+    };
+    std::vector<RowPosition> rowPositions_; //find row positions on viewRef_ directly
+    uint32_t rowPosViewStamp_ = 1;
+
+    mutable std::vector<RowPosition> rowPositionsFirstChild_; //find first child on sortedRef of a FolderPair
+    mutable std::vector<std::pair<const void* /*BaseFolderPair*/, size_t>> rowPositionsFirstChildBase_; //few items: linear search
+    //void* instead of BaseFolderPair*: these are weak pointers and should *never be dereferenced*!
+    mutable uint32_t rowPosFirstChildStamp_ = 0;
+    mutable bool rowPositionsFirstChildValid_ = false;
 
     struct GroupDetail
     {
@@ -160,6 +231,8 @@ private:
     std::vector<std::tuple<const void* /*BaseFolderPair*/, AbstractPath, AbstractPath>> folderPairs_;
 
     std::optional<SortInfo> currentSort_;
+
+    std::variant<std::monostate, DifferenceView, ActionView> currentView_; //filter + statistics of viewRef_; std::monostate: full update needed
 };
 }
 
@@ -0,0 +1,309 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef FILE_VIEW_SORT_H_3851720946183750295
+#define FILE_VIEW_SORT_H_3851720946183750295
+
+#include <span>
+#include <vector>
+#include <numeric>
+#include <unordered_map>
+#include <zen/thread.h>
+#include <zen/type_traits.h>
+#include "../base/file_hierarchy.h"
+
+//row sorting of FileView: no wxWidgets dependency => see bench/file_view_bench.cpp
+namespace fff
+{
+inline
+bool isDirectoryPair(const FileSystemObject& fsObj)
+{
+    return dynamic_cast<const FolderPair*>(&fsObj) != nullptr;
+}
+
+
+/*  10M+ rows: sort keys are extracted once per row into a compact array
+        => comparisons need neither FileSystemObject::retrieve() nor dynamic_cast
+        => chunks are sorted (and keys extracted) in parallel, then merged pairwise                      */
+const size_t PARALLEL_SORT_ROWS_MIN = 50'000; //per thread: don't bother for small views
+
+inline
+size_t getSortThreadCount(size_t rowCount)
+{
+    return std::clamp<size_t>(rowCount / PARALLEL_SORT_ROWS_MIN, 1, std::max(std::thread::hardware_concurrency(), 1U));
+}
+
+
+template <class Function> inline
+void runChunksParallel(size_t itemCount, size_t threadCount, Function fun /*(size_t first, size_t last)*/)
+{
+    if (threadCount == 1)
+        return fun(0, itemCount);
+
+    zen::ThreadGroup<std::function<void()>> tg(threadCount, Zstr("Sort rows"));
+    for (size_t i = 0; i < threadCount; ++i)
+        tg.run([&fun, first = itemCount * i / threadCount, last = itemCount * (i + 1) / threadCount] { fun(first, last); });
+    tg.wait();
+}
+
+
+template <bool stable, class T, class Less>
+void parallelSort(std::vector<T>& items, const Less& less)
+{
+    const size_t threadCount = getSortThreadCount(items.size());
+
+    auto getChunkBegin = [&](size_t i) { return items.begin() + items.size() * std::min(i, threadCount) / threadCount; };
+
+    runChunksParallel(items.size(), threadCount, [&](size_t first, size_t last)
+    {
+        const Less lessThread = less; //comparators may hold (mutable) buffers
+        if constexpr (stable)
+            std::stable_sort(items.begin() + first, items.begin() + last, lessThread);
+        else
+            std::sort(items.begin() + first, items.begin() + last, lessThread);
+    });
+
+    //merge sorted chunks: std::inplace_merge() is stable
+    for (size_t width = 1; width < threadCount; width *= 2)
+    {
+        zen::ThreadGroup<std::function<void()>> tg(threadCount, Zstr("Merge rows"));
+        for (size_t i = 0; i + width < threadCount; i += 2 * width)
+            tg.run([&, i, width] { std::inplace_merge(getChunkBegin(i), getChunkBegin(i + width), getChunkBegin(i + 2 * width), less); });
+        tg.wait();
+    }
+}
+
+
+const int RANK_INVALID = std::numeric_limits<int>::max(); //invalid rows shall appear at the end
+
+template <class Value>
+struct SortItem
+{
+    int rank = 0; //groups independent from sort direction, e.g. "empty rows always last"
+    Value value{};
+    FileSystemObject::ObjectId objId;
+};
+
+
+template <bool stable, class GetKey /*(const FileSystemObject&) -> std::pair<int rank, Value>*/, class LessValue>
+void sortByKey(std::vector<FileSystemObject::ObjectId>& rows, GetKey getKey, LessValue lessValue)
+{
+    using Value = decltype(getKey(std::declval<const FileSystemObject&>()).second);
+
+    std::vector<SortItem<Value>> items(rows.size());
+
+    runChunksParallel(rows.size(), getSortThreadCount(rows.size()), [&](size_t first, size_t last)
+    {
+        for (size_t i = first; i < last; ++i)
+        {
+            SortItem<Value>& item = items[i];
+            item.objId = rows[i];
+
+            if (const FileSystemObject* fsObj = FileSystemObject::retrieve(rows[i]))
+                std::tie(item.rank, item.value) = getKey(*fsObj);
+            else
+                item.rank = RANK_INVALID;
+        }
+    });
+
+    parallelSort<stable>(items, [lessValue](const SortItem<Value>& lhs, const SortItem<Value>& rhs)
+    {
+        if (lhs.rank != rhs.rank)
+            return lhs.rank < rhs.rank;
+        return lessValue(lhs.value, rhs.value);
+    });
+
+    for (size_t i = 0; i < items.size(); ++i)
+        rows[i] = items[i].objId;
+}
+
+//------------------------------------------------------------------------------------------------------
+
+/*  full path: sort component-wise, but without walking the parent chain (and dynamic_cast) per comparison
+        folder rank: position in a depth-first traversal visiting sibling folders sorted by name
+        => folder ranks compare like the folders' paths, parent folders first
+        => sort key: (base folder position, rank of folder or parent folder, folder before contained items, item name)   */
+template <bool ascending, SelectSide side>
+class FolderPathRanks
+{
+public:
+    static constexpr uint32_t RANK_BASE = 0; //items directly below base folder
+
+    explicit FolderPathRanks(std::span<const FileSystemObject::ObjectId> rows)
+    {
+        const uint32_t NO_PARENT = std::numeric_limits<uint32_t>::max(); //directly below base folder
+
+        std::vector<const FolderPair*> folders;
+        std::vector<uint32_t> parentIdx; //index into "folders" or NO_PARENT
+        std::unordered_map<const FolderPair*, uint32_t> folderIdx;
+        std::vector<const FolderPair*> newFolders;
+
+        //register folder + parents not seen yet: one dynamic_cast per folder (amortized)
+        auto getFolderIdx = [&](const FolderPair& folder)
+        {
+            uint32_t parent = NO_PARENT;
+            newFolders.clear();
+            for (const FolderPair* f = &folder; f; f = dynamic_cast<const FolderPair*>(&f->parent()))
+                if (auto it = folderIdx.find(f);
+                    it != folderIdx.end())
+                {
+                    parent = it->second;
+                    break;
+                }
+                else
+                    newFolders.push_back(f);
+
+            std::for_each(newFolders.rbegin(), newFolders.rend(), [&](const FolderPair* f)
+            {
+                folderIdx.emplace(f, static_cast<uint32_t>(folders.size()));
+                folders  .push_back(f);
+                parentIdx.push_back(parent);
+                parent = static_cast<uint32_t>(folders.size() - 1);
+            });
+            return parent;
+        };
+
+        //1. folder (or parent folder) per row: rankBySlot_ temporarily holds "folder index + 1"
+        uint32_t slotCount = 0;
+        for (const FileSystemObject::ObjectId& objId : rows)
+            slotCount = std::max(slotCount, objId.getSlotIndex() + 1);
+        rankBySlot_.resize(slotCount, RANK_BASE);
+
+        const FolderPair* folderLast = nullptr; //rows are mostly grouped by parent folder
+        uint32_t folderIdxLast = 0;
+        for (const FileSystemObject::ObjectId& objId : rows)
+            if (const FileSystemObject* fsObj = FileSystemObject::retrieve(objId))
+            {
+                const FolderPair* folder = dynamic_cast<const FolderPair*>(fsObj);
+                if (!folder)
+                    folder = dynamic_cast<const FolderPair*>(&fsObj->parent());
+                if (folder)
+                {
+                    if (folder != folderLast)
+                    {
+                        folderLast = folder;
+                        folderIdxLast = getFolderIdx(*folder);
+                    }
+                    rankBySlot_[objId.getSlotIndex()] = folderIdxLast + 1;
+                }
+            }
+
+        //2. group sibling folders, sorted by name
+        std::vector<uint32_t> order(folders.size());
+        std::iota(order.begin(), order.end(), 0);
+
+        std::sort(order.begin(), order.end(), [&](uint32_t lhs, uint32_t rhs)
+        {
+            if (parentIdx[lhs] != parentIdx[rhs])
+                return parentIdx[lhs] < parentIdx[rhs]; //any order
+
+            if (const std::weak_ordering cmp = compareNatural(folders[lhs]->getItemName<side>(), folders[rhs]->getItemName<side>());
+                cmp != std::weak_ordering::equivalent)
+            {
+                if constexpr (ascending)
+                    return std::is_lt(cmp);
+                else
+                    return std::is_gt(cmp);
+            }
+            /*...with equivalent names:
+                1. functional correctness => must not compare equal!  e.g. a/a/x and a/A/y
+                2. ensure stable sort order                                                            */
+            return folders[lhs] < folders[rhs];
+        });
+
+        std::vector<std::pair<uint32_t, uint32_t>> children(folders.size() + 1); //range in "order"; last: base folder level
+        for (uint32_t i = 0; i < order.size(); ++i)
+        {
+            auto& [first, last] = children[parentIdx[order[i]] == NO_PARENT ? folders.size() : parentIdx[order[i]]];
+            if (first == last)
+                first = i;
+            last = i + 1;
+        }
+
+        //3. depth-first traversal
+        std::vector<uint32_t> folderRanks(folders.size());
+        uint32_t rank = RANK_BASE;
+
+        std::vector<std::pair<uint32_t, uint32_t>> stack{children.back()};
+        while (!stack.empty())
+            if (auto& [first, last] = stack.back();
+                first == last)
+                stack.pop_back();
+            else
+            {
+                const uint32_t idx = order[first++];
+                folderRanks[idx] = ++rank;
+                stack.push_back(children[idx]);
+            }
+
+        for (uint32_t& r : rankBySlot_)
+            if (r != RANK_BASE)
+                r = folderRanks[r - 1];
+    }
+
+    //rank of folder itself, or of parent folder
+    uint32_t getRank(const FileSystemObject& fsObj) const
+    {
+        const uint32_t slotIdx = fsObj.getId().getSlotIndex();
+        assert(slotIdx < rankBySlot_.size());
+        return slotIdx < rankBySlot_.size() ? rankBySlot_[slotIdx] : RANK_BASE;
+    }
+
+private:
+    std::vector<uint32_t> rankBySlot_; //dense: indexed by ObjectId::getSlotIndex()
+};
+
+
+struct PathSortValue
+{
+    size_t basePos = 0; //position of folder pair
+    uint32_t folderRank = 0; //see FolderPathRanks
+    bool isFolder = false;
+    Zstring itemName;
+};
+
+
+template <bool ascending, SelectSide side>
+struct LessFilePath
+{
+    bool operator()(const PathSortValue& lhs, const PathSortValue& rhs) const
+    {
+        //------- presort by folder pair ----------
+        if (lhs.basePos != rhs.basePos)
+            return zen::makeSortDirection(std::less(), std::bool_constant<ascending>())(lhs.basePos, rhs.basePos);
+
+        //sort direction already considered by FolderPathRanks: parent folders first, then contained files before sub folders
+        if (lhs.folderRank != rhs.folderRank)
+            return lhs.folderRank < rhs.folderRank;
+
+        //make folders always appear before contained files
+        if (lhs.isFolder != rhs.isFolder)
+            return lhs.isFolder;
+
+        return zen::makeSortDirection(LessNaturalSort(), std::bool_constant<ascending>())(lhs.itemName, rhs.itemName);
+    }
+};
+
+
+template <bool ascending, SelectSide side>
+void sortByFilePath(std::vector<FileSystemObject::ObjectId>& rows, const std::unordered_map<const void* /*BaseFolderPair*/, size_t /*position*/>& basePositions)
+{
+    const FolderPathRanks<ascending, side> folderRanks(rows);
+
+    sortByKey<false /*stable*/>(rows, [&](const FileSystemObject& fsObj)
+    {
+        auto it = basePositions.find(&fsObj.base());
+        assert(it != basePositions.end());
+        if (it == basePositions.end()) //invalid rows shall appear at the end
+            return std::pair(RANK_INVALID, PathSortValue());
+
+        return std::pair(0, PathSortValue{it->second, folderRanks.getRank(fsObj), isDirectoryPair(fsObj), fsObj.getItemName<side>()});
+    },
+    LessFilePath<ascending, side>());
+}
+}
+
+#endif //FILE_VIEW_SORT_H_3851720946183750295
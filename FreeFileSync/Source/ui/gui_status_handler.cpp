@@ -143,7 +143,7 @@ StatusHandlerTemporaryPanel::Result StatusHandlerTemporaryPanel::prepareResult()
         !extraLog.empty())
     {
         append(errorLog_, extraLog);
-        std::stable_sort(errorLog_.begin(), errorLog_.end(), [](const LogEntry& lhs, const LogEntry& rhs) { return lhs.time < rhs.time; });
+        errorLog_.sortByTime();
     }
 
     //determine post-sync status irrespective of further errors during tear-down
@@ -415,7 +415,7 @@ StatusHandlerFloatingDialog::Result StatusHandlerFloatingDialog::prepareResult()
         !extraLog.empty())
     {
         append(errorLog_.ref(), extraLog);
-        std::stable_sort(errorLog_.ref().begin(), errorLog_.ref().end(), [](const LogEntry& lhs, const LogEntry& rhs) { return lhs.time < rhs.time; });
+        errorLog_.ref().sortByTime();
     }
 
     //determine post-sync status irrespective of further errors during tear-down
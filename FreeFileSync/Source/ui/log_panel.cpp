@@ -50,12 +50,15 @@ enum class ColumnTypeLog
 
 
 //a vector-view on ErrorLog considering multi-line messages: prepare consumption by Grid
+/*  think multi-million entries after a large sync:
+    - message lines are split only once: lines_ is built on first updateView() (and extended if the log grows)
+    - row indexes per message type filter are cached => toggling filters is O(1) after first use   */
 class fff::MessageView
 {
 public:
     MessageView(const SharedRef<const ErrorLog>& log) : log_(log) {}
 
-    size_t rowsOnView() const { return viewRef_.size(); }
+    size_t rowsOnView() const { return viewTypes_ == MSG_TYPES_ALL ? lines_.size() : rowsByTypes_[viewTypes_]->size(); }
 
     struct LogEntryView
     {
@@ -67,15 +70,16 @@ public:
 
     std::optional<LogEntryView> getEntry(size_t row) const
     {
-        if (row < viewRef_.size())
+        if (row < rowsOnView())
         {
-            const Line& line = viewRef_[row];
+            const Line& line = lines_[viewTypes_ == MSG_TYPES_ALL ? row : (*rowsByTypes_[viewTypes_])[row]];
+            const LogEntry entry = log_.ref()[line.logPos];
 
             LogEntryView output;
-            output.time = line.logIt->time;
-            output.type = line.logIt->type;
-            output.messageLine = extractLine(line.logIt->message, line.row);
-            output.firstLine = line.row == 0; //this is virtually always correct, unless first line of the original message is empty!
+            output.time = entry.time;
+            output.type = entry.type;
+            output.messageLine = entry.message.substr(line.offset, line.length);
+            output.firstLine = line.offset == 0; //messages never start with a newline
             return output;
         }
         return {};
@@ -83,59 +87,67 @@ public:
 
     void updateView(int includedTypes) //MSG_TYPE_INFO | MSG_TYPE_WARNING, etc. see error_log.h
     {
-        viewRef_.clear();
+        indexNewEntries();
 
-        for (auto it = log_.ref().begin(); it != log_.ref().end(); ++it)
-            if (it->type & includedTypes)
+        includedTypes &= MSG_TYPES_ALL;
+        if (includedTypes != MSG_TYPES_ALL) //all types: no need for an index
+        {
+            std::optional<std::vector<uint32_t>>& rows = rowsByTypes_[includedTypes];
+            if (!rows)
             {
-                assert(!startsWith(it->message, '\n'));
-
-                size_t rowNumber = 0;
-                bool lastCharNewline = true;
-                for (const char c : it->message)
-                    if (c == '\n')
-                    {
-                        if (!lastCharNewline) //do not reference empty lines!
-                            viewRef_.push_back({it, rowNumber});
-                        ++rowNumber;
-                        lastCharNewline = true;
-                    }
-                    else
-                        lastCharNewline = false;
-
-                if (!lastCharNewline)
-                    viewRef_.push_back({it, rowNumber});
+                rows.emplace();
+                for (size_t i = 0; i < lines_.size(); ++i)
+                    if (lines_[i].type & includedTypes)
+                        rows->push_back(static_cast<uint32_t>(i));
             }
+        }
+        viewTypes_ = includedTypes;
     }
 
 private:
-    static std::string_view extractLine(const Zstringc& message, size_t textRow)
+    static constexpr int MSG_TYPES_ALL = MSG_TYPE_INFO | MSG_TYPE_WARNING | MSG_TYPE_ERROR;
+
+    void indexNewEntries()
     {
-        auto it1 = message.begin();
-        for (;;)
-        {
-            auto it2 = std::find_if(it1, message.end(), [](char c) { return c == '\n'; });
-            if (textRow == 0)
-                return makeStringView(it1, it2 - it1);
+        const ErrorLog& log = log_.ref();
+        const size_t linesOld = lines_.size();
 
-            if (it2 == message.end())
-            {
-                assert(false);
-                return makeStringView(it1, 0);
-            }
+        for (; entriesIndexed_ < log.size(); ++entriesIndexed_)
+        {
+            const LogEntry entry = log[entriesIndexed_];
+            assert(!startsWith(entry.message, '\n'));
 
-            it1 = it2 + 1; //skip newline
-            --textRow;
+            size_t lineBegin = 0;
+            for (size_t i = 0; i <= entry.message.size(); ++i)
+                if (i == entry.message.size() || entry.message[i] == '\n')
+                {
+                    if (i > lineBegin) //do not reference empty lines!
+                        lines_.push_back({entriesIndexed_, static_cast<uint32_t>(lineBegin), static_cast<uint32_t>(i - lineBegin), static_cast<uint8_t>(entry.type)});
+                    lineBegin = i + 1;
+                }
         }
+
+        //keep cached filter indexes in sync
+        for (int includedTypes = 0; includedTypes < std::ssize(rowsByTypes_); ++includedTypes)
+            if (std::optional<std::vector<uint32_t>>& rows = rowsByTypes_[includedTypes])
+                for (size_t i = linesOld; i < lines_.size(); ++i)
+                    if (lines_[i].type & includedTypes)
+                        rows->push_back(static_cast<uint32_t>(i));
     }
 
     struct Line
     {
-        ErrorLog::const_iterator logIt; //always bound!
-        size_t row; //LogEntry::message may span multiple rows
+        size_t   logPos; //index into log_
+        uint32_t offset; //LogEntry::message may span multiple rows
+        uint32_t length; //
+        uint8_t  type;   //MessageType: avoid log_ access when filtering
     };
 
-    std::vector<Line> viewRef_; //partial view on log_
+    std::vector<Line> lines_; //all (non-empty) message lines in log order
+    size_t entriesIndexed_ = 0;
+
+    std::array<std::optional<std::vector<uint32_t>>, 8> rowsByTypes_; //index into lines_ by includedTypes (lazy)
+    int viewTypes_ = MSG_TYPES_ALL;
     /*          /|\
                  | updateView()
                  |                      */
@@ -257,13 +269,13 @@ public:
             switch (static_cast<ColumnTypeLog>(colType))
             {
                 case ColumnTypeLog::time:
-                    return 2 * getColumnGapLeft() + dc.GetTextExtent(getValue(row, colType)).GetWidth();
+                    return 2 * getColumnGapLeft() + getTextExtentBuffered(dc, getValue(row, colType)).GetWidth();
 
                 case ColumnTypeLog::severity:
                     return getDefaultMenuIconSize();
 
                 case ColumnTypeLog::text:
-                    return getColumnGapLeft() + dc.GetTextExtent(getValue(row, colType)).GetWidth();
+                    return getColumnGapLeft() + getTextExtentBuffered(dc, getValue(row, colType)).GetWidth();
             }
         return 0;
     }
@@ -272,7 +284,7 @@ public:
     {
         wxClientDC dc(&grid.getMainWin());
         dc.SetFont(grid.getMainWin().GetFont());
-        return 2 * getColumnGapLeft() + dc.GetTextExtent(utfTo<wxString>(formatTime(formatTimeTag))).GetWidth();
+        return 2 * getColumnGapLeft() + getTextExtentBuffered(dc, utfTo<std::wstring>(formatTime(formatTimeTag))).GetWidth();
     }
 
     static int getColumnSeverityDefaultWidth()
@@ -15,6 +15,7 @@
 #include <zen/shutdown.h>
 #include <zen/resolve_path.h>
 #include <zen/sys_info.h>
+#include <zen/trace.h>
 #include <wx/colordlg.h>
 #include <wx/wupdlock.h>
 #include <wx/sound.h>
@@ -1003,7 +1004,7 @@ imgFileManagerSmall_([]
             }
             catch (const FileError& e) { logMsg(extraLog, e.toString(), MessageType::MSG_TYPE_ERROR); }
 
-            std::stable_sort(extraLog.begin(), extraLog.end(), [](const LogEntry& lhs, const LogEntry& rhs) { return lhs.time < rhs.time; });
+            extraLog.sortByTime();
 
             if (!extraLog.empty())
             {
@@ -1152,7 +1153,7 @@ void MainDialog::setGlobalCfgOnInit(const XmlGlobalSettings& globalSettings)
     m_folderPathRight->setHistory(folderHistoryRight_);
 
     //show/hide file icons
-    filegrid::setupIcons(*m_gridMainL, *m_gridMainC, *m_gridMainR, globalSettings.mainDlg.showIcons, convert(globalSettings.mainDlg.iconSize));
+    filegrid::setupIcons(*m_gridMainL, *m_gridMainC, *m_gridMainR, globalSettings.mainDlg.showIcons, convert(globalSettings.mainDlg.iconSize), globalSettings.mainDlg.iconLoaderThreads);
 
     filegrid::setItemPathForm(*m_gridMainL, globalSettings.mainDlg.itemPathFormatLeftGrid);
     filegrid::setItemPathForm(*m_gridMainR, globalSettings.mainDlg.itemPathFormatRightGrid);
@@ -1603,9 +1604,6 @@ void MainDialog::deleteSelectedFiles(const std::vector<FileSystemObject*>& selec
     append(fullSyncLog_->log, r.errorLog.ref());
     fullSyncLog_->totalTime += r.summary.totalTime;
 
-    //remove rows that are empty: just a beautification, invalid rows shouldn't cause issues
-    filegrid::getDataView(*m_gridMainC).removeInvalidRows();
-
     updateGui();
 }
 
@@ -2513,9 +2511,9 @@ void MainDialog::onTreeGridSelection(GridSelectEvent& event)
                 leadRow = filegrid::getDataView(*m_gridMainC).findRowFirstChild(&(root->baseFolder));
             else if (const TreeView::DirNode* dir = dynamic_cast<const TreeView::DirNode*>(node.get()))
             {
-                leadRow = filegrid::getDataView(*m_gridMainC).findRowDirect(&(dir->folder));
+                leadRow = filegrid::getDataView(*m_gridMainC).findRowDirect(dir->folder.getId());
                 if (leadRow < 0) //directory was filtered out! still on tree view (but NOT on grid view)
-                    leadRow = filegrid::getDataView(*m_gridMainC).findRowFirstChild(&(dir->folder));
+                    leadRow = filegrid::getDataView(*m_gridMainC).findRowFirstChild(dir->folder.getId());
             }
             else if (const TreeView::FilesNode* files = dynamic_cast<const TreeView::FilesNode*>(node.get()))
             {
@@ -3023,7 +3021,7 @@ void MainDialog::onGridLabelContextRim(GridLabelClickEvent& event, bool leftSide
     {
         globalCfg_.mainDlg.iconSize  = sz;
         globalCfg_.mainDlg.showIcons = showIcons;
-        filegrid::setupIcons(*m_gridMainL, *m_gridMainC, *m_gridMainR, globalCfg_.mainDlg.showIcons, convert(globalCfg_.mainDlg.iconSize));
+        filegrid::setupIcons(*m_gridMainL, *m_gridMainC, *m_gridMainR, globalCfg_.mainDlg.showIcons, convert(globalCfg_.mainDlg.iconSize), globalCfg_.mainDlg.iconLoaderThreads);
     };
 
     menu.addSeparator();
@@ -4548,11 +4546,16 @@ void MainDialog::onCompare(wxCommandEvent& event)
     };
     try
     {
+        applyBlockSizeTuning(globalCfg_.blockSizeTuning);
+        enableTracing(globalCfg_.enableTracing); //comparison + following synchronization: saved along with the sync log file
+        resetIoMetrics();                        //
+
         //GUI mode: place directory locks on directories isolated(!) during both comparison and synchronization
 
         std::unique_ptr<LockHolder> dirLocks;
         folderCmp_ = compare(globalCfg_.warnDlgs,
                              globalCfg_.fileTimeTolerance,
+                             globalCfg_.detectMovedFilesByContent,
                              requestPassword,
                              globalCfg_.runWithBackgroundPriority,
                              globalCfg_.createLockFile,
@@ -4610,7 +4613,7 @@ void MainDialog::onCompare(wxCommandEvent& event)
         }
 
     //reset icon cache (IconBuffer) after *each* comparison!
-    filegrid::setupIcons(*m_gridMainL, *m_gridMainC, *m_gridMainR, globalCfg_.mainDlg.showIcons, convert(globalCfg_.mainDlg.iconSize));
+    filegrid::setupIcons(*m_gridMainL, *m_gridMainC, *m_gridMainR, globalCfg_.mainDlg.showIcons, convert(globalCfg_.mainDlg.iconSize), globalCfg_.mainDlg.iconLoaderThreads);
 }
 
 
@@ -4952,6 +4955,9 @@ void MainDialog::onStartSync(wxCommandEvent& event)
                 }
                 catch (const FileError& e2) { logMsg2(e2.toString(), MSG_TYPE_ERROR); assert(false); } //should never happen!!!
         }
+        //I/O metrics and trace were saved along with fullSyncLog_ => "consume" them, too: next sync starts from zero
+        enableTracing(globalCfg_.enableTracing);
+        resetIoMetrics();
 
         //--------- update last sync stats for the selected cfg files ---------
         const ErrorLogStats& fullLogStats = getStats(fullLog);
@@ -4975,9 +4981,6 @@ void MainDialog::onStartSync(wxCommandEvent& event)
     //---------------------------------------------------------------------------
     setLastOperationLog(r.summary, r.errorLog.ptr());
 
-    //remove empty rows: just a beautification, invalid rows shouldn't cause issues
-    filegrid::getDataView(*m_gridMainC).removeInvalidRows();
-
     //---------------------------------------------------------------------------
     const StatusHandlerFloatingDialog::DlgOptions dlgOpt = statusHandler.showResult();
 
@@ -5167,9 +5170,6 @@ void MainDialog::startSyncForSelecction(const std::vector<FileSystemObject*>& se
 
     } //run updateGui() *after* reverting our temporary exclusions
 
-    //remove empty rows: just a beautification, invalid rows shouldn't cause issues
-    filegrid::getDataView(*m_gridMainC).removeInvalidRows();
-
     updateGui();
 }
 
@@ -5473,6 +5473,11 @@ void MainDialog::updateGridViewData()
             btn.Show(show);
     };
 
+    //patch views for items changed since last call (manual operations, synchronization) instead of full re-evaluation
+    const HierarchyChanges changes = takeChanges(folderCmp_);
+    filegrid::getDataView(*m_gridMainC).applyChanges(changes);
+    treegrid::getDataView(*m_gridOverview).applyChanges(changes);
+
     FileView::FileStats fileStatsLeft;
     FileView::FileStats fileStatsRight;
 
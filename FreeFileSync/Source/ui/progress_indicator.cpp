@@ -42,7 +42,7 @@ constexpr std::chrono::seconds      SPEED_ESTIMATE_SAMPLE_SKIP(1);
 constexpr std::chrono::milliseconds SPEED_ESTIMATE_UPDATE_INTERVAL(500);
 constexpr std::chrono::seconds      GRAPH_TOTAL_TIME_UPDATE_INTERVAL(2);
 
-const size_t PROGRESS_GRAPH_SAMPLE_SIZE_MAX = 2'500'000; //sizeof(CurveDataStatistics::Sample) == 16 byte key/value
+const size_t PROGRESS_GRAPH_SAMPLE_SIZE_MAX = 10'000; //>> graph width in pixels; resolution is reduced for long runs: see SampledCurveData
 
 inline wxColor getColorBytes() { return {111, 255,  99}; } //light green
 inline wxColor getColorItems() { return {127, 147, 255}; } //light blue
@@ -454,84 +454,11 @@ std::chrono::milliseconds CompareProgressPanel::pauseAndGetTotalTime() { return
 
 namespace
 {
-class CurveDataStatistics : public SparseCurveData
+class CurveDataStatistics : public SampledCurveData
 {
 public:
-    CurveDataStatistics() : SparseCurveData(true /*addSteps*/) {}
-
-    void clear() { samples_.clear(); lastSample_ = {}; }
-
-    void addSample(double timeElapsed /*[sec]*/, double value /*[items|bytes]*/)
-    {
-        assert(( samples_.empty() && lastSample_.x == 0 && lastSample_.y == 0) ||
-               (!samples_.empty() && samples_.back().x <= lastSample_.x));
-
-        if (timeElapsed < lastSample_.x) //time *required* to be monotonously ascending for std::partition_point
-        {
-            assert(false);
-            return;
-        }
-
-        lastSample_ = {timeElapsed, value};
-
-        //allow for at most one sample per 100ms (handles duplicate inserts, too!) => unrelated to UI_UPDATE_INTERVAL!
-        if (!samples_.empty() && timeElapsed - samples_.back().x < 0.1)
-            return;
-
-        samples_.push_back(CurvePoint{timeElapsed, value});
-
-        if (samples_.size() > PROGRESS_GRAPH_SAMPLE_SIZE_MAX) //limit buffer size
-            samples_.pop_front();
-    }
-
-private:
-    std::pair<double, double> getRangeX() const override
-    {
-        if (samples_.empty())
-            return {};
-        /*
-            //report some additional width by 5% elapsed time to make graph recalibrate before hitting the right border
-            //caveat: graph for batch mode binary comparison does NOT start at elapsed time 0!! ProcessPhase::binaryCompare and ProcessPhase::sync!
-            //=> consider width of current sample set!
-            upperEndMs += 0.05 *(upperEndMs - samples.begin()->first);
-        */
-        return {samples_.front().x, //need not start with 0, e.g. "binary comparison, graph reset, followed by sync"
-                lastSample_.x};
-    }
-
-    std::optional<CurvePoint> getLessEq(double x) const override //x: seconds since begin
-    {
-        //--------- add artifical last sample value --------
-        if (!samples_.empty() && lastSample_.x <= x)
-            return lastSample_;
-        //--------------------------------------------------
-
-        //find first item > x, then go one step back:
-        auto it = std::partition_point(samples_.begin(), samples_.end(),
-        /*find first item for which "!pred"*/ [x](const CurvePoint& p) { return p.x <= x; });
-        if (it == samples_.begin())
-            return std::nullopt;
-        --it; //bound!
-        return *it;
-    }
-
-    std::optional<CurvePoint> getGreaterEq(double x) const override
-    {
-        //find first item >= x
-        const auto it = std::partition_point(samples_.begin(), samples_.end(),
-        /*find first item for which "!pred"*/ [x](const CurvePoint& p) { return p.x < x; });
-        if (it != samples_.end())
-            return *it;
-
-        //--------- add artifical last sample value --------
-        if (!samples_.empty() && x <= lastSample_.x)
-            return lastSample_;
-        //--------------------------------------------------
-        return std::nullopt;
-    }
-
-    RingBuffer<CurvePoint> samples_; //x: monotonously ascending with time!
-    CurvePoint lastSample_; //artificial record after end of samples to visualize current time!
+    //x: elapsed time [sec], y: items|bytes; at most one sample per 100ms (=> unrelated to UI_UPDATE_INTERVAL!), fewer for long runs
+    CurveDataStatistics() : SampledCurveData(true /*addSteps*/, 0.1 /*minGapX*/, PROGRESS_GRAPH_SAMPLE_SIZE_MAX) {}
 };
 
 
@@ -12,6 +12,7 @@
 #include <zen/utf.h>
 #include <zen/stl_tools.h>
 #include <zen/format_unit.h>
+#include <zen/thread.h>
 #include <wx+/rtl.h>
 #include <wx+/dc.h>
 #include <wx+/context_menu.h>
@@ -55,91 +56,115 @@ TreeView::TreeView(FolderComparison& folderCmp, const SortInfo& si) : folderCmp_
 }
 
 
-inline
-void TreeView::compressNode(Container& cont) //remove single-element sub-trees -> gain clarity + usability (call *after* inclusion check!!!)
+namespace
+{
+uint64_t getFileBytes(const FilePair& file)
 {
-    if (cont.subDirs.empty()) //single files node
-        cont.firstFileId = nullptr;
-
-#if 0 //let's not go overboard: empty folders should not be condensed => used for file exclusion filter; user expects to see them
-    if (cont.firstFileId == nullptr && //single dir node...
-        cont.subDirs.size() == 1   && //
-        cont.subDirs[0].firstFileId == nullptr && //...that is empty
-        cont.subDirs[0].subDirs.empty())          //
-        cont.subDirs.clear();
+#if 0 //give accumulated bytes the semantics of a sync preview?
+    switch (getEffectiveSyncDir(file.getSyncOperation()))
+    {
+        //*INDENT-OFF*
+        case SyncDirection::none: break;
+        case SyncDirection::left:  return file.getFileSize<SelectSide::right>();
+        case SyncDirection::right: return file.getFileSize<SelectSide::left>();
+        //*INDENT-ON*
+    }
 #endif
+    //prefer file-browser semantics over sync preview (=> always show useful numbers, even for SyncDirection::none)
+    //discussion: https://freefilesync.org/forum/viewtopic.php?t=1595
+    return std::max(file.isEmpty<SelectSide::left >() ? 0 : file.getFileSize<SelectSide::left>(),
+                    file.isEmpty<SelectSide::right>() ? 0 : file.getFileSize<SelectSide::right>());
 }
 
 
-template <class Function> //(const FileSystemObject&) -> bool
-void TreeView::extractVisibleSubtree(ContainerObject& conObj, //in
-                                     TreeView::Container& cont, //out
-                                     Function pred)
+uint64_t getFileBytes(const FsObjectState& state) //=> same as above
 {
-    auto getBytes = [](const FilePair& file) //MSVC screws up miserably if we put this lambda into std::for_each
-    {
-#if 0 //give accumulated bytes the semantics of a sync preview?
-        switch (getEffectiveSyncDir(file.getSyncOperation()))
-        {
-            //*INDENT-OFF*
-            case SyncDirection::none: break;
-            case SyncDirection::left:  return file.getFileSize<SelectSide::right>();
-            case SyncDirection::right: return file.getFileSize<SelectSide::left>();
-            //*INDENT-ON*
-        }
-#endif
-        //prefer file-browser semantics over sync preview (=> always show useful numbers, even for SyncDirection::none)
-        //discussion: https://freefilesync.org/forum/viewtopic.php?t=1595
-        return std::max(file.isEmpty<SelectSide::left >() ? 0 : file.getFileSize<SelectSide::left>(),
-                        file.isEmpty<SelectSide::right>() ? 0 : file.getFileSize<SelectSide::right>());
-    };
+    if (state.itemType != FsObjectState::ItemType::file)
+        return 0;
+    return std::max(state.isEmpty<SelectSide::left >() ? 0 : state.getFileSize<SelectSide::left>(),
+                    state.isEmpty<SelectSide::right>() ? 0 : state.getFileSize<SelectSide::right>());
+}
+
+
+const size_t PARALLEL_STATS_FOLDERS_MIN = 10'000; //per thread: don't bother for small trees
+}
+
+
+template <class Predicate> //(const FileSystemObject&) -> bool
+void TreeView::calcFolderStats(uint32_t statsIdx, ContainerObject& conObj, Predicate pred) //sub folders must be calculated already!
+{
+    FolderStats& stats = folderStats_[statsIdx];
 
-    cont.firstFileId = nullptr;
     for (FilePair& file : conObj.refSubFiles())
         if (pred(file))
         {
-            cont.bytesNet += getBytes(file);
-            ++cont.itemCountNet;
+            stats.bytesNet += getFileBytes(file);
+            ++stats.itemCountNet;
 
-            if (!cont.firstFileId)
-                cont.firstFileId = file.getId();
+            if (!stats.firstFileId)
+                stats.firstFileId = file.getId();
         }
 
     for (SymlinkPair& symlink : conObj.refSubLinks())
         if (pred(symlink))
         {
-            ++cont.itemCountNet;
+            ++stats.itemCountNet;
 
-            if (!cont.firstFileId)
-                cont.firstFileId = symlink.getId();
+            if (!stats.firstFileId)
+                stats.firstFileId = symlink.getId();
         }
 
-    cont.bytesGross     += cont.bytesNet;
-    cont.itemCountGross += cont.itemCountNet;
-
-    cont.subDirs.reserve(conObj.refSubFolders().size()); //avoid expensive reallocations!
+    stats.bytesGross     = stats.bytesNet;
+    stats.itemCountGross = stats.itemCountNet;
 
     for (FolderPair& folder : conObj.refSubFolders())
     {
-        const bool included = pred(folder);
+        const FolderStats& subStats = folderStats_[statsIdxBySlot_[folder.getId().getSlotIndex()]];
 
-        cont.subDirs.emplace_back(); //
-        auto& subDirCont = cont.subDirs.back();
-        TreeView::extractVisibleSubtree(folder, subDirCont, pred);
-        if (included)
-            ++subDirCont.itemCountGross;
+        stats.bytesGross     += subStats.bytesGross;
+        stats.itemCountGross += subStats.itemCountGross;
 
-        cont.bytesGross     += subDirCont.bytesGross;
-        cont.itemCountGross += subDirCont.itemCountGross;
+        if (subStats.itemCountGross > 0)
+            ++stats.subDirCount;
+    }
 
-        if (!included && !subDirCont.firstFileId && subDirCont.subDirs.empty())
-            cont.subDirs.pop_back();
-        else
-        {
-            subDirCont.objId = folder.getId();
-            compressNode(subDirCont);
-        }
+    if (auto folder = dynamic_cast<FolderPair*>(&conObj))
+        if (pred(*folder))
+            ++stats.itemCountGross;
+}
+
+
+uint32_t TreeView::getStatsIdx(FileSystemObject::ObjectIdConst folderId) const
+{
+    if (folderId.getSlotIndex() < statsIdxBySlot_.size())
+        return statsIdxBySlot_[folderId.getSlotIndex()];
+    return NO_STATS;
+}
+
+
+uint32_t TreeView::getStatsIdx(const BaseFolderPair* baseFolder) const
+{
+    for (size_t i = 0; i < folderCmp_.size(); ++i)
+        if (&folderCmp_[i].ref() == baseFolder)
+            return rootStatsIdx_[i];
+    return NO_STATS;
+}
+
+
+ContainerObject* TreeView::getContainerObject(const TreeLine& line)
+{
+    switch (line.type)
+    {
+        case NodeType::root:
+            return static_cast<const RootNodeImpl*>(line.node)->baseFolder.get();
+
+        case NodeType::folder:
+            return dynamic_cast<FolderPair*>(FileSystemObject::retrieve(static_cast<const DirNodeImpl*>(line.node)->objId));
+
+        case NodeType::files:
+            break; //none!!!
     }
+    return nullptr;
 }
 
 
@@ -227,32 +252,32 @@ struct TreeView::LessShortName
 
 
 template <bool ascending>
-void TreeView::sortSingleLevel(std::vector<TreeLine>& items, ColumnTypeOverview columnType)
+void TreeView::sortSingleLevel(std::vector<TreeLine>& items, ColumnTypeOverview columnType) const
 {
-    auto getBytes = [](const TreeLine& line) -> uint64_t
+    auto getBytes = [&](const TreeLine& line) -> uint64_t
     {
         switch (line.type)
         {
             case NodeType::root:
             case NodeType::folder:
-                return line.node->bytesGross;
+                return folderStats_[line.node->statsIdx].bytesGross;
             case NodeType::files:
-                return line.node->bytesNet;
+                return folderStats_[line.node->statsIdx].bytesNet;
         }
         assert(false);
         return 0U;
     };
 
-    auto getCount = [](const TreeLine& line) -> int
+    auto getCount = [&](const TreeLine& line) -> int
     {
         switch (line.type)
         {
             case NodeType::root:
             case NodeType::folder:
-                return line.node->itemCountGross;
+                return folderStats_[line.node->statsIdx].itemCountGross;
 
             case NodeType::files:
-                return line.node->itemCountNet;
+                return folderStats_[line.node->statsIdx].itemCountNet;
         }
         assert(false);
         return 0;
@@ -276,22 +301,39 @@ void TreeView::sortSingleLevel(std::vector<TreeLine>& items, ColumnTypeOverview
 }
 
 
-void TreeView::getChildren(const Container& cont, unsigned int level, std::vector<TreeLine>& output)
+void TreeView::getChildren(Container& cont, ContainerObject& conObj, unsigned int level, std::vector<TreeLine>& output)
 {
+    const FolderStats& stats = folderStats_[cont.statsIdx];
+
+    if (cont.subDirs.empty()) //create nodes on demand: folderStats_ already has all the numbers
+    {
+        cont.subDirs.reserve(stats.subDirCount);
+
+        for (FolderPair& folder : conObj.refSubFolders())
+            if (const uint32_t statsIdx = getStatsIdx(folder.getId());
+                statsIdx != NO_STATS && folderStats_[statsIdx].itemCountGross > 0)
+            {
+                DirNodeImpl& subDir = cont.subDirs.emplace_back();
+                subDir.statsIdx = statsIdx;
+                subDir.objId    = folder.getId();
+            }
+        assert(std::ssize(cont.subDirs) == stats.subDirCount);
+    }
+
     output.clear();
     output.reserve(cont.subDirs.size() + 1); //keep pointers in "workList" valid
     std::vector<std::pair<uint64_t, int*>> workList;
 
-    for (const DirNodeImpl& subDir : cont.subDirs)
+    for (DirNodeImpl& subDir : cont.subDirs)
     {
         output.push_back({level, 0, &subDir, NodeType::folder});
-        workList.emplace_back(subDir.bytesGross, &output.back().percent);
+        workList.emplace_back(folderStats_[subDir.statsIdx].bytesGross, &output.back().percent);
     }
 
-    if (cont.firstFileId)
+    if (!cont.subDirs.empty() && stats.itemCountNet > 0) //"compress": no single files node for directories without sub folders
     {
         output.push_back({level, 0, &cont, NodeType::files});
-        workList.emplace_back(cont.bytesNet, &output.back().percent);
+        workList.emplace_back(stats.bytesNet, &output.back().percent);
     }
     calcPercentage(workList);
 
@@ -305,31 +347,13 @@ void TreeView::getChildren(const Container& cont, unsigned int level, std::vecto
 void TreeView::applySubView(std::vector<RootNodeImpl>&& newView)
 {
     //preserve current node expansion status
-    auto getHierAlias = [](const TreeView::TreeLine& tl) -> const ContainerObject*
-    {
-        switch (tl.type)
-        {
-            case NodeType::root:
-                return static_cast<const RootNodeImpl*>(tl.node)->baseFolder.get();
-
-            case NodeType::folder:
-                if (auto folder = dynamic_cast<const FolderPair*>(FileSystemObject::retrieve(static_cast<const DirNodeImpl*>(tl.node)->objId)))
-                    return folder;
-                break;
-
-            case NodeType::files:
-                break; //none!!!
-        }
-        return nullptr;
-    };
-
     std::unordered_set<const ContainerObject*> expandedNodes;
     if (!flatTree_.empty())
     {
         auto it = flatTree_.begin();
         for (auto itNext = flatTree_.begin() + 1; itNext != flatTree_.end(); ++itNext, ++it)
             if (it->level < itNext->level)
-                if (auto conObj = getHierAlias(*it))
+                if (auto conObj = getContainerObject(*it))
                     expandedNodes.insert(conObj);
     }
 
@@ -342,7 +366,7 @@ void TreeView::applySubView(std::vector<RootNodeImpl>&& newView)
     if (folderCmp_.size() == 1) //single folder pair case (empty pairs were already removed!) do NOT use folderCmpView for this check!
     {
         if (!folderCmpView_.empty()) //possibly empty!
-            getChildren(folderCmpView_[0], 0, flatTree_); //do not show root
+            getChildren(folderCmpView_[0], *folderCmpView_[0].baseFolder, 0, flatTree_); //do not show root
     }
     else
     {
@@ -352,10 +376,10 @@ void TreeView::applySubView(std::vector<RootNodeImpl>&& newView)
         flatTree_.reserve(folderCmpView_.size()); //keep pointers in "workList" valid
         std::vector<std::pair<uint64_t, int*>> workList;
 
-        for (const RootNodeImpl& root : folderCmpView_)
+        for (RootNodeImpl& root : folderCmpView_)
         {
             flatTree_.push_back({0, 0, &root, NodeType::root});
-            workList.emplace_back(root.bytesGross, &flatTree_.back().percent);
+            workList.emplace_back(folderStats_[root.statsIdx].bytesGross, &flatTree_.back().percent);
         }
 
         calcPercentage(workList);
@@ -371,11 +395,11 @@ void TreeView::applySubView(std::vector<RootNodeImpl>&& newView)
     {
         const TreeLine& line = flatTree_[row];
 
-        if (auto conObj = getHierAlias(line))
+        if (auto conObj = getContainerObject(line))
             if (expandedNodes.contains(conObj))
             {
                 std::vector<TreeLine> newLines;
-                getChildren(*line.node, line.level + 1, newLines);
+                getChildren(*line.node, *conObj, line.level + 1, newLines);
 
                 flatTree_.insert(flatTree_.begin() + row + 1, newLines.begin(), newLines.end());
             }
@@ -383,35 +407,92 @@ void TreeView::applySubView(std::vector<RootNodeImpl>&& newView)
 }
 
 
+std::vector<TreeView::RootNodeImpl> TreeView::createRootNodes()
+{
+    std::vector<RootNodeImpl> newView;
+
+    for (size_t i = 0; i < folderCmp_.size(); ++i)
+        if (folderStats_[rootStatsIdx_[i]].itemCountGross > 0)
+        {
+            BaseFolderPair& baseFolder = folderCmp_[i].ref();
+
+            RootNodeImpl& root = newView.emplace_back();
+            root.statsIdx    = rootStatsIdx_[i];
+            root.baseFolder  = folderCmp_[i].ptr();
+            root.displayName = getShortDisplayNameForFolderPair(baseFolder.getAbstractPath<SelectSide::left >(),
+                                                                baseFolder.getAbstractPath<SelectSide::right>());
+        }
+    return newView;
+}
+
+
 template <class Predicate>
 void TreeView::updateView(Predicate pred)
 {
-    //update view on full data
-    std::vector<RootNodeImpl> newView;
-    newView.reserve(folderCmp_.size()); //avoid expensive reallocations!
+    //1. number all folders in pre-order => each sub tree is a contiguous range with sub folders *after* their parent
+    folderStats_   .clear();
+    statsIdxBySlot_.clear();
+    rootStatsIdx_  .clear();
 
-    for (SharedRef<BaseFolderPair>& baseObj : folderCmp_)
+    std::vector<ContainerObject*> statsConObjs; //same index as folderStats_
+    std::vector<uint32_t> subTreeEnd;           //
+
+    auto addStats = [&](ContainerObject& conObj, uint32_t parentIdx, auto& addStatsRef) -> uint32_t
     {
-        newView.emplace_back();
-        RootNodeImpl& root = newView.back();
-        this->extractVisibleSubtree(baseObj.ref(), root, pred); //"this->" is bogus for a static method, but GCC screws this one up
-
-        //warning: the following lines are almost 1:1 copy from extractVisibleSubtree:
-        //however we *cannot* reuse code here; this were only possible if we replaced "std::vector<RootNodeImpl>" with "Container"!
-        if (!root.firstFileId && root.subDirs.empty())
-            newView.pop_back();
-        else
+        const auto statsIdx = static_cast<uint32_t>(folderStats_.size());
+        folderStats_.push_back({.parentIdx = parentIdx});
+        statsConObjs.push_back(&conObj);
+        subTreeEnd  .push_back(0);
+
+        for (FolderPair& folder : conObj.refSubFolders())
         {
-            root.baseFolder = baseObj.ptr();
-            root.displayName = getShortDisplayNameForFolderPair(baseObj.ref().getAbstractPath<SelectSide::left >(),
-                                                                baseObj.ref().getAbstractPath<SelectSide::right>());
+            const uint32_t slotIdx = folder.getId().getSlotIndex();
+            if (slotIdx >= statsIdxBySlot_.size())
+                statsIdxBySlot_.resize(slotIdx + 1, NO_STATS);
 
-            this->compressNode(root); //"this->" required by two-pass lookup as enforced by GCC 4.7
+            statsIdxBySlot_[slotIdx] = addStatsRef(folder, statsIdx, addStatsRef);
         }
+        subTreeEnd[statsIdx] = static_cast<uint32_t>(folderStats_.size());
+        return statsIdx;
+    };
+    for (SharedRef<BaseFolderPair>& baseObj : folderCmp_)
+        rootStatsIdx_.push_back(addStats(baseObj.ref(), NO_STATS, addStats));
+
+    //2. calculate bottom-up (= reverse pre-order): sub trees in parallel, remaining upper levels on main thread
+    const size_t threadCount = std::clamp<size_t>(folderStats_.size() / PARALLEL_STATS_FOLDERS_MIN, 1, std::max(std::thread::hardware_concurrency(), 1U));
+    const size_t subTreeSizeMax = folderStats_.size() / (threadCount * 4); //load balancing: sub trees may differ greatly in size
+
+    std::vector<uint32_t> mainThreadIdxs;
+    {
+        std::optional<ThreadGroup<std::function<void()>>> tg;
+        if (threadCount > 1)
+            tg.emplace(threadCount, Zstr("Tree view statistics"));
+
+        for (uint32_t statsIdx = 0; statsIdx < folderStats_.size();)
+            if (const uint32_t statsIdxEnd = subTreeEnd[statsIdx];
+                tg && statsIdxEnd - statsIdx <= subTreeSizeMax)
+            {
+                //FolderPair::getSyncOperation() buffers results, but only considers items within the same sub tree
+                tg->run([this, &statsConObjs, &pred, statsIdx, statsIdxEnd]
+                {
+                    for (uint32_t i = statsIdxEnd; i-- > statsIdx;)
+                        calcFolderStats(i, *statsConObjs[i], pred);
+                });
+                statsIdx = statsIdxEnd;
+            }
+            else
+                mainThreadIdxs.push_back(statsIdx++);
+
+        if (tg)
+            tg->wait();
     }
 
+    for (auto it = mainThreadIdxs.rbegin(); it != mainThreadIdxs.rend(); ++it)
+        calcFolderStats(*it, *statsConObjs[*it], pred);
+
+    //3. create root nodes only: all other nodes are created when expanded
     lastViewFilterPred_ = pred;
-    applySubView(std::move(newView));
+    applySubView(createRootNodes());
 }
 
 
@@ -436,7 +517,7 @@ TreeView::NodeStatus TreeView::getStatus(size_t row) const
         {
             case NodeType::root:
             case NodeType::folder:
-                return flatTree_[row].node->firstFileId || !flatTree_[row].node->subDirs.empty() ? TreeView::STATUS_REDUCED : TreeView::STATUS_EMPTY;
+                return folderStats_[flatTree_[row].node->statsIdx].subDirCount > 0 ? TreeView::STATUS_REDUCED : TreeView::STATUS_EMPTY; //see getChildren()
 
             case NodeType::files:
                 return TreeView::STATUS_EMPTY;
@@ -462,7 +543,8 @@ void TreeView::expandNode(size_t row)
         {
             case NodeType::root:
             case NodeType::folder:
-                getChildren(*flatTree_[row].node, flatTree_[row].level + 1, newLines);
+                if (ContainerObject* conObj = getContainerObject(flatTree_[row]))
+                    getChildren(*flatTree_[row].node, *conObj, flatTree_[row].level + 1, newLines);
                 break;
             case NodeType::files:
                 break;
@@ -510,6 +592,74 @@ ptrdiff_t TreeView::getParent(size_t row) const
 }
 
 
+template <class FsItem>
+bool TreeView::matchesFilter(const FsItem& item, const DifferenceFilter& filter)
+{
+    if (!item.isActive() && !filter.showExcluded)
+        return false;
+
+    switch (item.getCategory())
+    {
+        case FILE_LEFT_ONLY:
+            return filter.leftOnlyFilesActive;
+        case FILE_RIGHT_ONLY:
+            return filter.rightOnlyFilesActive;
+        case FILE_LEFT_NEWER:
+            return filter.leftNewerFilesActive;
+        case FILE_RIGHT_NEWER:
+            return filter.rightNewerFilesActive;
+        case FILE_DIFFERENT_CONTENT:
+            return filter.differentFilesActive;
+        case FILE_EQUAL:
+            return filter.equalFilesActive;
+        case FILE_RENAMED:
+        case FILE_CONFLICT:
+        case FILE_TIME_INVALID:
+            return filter.conflictFilesActive;
+    }
+    assert(false);
+    return true;
+}
+
+
+template <class FsItem>
+bool TreeView::matchesFilter(const FsItem& item, const ActionFilter& filter)
+{
+    if (!item.isActive() && !filter.showExcluded)
+        return false;
+
+    switch (item.getSyncOperation())
+    {
+        case SO_CREATE_LEFT:
+            return filter.syncCreateLeftActive;
+        case SO_CREATE_RIGHT:
+            return filter.syncCreateRightActive;
+        case SO_DELETE_LEFT:
+            return filter.syncDeleteLeftActive;
+        case SO_DELETE_RIGHT:
+            return filter.syncDeleteRightActive;
+        case SO_OVERWRITE_RIGHT:
+        case SO_RENAME_RIGHT:
+        case SO_MOVE_RIGHT_FROM:
+        case SO_MOVE_RIGHT_TO:
+            return filter.syncDirOverwRightActive;
+        case SO_OVERWRITE_LEFT:
+        case SO_RENAME_LEFT:
+        case SO_MOVE_LEFT_FROM:
+        case SO_MOVE_LEFT_TO:
+            return filter.syncDirOverwLeftActive;
+        case SO_DO_NOTHING:
+            return filter.syncDirNoneActive;
+        case SO_EQUAL:
+            return filter.syncEqualActive;
+        case SO_UNRESOLVED_CONFLICT:
+            return filter.conflictFilesActive;
+    }
+    assert(false);
+    return true;
+}
+
+
 void TreeView::applyDifferenceFilter(bool showExcluded,
                                      bool leftOnlyFilesActive,
                                      bool rightOnlyFilesActive,
@@ -519,40 +669,15 @@ void TreeView::applyDifferenceFilter(bool showExcluded,
                                      bool equalFilesActive,
                                      bool conflictFilesActive)
 {
-    updateView([showExcluded, //make sure the predicate can be stored safely!
-                              leftOnlyFilesActive,
-                              rightOnlyFilesActive,
-                              leftNewerFilesActive,
-                              rightNewerFilesActive,
-                              differentFilesActive,
-                              equalFilesActive,
-                              conflictFilesActive](const FileSystemObject& fsObj) -> bool
-    {
-        if (!fsObj.isActive() && !showExcluded)
-            return false;
+    const DifferenceFilter filter{showExcluded, leftOnlyFilesActive, rightOnlyFilesActive, leftNewerFilesActive,
+                                  rightNewerFilesActive, differentFilesActive, equalFilesActive, conflictFilesActive};
 
-        switch (fsObj.getCategory())
-        {
-            case FILE_LEFT_ONLY:
-                return leftOnlyFilesActive;
-            case FILE_RIGHT_ONLY:
-                return rightOnlyFilesActive;
-            case FILE_LEFT_NEWER:
-                return leftNewerFilesActive;
-            case FILE_RIGHT_NEWER:
-                return rightNewerFilesActive;
-            case FILE_DIFFERENT_CONTENT:
-                return differentFilesActive;
-            case FILE_EQUAL:
-                return equalFilesActive;
-            case FILE_RENAMED:
-            case FILE_CONFLICT:
-            case FILE_TIME_INVALID:
-                return conflictFilesActive;
-        }
-        assert(false);
-        return true;
-    });
+    if (const DifferenceFilter* filterOld = std::get_if<DifferenceFilter>(&lastViewFilter_);
+        filterOld && *filterOld == filter)
+        return; //folderCmpView_ is up to date: see applyChanges()
+
+    updateView([filter](const FileSystemObject& fsObj) { return matchesFilter(fsObj, filter); }); //make sure the predicate can be stored safely!
+    lastViewFilter_ = filter;
 }
 
 
@@ -567,50 +692,132 @@ void TreeView::applyActionFilter(bool showExcluded,
                                  bool syncEqualActive,
                                  bool conflictFilesActive)
 {
-    updateView([showExcluded, //make sure the predicate can be stored safely!
-                              syncCreateLeftActive,
-                              syncCreateRightActive,
-                              syncDeleteLeftActive,
-                              syncDeleteRightActive,
-                              syncDirOverwLeftActive,
-                              syncDirOverwRightActive,
-                              syncDirNoneActive,
-                              syncEqualActive,
-                              conflictFilesActive](const FileSystemObject& fsObj) -> bool
+    const ActionFilter filter{showExcluded, syncCreateLeftActive, syncCreateRightActive, syncDeleteLeftActive, syncDeleteRightActive,
+                              syncDirOverwLeftActive, syncDirOverwRightActive, syncDirNoneActive, syncEqualActive, conflictFilesActive};
+
+    if (const ActionFilter* filterOld = std::get_if<ActionFilter>(&lastViewFilter_);
+        filterOld && *filterOld == filter)
+        return; //folderCmpView_ is up to date: see applyChanges()
+
+    updateView([filter](const FileSystemObject& fsObj) { return matchesFilter(fsObj, filter); }); //make sure the predicate can be stored safely!
+    lastViewFilter_ = filter;
+}
+
+
+void TreeView::applyChanges(const HierarchyChanges& changes)
+{
+    if (std::holds_alternative<std::monostate>(lastViewFilter_))
+        return;
+
+    if (!changes.fullUpdate && changes.items.empty())
+        return;
+
+    if (changes.fullUpdate || !patchFolderStats(changes))
     {
-        if (!fsObj.isActive() && !showExcluded)
+        lastViewFilter_ = std::monostate(); //=> full update during next applyDifferenceFilter()/applyActionFilter()
+        return;
+    }
+
+    applySubView(createRootNodes()); //nodes may have been added/removed; update percentages, sort order
+}
+
+
+bool TreeView::patchFolderStats(const HierarchyChanges& changes)
+{
+    auto matches = [&](const auto& item)
+    {
+        if (const auto filter = std::get_if<DifferenceFilter>(&lastViewFilter_))
+            return matchesFilter(item, *filter);
+        return matchesFilter(item, std::get<ActionFilter>(lastViewFilter_));
+    };
+
+    std::vector<std::pair<uint32_t /*statsIdx*/, const FsObjectState*>> netChanged; //=> update firstFileId
+
+    for (const FsObjectState& stateOld : changes.items)
+    {
+        const FileSystemObject* fsObj = FileSystemObject::retrieve(stateOld.objId);
+        const std::optional<FsObjectState> stateNew = fsObj ? std::optional(getObjectState(*fsObj)) : std::nullopt;
+
+        const bool shownOld = matches(stateOld);
+        const bool shownNew = stateNew && matches(*stateNew);
+
+        const int      itemCountDelta = static_cast<int>(shownNew) - static_cast<int>(shownOld);
+        const uint64_t bytesOld = shownOld ? getFileBytes(stateOld) : 0;
+        const uint64_t bytesNew = shownNew ? getFileBytes(*stateNew) : 0;
+
+        if (itemCountDelta == 0 && bytesOld == bytesNew)
+            continue;
+
+        uint32_t statsIdx = NO_STATS; //first folder to account for the item in "gross" numbers
+        if (stateOld.itemType == FsObjectState::ItemType::folder)
+            statsIdx = getStatsIdx(stateOld.objId);
+        else
+        {
+            statsIdx = stateOld.parentId ? getStatsIdx(stateOld.parentId) : getStatsIdx(stateOld.base);
+            if (statsIdx != NO_STATS)
+            {
+                FolderStats& stats = folderStats_[statsIdx];
+                stats.itemCountNet += itemCountDelta;
+                stats.bytesNet     += bytesNew - bytesOld; //unsigned wrap-around is fine
+                netChanged.emplace_back(statsIdx, &stateOld);
+            }
+        }
+        if (statsIdx == NO_STATS) //folder created after updateView()?
             return false;
 
-        switch (fsObj.getSyncOperation())
+        while (statsIdx != NO_STATS)
         {
-            case SO_CREATE_LEFT:
-                return syncCreateLeftActive;
-            case SO_CREATE_RIGHT:
-                return syncCreateRightActive;
-            case SO_DELETE_LEFT:
-                return syncDeleteLeftActive;
-            case SO_DELETE_RIGHT:
-                return syncDeleteRightActive;
-            case SO_OVERWRITE_RIGHT:
-            case SO_RENAME_RIGHT:
-            case SO_MOVE_RIGHT_FROM:
-            case SO_MOVE_RIGHT_TO:
-                return syncDirOverwRightActive;
-            case SO_OVERWRITE_LEFT:
-            case SO_RENAME_LEFT:
-            case SO_MOVE_LEFT_FROM:
-            case SO_MOVE_LEFT_TO:
-                return syncDirOverwLeftActive;
-            case SO_DO_NOTHING:
-                return syncDirNoneActive;
-            case SO_EQUAL:
-                return syncEqualActive;
-            case SO_UNRESOLVED_CONFLICT:
-                return conflictFilesActive;
+            FolderStats& stats = folderStats_[statsIdx];
+            const bool onViewOld = stats.itemCountGross > 0;
+
+            stats.itemCountGross += itemCountDelta;
+            stats.bytesGross     += bytesNew - bytesOld;
+            assert(stats.itemCountGross >= 0);
+
+            statsIdx = stats.parentIdx;
+
+            if (const bool onViewNew = stats.itemCountGross > 0;
+                onViewOld != onViewNew && statsIdx != NO_STATS)
+                folderStats_[statsIdx].subDirCount += onViewNew ? 1 : -1;
         }
-        assert(false);
-        return true;
-    });
+    }
+
+    //update firstFileId: keep if still on view
+    for (const auto& [statsIdx, stateOld] : netChanged)
+        if (FolderStats& stats = folderStats_[statsIdx];
+            stats.itemCountNet == 0)
+            stats.firstFileId = nullptr;
+        else if (const FileSystemObject* firstFile = FileSystemObject::retrieve(stats.firstFileId);
+                 !firstFile || !lastViewFilterPred_(*firstFile))
+        {
+            ContainerObject* conObj = nullptr;
+            if (stateOld->parentId)
+                conObj = const_cast<FolderPair*>(dynamic_cast<const FolderPair*>(FileSystemObject::retrieve(stateOld->parentId)));
+            else
+                for (SharedRef<BaseFolderPair>& baseObj : folderCmp_)
+                    if (&baseObj.ref() == stateOld->base)
+                        conObj = &baseObj.ref();
+            if (!conObj)
+                return false;
+
+            stats.firstFileId = nullptr;
+            for (FilePair& file : conObj->refSubFiles())
+                if (lastViewFilterPred_(file))
+                {
+                    stats.firstFileId = file.getId();
+                    break;
+                }
+
+            if (!stats.firstFileId)
+                for (SymlinkPair& symlink : conObj->refSubLinks())
+                    if (lastViewFilterPred_(symlink))
+                    {
+                        stats.firstFileId = symlink.getId();
+                        break;
+                    }
+            assert(stats.firstFileId);
+        }
+    return true;
 }
 
 
@@ -626,22 +833,24 @@ std::unique_ptr<TreeView::Node> TreeView::getLine(size_t row) const
             case NodeType::root:
             {
                 const auto& root = *static_cast<const TreeView::RootNodeImpl*>(flatTree_[row].node);
-                return std::make_unique<TreeView::RootNode>(percent, root.bytesGross, root.itemCountGross, getStatus(row), *root.baseFolder, root.displayName);
+                const FolderStats& stats = folderStats_[root.statsIdx];
+                return std::make_unique<TreeView::RootNode>(percent, stats.bytesGross, stats.itemCountGross, getStatus(row), *root.baseFolder, root.displayName);
             }
             break;
 
             case NodeType::folder:
             {
                 const auto* dir = static_cast<const TreeView::DirNodeImpl*>(flatTree_[row].node);
+                const FolderStats& stats = folderStats_[dir->statsIdx];
                 if (auto folder = dynamic_cast<FolderPair*>(FileSystemObject::retrieve(dir->objId)))
-                    return std::make_unique<TreeView::DirNode>(percent, dir->bytesGross, dir->itemCountGross, level, getStatus(row), *folder);
+                    return std::make_unique<TreeView::DirNode>(percent, stats.bytesGross, stats.itemCountGross, level, getStatus(row), *folder);
             }
             break;
 
             case NodeType::files:
             {
-                const auto* parentDir = flatTree_[row].node;
-                if (FileSystemObject* firstFile = FileSystemObject::retrieve(parentDir->firstFileId))
+                const FolderStats& stats = folderStats_[flatTree_[row].node->statsIdx];
+                if (FileSystemObject* firstFile = FileSystemObject::retrieve(stats.firstFileId))
                 {
                     std::vector<FileSystemObject*> filesAndLinks;
                     ContainerObject& parent = firstFile->parent();
@@ -655,7 +864,7 @@ std::unique_ptr<TreeView::Node> TreeView::getLine(size_t row) const
                         if (lastViewFilterPred_(fsObj))
                             filesAndLinks.push_back(&fsObj);
 
-                    return std::make_unique<TreeView::FilesNode>(percent, parentDir->bytesNet, parentDir->itemCountNet, level, filesAndLinks);
+                    return std::make_unique<TreeView::FilesNode>(percent, stats.bytesNet, stats.itemCountNet, level, filesAndLinks);
                 }
             }
             break;
@@ -950,13 +1159,13 @@ private:
         {
             if (std::unique_ptr<TreeView::Node> node = getDataView().getLine(row))
                 return node->level_ * widthLevelStep_ + gapSize_ + (showPercentBar_ ? percentageBarWidth_ + 2 * gapSize_ : 0) + widthNodeStatus_ + gapSize_
-                       + widthNodeIcon_ + gapSize_ + dc.GetTextExtent(getValue(row, colType)).GetWidth() +
+                       + widthNodeIcon_ + gapSize_ + getTextExtentBuffered(dc, getValue(row, colType)).GetWidth() +
                        gapSize_; //additional gap from right
             else
                 return 0;
         }
         else
-            return 2 * gapSize_ + dc.GetTextExtent(getValue(row, colType)).GetWidth() +
+            return 2 * gapSize_ + getTextExtentBuffered(dc, getValue(row, colType)).GetWidth() +
                    2 * gapSize_; //include gap from right!
     }
 
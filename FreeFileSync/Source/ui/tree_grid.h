@@ -8,6 +8,7 @@
 #define TREE_VIEW_H_841703190201835280256673425
 
 #include <functional>
+#include <variant>
 #include <wx+/grid.h>
 #include "tree_grid_attr.h"
 #include "../base/file_hierarchy.h"
@@ -50,6 +51,8 @@ public:
                            bool syncEqualActive,
                            bool conflictFilesActive);
 
+    void applyChanges(const HierarchyChanges& changes); //call *before* applyDifferenceFilter()/applyActionFilter()
+
     enum NodeStatus
     {
         STATUS_EXPANDED,
@@ -109,20 +112,30 @@ private:
     TreeView           (const TreeView&) = delete;
     TreeView& operator=(const TreeView&) = delete;
 
-    struct DirNodeImpl;
+    static constexpr uint32_t NO_STATS = std::numeric_limits<uint32_t>::max();
 
-    struct Container
+    struct FolderStats //subtree aggregates: calculated for *all* folders in parallel, patched by applyChanges()
     {
         uint64_t bytesGross = 0;
         uint64_t bytesNet   = 0; //bytes for files on view in this directory only
-        int itemCountGross  = 0;
+        int itemCountGross  = 0; //node is on view if > 0
         int itemCountNet    = 0; //number of files on view for in this directory only
+        int subDirCount     = 0; //number of sub folders on view
 
-        std::vector<DirNodeImpl> subDirs;
         FileSystemObject::ObjectId firstFileId = nullptr; //weak pointer to first FilePair or SymlinkPair
         //- "compress" algorithm may hide file nodes for directories with a single included file, i.e. itemCountGross == itemCountNet == 1
         //- a ContainerObject* would be a better fit, but we need weak pointer semantics!
         //- a std::vector<FileSystemObject::ObjectId> would be a better design, but we don't want a second memory structure as large as custom grid!
+
+        uint32_t parentIdx = NO_STATS; //NO_STATS for BaseFolderPair
+    };
+
+    struct DirNodeImpl;
+
+    struct Container
+    {
+        uint32_t statsIdx = NO_STATS;
+        std::vector<DirNodeImpl> subDirs; //lazy: created by getChildren() when node is expanded
     };
 
     struct DirNodeImpl : public Container
@@ -147,26 +160,66 @@ private:
     {
         unsigned int level = 0;
         int percent = 0; //[0, 100]
-        const Container* node = nullptr;     //
+        Container* node = nullptr;     //
         NodeType type = NodeType::root; //we increase size of "flatTree" using C-style types rather than have a polymorphic "folderCmpView"
     };
 
-    static void compressNode(Container& cont);
-    template <class Function>
-    static void extractVisibleSubtree(ContainerObject& conObj, Container& cont, Function includeObject);
-    void getChildren(const Container& cont, unsigned int level, std::vector<TreeLine>& output);
+    template <class Predicate> void calcFolderStats(uint32_t statsIdx, ContainerObject& conObj, Predicate pred);
+    uint32_t getStatsIdx(FileSystemObject::ObjectIdConst folderId) const;
+    uint32_t getStatsIdx(const BaseFolderPair* baseFolder) const;
+    static ContainerObject* getContainerObject(const TreeLine& line);
+
+    void getChildren(Container& cont, ContainerObject& conObj, unsigned int level, std::vector<TreeLine>& output);
     template <class Predicate> void updateView(Predicate pred);
+    std::vector<RootNodeImpl> createRootNodes();
     void applySubView(std::vector<RootNodeImpl>&& newView);
 
-    template <bool ascending> static void sortSingleLevel(std::vector<TreeLine>& items, ColumnTypeOverview columnType);
+    template <bool ascending> void sortSingleLevel(std::vector<TreeLine>& items, ColumnTypeOverview columnType) const;
     template <bool ascending> struct LessShortName;
 
+    struct DifferenceFilter
+    {
+        bool showExcluded;
+        bool leftOnlyFilesActive;
+        bool rightOnlyFilesActive;
+        bool leftNewerFilesActive;
+        bool rightNewerFilesActive;
+        bool differentFilesActive;
+        bool equalFilesActive;
+        bool conflictFilesActive;
+        bool operator==(const DifferenceFilter&) const = default;
+    };
+
+    struct ActionFilter
+    {
+        bool showExcluded;
+        bool syncCreateLeftActive;
+        bool syncCreateRightActive;
+        bool syncDeleteLeftActive;
+        bool syncDeleteRightActive;
+        bool syncDirOverwLeftActive;
+        bool syncDirOverwRightActive;
+        bool syncDirNoneActive;
+        bool syncEqualActive;
+        bool conflictFilesActive;
+        bool operator==(const ActionFilter&) const = default;
+    };
+
+    template <class FsItem> static bool matchesFilter(const FsItem& item, const DifferenceFilter& filter); //FsItem: FileSystemObject or FsObjectState
+    template <class FsItem> static bool matchesFilter(const FsItem& item, const ActionFilter&     filter); //
+    bool patchFolderStats(const HierarchyChanges& changes); //return false if full update is needed
+
     std::vector<TreeLine> flatTree_; //collapsable/expandable sub-tree of folderCmpView -> always sorted!
     /*             /|\
                     | (update...)
                     |                         */
     std::vector<RootNodeImpl> folderCmpView_; //partial view on folderCmp -> unsorted (cannot be, because files are not a separate entity)
     std::function<bool(const FileSystemObject& fsObj)> lastViewFilterPred_; //buffer view filter predicate for lazy evaluation of files/symlinks corresponding to a TYPE_FILES node
+    std::variant<std::monostate, DifferenceFilter, ActionFilter> lastViewFilter_; //monostate: folderCmpView_ needs full update
+
+    std::vector<FolderStats> folderStats_; //pre-order: BaseFolderPair followed by sub folders
+    std::vector<uint32_t> statsIdxBySlot_; //FolderPair's ObjectId slot index -> folderStats_ index
+    std::vector<uint32_t> rootStatsIdx_;   //folderCmp_ index -> folderStats_ index
     /*             /|\
                     | (update...)
                     |                         */
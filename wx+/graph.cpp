@@ -354,6 +354,81 @@ std::vector<CurvePoint> ContinuousCurveData::getPoints(double minX, double maxX,
 }
 
 
+void SampledCurveData::addSample(double x, double y)
+{
+    assert(( samples_.empty() && lastSample_.x == 0 && lastSample_.y == 0) ||
+           (!samples_.empty() && samples_.back().x <= lastSample_.x));
+
+    if (x < lastSample_.x) //x *required* to be monotonously ascending for std::partition_point
+    {
+        assert(false);
+        return;
+    }
+
+    lastSample_ = {x, y};
+
+    //handles duplicate inserts, too!
+    if (!samples_.empty() && x - samples_.back().x < minGapX_)
+        return;
+
+    samples_.push_back(lastSample_);
+
+    if (samples_.size() > samplesMax_) //limit buffer size: reduce resolution instead of dropping old samples
+    {
+        minGapX_ *= 2;
+
+        auto itOut = samples_.begin() + 1; //always keep first sample: start of x-range
+        for (auto it = itOut; it != samples_.end(); ++it)
+            if (it->x - itOut[-1].x >= minGapX_)
+                *itOut++ = *it;
+        samples_.erase(itOut, samples_.end());
+    }
+}
+
+
+std::pair<double, double> SampledCurveData::getRangeX() const
+{
+    if (samples_.empty())
+        return {};
+
+    return {samples_.front().x, //need not start with 0
+            lastSample_.x};
+}
+
+
+std::optional<CurvePoint> SampledCurveData::getLessEq(double x) const
+{
+    //--------- add artifical last sample value --------
+    if (!samples_.empty() && lastSample_.x <= x)
+        return lastSample_;
+    //--------------------------------------------------
+
+    //find first item > x, then go one step back:
+    auto it = std::partition_point(samples_.begin(), samples_.end(),
+    /*find first item for which "!pred"*/ [x](const CurvePoint& p) { return p.x <= x; });
+    if (it == samples_.begin())
+        return std::nullopt;
+    --it; //bound!
+    return *it;
+}
+
+
+std::optional<CurvePoint> SampledCurveData::getGreaterEq(double x) const
+{
+    //find first item >= x
+    const auto it = std::partition_point(samples_.begin(), samples_.end(),
+    /*find first item for which "!pred"*/ [x](const CurvePoint& p) { return p.x < x; });
+    if (it != samples_.end())
+        return *it;
+
+    //--------- add artifical last sample value --------
+    if (!samples_.empty() && x <= lastSample_.x)
+        return lastSample_;
+    //--------------------------------------------------
+    return std::nullopt;
+}
+
+
 std::vector<CurvePoint> SparseCurveData::getPoints(double minX, double maxX, const wxSize& areaSizePx) const
 {
     std::vector<CurvePoint> points;
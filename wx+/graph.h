@@ -102,6 +102,31 @@ private:
     std::vector<double> data_;
 };
 
+
+//samples with x monotonously ascending (e.g. elapsed time), memory bounded independent of x-range:
+//whenever "samplesMax" is exceeded, the minimum x-distance between samples is doubled and existing samples are thinned out accordingly
+class SampledCurveData : public SparseCurveData
+{
+public:
+    SampledCurveData(bool addSteps, double minGapX, size_t samplesMax) :
+        SparseCurveData(addSteps), minGapXInit_(minGapX), minGapX_(minGapX), samplesMax_(samplesMax) { assert(minGapX > 0 && samplesMax >= 2); }
+
+    void clear() { samples_.clear(); lastSample_ = {}; minGapX_ = minGapXInit_; }
+
+    void addSample(double x, double y);
+
+private:
+    std::pair<double, double> getRangeX() const override;
+    std::optional<CurvePoint> getLessEq   (double x) const override;
+    std::optional<CurvePoint> getGreaterEq(double x) const override;
+
+    std::vector<CurvePoint> samples_; //x: monotonously ascending!
+    CurvePoint lastSample_; //artificial record after end of samples: always show most recent value
+    const double minGapXInit_;
+    double minGapX_;
+    const size_t samplesMax_;
+};
+
 //------------------------------------------------------------------------------------------------------------
 
 struct LabelFormatter
@@ -7,6 +7,8 @@
 #include "grid.h"
 #include <cassert>
 #include <set>
+#include <list>
+#include <unordered_map>
 #include <chrono>
 #include <wx/settings.h>
 #include <wx/listbox.h>
@@ -33,6 +35,134 @@ wxColor GridData::getColorSelectionGradientTo  () { return {225, 234, 255}; } //
 int GridData::getColumnGapLeft() { return fastFromDIP(4); }
 
 
+namespace
+{
+/*  wxDC::GetTextExtent() dominates grid rendering (Pango text layout) and ellipsizing a cell text needs O(log n) of them
+    => remember extents and ellipsized texts across repaints, scroll steps and grids: bounded LRU, main thread only            */
+class TextExtentCache
+{
+public:
+    struct Key
+    {
+        std::wstring fontDesc;
+        std::wstring text;
+        int width = -1; //-1: extent of full text; else: ellipsized to fit
+        bool operator==(const Key&) const = default;
+    };
+    struct Value
+    {
+        wxSize extent;
+        std::wstring textTrunc; //ellipsized text (width >= 0 only)
+    };
+
+    const Value* find(const Key& key) //... and mark as hot
+    {
+        auto it = items_.find(key);
+        if (it == items_.end())
+            return nullptr;
+
+        lruList_.splice(lruList_.end(), lruList_, it->second.lruPos);
+        return &it->second.value;
+    }
+
+    const Value& insert(Key&& key, Value&& value)
+    {
+        if (items_.size() >= TEXT_EXTENT_CACHE_SIZE_MAX)
+        {
+            items_.erase(items_.find(*lruList_.front())); //evict least-recently used
+            lruList_.pop_front();
+        }
+        const auto [it, inserted] = items_.try_emplace(std::move(key), std::move(value));
+        assert(inserted);
+        if (inserted)
+            it->second.lruPos = lruList_.insert(lruList_.end(), &it->first); //references to unordered_map elements remain valid on rehash
+        return it->second.value;
+    }
+
+private:
+    static constexpr size_t TEXT_EXTENT_CACHE_SIZE_MAX = 10'000; //a few screens full of cells; long paths: ~10 MB worst case
+
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const
+        {
+            return std::hash<std::wstring>()(key.text) ^ (std::hash<std::wstring>()(key.fontDesc) * 31) ^ static_cast<size_t>(key.width);
+        }
+    };
+    struct Item
+    {
+        Item(Value&& v) : value(std::move(v)) {}
+        Value value;
+        std::list<const Key*>::iterator lruPos;
+    };
+
+    std::unordered_map<Key, Item, KeyHash> items_;
+    std::list<const Key*> lruList_; //front: least-recently used
+};
+
+TextExtentCache globalTextExtentCache; //no wxWidgets objects: safe to create statically
+
+
+inline std::wstring getFontDesc(wxDC& dc) { return copyStringTo<std::wstring>(dc.GetFont().GetNativeFontInfoDesc()); }
+
+
+wxSize getTextExtentBuffered(wxDC& dc, const std::wstring& fontDesc, const std::wstring& text)
+{
+    TextExtentCache::Key key{fontDesc, text};
+    if (const TextExtentCache::Value* val = globalTextExtentCache.find(key))
+        return val->extent;
+
+    const wxSize extent = dc.GetTextExtent(text);
+    globalTextExtentCache.insert(std::move(key), {extent, {}});
+    return extent;
+}
+
+
+TextExtentCache::Value ellipsizeText(wxDC& dc, const std::wstring& text, const wxSize& extent, int width)
+{
+    std::wstring textTrunc = text;
+    wxSize extentTrunc = extent;
+
+    //unlike Windows Explorer, we truncate UTF-16 correctly: e.g. CJK-Ideograph encodes to TWO wchar_t: utfTo<std::wstring>("\xf0\xa4\xbd\x9c");
+    size_t low  = 0;                   //number of Unicode chars!
+    size_t high = unicodeLength(text); //
+    if (high > 1)
+        for (;;)
+        {
+            if (high - low <= 1)
+            {
+                if (low == 0)
+                {
+                    textTrunc   = ELLIPSIS;
+                    extentTrunc = dc.GetTextExtent(ELLIPSIS);
+                }
+                break;
+            }
+            const size_t middle = (low + high) / 2; //=> never 0 when "high - low > 1"
+
+            const std::wstring candidate = getUnicodeSubstring(text, 0, middle) + ELLIPSIS;
+            const wxSize extentCand = dc.GetTextExtent(candidate); //perf: most expensive call of this routine!
+
+            if (extentCand.GetWidth() <= width)
+            {
+                low = middle;
+                textTrunc   = candidate;
+                extentTrunc = extentCand;
+            }
+            else
+                high = middle;
+        }
+    return {extentTrunc, std::move(textTrunc)};
+}
+}
+
+
+wxSize GridData::getTextExtentBuffered(wxDC& dc, const std::wstring& text)
+{
+    return ::getTextExtentBuffered(dc, getFontDesc(dc), text);
+}
+
+
 namespace
 {
 //------------------------------ Grid Parameters --------------------------------
@@ -129,7 +259,7 @@ void GridData::renderCell(wxDC& dc, const wxRect& rect, size_t row, ColumnType c
 
 int GridData::getBestSize(wxDC& dc, size_t row, ColumnType colType)
 {
-    return dc.GetTextExtent(getValue(row, colType)).GetWidth() + 2 * getColumnGapLeft() + fastFromDIP(1); //gap on left and right side + border
+    return getTextExtentBuffered(dc, getValue(row, colType)).GetWidth() + 2 * getColumnGapLeft() + fastFromDIP(1); //gap on left and right side + border
 }
 
 
@@ -149,7 +279,7 @@ wxRect GridData::drawCellBorder(wxDC& dc, const wxRect& rect) //returns remainin
 }
 
 
-void GridData::drawCellText(wxDC& dc, const wxRect& rect, const std::wstring& text, int alignment, const wxSize* textExtentHint)
+void GridData::drawCellText(wxDC& dc, const wxRect& rect, const std::wstring& text, int alignment)
 {
     /* Performance Notes (Windows):
         - wxDC::GetTextExtent() is by far the most expensive call (20x more expensive than wxDC::DrawText())
@@ -158,47 +288,27 @@ void GridData::drawCellText(wxDC& dc, const wxRect& rect, const std::wstring& te
         - wxDC::DrawText also calls wxDC::GetTextExtent()!!
         => wxDC::DrawLabel() boils down to 3(!) calls to wxDC::GetTextExtent()!!!
         - wxDC::DrawLabel results in GetTextExtent() call even for empty strings!!!
-        => NEVER EVER call wxDC::DrawLabel() cruft and directly call wxDC::DrawText()!                   */
+        => NEVER EVER call wxDC::DrawLabel() cruft and directly call wxDC::DrawText()!
+        => buffer GetTextExtent() results: see TextExtentCache                                          */
     assert(!contains(text, L'\n'));
     if (rect.width <= 0 || rect.height <= 0 || text.empty())
         return;
 
-    //truncate large texts and add ellipsis
-    wxString textTrunc = text;
-    wxSize extentTrunc = textExtentHint ? *textExtentHint : dc.GetTextExtent(text);
-    assert(!textExtentHint || *textExtentHint == dc.GetTextExtent(text)); //"trust, but verify" :>
+    const std::wstring fontDesc = getFontDesc(dc);
 
+    const std::wstring* textTrunc = &text;
+    wxSize extentTrunc = ::getTextExtentBuffered(dc, fontDesc, text);
+
+    //truncate large texts and add ellipsis
     if (extentTrunc.GetWidth() > rect.width)
     {
-        //unlike Windows Explorer, we truncate UTF-16 correctly: e.g. CJK-Ideograph encodes to TWO wchar_t: utfTo<std::wstring>("\xf0\xa4\xbd\x9c");
-        size_t low  = 0;                   //number of Unicode chars!
-        size_t high = unicodeLength(text); //
-        if (high > 1)
-            for (;;)
-            {
-                if (high - low <= 1)
-                {
-                    if (low == 0)
-                    {
-                        textTrunc   = ELLIPSIS;
-                        extentTrunc = dc.GetTextExtent(ELLIPSIS);
-                    }
-                    break;
-                }
-                const size_t middle = (low + high) / 2; //=> never 0 when "high - low > 1"
-
-                const wxString candidate = getUnicodeSubstring(text, 0, middle) + ELLIPSIS;
-                const wxSize extentCand = dc.GetTextExtent(candidate); //perf: most expensive call of this routine!
+        TextExtentCache::Key key{fontDesc, text, rect.width};
+        const TextExtentCache::Value* val = globalTextExtentCache.find(key);
+        if (!val)
+            val = &globalTextExtentCache.insert(std::move(key), ellipsizeText(dc, text, extentTrunc, rect.width));
 
-                if (extentCand.GetWidth() <= rect.width)
-                {
-                    low = middle;
-                    textTrunc   = candidate;
-                    extentTrunc = extentCand;
-                }
-                else
-                    high = middle;
-            }
+        textTrunc   = &val->textTrunc;
+        extentTrunc =  val->extent;
     }
 
     wxPoint pt = rect.GetTopLeft();
@@ -216,7 +326,7 @@ void GridData::drawCellText(wxDC& dc, const wxRect& rect, const std::wstring& te
     //if (extentTrunc.GetWidth() > rect.width)
     //    clip = std::make_unique<RecursiveDcClipper>(dc, rect);
 
-    dc.DrawText(textTrunc, pt);
+    dc.DrawText(*textTrunc, pt);
 }
 
 
@@ -122,8 +122,8 @@ public:
     static wxColor getColorSelectionGradientFrom();
     static wxColor getColorSelectionGradientTo();
 
-    static void drawCellText(wxDC& dc, const wxRect& rect, const std::wstring& text,
-                             int alignment = wxALIGN_LEFT | wxALIGN_CENTER_VERTICAL, const wxSize* textExtentHint = nullptr);
+    static void drawCellText(wxDC& dc, const wxRect& rect, const std::wstring& text, int alignment = wxALIGN_LEFT | wxALIGN_CENTER_VERTICAL);
+    static wxSize getTextExtentBuffered(wxDC& dc, const std::wstring& text); //wxDC::GetTextExtent() for the dc's current font; main thread only
     static wxRect drawCellBorder(wxDC& dc, const wxRect& rect); //returns inner rectangle
 
     static wxRect drawColumnLabelBackground(wxDC& dc, const wxRect& rect, bool highlighted); //returns inner rectangle
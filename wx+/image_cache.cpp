@@ -0,0 +1,155 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include "image_cache.h"
+#include <zen/file_io.h>
+#include <zen/file_access.h>
+#include <zen/serialize.h>
+#include <zen/extra_log.h>
+    #include <sys/mman.h>
+
+using namespace zen;
+
+
+namespace
+{
+/*  file format: header, table of contents (name, width, height), then rgb + alpha of each image in TOC order
+    => load() touches only the first few pages of the file                                                  */
+const int CACHE_FORMAT_VER = 2; //2: table of contents before image data
+const int IMAGE_SIZE_MAX = 16 * 1024; //width/height: don't trust sizes from disk
+}
+
+
+bool ImageDiskCache::load() //noexcept
+{
+    unmap();
+    index_.clear();
+    try
+    {
+        FileInputPlain fileIn(filePath_); //throw FileError, ErrorFileLocked
+        const size_t fileSize = fileIn.getStatBuffered().st_size; //throw FileError
+        if (fileSize == 0)
+            throw SysErrorUnexpectedEos();
+
+        void* mapped = ::mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fileIn.getHandle(), 0); //mapping remains valid after file is closed
+        if (mapped == MAP_FAILED)
+            THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(filePath_)), "mmap");
+        mapped_     = static_cast<const char*>(mapped);
+        mappedSize_ = fileSize;
+
+        MemoryStreamIn memIn(std::string_view(mapped_, mappedSize_));
+
+        if (readNumber<int32_t >(memIn) != CACHE_FORMAT_VER || //throw SysErrorUnexpectedEos
+            readNumber<int32_t >(memIn) != hqScale_ ||          //
+            readNumber<uint64_t>(memIn) != resourceHash_)       //
+        {
+            unmap();
+            return false;
+        }
+
+        const size_t count = readNumber<uint32_t>(memIn); //throw SysErrorUnexpectedEos
+
+        std::vector<std::pair<std::string, ImageEntry>> entries;
+        for (size_t i = 0; i < count; ++i)
+        {
+            const size_t nameLen = readNumber<uint32_t>(memIn); //throw SysErrorUnexpectedEos
+            if (nameLen > mappedSize_ - memIn.pos()) //don't trust size before allocating
+                throw SysErrorUnexpectedEos();
+            std::string imageName(nameLen, '\0');
+            readArray(memIn, imageName.data(), nameLen); //throw SysErrorUnexpectedEos
+
+            ImageEntry entry;
+            entry.width  = readNumber<int32_t>(memIn); //throw SysErrorUnexpectedEos
+            entry.height = readNumber<int32_t>(memIn); //
+            if (entry.width <= 0 || entry.width > IMAGE_SIZE_MAX || entry.height <= 0 || entry.height > IMAGE_SIZE_MAX)
+                throw SysErrorUnexpectedEos();
+
+            entries.emplace_back(std::move(imageName), entry);
+        }
+
+        size_t pos = memIn.pos();
+        for (auto& [imageName, entry] : entries)
+        {
+            const size_t imageBytes = static_cast<size_t>(entry.width) * entry.height * 4; //rgb + alpha
+            if (imageBytes > mappedSize_ - pos)
+                throw SysErrorUnexpectedEos();
+
+            entry.pos = pos;
+            pos += imageBytes;
+            index_.emplace(std::move(imageName), entry);
+        }
+        return true;
+    }
+    catch (FileError&) {} //not cached (yet)
+    catch (const SysError& e) { logExtraError(e.toString()); } //corrupted => will be overwritten
+
+    unmap();
+    index_.clear();
+    return false;
+}
+
+
+ImageHolder ImageDiskCache::getImage(const std::string& imageName) const
+{
+    auto it = index_.find(imageName);
+    if (it == index_.end())
+        return {};
+
+    const auto& [pos, width, height] = it->second;
+    const size_t pixelCount = static_cast<size_t>(width) * height; //no overflow/out of bounds: checked by load()
+
+    ImageHolder ih(width, height, true /*withAlpha*/);
+    std::memcpy(ih.getRgb  (), mapped_ + pos,                  pixelCount * 3);
+    std::memcpy(ih.getAlpha(), mapped_ + pos + pixelCount * 3, pixelCount);
+    return ih;
+}
+
+
+void ImageDiskCache::save(const std::vector<ImageRef>& images) //noexcept
+{
+    unmap(); //file is about to be replaced
+    index_.clear();
+
+    MemoryStreamOut memOut;
+    writeNumber<int32_t >(memOut, CACHE_FORMAT_VER);
+    writeNumber<int32_t >(memOut, hqScale_);
+    writeNumber<uint64_t>(memOut, resourceHash_);
+    writeNumber<uint32_t>(memOut, static_cast<uint32_t>(images.size()));
+
+    for (const ImageRef& img : images)
+    {
+        assert(img.rgb && img.alpha); //see convertToVanillaImage()
+        writeNumber<uint32_t>(memOut, static_cast<uint32_t>(img.name.size()));
+        writeArray(memOut, img.name.c_str(), img.name.size());
+        writeNumber<int32_t>(memOut, img.width);
+        writeNumber<int32_t>(memOut, img.height);
+    }
+    for (const ImageRef& img : images)
+    {
+        writeArray(memOut, img.rgb,   static_cast<size_t>(img.width) * img.height * 3);
+        writeArray(memOut, img.alpha, static_cast<size_t>(img.width) * img.height);
+    }
+    try
+    {
+        if (const std::optional<Zstring> parentPath = getParentFolderPath(filePath_))
+            createDirectoryIfMissingRecursion(*parentPath); //throw FileError
+
+        setFileContent(filePath_, memOut.ref(), nullptr /*notifyUnbufferedIO*/); //throw FileError
+    }
+    catch (const FileError& e) { logExtraError(e.toString()); }
+}
+
+
+void ImageDiskCache::unmap()
+{
+    if (mapped_)
+    {
+        [[maybe_unused]] const int rv = ::munmap(const_cast<char*>(mapped_), mappedSize_);
+        assert(rv == 0);
+        mapped_ = nullptr;
+        mappedSize_ = 0;
+    }
+}
@@ -0,0 +1,68 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef IMAGE_CACHE_H_7390184756201938475
+#define IMAGE_CACHE_H_7390184756201938475
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <zen/zstring.h>
+#include "image_holder.h"
+//DO NOT add any wx/wx+ includes! => used by FreeFileSync/Source/bench
+
+namespace zen
+{
+/*  xBRZ-scaled images persisted across application runs => warm starts skip xBRZ scaling altogether (see image_resources.cpp)
+    - single file: invalidated as a whole if resource archive (hash) or scale factor change
+    - memory-mapped: load() parses the table of contents only, images are copied out on first use
+        => no heap memory for images that are never shown, file pages are reclaimable             */
+class ImageDiskCache
+{
+public:
+    ImageDiskCache(const Zstring& filePath, int hqScale, uint64_t resourceHash) : filePath_(filePath), hqScale_(hqScale), resourceHash_(resourceHash) {}
+    ~ImageDiskCache() { unmap(); }
+
+    bool load(); //noexcept; false if missing or stale
+
+    ImageHolder getImage(const std::string& imageName) const; //empty if not cached
+
+    struct ImageRef
+    {
+        std::string name;
+        int width  = 0;
+        int height = 0;
+        const unsigned char* rgb   = nullptr;
+        const unsigned char* alpha = nullptr;
+    };
+    void save(const std::vector<ImageRef>& images); //noexcept
+
+    size_t getMappedSize() const { return mappedSize_; }
+
+private:
+    ImageDiskCache           (const ImageDiskCache&) = delete;
+    ImageDiskCache& operator=(const ImageDiskCache&) = delete;
+
+    void unmap();
+
+    const Zstring filePath_;
+    const int hqScale_;
+    const uint64_t resourceHash_;
+
+    const char* mapped_ = nullptr;
+    size_t mappedSize_ = 0;
+
+    struct ImageEntry
+    {
+        size_t pos = 0; //of rgb + alpha in mapped file
+        int width  = 0;
+        int height = 0;
+    };
+    std::unordered_map<std::string, ImageEntry> index_;
+};
+}
+
+#endif //IMAGE_CACHE_H_7390184756201938475
@@ -16,6 +16,7 @@
 #include <xBRZ/src/xbrz_tools.h>
 #include "image_tools.h"
 #include "image_holder.h"
+#include "image_cache.h"
 #include "dc.h"
 
 using namespace zen;
@@ -23,6 +24,15 @@ using namespace zen;
 
 namespace
 {
+inline
+wxImage toWxImage(ImageHolder&& ih)
+{
+    wxImage img(ih.getWidth(), ih.getHeight(), ih.releaseRgb(), false /*static_data*/); //pass ownership
+    img.SetAlpha(ih.releaseAlpha(), false /*static_data*/);
+    return img;
+}
+
+
 ImageHolder xbrzScale(int width, int height, const unsigned char* imageRgb, const unsigned char* imageAlpha, int hqScale)
 {
     assert(imageRgb && imageAlpha && width > 0 && height > 0); //see convertToVanillaImage()
@@ -109,12 +119,7 @@ public:
         protResult_.access([&](std::vector<std::pair<std::string, ImageHolder>>& result)
         {
             for (auto& [imageName, ih] : result)
-            {
-                wxImage img(ih.getWidth(), ih.getHeight(), ih.releaseRgb(), false /*static_data*/); //pass ownership
-                img.SetAlpha(ih.releaseAlpha(), false /*static_data*/);
-
-                output.emplace(imageName, std::move(img));
-            }
+                output.emplace(imageName, toWxImage(std::move(ih)));
         });
         return output;
     }
@@ -135,7 +140,7 @@ private:
 class ImageBuffer
 {
 public:
-    explicit ImageBuffer(const Zstring& filePath); //throw FileError
+    ImageBuffer(const Zstring& zipPath, const Zstring& cacheFolderPath /*optional*/); //throw FileError
 
     const wxImage& getImage(const std::string& name, int maxWidth /*optional*/, int maxHeight /*optional*/);
 
@@ -146,10 +151,13 @@ private:
     const wxImage& getRawImage   (const std::string& name);
     const wxImage& getScaledImage(const std::string& name);
 
+    std::unordered_map<std::string, std::string> pngStreams_; //decoded on first use (except for cold start xBRZ scaling)
     std::unordered_map<std::string, wxImage> imagesRaw_;
     std::unordered_map<std::string, wxImage> imagesScaled_;
 
+    int hqScale_ = 1;
     std::unique_ptr<HqParallelScaler> hqScaler_;
+    std::unique_ptr<ImageDiskCache> hqCache_;
 
     using OutImageKey = std::tuple<std::string /*name*/, int /*height*/>;
 
@@ -172,7 +180,7 @@ private:
 };
 
 
-ImageBuffer::ImageBuffer(const Zstring& zipPath) //throw FileError
+ImageBuffer::ImageBuffer(const Zstring& zipPath, const Zstring& cacheFolderPath /*optional*/) //throw FileError
 {
     std::vector<std::pair<Zstring /*file name*/, std::string /*byte stream*/>> streams;
 
@@ -211,33 +219,36 @@ ImageBuffer::ImageBuffer(const Zstring& zipPath) //throw FileError
     wxImage::AddHandler(new wxPNGHandler/*ownership passed*/); //activate support for .png files
 
     //do we need xBRZ scaling for high quality DPI images?
-    const int hqScale = std::clamp(numeric::intDivCeil(fastFromDIP(1000), 1000), 1, xbrz::SCALE_FACTOR_MAX);
+    hqScale_ = std::clamp(numeric::intDivCeil(fastFromDIP(1000), 1000), 1, xbrz::SCALE_FACTOR_MAX);
     //even for 125% DPI scaling, "2xBRZ + bilinear downscale" gives a better result than mere "125% bilinear upscale"!
-    if (hqScale > 1)
-        hqScaler_ = std::make_unique<HqParallelScaler>(hqScale);
+    if (hqScale_ > 1)
+    {
+        if (!cacheFolderPath.empty())
+        {
+            FNV1aHash<uint64_t> resourceHash;
+            for (const auto& [fileName, stream] : streams)
+            {
+                resourceHash.add(hashString<uint64_t>(fileName));
+                resourceHash.add(hashString<uint64_t>(stream));
+            }
+            hqCache_ = std::make_unique<ImageDiskCache>(appendPath(cacheFolderPath, beforeLast(getItemName(zipPath), Zstr('.'), IfNotFoundReturn::all) +
+                                                                   Zstr('@') + numberTo<Zstring>(hqScale_) + Zstr("x.cache")), hqScale_, resourceHash.get()); //e.g. "Icons@2x.cache"
+            if (!hqCache_->load()) //noexcept
+                hqScaler_ = std::make_unique<HqParallelScaler>(hqScale_); //cold start: scale everything in parallel, then save
+        }
+        else
+            hqScaler_ = std::make_unique<HqParallelScaler>(hqScale_);
+    }
 
-    for (const auto& [fileName, stream] : streams)
+    for (auto& [fileName, stream] : streams)
         if (endsWith(fileName, Zstr(".png")))
         {
-            wxMemoryInputStream wxstream(stream.c_str(), stream.size()); //stream does not take ownership of data
-
-            wxImage img(wxstream, wxBITMAP_TYPE_PNG);
-            assert(img.IsOk());
-
-            //end this alpha/no-alpha/mask/wxDC::DrawBitmap/RTL/high-contrast-scheme interoperability nightmare here and now!!!!
-            //=> there's only one type of wxImage: with alpha channel, no mask!!!
-            convertToVanillaImage(img);
-
             const std::string imageName = utfTo<std::string>(beforeLast(fileName, Zstr("."), IfNotFoundReturn::none));
+            pngStreams_.emplace(imageName, std::move(stream));
 
-            imagesRaw_.emplace(imageName, img);
             if (hqScaler_)
-                hqScaler_->add(imageName, img); //scale in parallel!
-            else
-                imagesScaled_.emplace(imageName, img);
-
-            //wxBitmap::NewFromPNGData(stream.c_str(), stream.size())?
-            //  => Windows: just a (slow!) wrapper for wxBitmap(wxImage())!
+                hqScaler_->add(imageName, getRawImage(imageName)); //scale in parallel!
+            //else: decode on first use; load scaled image from hqCache_ on first use
         }
         else
             assert(false);
@@ -250,6 +261,25 @@ const wxImage& ImageBuffer::getRawImage(const std::string& name)
         it != imagesRaw_.end())
         return it->second;
 
+    if (auto itPng = pngStreams_.find(name);
+        itPng != pngStreams_.end())
+    {
+        wxMemoryInputStream wxstream(itPng->second.c_str(), itPng->second.size()); //stream does not take ownership of data
+
+        wxImage img(wxstream, wxBITMAP_TYPE_PNG);
+        assert(img.IsOk());
+
+        //end this alpha/no-alpha/mask/wxDC::DrawBitmap/RTL/high-contrast-scheme interoperability nightmare here and now!!!!
+        //=> there's only one type of wxImage: with alpha channel, no mask!!!
+        convertToVanillaImage(img);
+
+        //wxBitmap::NewFromPNGData(stream.c_str(), stream.size())?
+        //  => Windows: just a (slow!) wrapper for wxBitmap(wxImage())!
+
+        pngStreams_.erase(itPng);
+        return imagesRaw_.emplace(name, std::move(img)).first->second;
+    }
+
     assert(false);
     return wxNullImage;
 }
@@ -264,14 +294,36 @@ const wxImage& ImageBuffer::getScaledImage(const std::string& name)
     {
         imagesScaled_ = hqScaler_->waitAndGetResult();
         hqScaler_.reset();
+
+        if (hqCache_)
+        {
+            std::vector<ImageDiskCache::ImageRef> images;
+            for (const auto& [imageName, img] : imagesScaled_)
+                images.push_back({imageName, img.GetWidth(), img.GetHeight(), img.GetData(), img.GetAlpha()});
+
+            hqCache_->save(images); //noexcept
+            hqCache_.reset(); //everything's in memory now
+        }
     }
+    if (hqScale_ == 1)
+        return getRawImage(name);
 
-    if (auto it = imagesScaled_.find(name);
-        it != imagesScaled_.end())
-        return it->second;
+    auto it = imagesScaled_.find(name);
+    if (it == imagesScaled_.end())
+    {
+        if (hqCache_)
+            if (ImageHolder ih = hqCache_->getImage(name))
+                it = imagesScaled_.emplace(name, toWxImage(std::move(ih))).first;
 
-    assert(false);
-    return wxNullImage;
+        if (it == imagesScaled_.end()) //not expected: cache is complete for current resources
+        {
+            const wxImage& rawImg = getRawImage(name);
+            if (!rawImg.IsOk())
+                return wxNullImage;
+            it = imagesScaled_.emplace(name, toWxImage(xbrzScale(rawImg.GetWidth(), rawImg.GetHeight(), rawImg.GetData(), rawImg.GetAlpha(), hqScale_))).first;
+        }
+    }
+    return it->second;
 }
 
 
@@ -310,11 +362,11 @@ std::unique_ptr<ImageBuffer> globalImageBuffer;
 }
 
 
-void zen::imageResourcesInit(const Zstring& zipPath) //throw FileError
+void zen::imageResourcesInit(const Zstring& zipPath, const Zstring& cacheFolderPath /*optional*/) //throw FileError
 {
     assert(runningOnMainThread()); //wxWidgets is not thread-safe!
     assert(!globalImageBuffer);
-    globalImageBuffer = std::make_unique<ImageBuffer>(zipPath); //throw FileError
+    globalImageBuffer = std::make_unique<ImageBuffer>(zipPath, cacheFolderPath); //throw FileError
 }
 
 
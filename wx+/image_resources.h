@@ -14,7 +14,8 @@
 namespace zen
 {
 //pass resources .zip file at application startup
-void imageResourcesInit(const Zstring& zipPath); //throw FileError
+//cacheFolderPath: keep xBRZ-scaled images for high-DPI across application runs
+void imageResourcesInit(const Zstring& zipPath, const Zstring& cacheFolderPath /*optional*/); //throw FileError
 void imageResourcesCleanup();
 
 const wxImage& loadImage(const std::string& name, int maxWidth /*optional*/, int maxHeight /*optional*/);
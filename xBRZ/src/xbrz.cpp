@@ -19,8 +19,12 @@
 #include <algorithm>
 #include <cassert>
 #include <cmath> //std::sqrt
+#include <cstring>
 #include <vector>
 #include "xbrz_tools.h"
+#if defined __x86_64__ //not __i386__: x87 excess precision would make the scalar path deviate from SSE/AVX results
+    #include <immintrin.h>
+#endif
 
 using namespace xbrz;
 
@@ -156,25 +160,19 @@ double distRGB(uint32_t pix1, uint32_t pix2)
 #endif
 
 
-inline
-double distYCbCr(uint32_t pix1, uint32_t pix2, double /*testAttribute*/)
-{
-    //https://en.wikipedia.org/wiki/YCbCr#ITU-R_BT.601_conversion
-    //Y'CbCr conversion is a matrix multiplication => take advantage of linearity by subtracting first!
-    //NOTE: input is gamma-encoded RGB! => what does this mean for the output distance!??
-    const int r_diff = static_cast<int>(getRed  (pix1)) - getRed  (pix2); //defer division by 255 to after matrix multiplication
-    const int g_diff = static_cast<int>(getGreen(pix1)) - getGreen(pix2); //
-    const int b_diff = static_cast<int>(getBlue (pix1)) - getBlue (pix2); //substraction for int is noticeable faster than for double!
+//const double k_b = 0.0722; //ITU-R BT.709 conversion
+//const double k_r = 0.2126; //
+constexpr double k_b = 0.0593; //ITU-R BT.2020 conversion
+constexpr double k_r = 0.2627; //
+constexpr double k_g = 1 - k_b - k_r;
 
-    //const double k_b = 0.0722; //ITU-R BT.709 conversion
-    //const double k_r = 0.2126; //
-    const double k_b = 0.0593; //ITU-R BT.2020 conversion
-    const double k_r = 0.2627; //
-    const double k_g = 1 - k_b - k_r;
+constexpr double scale_b = 0.5 / (1 - k_b);
+constexpr double scale_r = 0.5 / (1 - k_r);
 
-    const double scale_b = 0.5 / (1 - k_b);
-    const double scale_r = 0.5 / (1 - k_r);
 
+inline
+double distYCbCrDiff(int r_diff, int g_diff, int b_diff)
+{
     const double y   = k_r * r_diff + k_g * g_diff + k_b * b_diff; //[!], analog YCbCr!
     const double c_b = scale_b * (b_diff - y);
     const double c_r = scale_r * (r_diff - y);
@@ -184,34 +182,93 @@ double distYCbCr(uint32_t pix1, uint32_t pix2, double /*testAttribute*/)
 }
 
 
-inline
-double distYCbCrBuffered(uint32_t pix1, uint32_t pix2, double /*testAttribute*/)
+void fillDiffToDist(float* trg) //256 * 256 * 256 entries
 {
-    //30% perf boost compared to plain distYCbCr()!
-    //consumes 64 MB memory; using double is only 2% faster, but takes 128 MB
-    static const std::vector<float> diffToDist = []
+    for (uint32_t i = 0; i < 256 * 256 * 256; ++i) //startup time: 114 ms on Intel Core i5 (four cores)
     {
-        std::vector<float> tmp;
+        const int r_diff = static_cast<signed char>(getByte<2>(i)) * 2;
+        const int g_diff = static_cast<signed char>(getByte<1>(i)) * 2;
+        const int b_diff = static_cast<signed char>(getByte<0>(i)) * 2;
+
+        trg[i] = static_cast<float>(distYCbCrDiff(r_diff, g_diff, b_diff));
+    }
+}
+
+
+#if defined __x86_64__
+/*  AVX2 kernels: results must be bit-identical to the scalar code!
+    - same order of operations per lane; no "fma" target => no contraction of a * b + c
+    - sqrt, division and double -> float conversion are correctly rounded both ways
+    - truncation via _mm256_cvttpd_epi32 == static_cast<int>                                 */
+bool cpuHasAvx2 = __builtin_cpu_supports("avx2"); //non-const: FreeFileSync's bench/xbrz_bench.cpp compares against the scalar code paths
+
 
-        for (uint32_t i = 0; i < 256 * 256 * 256; ++i) //startup time: 114 ms on Intel Core i5 (four cores)
+__attribute__((target("avx2")))
+void fillDiffToDistAvx2(float* trg) //256 * 256 * 256 entries
+{
+    alignas(32) double bDiffs[256];
+    for (int b = 0; b < 256; ++b)
+        bDiffs[b] = static_cast<signed char>(b) * 2;
+
+    const __m256d vk_b     = _mm256_set1_pd(k_b);
+    const __m256d vscale_b = _mm256_set1_pd(scale_b);
+    const __m256d vscale_r = _mm256_set1_pd(scale_r);
+
+    for (int r = 0; r < 256; ++r)
+        for (int g = 0; g < 256; ++g)
         {
-            const int r_diff = static_cast<signed char>(getByte<2>(i)) * 2;
-            const int g_diff = static_cast<signed char>(getByte<1>(i)) * 2;
-            const int b_diff = static_cast<signed char>(getByte<0>(i)) * 2;
+            const int r_diff = static_cast<signed char>(r) * 2;
+            const int g_diff = static_cast<signed char>(g) * 2;
 
-            const double k_b = 0.0593; //ITU-R BT.2020 conversion
-            const double k_r = 0.2627; //
-            const double k_g = 1 - k_b - k_r;
+            const __m256d yRG   = _mm256_set1_pd(k_r * r_diff + k_g * g_diff);
+            const __m256d rDiff = _mm256_set1_pd(r_diff);
 
-            const double scale_b = 0.5 / (1 - k_b);
-            const double scale_r = 0.5 / (1 - k_r);
+            for (int b = 0; b < 256; b += 4, trg += 4)
+            {
+                const __m256d bDiff = _mm256_load_pd(bDiffs + b);
 
-            const double y   = k_r * r_diff + k_g * g_diff + k_b * b_diff; //[!], analog YCbCr!
-            const double c_b = scale_b * (b_diff - y);
-            const double c_r = scale_r * (r_diff - y);
+                const __m256d y   = _mm256_add_pd(yRG, _mm256_mul_pd(vk_b, bDiff));
+                const __m256d c_b = _mm256_mul_pd(vscale_b, _mm256_sub_pd(bDiff, y));
+                const __m256d c_r = _mm256_mul_pd(vscale_r, _mm256_sub_pd(rDiff, y));
 
-            tmp.push_back(static_cast<float>(std::sqrt(square(y) + square(c_b) + square(c_r))));
+                const __m256d dist = _mm256_sqrt_pd(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(y,   y),
+                                                                                 _mm256_mul_pd(c_b, c_b)),
+                                                                  /**/           _mm256_mul_pd(c_r, c_r)));
+                _mm_storeu_ps(trg, _mm256_cvtpd_ps(dist));
+            }
         }
+}
+#endif
+
+
+inline
+double distYCbCr(uint32_t pix1, uint32_t pix2, double /*testAttribute*/)
+{
+    //https://en.wikipedia.org/wiki/YCbCr#ITU-R_BT.601_conversion
+    //Y'CbCr conversion is a matrix multiplication => take advantage of linearity by subtracting first!
+    //NOTE: input is gamma-encoded RGB! => what does this mean for the output distance!??
+    const int r_diff = static_cast<int>(getRed  (pix1)) - getRed  (pix2); //defer division by 255 to after matrix multiplication
+    const int g_diff = static_cast<int>(getGreen(pix1)) - getGreen(pix2); //
+    const int b_diff = static_cast<int>(getBlue (pix1)) - getBlue (pix2); //substraction for int is noticeable faster than for double!
+
+    return distYCbCrDiff(r_diff, g_diff, b_diff);
+}
+
+
+inline
+double distYCbCrBuffered(uint32_t pix1, uint32_t pix2, double /*testAttribute*/)
+{
+    //30% perf boost compared to plain distYCbCr()!
+    //consumes 64 MB memory; using double is only 2% faster, but takes 128 MB
+    static const std::vector<float> diffToDist = []
+    {
+        std::vector<float> tmp(256 * 256 * 256);
+#if defined __x86_64__
+        if (cpuHasAvx2)
+            fillDiffToDistAvx2(tmp.data());
+        else
+#endif
+            fillDiffToDist(tmp.data());
         return tmp;
     }();
 
@@ -1148,6 +1205,115 @@ struct ColorGradientARGB
         pixBack = gradientARGB<M, N>(pixFront, pixBack);
     }
 };
+
+//------------------------------------------------------------------------------------
+
+#if defined __x86_64__
+__attribute__((target("avx2"))) inline
+__m256d loadBytesAvx2(uint32_t pix) //4 x unsigned char -> 4 x double
+{
+    return _mm256_cvtepi32_pd(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(static_cast<int>(pix))));
+}
+
+
+__attribute__((target("avx2"))) inline
+uint32_t demultiplyAvx2(__m128i pix /*b, g, r, a*/)
+{
+    const int a = _mm_extract_epi32(pix, 3);
+    if (a == 0)
+        return 0;
+
+    //same as demultiply(): (c * 255 + a / 2) / a; exact: numerator < 2^16 => quotient cannot round up to the next integer
+    const __m128i num = _mm_add_epi32(_mm_mullo_epi32(pix, _mm_set1_epi32(255)), _mm_set1_epi32(a / 2));
+
+    __m128i c = _mm256_cvttpd_epi32(_mm256_div_pd(_mm256_cvtepi32_pd(num), _mm256_set1_pd(a)));
+    c = _mm_min_epi32(c, _mm_set1_epi32(255));
+    c = _mm_insert_epi32(c, a, 3);
+
+    c = _mm_packus_epi32(c, c);
+    c = _mm_packus_epi16(c, c);
+    return static_cast<uint32_t>(_mm_cvtsi128_si32(c));
+}
+
+
+//same coefficients and order of operations as bilinearScaleSimple()
+__attribute__((target("avx2")))
+void bilinearScaleAvx2(const uint32_t* src /*premultiplied*/, int srcWidth, int srcHeight,
+                       /**/  uint32_t* trg, int trgWidth, int trgHeight)
+{
+    const double scaleX = static_cast<double>(trgWidth ) / srcWidth;
+    const double scaleY = static_cast<double>(trgHeight) / srcHeight;
+
+    struct CoeffsX
+    {
+        int     x1 = 0;
+        int     x2 = 0;
+        double xx1 = 0;
+        double x2x = 0;
+    };
+    std::vector<CoeffsX> buf(trgWidth);
+    for (int x = 0; x < trgWidth; ++x)
+    {
+        const int x1 = srcWidth * x / trgWidth;
+        int x2 = x1 + 1;
+        if (x2 == srcWidth)
+            --x2;
+
+        const double xx1 = x / scaleX - x1;
+        const double x2x = 1 - xx1;
+
+        buf[x] = {x1, x2, xx1, x2x};
+    }
+
+    const __m256d half = _mm256_set1_pd(0.5);
+
+    for (int y = 0; y < trgHeight; ++y)
+    {
+        const int y1 = srcHeight * y / trgHeight;
+        int y2 = y1 + 1;
+        if (y2 == srcHeight)
+            --y2;
+
+        const double yy1 = y / scaleY - y1;
+        const double y2y = 1 - yy1;
+
+        const uint32_t* const row1 = src + y1 * srcWidth;
+        const uint32_t* const row2 = src + y2 * srcWidth;
+
+        for (int x = 0; x < trgWidth; ++x)
+        {
+            const CoeffsX& bufX = buf[x];
+
+            const __m256d x2xy2y = _mm256_set1_pd(bufX.x2x * y2y);
+            const __m256d xx1y2y = _mm256_set1_pd(bufX.xx1 * y2y);
+            const __m256d x2xyy1 = _mm256_set1_pd(bufX.x2x * yy1);
+            const __m256d xx1yy1 = _mm256_set1_pd(bufX.xx1 * yy1);
+
+            __m256d c = _mm256_mul_pd(loadBytesAvx2(row1[bufX.x1]), x2xy2y);
+            c = _mm256_add_pd(c, _mm256_mul_pd(loadBytesAvx2(row1[bufX.x2]), xx1y2y));
+            c = _mm256_add_pd(c, _mm256_mul_pd(loadBytesAvx2(row2[bufX.x1]), x2xyy1));
+            c = _mm256_add_pd(c, _mm256_mul_pd(loadBytesAvx2(row2[bufX.x2]), xx1yy1));
+            c = _mm256_add_pd(c, half);
+
+            *trg++ = demultiplyAvx2(_mm256_cvttpd_epi32(c));
+        }
+    }
+}
+
+
+__attribute__((target("avx2")))
+void nearestNeighborRowAvx2(const uint32_t* srcRow, const int* xSrc, uint32_t* trg, int trgWidth)
+{
+    int x = 0;
+    for (; x + 8 <= trgWidth; x += 8)
+    {
+        const __m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(xSrc + x));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(trg + x), _mm256_i32gather_epi32(reinterpret_cast<const int*>(srcRow), idx, 4));
+    }
+    for (; x < trgWidth; ++x)
+        trg[x] = srcRow[xSrc[x]];
+}
+#endif
 }
 
 
@@ -1220,16 +1386,34 @@ bool xbrz::equalColorTest2(uint32_t col1, uint32_t col2, ColorFormat colFmt, dou
 void xbrz::bilinearScale(const uint32_t* src, int srcWidth, int srcHeight,
                          /**/  uint32_t* trg, int trgWidth, int trgHeight)
 {
-    const auto pixReader = [src, srcWidth](int x, int y, BytePixel& pix)
+    if (srcWidth <= 0 || srcHeight <= 0 || trgWidth <= 0 || trgHeight <= 0)
+        return;
+
+    //premultiply once instead of four times per target pixel
+    std::vector<uint32_t> srcPm(static_cast<size_t>(srcWidth) * srcHeight);
+    std::transform(src, src + srcPm.size(), srcPm.begin(), [](uint32_t pix)
+    {
+        const unsigned char a = getAlpha(pix);
+        return makePixel(a,
+                         xbrz::premultiply(getRed  (pix), a),
+                         xbrz::premultiply(getGreen(pix), a),
+                         xbrz::premultiply(getBlue (pix), a));
+    });
+
+#if defined __x86_64__
+    if (cpuHasAvx2)
+        return bilinearScaleAvx2(srcPm.data(), srcWidth, srcHeight, trg, trgWidth, trgHeight);
+#endif
+
+    const auto pixReader = [src = srcPm.data(), srcWidth](int x, int y, BytePixel& pix)
     {
         static_assert(sizeof(pix) == sizeof(*src));
         const uint32_t pixSrc = src[y * srcWidth + x];
 
-        const unsigned char a = getAlpha(pixSrc);
-        pix[0] = a;
-        pix[1] = xbrz::premultiply(getRed  (pixSrc), a); //r
-        pix[2] = xbrz::premultiply(getGreen(pixSrc), a); //g
-        pix[3] = xbrz::premultiply(getBlue (pixSrc), a); //b
+        pix[0] = getAlpha(pixSrc);
+        pix[1] = getRed  (pixSrc);
+        pix[2] = getGreen(pixSrc);
+        pix[3] = getBlue (pixSrc);
     };
 
     const auto pixWriter = [trg](const xbrz::BytePixel& pix) mutable
@@ -1249,16 +1433,34 @@ void xbrz::bilinearScale(const uint32_t* src, int srcWidth, int srcHeight,
 void xbrz::nearestNeighborScale(const uint32_t* src, int srcWidth, int srcHeight,
                                 /**/  uint32_t* trg, int trgWidth, int trgHeight)
 {
-    const auto imgReader = [src, srcWidth](int x, int y, BytePixel& pix)
-    {
-        static_assert(sizeof(pix) == sizeof(uint32_t));
-        std::memcpy(pix, src + y * srcWidth + x, sizeof(pix));
-    };
+    if (srcWidth <= 0 || srcHeight <= 0 || trgWidth <= 0 || trgHeight <= 0)
+        return;
+
+    //same source pixel selection as the generic nearestNeighborScale(), but calculated only once per column
+    std::vector<int> xSrc(trgWidth);
+    for (int x = 0; x < trgWidth; ++x)
+        xSrc[x] = srcWidth * x / trgWidth;
 
-    const auto imgWriter = [trg](const xbrz::BytePixel& pix) mutable { std::memcpy(trg++, pix, sizeof(pix)); };
+    int ySrcPrev = -1;
+    for (int y = 0; y < trgHeight; ++y, trg += trgWidth)
+    {
+        const int ySrc = srcHeight * y / trgHeight;
 
-    nearestNeighborScale(imgReader, srcWidth, srcHeight,
-                         imgWriter, trgWidth, trgHeight, 0, trgHeight);
+        if (ySrc == ySrcPrev) //upscaling: repeat previous row
+            std::memcpy(trg, trg - trgWidth, trgWidth * sizeof(*trg));
+        else
+        {
+            const uint32_t* const srcRow = src + ySrc * srcWidth;
+#if defined __x86_64__
+            if (cpuHasAvx2)
+                nearestNeighborRowAvx2(srcRow, xSrc.data(), trg, trgWidth);
+            else
+#endif
+                for (int x = 0; x < trgWidth; ++x)
+                    trg[x] = srcRow[xSrc[x]];
+        }
+        ySrcPrev = ySrc;
+    }
 }
 
 
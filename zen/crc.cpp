@@ -0,0 +1,175 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include "crc.h"
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstring>
+#if defined __x86_64__ || defined __i386__
+    #include <immintrin.h>
+#elif defined __ARM_FEATURE_CRC32
+    #include <arm_acle.h>
+#endif
+
+using namespace zen;
+
+
+namespace
+{
+//slicing-by-8: https://create.stephan-brumme.com/crc32/#slicing-by-8-overview
+constexpr auto crc32Slices = []
+{
+    std::array<std::array<uint32_t, 256>, 8> slices{};
+    for (size_t i = 0; i < 256; ++i)
+        slices[0][i] = impl::crc32Table[i];
+
+    for (size_t k = 1; k < slices.size(); ++k)
+        for (size_t i = 0; i < 256; ++i)
+            slices[k][i] = (slices[k - 1][i] >> 8) ^ slices[0][slices[k - 1][i] & 0xFF];
+    return slices;
+}();
+
+
+inline uint32_t loadLittleEndian32(const unsigned char* p)
+{
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    if constexpr (std::endian::native == std::endian::big)
+        v = std::byteswap(v);
+    return v;
+}
+
+
+uint32_t crc32Slicing8(uint32_t crc, const unsigned char* p, size_t len)
+{
+    const auto& t = crc32Slices;
+
+    for (; len >= 8; p += 8, len -= 8)
+    {
+        const uint32_t lo = loadLittleEndian32(p) ^ crc;
+        const uint32_t hi = loadLittleEndian32(p + 4);
+
+        crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+              t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+    }
+
+    for (; len > 0; ++p, --len)
+        crc = (crc >> 8) ^ t[0][(crc ^ *p) & 0xFF];
+    return crc;
+}
+
+
+#if defined __x86_64__ || defined __i386__
+/*  carry-less multiplication folding: "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction", Intel 2009
+    constants: zlib/Chromium crc32_simd.c                                                                                    */
+__attribute__((target("pclmul,sse4.1"))) inline
+__m128i loadBlock(const unsigned char* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+
+
+__attribute__((target("pclmul,sse4.1"))) inline
+__m128i foldBlock(__m128i x, __m128i k, __m128i next) { return _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x11), _mm_clmulepi64_si128(x, k, 0x00)), next); }
+
+
+__attribute__((target("pclmul,sse4.1")))
+uint32_t crc32Pclmul(uint32_t crc, const unsigned char* p, size_t len) //precondition: len >= 64 && len % 16 == 0
+{
+    assert(len >= 64 && len % 16 == 0);
+
+    alignas(16) static constexpr uint64_t k1k2[] = {0x0154442bd4, 0x01c6e41596};
+    alignas(16) static constexpr uint64_t k3k4[] = {0x01751997d0, 0x00ccaa009e};
+    alignas(16) static constexpr uint64_t k5k0[] = {0x0163cd6124, 0x0000000000};
+    alignas(16) static constexpr uint64_t poly[] = {0x01db710641, 0x01f7011641};
+
+    __m128i x1 = _mm_xor_si128(loadBlock(p), _mm_cvtsi32_si128(static_cast<int>(crc)));
+    __m128i x2 = loadBlock(p + 0x10);
+    __m128i x3 = loadBlock(p + 0x20);
+    __m128i x4 = loadBlock(p + 0x30);
+    p   += 64;
+    len -= 64;
+
+    //fold 4 x 128 bits in parallel
+    __m128i k = _mm_load_si128(reinterpret_cast<const __m128i*>(k1k2));
+
+    for (; len >= 64; p += 64, len -= 64)
+    {
+        x1 = foldBlock(x1, k, loadBlock(p));
+        x2 = foldBlock(x2, k, loadBlock(p + 0x10));
+        x3 = foldBlock(x3, k, loadBlock(p + 0x20));
+        x4 = foldBlock(x4, k, loadBlock(p + 0x30));
+    }
+
+    //fold into 128 bits
+    k = _mm_load_si128(reinterpret_cast<const __m128i*>(k3k4));
+
+    x1 = foldBlock(x1, k, x2);
+    x1 = foldBlock(x1, k, x3);
+    x1 = foldBlock(x1, k, x4);
+
+    for (; len >= 16; p += 16, len -= 16)
+        x1 = foldBlock(x1, k, loadBlock(p));
+
+    //fold 128 bits to 64 bits
+    const __m128i mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), _mm_clmulepi64_si128(x1, k, 0x10));
+
+    k = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(k5k0));
+    x1 = _mm_xor_si128(_mm_clmulepi64_si128(_mm_and_si128(x1, mask32), k, 0x00), _mm_srli_si128(x1, 4));
+
+    //Barrett reduction to 32 bits
+    k = _mm_load_si128(reinterpret_cast<const __m128i*>(poly));
+
+    __m128i xr = _mm_clmulepi64_si128(_mm_and_si128(x1, mask32), k, 0x10);
+    xr = _mm_clmulepi64_si128(_mm_and_si128(xr, mask32), k, 0x00);
+    x1 = _mm_xor_si128(x1, xr);
+
+    return static_cast<uint32_t>(_mm_extract_epi32(x1, 1));
+}
+
+
+const bool cpuHasPclmul = __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
+
+#elif defined __ARM_FEATURE_CRC32
+uint32_t crc32Armv8(uint32_t crc, const unsigned char* p, size_t len) //same polynomial as zlib: "crc32*", not "crc32c*"
+{
+    for (; len >= 8; p += 8, len -= 8)
+    {
+        uint64_t v;
+        std::memcpy(&v, p, sizeof(v));
+        crc = __crc32d(crc, v);
+    }
+    for (; len > 0; ++p, --len)
+        crc = __crc32b(crc, *p);
+    return crc;
+}
+#endif
+}
+
+
+uint32_t zen::impl::updateCrc32(uint32_t crc, const void* buffer, size_t bytesCount)
+{
+    auto p = static_cast<const unsigned char*>(buffer);
+
+#if defined __x86_64__ || defined __i386__
+    if (bytesCount >= 64 && cpuHasPclmul) //small inputs (e.g. GUIDs): not worth it
+    {
+        const size_t blockBytes = bytesCount & ~static_cast<size_t>(15);
+        crc = crc32Pclmul(crc, p, blockBytes);
+        p          += blockBytes;
+        bytesCount -= blockBytes;
+    }
+#elif defined __ARM_FEATURE_CRC32
+    return crc32Armv8(crc, p, bytesCount);
+#endif
+    return crc32Slicing8(crc, p, bytesCount);
+}
+
+
+uint32_t zen::impl::updateCrc32Slicing8(uint32_t crc, const void* buffer, size_t bytesCount)
+{
+    return crc32Slicing8(crc, static_cast<const unsigned char*>(buffer), bytesCount);
+}
@@ -7,7 +7,14 @@
 #ifndef ERROR_LOG_H_8917590832147915
 #define ERROR_LOG_H_8917590832147915
 
+#include <algorithm>
+#include <bit>
 #include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <numeric>
 #include <vector>
 #include "time.h"
 #include "i18n.h"
@@ -27,15 +34,106 @@ struct LogEntry
 {
     time_t      time = 0;
     MessageType type = MSG_TYPE_ERROR;
-    Zstringc message; //conserve memory (=> avoid std::string SSO overhead!)
+    std::string_view message; //UTF-8; references ErrorLog's message storage => valid as long as the log is
 };
 
 std::string formatMessage(const LogEntry& entry);
 
-using ErrorLog = std::vector<LogEntry>;
+
+/*  append-only log with columnar storage: think multi-million entries for long batch runs
+    - time/type/message id in separate arrays: 13 bytes per entry
+    - message texts in a chunked arena: no per-message heap allocation
+    - identical message texts (e.g. retries, repeated warnings) are stored once:
+        open-addressed table of message ids, hash + text compared in the arena => 24-32 bytes per unique message + text
+    - bounded memory for batch runs: see LogSpool (FreeFileSync/Source/log_file.h)                            */
+class ErrorLog
+{
+public:
+    ErrorLog() {}
+    ErrorLog(const ErrorLog& other) { append(other); } //message views must reference *our* arena!
+    ErrorLog(ErrorLog&& tmp) noexcept { swap(tmp); } //arena chunks don't move in memory
+    ErrorLog& operator=(const ErrorLog& other) { return *this = ErrorLog(other); }
+    ErrorLog& operator=(ErrorLog&& tmp) noexcept { swap(tmp); return *this; }
+
+    void swap(ErrorLog& other) noexcept
+    {
+        times_       .swap(other.times_);
+        types_       .swap(other.types_);
+        msgIds_      .swap(other.msgIds_);
+        messages_    .swap(other.messages_);
+        msgIdTable_  .swap(other.msgIdTable_);
+        msgArena_    .swap(other.msgArena_);
+        std::swap(msgArenaChunkUsed_, other.msgArenaChunkUsed_);
+    }
+
+    void push_back(const LogEntry& entry);
+    void append(const ErrorLog& other) { for (const LogEntry& entry : other) push_back(entry); }
+
+    void sortByTime(); //stable!
+
+    size_t size() const { return times_.size(); }
+    bool  empty() const { return times_.empty(); }
+
+    LogEntry operator[](size_t pos) const
+    {
+        assert(pos < size());
+        return {times_[pos], static_cast<MessageType>(types_[pos]), getMessage(msgIds_[pos])};
+    }
+
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::input_iterator_tag; //proxy iterator: no LogEntry& to hand out
+        using value_type        = LogEntry;
+        using difference_type   = ptrdiff_t;
+        using pointer           = void;
+        using reference         = LogEntry;
+
+        const_iterator() {}
+        const_iterator(const ErrorLog& log, size_t pos) : log_(&log), pos_(pos) {}
+
+        LogEntry operator*() const { return (*log_)[pos_]; }
+
+        const_iterator& operator++() { ++pos_; return *this; }
+        const_iterator  operator++(int) { const_iterator tmp = *this; ++pos_; return tmp; }
+
+        const_iterator operator+(ptrdiff_t offset) const { return {*log_, pos_ + offset}; }
+        ptrdiff_t operator-(const const_iterator& other) const { return static_cast<ptrdiff_t>(pos_ - other.pos_); }
+
+        bool operator==(const const_iterator& other) const { assert(log_ == other.log_); return pos_ == other.pos_; }
+
+    private:
+        const ErrorLog* log_ = nullptr;
+        size_t pos_ = 0;
+    };
+
+    const_iterator begin() const { return {*this, 0}; }
+    const_iterator end  () const { return {*this, size()}; }
+
+private:
+    uint32_t internMessage(std::string_view msg);
+    std::string_view getMessage(uint32_t msgId) const;
+    uint32_t getMessageHash(uint32_t msgId) const;
+    void rehashMessages(size_t tableSize);
+
+    std::vector<time_t>   times_;
+    std::vector<uint8_t>  types_;  //MessageType
+    std::vector<uint32_t> msgIds_; //index into messages_
+
+    std::vector<const char*> messages_; //unique message texts in msgArena_: uint32_t hash, uint32_t length, UTF-8 bytes
+
+    static constexpr uint32_t MSG_ID_NONE = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> msgIdTable_; //open addressing, linear probing: size is power of 2, load factor <= 1/2
+
+    static constexpr size_t ARENA_CHUNK_SIZE = 64 * 1024;
+    std::vector<std::unique_ptr<char[]>> msgArena_;
+    size_t msgArenaChunkUsed_ = ARENA_CHUNK_SIZE;
+};
 
 void logMsg(ErrorLog& log, const std::wstring& msg, MessageType type, time_t time = std::time(nullptr));
 
+inline void append(ErrorLog& log, const ErrorLog& other) { log.append(other); }
+
 struct ErrorLogStats
 {
     int info    = 0;
@@ -51,10 +149,122 @@ ErrorLogStats getStats(const ErrorLog& log);
 
 
 //######################## implementation ##########################
+inline
+std::string_view ErrorLog::getMessage(uint32_t msgId) const
+{
+    const char* const msgStored = messages_[msgId];
+    uint32_t msgLen = 0;
+    std::memcpy(&msgLen, msgStored + sizeof(uint32_t), sizeof(msgLen)); //arena is unaligned
+    return {msgStored + 2 * sizeof(uint32_t), msgLen};
+}
+
+
+inline
+uint32_t ErrorLog::getMessageHash(uint32_t msgId) const
+{
+    uint32_t msgHash = 0;
+    std::memcpy(&msgHash, messages_[msgId], sizeof(msgHash));
+    return msgHash;
+}
+
+
+inline
+void ErrorLog::rehashMessages(size_t tableSize)
+{
+    assert(std::has_single_bit(tableSize));
+    msgIdTable_.assign(tableSize, MSG_ID_NONE);
+
+    for (uint32_t msgId = 0; msgId < messages_.size(); ++msgId) //arena order: sequential memory access
+        for (size_t i = getMessageHash(msgId);; ++i)
+            if (uint32_t& slot = msgIdTable_[i & (tableSize - 1)];
+                slot == MSG_ID_NONE)
+            {
+                slot = msgId;
+                break;
+            }
+}
+
+
+inline
+uint32_t ErrorLog::internMessage(std::string_view msg)
+{
+    if (2 * (messages_.size() + 1) > msgIdTable_.size())
+        rehashMessages(std::max<size_t>(msgIdTable_.size() * 2, 64));
+
+    const uint32_t msgHash = static_cast<uint32_t>(std::hash<std::string_view>()(msg));
+    const size_t tableMask = msgIdTable_.size() - 1;
+    size_t i = msgHash;
+    for (;; ++i)
+        if (const uint32_t msgId = msgIdTable_[i & tableMask];
+            msgId == MSG_ID_NONE)
+            break;
+        else if (getMessageHash(msgId) == msgHash && getMessage(msgId) == msg)
+            return msgId;
+
+    const size_t bytesNeeded = 2 * sizeof(uint32_t) + msg.size();
+    char* msgStored = nullptr;
+    if (bytesNeeded > ARENA_CHUNK_SIZE / 4) //outlier: dedicated chunk inserted *before* the current one, so that the latter is still filled up
+        msgStored = msgArena_.insert(msgArena_.empty() ? msgArena_.end() : msgArena_.end() - 1, std::make_unique<char[]>(bytesNeeded))->get();
+    else
+    {
+        if (ARENA_CHUNK_SIZE - msgArenaChunkUsed_ < bytesNeeded)
+        {
+            msgArena_.push_back(std::make_unique<char[]>(ARENA_CHUNK_SIZE));
+            msgArenaChunkUsed_ = 0;
+        }
+        msgStored = msgArena_.back().get() + msgArenaChunkUsed_;
+        msgArenaChunkUsed_ += bytesNeeded;
+    }
+    const uint32_t msgLen = static_cast<uint32_t>(msg.size());
+    std::memcpy(msgStored,                        &msgHash, sizeof(msgHash));
+    std::memcpy(msgStored +     sizeof(uint32_t), &msgLen,  sizeof(msgLen));
+    std::memcpy(msgStored + 2 * sizeof(uint32_t), msg.data(), msg.size());
+
+    const uint32_t msgId = static_cast<uint32_t>(messages_.size());
+    messages_.push_back(msgStored);
+    msgIdTable_[i & tableMask] = msgId;
+    return msgId;
+}
+
+
+inline
+void ErrorLog::push_back(const LogEntry& entry)
+{
+    const uint32_t msgId = internMessage(entry.message);
+    times_ .push_back(entry.time);
+    types_ .push_back(static_cast<uint8_t>(entry.type));
+    msgIds_.push_back(msgId);
+}
+
+
+inline
+void ErrorLog::sortByTime()
+{
+    if (std::is_sorted(times_.begin(), times_.end())) //the common case: nothing to do
+        return;
+
+    std::vector<size_t> order(size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) { return times_[lhs] < times_[rhs]; });
+
+    auto permute = [&](auto& column)
+    {
+        std::remove_reference_t<decltype(column)> tmp;
+        tmp.reserve(column.size());
+        for (const size_t pos : order)
+            tmp.push_back(column[pos]);
+        column.swap(tmp);
+    };
+    permute(times_);
+    permute(types_);
+    permute(msgIds_);
+}
+
+
 inline
 void logMsg(ErrorLog& log, const std::wstring& msg, MessageType type, time_t time)
 {
-    log.push_back({time, type, utfTo<Zstringc>(msg)});
+    log.push_back({time, type, utfTo<std::string>(msg)});
 }
 
 
@@ -103,8 +313,7 @@ std::string formatMessage(const LogEntry& entry)
     std::string msgFmt = '[' + utfTo<std::string>(formatTime(formatTimeTag, getLocalTime(entry.time))) + "]  " + utfTo<std::string>(getMessageTypeLabel(entry.type)) + ":  ";
     const size_t prefixLen = unicodeLength(msgFmt); //consider Unicode!
 
-    const Zstringc msg = trimCpy(entry.message);
-    static_assert(std::is_same_v<decltype(msg), const Zstringc>, "no worries about copying as long as we're using a ref-counted string!");
+    const std::string_view msg = trimCpy(entry.message);
     assert(msg == entry.message); //trimming shouldn't be needed usually!?
 
     for (auto it = msg.begin(); it != msg.end(); )
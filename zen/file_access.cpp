@@ -649,8 +649,11 @@ void zen::copySymlink(const Zstring& sourcePath, const Zstring& targetPath) //th
 
 
 FileCopyResult zen::copyNewFile(const Zstring& sourceFile, const Zstring& targetFile, //throw FileError, ErrorTargetExisting, (ErrorFileLocked), X
+                                size_t blockMultiplierIn, size_t blockMultiplierOut,
                                 const IoCallback& notifyUnbufferedIO /*throw X*/)
 {
+    assert(blockMultiplierIn > 0 && blockMultiplierOut > 0);
+
     int64_t totalBytesNotified = 0;
     IOCallbackDivider notifyIoDiv(notifyUnbufferedIO, totalBytesNotified);
 
@@ -681,21 +684,25 @@ FileCopyResult zen::copyNewFile(const Zstring& sourceFile, const Zstring& target
     //preallocate disk space + reduce fragmentation
     fileOut.reserveSpace(sourceInfo.st_size); //throw FileError
 
+    const size_t blockSizeOut = fileOut.getBlockSize(); //throw FileError
+
     unbufferedStreamCopy([&](void* buffer, size_t bytesToRead)
     {
         const size_t bytesRead = fileIn.tryRead(buffer, bytesToRead); //throw FileError, (ErrorFileLocked)
         notifyIoDiv(bytesRead); //throw X
         return bytesRead;
     },
-    fileIn.getBlockSize() /*throw FileError*/,
+    fileIn.getBlockSize() /*throw FileError*/ * blockMultiplierIn,
 
     [&](const void* buffer, size_t bytesToWrite)
     {
+        if (bytesToWrite > blockSizeOut) //last block with tuned block size: FileOutputPlain::tryWrite() still expects multiples of st_blksize
+            bytesToWrite -= bytesToWrite % blockSizeOut;
         const size_t bytesWritten = fileOut.tryWrite(buffer, bytesToWrite); //throw FileError
         notifyIoDiv(bytesWritten); //throw X
         return bytesWritten;
     },
-    fileOut.getBlockSize() /*throw FileError*/); //throw FileError, X
+    blockSizeOut * blockMultiplierOut); //throw FileError, X
 
     //possible improvement: copy_file_range() performs an in-kernel copy: https://github.com/coreutils/coreutils/blob/17479ef60c8edbd2fe8664e31a7f69704f0cd221/src/copy.c#L342
 
@@ -93,6 +93,7 @@ struct FileCopyResult
 };
 
 FileCopyResult copyNewFile(const Zstring& sourceFile, const Zstring& targetFile, //throw FileError, ErrorTargetExisting, ErrorFileLocked, X
+                           size_t blockMultiplierIn, size_t blockMultiplierOut, //tuned I/O sizes: multiples of the file systems' block sizes
                            //accummulated delta != file size! consider ADS, sparse, compressed files
                            const IoCallback& notifyUnbufferedIO /*throw X*/);
 }
@@ -8,6 +8,7 @@
 
     #include <libcurl/curl_wrap.h> //DON'T include <curl/curl.h> directly!
     #include "stream_buffer.h"
+    #include "thread.h"
 
 using namespace zen;
 
@@ -871,3 +871,57 @@ std::string zen::convertPuttyKeyToPkix(const std::string_view keyStream, const s
         - ecdsa-sha2-nistp384-cert-v01@openssh.com
         - ecdsa-sha2-nistp521-cert-v01@openssh.com     */
 }
+
+
+class Sha256Stream::Impl
+{
+public:
+    Impl() //throw SysError
+    {
+        if (!mdctx_)
+            throw SysError(formatSystemError("EVP_MD_CTX_new", L"", L"No more error details.")); //no more error details
+
+        if (::EVP_DigestInit(mdctx_,             //EVP_MD_CTX* ctx
+                             EVP_sha256()) != 1) //const EVP_MD* type
+            throw SysError(formatLastOpenSSLError("EVP_DigestInit"));
+    }
+
+    ~Impl() { ::EVP_MD_CTX_free(mdctx_); }
+
+    void update(const void* buffer, size_t bytesToHash) //throw SysError
+    {
+        if (::EVP_DigestUpdate(mdctx_,             //EVP_MD_CTX* ctx
+                               buffer,             //const void*
+                               bytesToHash) != 1)  //size_t cnt);
+            throw SysError(formatLastOpenSSLError("EVP_DigestUpdate"));
+    }
+
+    std::string finalize() //throw SysError
+    {
+        std::string output(EVP_MAX_MD_SIZE, '\0');
+        unsigned int bytesWritten = 0;
+
+        if (::EVP_DigestFinal_ex(mdctx_,                                          //EVP_MD_CTX* ctx
+                                 reinterpret_cast<unsigned char*>(output.data()), //unsigned char* md
+                                 &bytesWritten) != 1)                             //unsigned int* s
+            throw SysError(formatLastOpenSSLError("EVP_DigestFinal_ex"));
+
+        output.resize(bytesWritten);
+        return output;
+    }
+
+private:
+    Impl           (const Impl&) = delete;
+    Impl& operator=(const Impl&) = delete;
+
+    EVP_MD_CTX* const mdctx_ = ::EVP_MD_CTX_new();
+};
+
+
+zen::Sha256Stream::Sha256Stream() : pimpl_(std::make_unique<Impl>()) {} //throw SysError
+
+zen::Sha256Stream::~Sha256Stream() {}
+
+void zen::Sha256Stream::update(const void* buffer, size_t bytesToHash) { pimpl_->update(buffer, bytesToHash); } //throw SysError
+
+std::string zen::Sha256Stream::finalize() { return pimpl_->finalize(); } //throw SysError
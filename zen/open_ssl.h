@@ -35,6 +35,21 @@ std::string convertRsaKey(const std::string_view keyStream, RsaStreamType typeFr
 
 bool isPuttyKeyStream(const std::string_view keyStream);
 std::string convertPuttyKeyToPkix(const std::string_view keyStream, const std::string_view passphrase); //throw SysError
+
+
+class Sha256Stream //incremental SHA-256: e.g. hash file content while reading
+{
+public:
+    Sha256Stream(); //throw SysError
+    ~Sha256Stream();
+
+    void update(const void* buffer, size_t bytesToHash); //throw SysError
+    std::string finalize(); //throw SysError; raw 32 bytes, call once!
+
+private:
+    class Impl;
+    const std::unique_ptr<Impl> pimpl_;
+};
 }
 
 #endif //OPEN_SSL_H_801974580936508934568792347506
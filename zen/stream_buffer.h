@@ -7,10 +7,12 @@
 #ifndef STREAM_BUFFER_H_08492572089560298
 #define STREAM_BUFFER_H_08492572089560298
 
-#include <condition_variable>
-#include "ring_buffer.h"
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include "scope_guard.h"
 #include "string_tools.h"
-#include "thread.h"
 
 
 namespace zen
@@ -19,24 +21,29 @@ namespace zen
         + curl uses READBUFFER_SIZE download buffer size, but returns via a retarded sendf.c::chop_write() writing in small junks of CURL_MAX_WRITE_SIZE (16 kB)
         => support copying arbitrarily-large files: https://freefilesync.org/forum/viewtopic.php?t=4471
         => maximum performance through async processing (prefetching + output buffer!)
-        => cost per worker thread creation ~ 1/20 ms                                         */
+        => cost per worker thread creation ~ 1/20 ms
+
+    single producer (output thread), single consumer (input thread) => lock-free ring buffer:
+        - each side owns one position: no lock for reading/writing data
+        - blocking only if buffer is empty/full: std::atomic::wait() on an event counter
+        - notify only if other side is actually waiting; a full buffer waits for a larger chunk of free space => batched wakeups  */
 class AsyncStreamBuffer
 {
 public:
-    explicit AsyncStreamBuffer(size_t capacity) { ringBuf_.reserve(capacity); }
+    explicit AsyncStreamBuffer(size_t capacity) :
+        capacity_(std::max<size_t>(capacity, 1)),
+        buffer_(std::make_unique<std::byte[]>(capacity_)) {}
 
     //context of input thread, blocking
     size_t read(void* buffer, size_t bytesToRead) //throw <write error>; return "bytesToRead" bytes unless end of stream!
     {
-        std::unique_lock dummy(lockStream_);
         const auto bufStart = buffer;
 
         while (bytesToRead > 0)
         {
-            const size_t bytesRead = tryReadImpl(dummy, buffer, bytesToRead); //throw <write error>
+            const size_t bytesRead = tryRead(buffer, bytesToRead); //throw <write error>
             if (bytesRead == 0) //end of file
                 break;
-            conditionBytesRead_.notify_all();
             buffer = static_cast<std::byte*>(buffer) + bytesRead;
             bytesToRead -= bytesRead;
         }
@@ -47,24 +54,47 @@ public:
     //context of input thread, blocking
     size_t tryRead(void* buffer, size_t bytesToRead) //throw <write error>; may return short; only 0 means EOF! CONTRACT: bytesToRead > 0!
     {
-        size_t bytesRead = 0;
+        if (bytesToRead == 0) //"read() with a count of 0 returns zero" => indistinguishable from end of file! => check!
+            throw std::logic_error(std::string(__FILE__) + '[' + numberTo<std::string>(__LINE__) + "] Contract violation!");
+
+        assert(!errorReadSet_);
+        const uint64_t readPos = readPos_.load(std::memory_order_relaxed); //owned by input thread
+
+        //wait until data is available, end of stream or error
+        const uint64_t writePos = waitForEvent(writeEvents_, readerWaiting_, [&]() -> std::optional<uint64_t>
+        {
+            if (errorWriteSet_.load())
+                std::rethrow_exception(errorWrite_); //throw <write error>
+
+            const bool eof = eof_.load(); //*before* reading writePos_: no data missed after closeStream()
+            if (const uint64_t writePosNow = writePos_.load();
+                writePosNow != readPos || eof)
+                return writePosNow;
+            return std::nullopt;
+        });
+
+        const size_t junkSize = static_cast<size_t>(std::min<uint64_t>(bytesToRead, writePos - readPos));
+        copyFromRing(readPos, static_cast<std::byte*>(buffer), junkSize);
+
+        if (junkSize > 0)
         {
-            std::unique_lock dummy(lockStream_);
-            bytesRead = tryReadImpl(dummy, buffer, bytesToRead);
+            readPos_.store(readPos + junkSize);
+            readEvents_.fetch_add(1);
+
+            if (const size_t spaceWanted = writerWaiting_.load(); //batched wakeup: don't wake writer for every small read
+                spaceWanted > 0 && capacity_ - (writePos_.load() - (readPos + junkSize)) >= spaceWanted &&
+                writerWaiting_.exchange(0) > 0) //notify once per wait
+                readEvents_.notify_one();
         }
-        if (bytesRead > 0)
-            conditionBytesRead_.notify_all(); //...*outside* the lock
-        return bytesRead;
+        return junkSize;
     }
 
     //context of output thread, blocking
     void write(const void* buffer, size_t bytesToWrite) //throw <read error>
     {
-        std::unique_lock dummy(lockStream_);
         while (bytesToWrite > 0)
         {
-            const size_t bytesWritten = tryWriteWhileImpl(dummy, buffer, bytesToWrite); //throw <read error>
-            conditionBytesWritten_.notify_all();
+            const size_t bytesWritten = tryWrite(buffer, bytesToWrite); //throw <read error>
             buffer = static_cast<const std::byte*>(buffer) + bytesWritten;
             bytesToWrite -= bytesWritten;
         }
@@ -73,48 +103,68 @@ public:
     //context of output thread, blocking
     size_t tryWrite(const void* buffer, size_t bytesToWrite) //throw <read error>; may return short! CONTRACT: bytesToWrite > 0
     {
-        size_t bytesWritten = 0;
+        if (bytesToWrite == 0)
+            throw std::logic_error(std::string(__FILE__) + '[' + numberTo<std::string>(__LINE__) + "] Contract violation!");
+
+        assert(!eof_ && !errorWriteSet_);
+        /*  => can't use InterruptibleThread's interruptibleWait() :(
+            -> AsyncStreamBuffer is used for input and output streaming
+            => both AsyncStreamBuffer::write()/read() would have to implement interruptibleWait()
+            => one of these usually called from main thread
+            => but interruptibleWait() cannot be called from main thread!          */
+        const uint64_t writePos = writePos_.load(std::memory_order_relaxed); //owned by output thread
+        const size_t spaceWanted = std::min(bytesToWrite, std::max<size_t>(capacity_ / 4, 1));
+
+        const size_t spaceFree = waitForEvent(readEvents_, writerWaiting_, [&]() -> std::optional<size_t>
         {
-            std::unique_lock dummy(lockStream_);
-            bytesWritten = tryWriteWhileImpl(dummy, buffer, bytesToWrite);
-        }
-        conditionBytesWritten_.notify_all(); //...*outside* the lock
-        return bytesWritten;
+            if (errorReadSet_.load())
+                std::rethrow_exception(errorRead_); //throw <read error>
+
+            if (const size_t spaceFreeNow = capacity_ - static_cast<size_t>(writePos - readPos_.load());
+                spaceFreeNow >= spaceWanted)
+                return spaceFreeNow;
+            return std::nullopt;
+        }, spaceWanted);
+
+        const size_t junkSize = std::min(bytesToWrite, spaceFree);
+        copyToRing(writePos, static_cast<const std::byte*>(buffer), junkSize);
+
+        writePos_.store(writePos + junkSize);
+        notifyWriteEvent();
+        return junkSize;
     }
 
     //context of output thread
     void closeStream()
     {
-        {
-            std::lock_guard dummy(lockStream_);
-            assert(!eof_ && !errorWrite_);
-            eof_ = true;
-        }
-        conditionBytesWritten_.notify_all();
+        assert(!eof_ && !errorWriteSet_);
+        eof_.store(true);
+        notifyWriteEvent(true /*force*/);
     }
 
     //context of input thread
     void setReadError(const std::exception_ptr& error)
     {
+        assert(error && !errorReadSet_);
+        if (!errorReadSet_.load(std::memory_order_relaxed))
         {
-            std::lock_guard dummy(lockStream_);
-            assert(error && !errorRead_);
-            if (!errorRead_)
-                errorRead_ = error;
+            errorRead_ = error;
+            errorReadSet_.store(true); //publish errorRead_
         }
-        conditionBytesRead_.notify_all();
+        readEvents_.fetch_add(1);
+        readEvents_.notify_one();
     }
 
     //context of output thread
     void setWriteError(const std::exception_ptr& error)
     {
+        assert(error && !errorWriteSet_);
+        if (!errorWriteSet_.load(std::memory_order_relaxed))
         {
-            std::lock_guard dummy(lockStream_);
-            assert(error && !errorWrite_);
-            if (!errorWrite_)
-                errorWrite_ = error;
+            errorWrite_ = error;
+            errorWriteSet_.store(true); //publish errorWrite_
         }
-        conditionBytesWritten_.notify_all();
+        notifyWriteEvent(true /*force*/);
     }
 
 #if 0
@@ -123,8 +173,7 @@ public:
     //context of *output* thread
     void checkReadErrors() //throw <read error>
     {
-        std::lock_guard dummy(lockStream_);
-        if (errorRead_)
+        if (errorReadSet_)
             std::rethrow_exception(errorRead_); //throw <read error>
     }
 
@@ -132,76 +181,82 @@ public:
     //context of *input* thread
     void checkWriteErrors() //throw <write error>
     {
-        std::lock_guard dummy(lockStream_);
-        if (errorWrite_)
+        if (errorWriteSet_)
             std::rethrow_exception(errorWrite_); //throw <write error>
     }
 #endif
 
-    uint64_t getTotalBytesWritten() const { return totalBytesWritten_; }
-    uint64_t getTotalBytesRead   () const { return totalBytesRead_; }
+    uint64_t getTotalBytesWritten() const { return writePos_; }
+    uint64_t getTotalBytesRead   () const { return readPos_; }
 
 private:
     AsyncStreamBuffer           (const AsyncStreamBuffer&) = delete;
     AsyncStreamBuffer& operator=(const AsyncStreamBuffer&) = delete;
 
-    //context of input thread, blocking
-    size_t tryReadImpl(std::unique_lock<std::mutex>& ul, void* buffer, size_t bytesToRead) //throw <write error>; may return short; only 0 means EOF! CONTRACT: bytesToRead > 0!
+    /*  no lost wakeups: all atomics involved use memory_order_seq_cst
+        1. waiting side: announce waiting, load event counter, check condition, wait for event counter to change
+        2. other side:   update state,     increment event counter,   notify if waiting (and reset "waiting")
+        => either 1. sees the new state, or the event counter was incremented after 1. loaded it => wait() returns immediately   */
+    template <class Function>
+    static typename std::invoke_result_t<Function>::value_type waitForEvent(std::atomic<uint32_t>& events, std::atomic<size_t>& waiting, //throw X
+                                                                             Function checkReady /*throw X*/, size_t waitingValue = 1)
     {
-        if (bytesToRead == 0) //"read() with a count of 0 returns zero" => indistinguishable from end of file! => check!
-            throw std::logic_error(std::string(__FILE__) + '[' + numberTo<std::string>(__LINE__) + "] Contract violation!");
-
-        assert(isLocked(lockStream_));
-        assert(!errorRead_);
+        if (auto result = checkReady()) //fast path
+            return *result;
 
-        conditionBytesWritten_.wait(ul, [this] { return errorWrite_ || !ringBuf_.empty() || eof_; });
+        ZEN_ON_SCOPE_EXIT(waiting.store(0));
+        for (;;)
+        {
+            waiting.store(waitingValue);
+            const uint32_t eventCount = events.load();
 
-        if (errorWrite_)
-            std::rethrow_exception(errorWrite_); //throw <write error>
+            if (auto result = checkReady()) //throw X
+                return *result;
 
-        const size_t junkSize = std::min(bytesToRead, ringBuf_.size());
-        ringBuf_.extract_front(static_cast<std::byte*>(buffer),
-                               static_cast<std::byte*>(buffer)+ junkSize);
-        totalBytesRead_ += junkSize;
-        return junkSize;
+            events.wait(eventCount);
+        }
     }
 
-    //context of output thread, blocking
-    size_t tryWriteWhileImpl(std::unique_lock<std::mutex>& ul, const void* buffer, size_t bytesToWrite) //throw <read error>; may return short! CONTRACT: bytesToWrite > 0
+    //context of output thread
+    void notifyWriteEvent(bool force = false)
     {
-        if (bytesToWrite == 0)
-            throw std::logic_error(std::string(__FILE__) + '[' + numberTo<std::string>(__LINE__) + "] Contract violation!");
-
-        assert(isLocked(lockStream_));
-        assert(!eof_ && !errorWrite_);
-        /*  => can't use InterruptibleThread's interruptibleWait() :(
-            -> AsyncStreamBuffer is used for input and output streaming
-            => both AsyncStreamBuffer::write()/read() would have to implement interruptibleWait()
-            => one of these usually called from main thread
-            => but interruptibleWait() cannot be called from main thread!          */
-        conditionBytesRead_.wait(ul, [this] { return errorRead_ || ringBuf_.size() < ringBuf_.capacity(); });
-
-        if (errorRead_)
-            std::rethrow_exception(errorRead_); //throw <read error>
+        writeEvents_.fetch_add(1);
+        if (readerWaiting_.exchange(0) > 0 || force) //notify once per wait
+            writeEvents_.notify_one();
+    }
 
-        const size_t junkSize = std::min(bytesToWrite, ringBuf_.capacity() - ringBuf_.size());
+    void copyToRing(uint64_t pos, const std::byte* src, size_t len)
+    {
+        const size_t offset = static_cast<size_t>(pos % capacity_);
+        const size_t len1 = std::min(len, capacity_ - offset);
+        std::memcpy(&buffer_[offset], src, len1);
+        std::memcpy(&buffer_[0], src + len1, len - len1);
+    }
 
-        ringBuf_.insert_back(static_cast<const std::byte*>(buffer),
-                             static_cast<const std::byte*>(buffer) + junkSize);
-        totalBytesWritten_ += junkSize;
-        return junkSize;
+    void copyFromRing(uint64_t pos, std::byte* trg, size_t len) const
+    {
+        const size_t offset = static_cast<size_t>(pos % capacity_);
+        const size_t len1 = std::min(len, capacity_ - offset);
+        std::memcpy(trg, &buffer_[offset], len1);
+        std::memcpy(trg + len1, &buffer_[0], len - len1);
     }
 
-    std::mutex lockStream_;
-    RingBuffer<std::byte> ringBuf_; //prefetch/output buffer
-    bool eof_ = false;
-    std::exception_ptr errorWrite_;
-    std::exception_ptr errorRead_;
-    std::condition_variable conditionBytesWritten_;
-    std::condition_variable conditionBytesRead_;
+    const size_t capacity_;
+    const std::unique_ptr<std::byte[]> buffer_; //prefetch/output buffer
+
+    //avoid false sharing between input and output thread: 64 = cache line size
+    alignas(64) std::atomic<uint64_t> writePos_{0}; //= total bytes written; std:atomic is uninitialized by default!
+    std::atomic<uint32_t> writeEvents_{0};
+    std::atomic<size_t>   writerWaiting_{0}; //0 or free space wanted
+    std::atomic<bool>     eof_{false};
+    std::atomic<bool>     errorWriteSet_{false};
+    std::exception_ptr    errorWrite_;
 
-    std::atomic<uint64_t> totalBytesWritten_{0}; //std:atomic is uninitialized by default!
-    std::atomic<uint64_t> totalBytesRead_   {0}; //
+    alignas(64) std::atomic<uint64_t> readPos_{0}; //= total bytes read
+    std::atomic<uint32_t> readEvents_{0};
+    std::atomic<size_t>   readerWaiting_{0};
+    std::atomic<bool>     errorReadSet_{false};
+    std::exception_ptr    errorRead_;
 };
 }
 
@@ -512,7 +512,8 @@ void Zbase<Char, SP>::resize(size_t newSize, Char fillChar)
 template <class Char, template <class> class SP> inline
 bool operator==(const Zbase<Char, SP>& lhs, const Zbase<Char, SP>& rhs)
 {
-    return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin()); //respect embedded 0
+    return lhs.size() == rhs.size() && (lhs.c_str() == rhs.c_str() || //shared buffer, e.g. interned names
+                                        std::equal(lhs.begin(), lhs.end(), rhs.begin())); //respect embedded 0
 }
 
 
@@ -666,7 +667,7 @@ struct std::hash<zen::Zbase<Char, SP>>
     using is_transparent = int; //allow heterogenous lookup!
 
     template <class String>
-    size_t operator()(const String& str) const { return zen::hashString<size_t>(str); }
+    size_t operator()(const String& str) const { return zen::StringHash()(str); }
 };
 
 
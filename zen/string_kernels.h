@@ -0,0 +1,159 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef STRING_KERNELS_H_8347591023847562
+#define STRING_KERNELS_H_8347591023847562
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring> //memcpy
+#include <type_traits>
+#if defined __SSE2__ //x86-64 baseline => no runtime dispatch needed
+    #include <emmintrin.h>
+#endif
+
+
+//word-at-a-time kernels for the string hot paths: hashing, ASCII detection, ASCII upper-casing
+// => all "Char" types are supported (char, UTF16/UTF32 wchar_t): ASCII has the same value in all UTF encodings
+namespace zen::impl
+{
+inline uint64_t loadU64(const void* p) { uint64_t v; std::memcpy(&v, p, sizeof(v)); return v; } //unaligned + no strict aliasing issues
+inline uint64_t loadU32(const void* p) { uint32_t v; std::memcpy(&v, p, sizeof(v)); return v; }
+
+
+inline uint64_t hashMix(uint64_t a, uint64_t b)
+{
+#ifdef __SIZEOF_INT128__
+    const unsigned __int128 r = static_cast<unsigned __int128>(a) * b;
+    return static_cast<uint64_t>(r) ^ static_cast<uint64_t>(r >> 64);
+#else
+    const uint64_t aLo = static_cast<uint32_t>(a), aHi = a >> 32;
+    const uint64_t bLo = static_cast<uint32_t>(b), bHi = b >> 32;
+    const uint64_t ll = aLo * bLo, lh = aLo * bHi, hl = aHi * bLo, hh = aHi * bHi;
+    const uint64_t mid = (ll >> 32) + static_cast<uint32_t>(lh) + static_cast<uint32_t>(hl);
+    return ((mid << 32) | static_cast<uint32_t>(ll)) ^ (hh + (lh >> 32) + (hl >> 32) + (mid >> 32));
+#endif
+}
+
+
+//wyhash-style: 8/16 bytes per multiply instead of FNV-1a's one multiply per character
+//=> result differs between platforms (endianess, sizeof(wchar_t)): in-memory use only, do NOT persist!
+inline uint64_t hashBytes(const void* data, size_t len)
+{
+    constexpr uint64_t p0 = 0xa0761d6478bd642f;
+    constexpr uint64_t p1 = 0xe7037ed1a0b428db;
+    constexpr uint64_t p2 = 0x8ebc6af09c88c6e3;
+    constexpr uint64_t p3 = 0x589965cc75374cc3;
+
+    const auto* p = static_cast<const unsigned char*>(data);
+    uint64_t seed = p0;
+    uint64_t a = 0;
+    uint64_t b = 0;
+
+    if (len <= 16)
+    {
+        if (len >= 4) //overlapping reads cover [4, 16] bytes
+        {
+            const size_t offset = (len >> 3) << 2;
+            a = (loadU32(p) << 32) | loadU32(p + offset);
+            b = (loadU32(p + len - 4) << 32) | loadU32(p + len - 4 - offset);
+        }
+        else if (len > 0)
+            a = (static_cast<uint64_t>(p[0]) << 16) | (static_cast<uint64_t>(p[len >> 1]) << 8) | p[len - 1];
+    }
+    else
+    {
+        size_t bytesLeft = len;
+        if (bytesLeft > 48) //three independent lanes for long strings (e.g. full paths)
+        {
+            uint64_t seed1 = seed;
+            uint64_t seed2 = seed;
+            do
+            {
+                seed  = hashMix(loadU64(p)      ^ p1, loadU64(p +  8) ^ seed);
+                seed1 = hashMix(loadU64(p + 16) ^ p2, loadU64(p + 24) ^ seed1);
+                seed2 = hashMix(loadU64(p + 32) ^ p3, loadU64(p + 40) ^ seed2);
+                p += 48;
+                bytesLeft -= 48;
+            }
+            while (bytesLeft > 48);
+            seed ^= seed1 ^ seed2;
+        }
+        for (; bytesLeft > 16; p += 16, bytesLeft -= 16)
+            seed = hashMix(loadU64(p) ^ p1, loadU64(p + 8) ^ seed);
+
+        a = loadU64(p + bytesLeft - 16); //last 16 bytes: may overlap with previous block
+        b = loadU64(p + bytesLeft -  8);
+    }
+    return hashMix(hashMix(a ^ p1, b ^ seed) ^ p0 ^ len, p1);
+}
+
+//-----------------------------------------------------------------------------------------
+
+//set all bits that are not allowed for an ASCII char:
+template <class Char> constexpr uint64_t nonAsciiBits = sizeof(Char) == 1 ? 0x8080'8080'8080'8080 :
+                                                        sizeof(Char) == 2 ? 0xff80'ff80'ff80'ff80 :
+                                                        /**/                0xffff'ff80'ffff'ff80;
+
+//return pointer to first non-ASCII char or "last"
+template <class Char> inline
+const Char* findNonAscii(const Char* first, const Char* last)
+{
+    static_assert(sizeof(Char) == 1 || sizeof(Char) == 2 || sizeof(Char) == 4);
+    constexpr uint64_t nonAsciiMask = nonAsciiBits<Char>;
+
+#ifdef __SSE2__
+    constexpr size_t blockSize = 16 / sizeof(Char);
+    const __m128i mask = _mm_set1_epi64x(static_cast<long long>(nonAsciiMask));
+
+    for (; last - first >= static_cast<ptrdiff_t>(blockSize); first += blockSize)
+    {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(block, mask), _mm_setzero_si128())) != 0xffff)
+            break; //=> locate via scalar code below
+    }
+#endif
+    constexpr size_t wordSize = 8 / sizeof(Char);
+    for (; last - first >= static_cast<ptrdiff_t>(wordSize); first += wordSize)
+        if (loadU64(first) & nonAsciiMask)
+            break;
+
+    for (; first != last; ++first)
+        if (static_cast<std::make_unsigned_t<Char>>(*first) >= 128)
+            break;
+    return first;
+}
+
+
+//precondition: all chars are ASCII
+inline void asciiToUpperInPlace(char* first, char* last)
+{
+    constexpr uint64_t ones = 0x0101'0101'0101'0101;
+
+    for (; last - first >= 8; first += 8)
+    {
+        uint64_t word = loadU64(first);
+        //no carry between bytes: all bytes < 0x80
+        const uint64_t geA = word + ones * (0x80 - 'a');     //high bit set if byte >= 'a'
+        const uint64_t gtZ = word + ones * (0x80 - 'z' - 1); //high bit set if byte >  'z'
+        word ^= ((geA ^ gtZ) & ones * 0x80) >> 2;           //flip 0x20 for [a-z]
+        std::memcpy(first, &word, sizeof(word));
+    }
+    for (; first != last; ++first)
+        if ('a' <= *first && *first <= 'z')
+            *first = static_cast<char>(*first - 'a' + 'A');
+}
+
+
+inline void asciiToUpperInPlace(wchar_t* first, wchar_t* last)
+{
+    for (; first != last; ++first)
+        if (L'a' <= *first && *first <= L'z')
+            *first = static_cast<wchar_t>(*first - L'a' + L'A');
+}
+}
+
+#endif //STRING_KERNELS_H_8347591023847562
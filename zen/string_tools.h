@@ -13,6 +13,7 @@
 #include <cwchar>  //swprintf
 #include "stl_tools.h"
 #include "string_traits.h"
+#include "string_kernels.h"
 #include "legacy_compiler.h" //<charconv> but without the compiler crashes :>
 
 
@@ -52,7 +53,7 @@ struct LessAsciiNoCase;
 struct StringHashAsciiNoCase;
 struct StringEqualAsciiNoCase;
 
-template <class Num, class S> Num hashString(const S& str);
+template <class Num, class S> Num hashString(const S& str); //stable across versions/platforms (FNV-1a) => may be persisted
 
 enum class IfNotFoundReturn
 {
@@ -175,7 +176,8 @@ template <class S> inline
 bool isAsciiString(const S& str)
 {
     const auto* const first = strBegin(str);
-    return std::all_of(first, first + strLength(str), [](auto c) { return isAsciiChar(c); });
+    const auto* const last  = first + strLength(str);
+    return impl::findNonAscii(first, last) == last;
 }
 
 
@@ -969,7 +971,10 @@ struct StringHash
     using is_transparent = int; //enable heterogenous lookup!
 
     template <class String>
-    size_t operator()(const String& str) const { return hashString<size_t>(str); }
+    size_t operator()(const String& str) const
+    {
+        return static_cast<size_t>(impl::hashBytes(strBegin(str), strLength(str) * sizeof(GetCharTypeT<String>)));
+    }
 };
 
 
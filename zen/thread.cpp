@@ -5,6 +5,7 @@
 // *****************************************************************************
 
 #include "thread.h"
+#include "trace.h"
     #include <sys/prctl.h>
 
 using namespace zen;
@@ -15,6 +16,7 @@ using namespace zen;
 void zen::setCurrentThreadName(const Zstring& threadName)
 {
     ::prctl(PR_SET_NAME, threadName.c_str(), 0, 0, 0);
+    traceThreadName(utfTo<std::string>(threadName));
 
 }
 
@@ -35,3 +37,87 @@ bool zen::runningOnMainThread()
 }
 
 
+namespace
+{
+const std::chrono::seconds EXECUTOR_IDLE_TIMEOUT(30); //keep threads around between phases (e.g. comparison => synchronization)
+
+
+class Executor
+{
+public:
+    void run(std::function<void()>&& job)
+    {
+        {
+            std::lock_guard dummy(lock_);
+            jobs_.push_back(std::move(job));
+
+            if (threadsIdle_ < jobs_.size()) //idle threads might be busy soon, but don't wait for them: jobs may block each other!
+            {
+                std::thread(&Executor::workerLoop, this).detach();
+                ++threadsTotal_;
+                ++threadsCreated_;
+            }
+        }
+        conditionNewJob_.notify_one();
+    }
+
+    ExecutorStats getStats()
+    {
+        std::lock_guard dummy(lock_);
+        return {threadsTotal_, threadsIdle_, jobs_.size(), threadsCreated_, jobsCompleted_};
+    }
+
+private:
+    void workerLoop() //context of executor thread
+    {
+        setCurrentThreadName(Zstr("Executor"));
+
+        std::unique_lock dummy(lock_);
+        for (;;)
+        {
+            ++threadsIdle_;
+            const bool haveJob = conditionNewJob_.wait_for(dummy, EXECUTOR_IDLE_TIMEOUT, [this] { return !jobs_.empty(); });
+            --threadsIdle_;
+
+            if (!haveJob)
+            {
+                --threadsTotal_;
+                return;
+            }
+
+            std::function<void()> job = std::move(jobs_.    front()); //noexcept thanks to move
+            /**/                                  jobs_.pop_front();  //
+            dummy.unlock();
+            job(); //noexcept!
+            job = nullptr; //release captured state *before* locking
+            setCurrentThreadName(Zstr("Executor")); //job may have renamed the thread
+            dummy.lock();
+
+            ++jobsCompleted_;
+        }
+    }
+
+    std::mutex lock_;
+    RingBuffer<std::function<void()>> jobs_;
+    std::condition_variable conditionNewJob_;
+
+    size_t threadsTotal_ = 0;
+    size_t threadsIdle_  = 0;
+    uint64_t threadsCreated_ = 0;
+    uint64_t jobsCompleted_  = 0;
+};
+
+
+Executor& getExecutor()
+{
+    //intentional leak: detached executor threads may still be running during static destruction
+    static Executor& inst = *new Executor;
+    return inst;
+}
+}
+
+
+void zen::impl::runOnExecutor(std::function<void()>&& job) { getExecutor().run(std::move(job)); }
+
+
+ExecutorStats zen::getExecutorStats() { return getExecutor().getStats(); }
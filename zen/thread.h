@@ -19,19 +19,20 @@ namespace zen
 class InterruptionStatus;
 
 //migrate towards https://en.cppreference.com/w/cpp/thread/jthread
+//long-lived worker (e.g. icon loader, lock file life signs, network streams): runs as a job on the process-wide executor (see below)
 class InterruptibleThread
 {
 public:
     InterruptibleThread() {}
     InterruptibleThread           (InterruptibleThread&&    ) noexcept = default;
-    InterruptibleThread& operator=(InterruptibleThread&& tmp) noexcept //don't use swap() but end stdThread_ life time immediately
+    InterruptibleThread& operator=(InterruptibleThread&& tmp) noexcept //don't use swap() but end job life time immediately
     {
         if (joinable())
         {
             requestStop();
             join();
         }
-        stdThread_ = std::move(tmp.stdThread_);
+        jobDone_   = std::move(tmp.jobDone_);
         intStatus_ = std::move(tmp.intStatus_);
         return *this;
     }
@@ -48,13 +49,13 @@ public:
         }
     }
 
-    bool joinable () const { return stdThread_.joinable(); }
+    bool joinable () const { return jobDone_.valid(); }
     void requestStop();
-    void join     () { stdThread_.join(); }
-    void detach   () { stdThread_.detach(); }
+    void join     () { jobDone_.get(); } //returns after f and its captured state are destroyed
+    void detach   () { jobDone_ = {}; }
 
 private:
-    std::thread stdThread_;
+    std::future<void> jobDone_;
     std::shared_ptr<InterruptionStatus> intStatus_ = std::make_shared<InterruptionStatus>();
 };
 
@@ -149,6 +150,31 @@ private:
 
 //------------------------------------------------------------------------------------------
 
+/*  Process-wide executor: pool of worker threads shared by all ThreadGroups
+    - threads are created on demand, reused across ThreadGroups (=> no thread creation per phase and device) and end after an idle time out
+    - no global limit on concurrency: tasks block on I/O and may wait for each other => a global cap could dead-lock
+      => limit concurrency per ThreadGroup instead, e.g. one group per device
+    - InterruptibleThread occupies one executor thread for the job's life time                                        */
+struct ExecutorStats
+{
+    size_t threadsTotal = 0;
+    size_t threadsIdle  = 0;
+    size_t jobsQueued   = 0;
+    uint64_t threadsCreated = 0; //since process start
+    uint64_t jobsCompleted  = 0; //
+};
+ExecutorStats getExecutorStats();
+
+namespace impl
+{
+void runOnExecutor(std::function<void()>&& job /*noexcept!*/);
+}
+
+//------------------------------------------------------------------------------------------
+
+/*  FIFO task queue with at most "threadCountMax" tasks running in parallel on the executor
+    - a "runner" job drains the queue and returns its thread to the executor as soon as the queue is empty
+    - ~ThreadGroup() interrupts all running tasks (ThreadStopRequest) and waits for them, unless detached       */
 template <class Function>
 class ThreadGroup
 {
@@ -157,34 +183,31 @@ public:
     { if (threadCountMax == 0) throw std::logic_error(std::string(__FILE__) + '[' + numberTo<std::string>(__LINE__) + "] Contract violation!"); }
 
     ThreadGroup           (ThreadGroup&& tmp) noexcept = default; //noexcept *required* to support move for reallocations in std::vector and std::swap!!!
-    ThreadGroup& operator=(ThreadGroup&& tmp) noexcept = default; //don't use swap() but end worker_ life time immediately
-
-    ~ThreadGroup()
+    ThreadGroup& operator=(ThreadGroup&& tmp) noexcept //don't use swap() but end running tasks immediately
     {
-        for (InterruptibleThread& w : worker_)
-            w.requestStop(); //similar, but not the same as ~InterruptibleThread: stop *all* at the same time before join!
-
-        if (detach_) //detach() without requestStop() doesn't make sense
-            for (InterruptibleThread& w : worker_)
-                w.detach();
+        stopAndJoin();
+        workLoad_       = std::move(tmp.workLoad_);
+        detach_         = tmp.detach_;
+        threadCountMax_ = tmp.threadCountMax_;
+        groupName_      = std::move(tmp.groupName_);
+        return *this;
     }
 
+    ~ThreadGroup() { stopAndJoin(); }
+
     //context of controlling OR worker thread, non-blocking:
     void run(Function&& wi /*should throw ThreadStopRequest when needed*/, bool insertFront = false)
     {
-        {
-            std::lock_guard dummy(workLoad_.ref().lock);
+        std::lock_guard dummy(workLoad_->lock);
 
-            if (insertFront)
-                workLoad_.ref().tasks.push_front(std::move(wi));
-            else
-                workLoad_.ref().tasks.push_back(std::move(wi));
-            const size_t tasksPending = ++(workLoad_.ref().tasksPending);
+        if (insertFront)
+            workLoad_->tasks.push_front(std::move(wi));
+        else
+            workLoad_->tasks.push_back(std::move(wi));
+        const size_t tasksPending = ++(workLoad_->tasksPending);
 
-            if (worker_.size() < std::min(tasksPending, threadCountMax_))
-                addWorkerThread();
-        }
-        workLoad_.ref().conditionNewTask.notify_all();
+        if (workLoad_->runnersActive < std::min(tasksPending, threadCountMax_) && !workLoad_->stopRequested)
+            addRunner();
     }
 
     //context of controlling thread, blocking:
@@ -203,14 +226,17 @@ public:
     //non-blocking wait()-alternative: context of controlling thread:
     void notifyWhenDone(const std::function<void()>& onCompletion /*noexcept! runs on worker thread!*/)
     {
-        std::lock_guard dummy(workLoad_.ref().lock);
+        std::lock_guard dummy(workLoad_->lock);
 
-        if (workLoad_.ref().tasksPending == 0)
+        if (workLoad_->tasksPending == 0)
             onCompletion();
         else
-            workLoad_.ref().onCompletionCallbacks.push_back(onCompletion);
+            workLoad_->onCompletionCallbacks.push_back(onCompletion);
     }
 
+    //context of controlling thread, non-blocking: interrupt running tasks and discard queued ones
+    void requestStop();
+
     //context of controlling thread:
     void detach() { detach_ = true; } //not expected to also interrupt!
 
@@ -218,53 +244,44 @@ private:
     ThreadGroup           (const ThreadGroup&) = delete;
     ThreadGroup& operator=(const ThreadGroup&) = delete;
 
-    void addWorkerThread()
+    struct WorkLoad
     {
-        Zstring threadName = groupName_ + Zstr('[') + numberTo<Zstring>(worker_.size() + 1) + Zstr('/') + numberTo<Zstring>(threadCountMax_) + Zstr(']');
+        std::mutex lock;
+        RingBuffer<Function> tasks; //FIFO! :)
+        size_t tasksPending = 0; //queued + running
+        std::vector<std::function<void()>> onCompletionCallbacks;
 
-        worker_.emplace_back([workLoad_ /*clang bug*/= workLoad_ /*share ownership!*/, threadName = std::move(threadName)]() mutable //don't capture "this"! consider detach() and move operations
-        {
-            setCurrentThreadName(threadName);
-            WorkLoad& workLoad = workLoad_.ref();
+        size_t runnersActive = 0;
+        std::vector<InterruptionStatus*> runnerStatus;
+        bool stopRequested = false;
+        std::condition_variable conditionRunnersDone;
+    };
 
-            std::unique_lock dummy(workLoad.lock);
-            for (;;)
-            {
-                interruptibleWait(workLoad.conditionNewTask, dummy, [&tasks = workLoad.tasks] { return !tasks.empty(); }); //throw ThreadStopRequest
+    void addRunner() //call while locked!
+    {
+        Zstring threadName = groupName_ + Zstr('[') + numberTo<Zstring>(++(workLoad_->runnersActive)) + Zstr('/') + numberTo<Zstring>(threadCountMax_) + Zstr(']');
 
-                Function task = std::move(workLoad.tasks.    front()); //noexcept thanks to move
-                /**/                      workLoad.tasks.pop_front();  //
+        impl::runOnExecutor([workLoad = workLoad_ /*share ownership!*/, threadName = std::move(threadName)] //don't capture "this"! consider detach() and move operations
+        { runTasks(*workLoad, threadName); });
+    }
 
-                dummy.unlock();
-                task(); //throw ThreadStopRequest?
-                dummy.lock();
+    static void runTasks(WorkLoad& workLoad, const Zstring& threadName); //context of executor thread
 
-                if (--(workLoad.tasksPending) == 0)
-                    if (!workLoad.onCompletionCallbacks.empty())
-                    {
-                        std::vector<std::function<void()>> callbacks;
-                        callbacks.swap(workLoad.onCompletionCallbacks);
-
-                        dummy.unlock();
-                        for (const auto& cb : callbacks)
-                            cb(); //noexcept!
-                        dummy.lock();
-                    }
+    void stopAndJoin()
+    {
+        if (workLoad_) //not moved-from
+        {
+            requestStop(); //stop *all* at the same time before join!
+
+            if (!detach_) //detach() without requestStop() doesn't make sense
+            {
+                std::unique_lock dummy(workLoad_->lock);
+                workLoad_->conditionRunnersDone.wait(dummy, [&] { return workLoad_->runnersActive == 0; });
             }
-        });
+        }
     }
 
-    struct WorkLoad
-    {
-        std::mutex lock;
-        RingBuffer<Function> tasks; //FIFO! :)
-        size_t tasksPending = 0;
-        std::condition_variable conditionNewTask;
-        std::vector<std::function<void()>> onCompletionCallbacks;
-    };
-
-    std::vector<InterruptibleThread> worker_;
-    SharedRef<WorkLoad> workLoad_ = makeSharedRef<WorkLoad>();
+    std::shared_ptr<WorkLoad> workLoad_ = std::make_shared<WorkLoad>();
     bool detach_ = false;
     size_t threadCountMax_;
     Zstring groupName_;
@@ -500,20 +517,89 @@ void interruptibleSleep(const std::chrono::duration<Rep, Period>& relTime) //thr
 
 
 template <class Function> inline
-InterruptibleThread::InterruptibleThread(Function&& f)
+void ThreadGroup<Function>::requestStop()
 {
-    stdThread_ = std::thread([f = std::forward<Function>(f),
-                                intStatus = this->intStatus_]() mutable
+    std::lock_guard dummy(workLoad_->lock);
+    workLoad_->stopRequested = true;
+
+    for (InterruptionStatus* intStatus : workLoad_->runnerStatus)
+        intStatus->requestStop();
+}
+
+
+template <class Function>
+void ThreadGroup<Function>::runTasks(WorkLoad& workLoad, const Zstring& threadName)
+{
+    setCurrentThreadName(threadName);
+
+    InterruptionStatus intStatus;
+    assert(!impl::threadLocalInterruptionStatus);
+    impl::threadLocalInterruptionStatus = &intStatus;
+    ZEN_ON_SCOPE_EXIT(impl::threadLocalInterruptionStatus = nullptr);
+
+    std::unique_lock dummy(workLoad.lock);
+    workLoad.runnerStatus.push_back(&intStatus);
+
+    while (!workLoad.stopRequested && !workLoad.tasks.empty())
     {
-        assert(!impl::threadLocalInterruptionStatus);
-        impl::threadLocalInterruptionStatus = intStatus.get();
-        ZEN_ON_SCOPE_EXIT(impl::threadLocalInterruptionStatus = nullptr);
+        Function task = std::move(workLoad.tasks.    front()); //noexcept thanks to move
+        /**/                      workLoad.tasks.pop_front();  //
 
+        dummy.unlock();
+        bool taskStopped = false;
         try
         {
-            f(); //throw ThreadStopRequest
+            task(); //throw ThreadStopRequest
+        }
+        catch (ThreadStopRequest&) { taskStopped = true; }
+        dummy.lock();
+
+        if (taskStopped)
+            break;
+
+        if (--(workLoad.tasksPending) == 0)
+            if (!workLoad.onCompletionCallbacks.empty())
+            {
+                std::vector<std::function<void()>> callbacks;
+                callbacks.swap(workLoad.onCompletionCallbacks);
+
+                dummy.unlock();
+                for (const auto& cb : callbacks)
+                    cb(); //noexcept!
+                dummy.lock();
+            }
+    }
+
+    std::erase(workLoad.runnerStatus, &intStatus);
+    if (--(workLoad.runnersActive) == 0)
+        workLoad.conditionRunnersDone.notify_all();
+}
+
+
+template <class Function> inline
+InterruptibleThread::InterruptibleThread(Function&& f)
+{
+    auto promDone = std::make_shared<std::promise<void>>();
+    jobDone_ = promDone->get_future();
+
+    //std::function doesn't support move-only types:
+    auto sharedFun = std::make_shared<std::decay_t<Function>>(std::forward<Function>(f));
+
+    impl::runOnExecutor([sharedFun, promDone, intStatus = this->intStatus_]() mutable
+    {
+        {
+            assert(!impl::threadLocalInterruptionStatus);
+            impl::threadLocalInterruptionStatus = intStatus.get();
+            ZEN_ON_SCOPE_EXIT(impl::threadLocalInterruptionStatus = nullptr);
+
+            try
+            {
+                (*sharedFun)(); //throw ThreadStopRequest
+            }
+            catch (ThreadStopRequest&) {}
         }
-        catch (ThreadStopRequest&) {}
+        sharedFun.reset(); //join() semantics like std::thread: captured state is gone *before* signalling
+        promDone->set_value();
     });
 }
 
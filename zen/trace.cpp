@@ -0,0 +1,159 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include "trace.h"
+#include "thread.h"
+#include "json.h"
+
+using namespace zen;
+
+
+namespace
+{
+struct TraceEvent
+{
+    const char* name;
+    int threadId;
+    std::chrono::microseconds startTime; //relative to TraceBuffer::startTime
+    std::chrono::microseconds duration;
+    std::string device;
+    std::optional<int64_t> items;
+    std::optional<int64_t> bytes;
+};
+
+
+struct TraceBuffer
+{
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    std::vector<TraceEvent> events;
+    std::vector<std::pair<int /*threadId*/, std::string>> threadNames;
+    size_t eventsDropped = 0;
+};
+
+const size_t TRACE_EVENTS_MAX = 100'000; //limit memory consumption for long-running jobs: per-file spans may be many!
+
+Protected<TraceBuffer> globalTraceBuffer;
+
+
+int getTraceThreadId()
+{
+    static constinit std::atomic<int> nextThreadId{1};
+    thread_local const int threadId = nextThreadId++;
+    return threadId;
+}
+}
+
+
+void zen::enableTracing(bool enable)
+{
+    globalTraceBuffer.access([](TraceBuffer& buf) { buf = TraceBuffer(); });
+    impl::tracingEnabled = enable;
+}
+
+
+bool zen::isTracingEnabled()
+{
+    return impl::tracingEnabled.load(std::memory_order_relaxed);
+}
+
+
+void zen::traceThreadName(const std::string& threadName)
+{
+    if (isTracingEnabled())
+        globalTraceBuffer.access([&, threadId = getTraceThreadId()](TraceBuffer& buf)
+    {
+        //executor threads are renamed for each ThreadGroup they run tasks for => don't accumulate
+        if (auto it = std::find_if(buf.threadNames.begin(), buf.threadNames.end(), [&](const auto& item) { return item.first == threadId; });
+            it != buf.threadNames.end())
+            it->second = threadName;
+        else
+            buf.threadNames.emplace_back(threadId, threadName);
+    });
+}
+
+
+void impl::recordTraceSpan(const char* name, std::chrono::steady_clock::time_point startTime, const std::string& device,
+                           std::optional<int64_t> items, std::optional<int64_t> bytes)
+{
+    const auto endTime = std::chrono::steady_clock::now();
+    const int threadId = getTraceThreadId();
+
+    globalTraceBuffer.access([&](TraceBuffer& buf)
+    {
+        if (!isTracingEnabled() || startTime < buf.startTime) //tracing was disabled or restarted while span was active
+            return;
+
+        if (buf.events.size() >= TRACE_EVENTS_MAX)
+            ++buf.eventsDropped;
+        else
+            buf.events.push_back(
+        {
+            name, threadId,
+            std::chrono::duration_cast<std::chrono::microseconds>(startTime - buf.startTime),
+            std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime),
+            device, items, bytes
+        });
+    });
+}
+
+
+std::string zen::getTraceEventsJson()
+{
+    //https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU
+    JsonValue traceEvents(JsonValue::Type::array);
+    size_t eventsDropped = 0;
+
+    globalTraceBuffer.access([&](const TraceBuffer& buf)
+    {
+        eventsDropped = buf.eventsDropped;
+
+        for (const auto& [threadId, threadName] : buf.threadNames)
+        {
+            JsonValue jevent(JsonValue::Type::object);
+            jevent.objectVal.emplace("name", "thread_name");
+            jevent.objectVal.emplace("ph",   "M");
+            jevent.objectVal.emplace("pid",  1);
+            jevent.objectVal.emplace("tid",  threadId);
+
+            JsonValue& jargs = jevent.objectVal["args"] = JsonValue(JsonValue::Type::object);
+            jargs.objectVal.emplace("name", threadName);
+
+            traceEvents.arrayVal.push_back(std::move(jevent));
+        }
+
+        for (const TraceEvent& te : buf.events)
+        {
+            JsonValue jevent(JsonValue::Type::object);
+            jevent.objectVal.emplace("name", te.name);
+            jevent.objectVal.emplace("cat",  "ffs");
+            jevent.objectVal.emplace("ph",   "X"); //"complete event"
+            jevent.objectVal.emplace("pid",  1);
+            jevent.objectVal.emplace("tid",  te.threadId);
+            jevent.objectVal.emplace("ts",   static_cast<int64_t>(te.startTime.count()));
+            jevent.objectVal.emplace("dur",  static_cast<int64_t>(te.duration .count()));
+
+            JsonValue& jargs = jevent.objectVal["args"] = JsonValue(JsonValue::Type::object);
+            if (!te.device.empty())
+                jargs.objectVal.emplace("device", te.device);
+            if (te.items)
+                jargs.objectVal.emplace("items", *te.items);
+            if (te.bytes)
+                jargs.objectVal.emplace("bytes", *te.bytes);
+
+            traceEvents.arrayVal.push_back(std::move(jevent));
+        }
+    });
+
+    JsonValue jroot(JsonValue::Type::object);
+    jroot.objectVal.emplace("traceEvents", std::move(traceEvents));
+    jroot.objectVal.emplace("displayTimeUnit", "ms");
+    if (eventsDropped > 0)
+    {
+        JsonValue& jmeta = jroot.objectVal["otherData"] = JsonValue(JsonValue::Type::object);
+        jmeta.objectVal.emplace("eventsDropped", static_cast<int64_t>(eventsDropped));
+    }
+    return serializeJson(jroot, "\n", "" /*indent*/);
+}
@@ -0,0 +1,79 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef TRACE_H_3856102947561029384
+#define TRACE_H_3856102947561029384
+
+#include <atomic>
+#include <chrono>
+#include <optional>
+#include <string>
+
+
+/*  Structured tracing: scoped spans exported as Chrome trace-event JSON => view in chrome://tracing or https://ui.perfetto.dev
+    - always compiled, disabled by default: an inactive TraceSpan costs a single relaxed atomic load
+    - thread-safe: spans are recorded when they end, nested spans on the same thread show up as a call tree
+
+    Example:
+        TraceSpan span("parallelDeviceTraversal"); //string literal!
+        if (span) //only evaluate expensive details while tracing
+            span.setDevice(utfTo<std::string>(AFS::getDisplayPath(...)));
+        ...
+        span.addItems(itemCount);                                                                             */
+namespace zen
+{
+void enableTracing(bool enable); //discards all events recorded so far
+bool isTracingEnabled();
+
+std::string getTraceEventsJson(); //Chrome "JSON Object Format"
+
+void traceThreadName(const std::string& threadName); //label current thread in trace output
+
+
+namespace impl
+{
+inline constinit std::atomic<bool> tracingEnabled{false};
+
+void recordTraceSpan(const char* name, std::chrono::steady_clock::time_point startTime, const std::string& device,
+                     std::optional<int64_t> items, std::optional<int64_t> bytes);
+}
+
+
+class TraceSpan
+{
+public:
+    explicit TraceSpan(const char* name /*static lifetime!*/) :
+        name_(impl::tracingEnabled.load(std::memory_order_relaxed) ? name : nullptr)
+    {
+        if (name_)
+            startTime_ = std::chrono::steady_clock::now();
+    }
+
+    ~TraceSpan()
+    {
+        if (name_)
+            impl::recordTraceSpan(name_, startTime_, device_, items_, bytes_);
+    }
+
+    explicit operator bool() const { return name_; }
+
+    void setDevice(const std::string& device) { if (name_) device_ = device; }
+    void addItems(int64_t count) { if (name_) items_ = items_.value_or(0) + count; }
+    void addBytes(int64_t bytes) { if (name_) bytes_ = bytes_.value_or(0) + bytes; }
+
+private:
+    TraceSpan           (const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    const char* const name_;
+    std::chrono::steady_clock::time_point startTime_;
+    std::string device_; //UTF8
+    std::optional<int64_t> items_;
+    std::optional<int64_t> bytes_;
+};
+}
+
+#endif //TRACE_H_3856102947561029384
@@ -348,12 +348,27 @@ TargetString utfTo(const SourceString& str, std::false_type)
     using CharTrg = GetCharTypeT<TargetString>;
     static_assert(sizeof(CharSrc) != sizeof(CharTrg));
 
-    TargetString output;
+    const CharSrc*       it   = strBegin(str);
+    const CharSrc* const last = it + strLength(str);
 
-    UtfDecoder<CharSrc> decoder(strBegin(str), strLength(str));
-    while (const std::optional<CodePoint> cp = decoder.getNext())
-        codePointToUtf<CharTrg>(*cp, [&](CharTrg c) { output += c; });
+    TargetString output;
+    output.reserve(last - it); //exact for ASCII
 
+    while (it != last)
+    {
+        //fast path: ASCII is encoded identically in UTF8/16/32
+        const CharSrc* const itAsciiEnd = findNonAscii(it, last);
+        for (; it != itAsciiEnd; ++it)
+            output += static_cast<CharTrg>(*it);
+
+        //slow path: multi-byte UTF8 and UTF16 surrogates contain no ASCII => decode non-ASCII range separately
+        const CharSrc* const itNonAsciiEnd = std::find_if(it, last, [](CharSrc c) { return isAsciiChar(c); });
+
+        UtfDecoder<CharSrc> decoder(it, itNonAsciiEnd - it);
+        while (const std::optional<CodePoint> cp = decoder.getNext())
+            codePointToUtf<CharTrg>(*cp, [&](CharTrg c) { output += c; });
+        it = itNonAsciiEnd;
+    }
     return output;
 }
 }
@@ -85,9 +85,8 @@ Zstring getUpperCaseAscii(const Zstring& str)
 {
     assert(isAsciiString(str));
 
-    Zstring output = str;
-    for (Zchar& c : output)  //identical to LCMapStringEx(), g_unichar_toupper(), CFStringUppercase() [verified!]
-        c = asciiToUpper(c); //
+    Zstring output = str; //identical to LCMapStringEx(), g_unichar_toupper(), CFStringUppercase() [verified!]
+    impl::asciiToUpperInPlace(output.begin(), output.end());
     return output;
 }
 